@@ -1,17 +1,22 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Jewel3D/Precompiled.h"
 #include "Application.h"
+#include "FrameStats.h"
 #include "Logging.h"
+#include "Profiler.h"
 #include "Timer.h"
 #include "Jewel3D/Input/Input.h"
 #include "Jewel3D/Rendering/Light.h"
 #include "Jewel3D/Rendering/ParticleEmitter.h"
 #include "Jewel3D/Rendering/Rendering.h"
+#include "Jewel3D/Resource/AssetReloader.h"
+#include "Jewel3D/Resource/AssetStreamer.h"
 #include "Jewel3D/Resource/Font.h"
 #include "Jewel3D/Resource/Model.h"
 #include "Jewel3D/Resource/ParticleBuffer.h"
 #include "Jewel3D/Resource/Shader.h"
 #include "Jewel3D/Resource/Texture.h"
+#include "Jewel3D/Resource/TextureStreamer.h"
 #include "Jewel3D/Sound/SoundSystem.h"
 
 #include <GLEW/GL/glew.h>
@@ -326,6 +331,10 @@ namespace Jwl
 	{
 		ASSERT(hwnd != NULL, "A game window must be created before calling this function.");
 
+		// Streaming assets are completed first so that they are released along with the rest.
+		AssetReloader.Disable();
+		AssetStreamer.Unload();
+
 		// Delete all resources that require the OpenGL context.
 		UnloadAll<Font>();
 		UnloadAll<Shader>();
@@ -374,6 +383,8 @@ namespace Jwl
 		__int64 lastRender = lastUpdate;
 		__int64 lastFpsCapture = lastRender;
 
+		Profiler.SetThreadName("Main");
+
 		while (true)
 		{
 			// Updates our input and Windows OS events.
@@ -397,6 +408,7 @@ namespace Jwl
 			unsigned updateCount = 0;
 			while (currentTime - lastUpdate >= updateStep)
 			{
+				PROFILE_SCOPE("Update");
 				update();
 
 				// The user might have requested to exit during update().
@@ -423,11 +435,21 @@ namespace Jwl
 				// If the frame rate is uncapped or we are due for a new frame, render the latest game-state.
 				if (FPSCap == 0 || (currentTime - lastRender) >= renderStep)
 				{
-					draw();
-					SwapBuffers(deviceContext);
+					{
+						PROFILE_SCOPE("Draw");
+						draw();
+						SwapBuffers(deviceContext);
+					}
+
+					// Stream texture levels in and out based on what was just drawn.
+					TextureStreamer.Update();
 
 					lastRender += renderStep;
 					fpsCounter++;
+
+					// Summarize the zones recorded and the work done during the frame.
+					Profiler.EndFrame();
+					FrameStats.EndFrame();
 				}
 			}
 		}
@@ -435,9 +457,18 @@ namespace Jwl
 
 	void ApplicationSingleton::UpdateEngine()
 	{
+		PROFILE_SCOPE("UpdateEngine");
+
 		// Distribute all queued events to their listeners.
+		Input.BeginDispatch();
 		EventQueue.Dispatch();
 
+		// Begin reloading assets whose files have changed.
+		AssetReloader.Update();
+
+		// Upload assets that have finished streaming in the background.
+		AssetStreamer.Update();
+
 		// Update engine components.
 		for (Entity& entity : With<ParticleUpdaterTag>())
 		{
@@ -726,7 +757,7 @@ namespace Jwl
 				Application.screenViewport.height = height;
 				Application.screenViewport.bind();
 
-				EventQueue.Push(std::make_unique<Resize>(Application.screenViewport.width, Application.screenViewport.height));
+				EventQueue.Push<Resize>(Application.screenViewport.width, Application.screenViewport.height);
 			}
 			return 0;
 		}
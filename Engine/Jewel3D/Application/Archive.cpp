@@ -0,0 +1,457 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "Archive.h"
+#include "Jewel3D/Utilities/BinaryReader.h"
+#include "Jewel3D/Utilities/Compression.h"
+#include "Jewel3D/Utilities/Hash.h"
+#include "Jewel3D/Utilities/ScopeGuard.h"
+
+#include <algorithm>
+#include <mutex>
+
+#define ARCHIVE_VERSION 1
+
+namespace
+{
+	constexpr char archiveMagic[4] = { 'J', 'W', 'P', 'K' };
+
+	// Begins every archive. It is followed by the table of contents, the name table, and then the data.
+	struct ArchiveHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t namesSize;
+	};
+
+	bool EntryLess(const Jwl::ArchiveEntry& entry, uint64_t hash)
+	{
+		return entry.nameHash < hash;
+	}
+
+	struct MountPoint
+	{
+		std::string archiveFile;
+		std::string directory;
+		std::shared_ptr<Jwl::Archive> archive;
+	};
+
+	// Mounted archives are searched from the back.
+	std::vector<MountPoint> mountPoints;
+	// Files can be opened from any thread while streaming.
+	std::mutex mountMutex;
+}
+
+namespace Jwl
+{
+	std::string NormalizeArchivePath(std::string_view path)
+	{
+		while (path.size() >= 2 && path[0] == '.' && (path[1] == '/' || path[1] == '\\'))
+		{
+			path.remove_prefix(2);
+		}
+
+		std::string result(path);
+		for (char& c : result)
+		{
+			if (c == '\\')
+			{
+				c = '/';
+			}
+			else
+			{
+				c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+			}
+		}
+
+		return result;
+	}
+
+	bool Archive::Open(std::string_view _file)
+	{
+		Close();
+
+		FileMapping mapping;
+		if (!mapping.Open(_file))
+		{
+			Error("Archive: ( %s )\nUnable to open file.", _file.data());
+			return false;
+		}
+
+		// Only the header and table of contents are mapped now. Entries are mapped as they are opened.
+		FileView headerView = mapping.Map(0, sizeof(ArchiveHeader));
+		BinaryReader headerReader(headerView.GetData(), headerView.GetSize());
+
+		ArchiveHeader header;
+		if (!headerReader.Read(header) ||
+			memcmp(header.magic, archiveMagic, sizeof(archiveMagic)) != 0 ||
+			header.version != ARCHIVE_VERSION)
+		{
+			Error("Archive: ( %s )\nNot a valid archive, or was created by a different version.", _file.data());
+			return false;
+		}
+
+		// Computed in 64 bits so that a corrupt entry count cannot wrap the size around.
+		const uint64_t tocSize = sizeof(ArchiveEntry) * static_cast<uint64_t>(header.entryCount);
+		const uint64_t tableSize = tocSize + header.namesSize;
+		FileView tableView = tableSize <= SIZE_MAX ? mapping.Map(sizeof(ArchiveHeader), static_cast<size_t>(tableSize)) : FileView();
+		if (!tableView.IsOpen())
+		{
+			Error("Archive: ( %s )\nTable of contents is truncated.", _file.data());
+			return false;
+		}
+
+		std::vector<ArchiveEntry> tocEntries(header.entryCount);
+		if (!tocEntries.empty())
+		{
+			memcpy(tocEntries.data(), tableView.GetData(), static_cast<size_t>(tocSize));
+		}
+
+		// Validate every entry up front so that lookups never need to.
+		const uint64_t fileSize = mapping.GetSize();
+		for (auto& entry : tocEntries)
+		{
+			if (entry.nameOffset > header.namesSize ||
+				entry.nameLength > header.namesSize - entry.nameOffset ||
+				entry.offset > fileSize ||
+				entry.storedSize > fileSize - entry.offset ||
+				entry.storedSize > SIZE_MAX ||
+				entry.size > SIZE_MAX ||
+				(entry.compression == static_cast<uint32_t>(ArchiveCompression::None) && entry.storedSize != entry.size) ||
+				entry.compression > static_cast<uint32_t>(ArchiveCompression::LZ4))
+			{
+				Error("Archive: ( %s )\nContains an invalid entry.", _file.data());
+				return false;
+			}
+		}
+
+		const char* nameTable = reinterpret_cast<const char*>(tableView.GetData()) + static_cast<size_t>(tocSize);
+		names.assign(nameTable, nameTable + header.namesSize);
+		entries = std::move(tocEntries);
+		file = std::move(mapping);
+
+		return true;
+	}
+
+	void Archive::Close()
+	{
+		file.Close();
+		entries.clear();
+		names.clear();
+	}
+
+	bool Archive::IsOpen() const
+	{
+		return file.IsOpen();
+	}
+
+	bool Archive::Contains(std::string_view name) const
+	{
+		return FindEntry(name) != nullptr;
+	}
+
+	bool Archive::OpenEntry(std::string_view name, FileView& out) const
+	{
+		const ArchiveEntry* entry = FindEntry(name);
+		if (entry == nullptr)
+		{
+			return false;
+		}
+
+		FileView stored = file.Map(entry->offset, static_cast<size_t>(entry->storedSize));
+		if (!stored.IsOpen())
+		{
+			Error("Archive: ( %s )\nUnable to map entry.", std::string(name).c_str());
+			return false;
+		}
+
+		if (entry->compression == static_cast<uint32_t>(ArchiveCompression::None))
+		{
+			out = std::move(stored);
+			return true;
+		}
+
+		std::vector<unsigned char> buffer(static_cast<size_t>(entry->size));
+		if (!DecompressLZ4(stored.GetData(), stored.GetSize(), buffer.data(), buffer.size()))
+		{
+			Error("Archive: ( %s )\nEntry is corrupt.", std::string(name).c_str());
+			return false;
+		}
+
+		out = FileView::FromBuffer(std::move(buffer));
+		return true;
+	}
+
+	const std::vector<ArchiveEntry>& Archive::GetEntries() const
+	{
+		return entries;
+	}
+
+	std::string_view Archive::GetName(const ArchiveEntry& entry) const
+	{
+		return std::string_view(names).substr(entry.nameOffset, entry.nameLength);
+	}
+
+	const ArchiveEntry* Archive::FindEntry(std::string_view name) const
+	{
+		const std::string normalized = NormalizeArchivePath(name);
+		const uint64_t hash = HashFNV(normalized);
+
+		// Names with the same hash are adjacent, so we check each of them.
+		for (auto itr = std::lower_bound(entries.begin(), entries.end(), hash, EntryLess);
+			itr != entries.end() && itr->nameHash == hash; ++itr)
+		{
+			if (GetName(*itr) == normalized)
+			{
+				return &*itr;
+			}
+		}
+
+		return nullptr;
+	}
+
+	//-----------------------------------------------------------------------------------------------------
+
+	void ArchiveWriter::Add(std::string_view name, std::vector<unsigned char> data, bool compress)
+	{
+		PendingEntry entry;
+		entry.name = NormalizeArchivePath(name);
+		entry.size = data.size();
+		entry.compression = ArchiveCompression::None;
+
+		if (compress && !data.empty())
+		{
+			std::vector<unsigned char> compressed;
+			CompressLZ4(data.data(), data.size(), compressed);
+
+			if (compressed.size() < data.size())
+			{
+				data = std::move(compressed);
+				entry.compression = ArchiveCompression::LZ4;
+			}
+		}
+
+		entry.data = std::move(data);
+
+		// Replace any previous entry with the same name.
+		auto itr = std::find_if(pending.begin(), pending.end(), [&](const PendingEntry& other) { return other.name == entry.name; });
+		if (itr != pending.end())
+		{
+			*itr = std::move(entry);
+		}
+		else
+		{
+			pending.push_back(std::move(entry));
+		}
+	}
+
+	bool ArchiveWriter::AddFile(std::string_view name, std::string_view filePath, bool compress)
+	{
+		FILE* input = fopen(filePath.data(), "rb");
+		if (input == nullptr)
+		{
+			Error("Archive: ( %s )\nUnable to open file.", filePath.data());
+			return false;
+		}
+		defer { fclose(input); };
+
+		fseek(input, 0, SEEK_END);
+		const long size = ftell(input);
+		fseek(input, 0, SEEK_SET);
+
+		std::vector<unsigned char> data(size > 0 ? static_cast<size_t>(size) : 0);
+		if (!data.empty() && fread(data.data(), data.size(), 1, input) != 1)
+		{
+			Error("Archive: ( %s )\nUnable to read file.", filePath.data());
+			return false;
+		}
+
+		Add(name, std::move(data), compress);
+		return true;
+	}
+
+	bool ArchiveWriter::Save(std::string_view _file) const
+	{
+		// Sort the table of contents by hash, then by name to keep the output deterministic.
+		std::vector<const PendingEntry*> sorted;
+		sorted.reserve(pending.size());
+		for (auto& entry : pending)
+		{
+			sorted.push_back(&entry);
+		}
+
+		std::sort(sorted.begin(), sorted.end(), [](const PendingEntry* a, const PendingEntry* b) {
+			const uint64_t hashA = HashFNV(a->name);
+			const uint64_t hashB = HashFNV(b->name);
+			return hashA != hashB ? hashA < hashB : a->name < b->name;
+		});
+
+		std::string nameTable;
+		std::vector<ArchiveEntry> toc(sorted.size());
+
+		ArchiveHeader header;
+		memcpy(header.magic, archiveMagic, sizeof(archiveMagic));
+		header.version = ARCHIVE_VERSION;
+		header.entryCount = static_cast<uint32_t>(sorted.size());
+
+		for (size_t i = 0; i < sorted.size(); ++i)
+		{
+			toc[i].nameHash = HashFNV(sorted[i]->name);
+			toc[i].nameOffset = static_cast<uint32_t>(nameTable.size());
+			toc[i].nameLength = static_cast<uint32_t>(sorted[i]->name.size());
+			toc[i].storedSize = sorted[i]->data.size();
+			toc[i].size = sorted[i]->size;
+			toc[i].compression = static_cast<uint32_t>(sorted[i]->compression);
+			toc[i].padding = 0;
+
+			nameTable += sorted[i]->name;
+		}
+
+		header.namesSize = static_cast<uint32_t>(nameTable.size());
+
+		// Lay out the data after the table of contents.
+		auto align = [](uint64_t offset) { return (offset + ARCHIVE_ALIGNMENT - 1) & ~(ARCHIVE_ALIGNMENT - 1); };
+
+		uint64_t offset = align(sizeof(ArchiveHeader) + sizeof(ArchiveEntry) * toc.size() + nameTable.size());
+		for (auto& entry : toc)
+		{
+			entry.offset = offset;
+			offset = align(offset + entry.storedSize);
+		}
+
+		FILE* output = fopen(_file.data(), "wb");
+		if (output == nullptr)
+		{
+			Error("Archive: ( %s )\nUnable to create file.", _file.data());
+			return false;
+		}
+
+		bool success =
+			fwrite(&header, sizeof(ArchiveHeader), 1, output) == 1 &&
+			fwrite(toc.data(), sizeof(ArchiveEntry), toc.size(), output) == toc.size() &&
+			fwrite(nameTable.data(), 1, nameTable.size(), output) == nameTable.size();
+
+		const std::vector<unsigned char> zeros(ARCHIVE_ALIGNMENT, 0);
+		uint64_t position = sizeof(ArchiveHeader) + sizeof(ArchiveEntry) * toc.size() + nameTable.size();
+		for (size_t i = 0; i < toc.size() && success; ++i)
+		{
+			const size_t paddingSize = static_cast<size_t>(toc[i].offset - position);
+			const auto& data = sorted[i]->data;
+
+			success =
+				fwrite(zeros.data(), 1, paddingSize, output) == paddingSize &&
+				(data.empty() || fwrite(data.data(), 1, data.size(), output) == data.size());
+
+			position = toc[i].offset + data.size();
+		}
+
+		success = (fclose(output) == 0) && success;
+		if (!success)
+		{
+			Error("Archive: ( %s )\nFailed to write file.", _file.data());
+			RemoveFile(_file);
+		}
+
+		return success;
+	}
+
+	unsigned ArchiveWriter::GetEntryCount() const
+	{
+		return static_cast<unsigned>(pending.size());
+	}
+
+	//-----------------------------------------------------------------------------------------------------
+
+	bool MountArchive(std::string_view archiveFile, std::string_view directory)
+	{
+		auto archive = std::make_shared<Archive>();
+		if (!archive->Open(archiveFile))
+		{
+			return false;
+		}
+
+		MountPoint mount;
+		mount.archiveFile = archiveFile;
+		mount.directory = NormalizeArchivePath(directory);
+		mount.archive = std::move(archive);
+
+		if (!mount.directory.empty() && mount.directory.back() != '/')
+		{
+			mount.directory.push_back('/');
+		}
+
+		std::lock_guard lock(mountMutex);
+		mountPoints.push_back(std::move(mount));
+
+		return true;
+	}
+
+	void UnmountArchive(std::string_view archiveFile)
+	{
+		std::lock_guard lock(mountMutex);
+		mountPoints.erase(std::remove_if(mountPoints.begin(), mountPoints.end(), [archiveFile](const MountPoint& mount) {
+			return mount.archiveFile == archiveFile;
+		}), mountPoints.end());
+	}
+
+	void UnmountAllArchives()
+	{
+		std::lock_guard lock(mountMutex);
+		mountPoints.clear();
+	}
+
+	bool OpenFromArchive(std::string_view filePath, FileView& out)
+	{
+		// The matching archives are gathered under the lock, but entries are opened without it,
+		// so that decompressing a large entry does not block other threads from opening files.
+		std::vector<std::pair<std::shared_ptr<Archive>, size_t>> candidates;
+		std::string normalized;
+		{
+			std::lock_guard lock(mountMutex);
+			if (mountPoints.empty())
+			{
+				return false;
+			}
+
+			normalized = NormalizeArchivePath(filePath);
+			for (auto itr = mountPoints.rbegin(); itr != mountPoints.rend(); ++itr)
+			{
+				if (normalized.compare(0, itr->directory.size(), itr->directory) == 0)
+				{
+					candidates.emplace_back(itr->archive, itr->directory.size());
+				}
+			}
+		}
+
+		for (auto& [archive, prefixSize] : candidates)
+		{
+			if (archive->OpenEntry(std::string_view(normalized).substr(prefixSize), out))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool IsInArchive(std::string_view filePath)
+	{
+		std::lock_guard lock(mountMutex);
+		if (mountPoints.empty())
+		{
+			return false;
+		}
+
+		const std::string normalized = NormalizeArchivePath(filePath);
+		for (const MountPoint& mountPoint : mountPoints)
+		{
+			if (normalized.compare(0, mountPoint.directory.size(), mountPoint.directory) == 0 &&
+				mountPoint.archive->Contains(std::string_view(normalized).substr(mountPoint.directory.size())))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include "FileSystem.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Jwl
+{
+	// Describes one file stored in an archive.
+	struct ArchiveEntry
+	{
+		uint64_t nameHash;
+		// Location of the entry's name in the archive's name table.
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		// Location of the entry's data from the start of the archive. Always aligned to ARCHIVE_ALIGNMENT.
+		uint64_t offset;
+		uint64_t storedSize;
+		// Size of the data once decompressed.
+		uint64_t size;
+		uint32_t compression;
+		uint32_t padding;
+	};
+
+	// Data is aligned to the size of a page so that reading an entry never faults in the pages of another.
+	// Entries are mapped individually, starting from the allocation granularity below their offset.
+	constexpr uint64_t ARCHIVE_ALIGNMENT = 4096;
+
+	enum class ArchiveCompression : uint32_t
+	{
+		None = 0,
+		LZ4  = 1
+	};
+
+	// Converts a path to the form used for archive lookups: lowercase, with forward slashes, without a leading "./".
+	std::string NormalizeArchivePath(std::string_view path);
+
+	// A read-only collection of files packed into a single file on disk.
+	// The table of contents is sorted by the hash of each name so that lookups are a binary search.
+	// Only the entries that are opened are mapped into memory, so archives can be larger than the address space.
+	class Archive
+	{
+	public:
+		bool Open(std::string_view file);
+		void Close();
+
+		bool IsOpen() const;
+
+		// Returns true if the archive contains an entry with the name.
+		bool Contains(std::string_view name) const;
+
+		// Provides the contents of the entry. Uncompressed entries are mapped in place, without a copy.
+		bool OpenEntry(std::string_view name, FileView& out) const;
+
+		const std::vector<ArchiveEntry>& GetEntries() const;
+		std::string_view GetName(const ArchiveEntry& entry) const;
+
+	private:
+		const ArchiveEntry* FindEntry(std::string_view name) const;
+
+		FileMapping file;
+		std::vector<ArchiveEntry> entries;
+		std::string names;
+	};
+
+	// Builds a new archive.
+	class ArchiveWriter
+	{
+	public:
+		// Adds the data as an entry. With compression, the entry is only compressed if it becomes smaller.
+		void Add(std::string_view name, std::vector<unsigned char> data, bool compress);
+		// Adds the contents of a file on disk as an entry.
+		bool AddFile(std::string_view name, std::string_view filePath, bool compress);
+
+		// Writes the archive to disk.
+		bool Save(std::string_view file) const;
+
+		unsigned GetEntryCount() const;
+
+	private:
+		struct PendingEntry
+		{
+			std::string name;
+			std::vector<unsigned char> data;
+			size_t size;
+			ArchiveCompression compression;
+		};
+
+		std::vector<PendingEntry> pending;
+	};
+
+	// Makes the archive's contents available to FileView::Open() and LoadFileAsString() under the directory.
+	// For example, an entry named "Models/Tree.model" mounted at "./Assets/" is opened as "./Assets/Models/Tree.model".
+	// Archives mounted later take priority, so they can be used to patch earlier ones.
+	bool MountArchive(std::string_view archiveFile, std::string_view directory);
+	void UnmountArchive(std::string_view archiveFile);
+	void UnmountAllArchives();
+
+	// Opens a file from the mounted archives. Returns false if no archive contains the file.
+	bool OpenFromArchive(std::string_view filePath, FileView& out);
+	// Whether FileView::Open() would find the file in one of the mounted archives rather than on disk.
+	bool IsInArchive(std::string_view filePath);
+}
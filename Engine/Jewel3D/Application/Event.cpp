@@ -2,23 +2,85 @@
 #include "Jewel3D/Precompiled.h"
 #include "Event.h"
 
+#include <algorithm>
+#include <thread>
+
 #ifdef _DEBUG
 #include "Jewel3D/Application/Logging.h"
 #endif
 
+namespace
+{
+	// The size of an arena's first block. Arenas grow to fit the largest frame seen so far.
+	constexpr size_t DEFAULT_BLOCK_SIZE = 4 * 1024;
+
+	constexpr size_t AlignSize(size_t size)
+	{
+		return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+	}
+}
+
 namespace Jwl
 {
 	EventQueueSingleton EventQueue;
 
-	void EventQueueSingleton::Push(std::unique_ptr<EventBase> e)
+	// A chunk of arena memory. The storage immediately follows the header.
+	struct EventQueueSingleton::Block
 	{
-#ifdef _DEBUG
-		ASSERT(!inDispatch,
-			"It is dangerous to add a new event to the queue while currently inside a global Dispatch().\n"
-			"Consider using Dispatch(const EventBase&) instead.");
-#endif
+		Block* next;
+		size_t capacity;
+		// Can exceed the capacity once the block is full.
+		std::atomic<size_t> used;
+
+		static Block* Create(size_t capacity, size_t used)
+		{
+			Block* block = new (::operator new(GetHeaderSize() + capacity)) Block;
+			block->next = nullptr;
+			block->capacity = capacity;
+			block->used = used;
+
+			return block;
+		}
+
+		static void Destroy(Block* block)
+		{
+			block->~Block();
+			::operator delete(block);
+		}
 
-		eventQueue.push(std::move(e));
+		std::byte* GetStorage()
+		{
+			return reinterpret_cast<std::byte*>(this) + GetHeaderSize();
+		}
+
+		// The storage is padded to keep it aligned.
+		static constexpr size_t GetHeaderSize()
+		{
+			return AlignSize(sizeof(Block));
+		}
+	};
+
+	EventQueueSingleton::~EventQueueSingleton()
+	{
+		// Events that were never dispatched must still be destroyed.
+		Bucket* bucket = buckets.exchange(nullptr);
+		while (bucket)
+		{
+			for (Arena& arena : bucket->arenas)
+			{
+				for (Block* block = arena.current.exchange(nullptr); block;)
+				{
+					Block* next = block->next;
+					bucket->destroy(block->GetStorage(), static_cast<unsigned>(std::min(block->used.load(), block->capacity) / bucket->eventSize));
+					Block::Destroy(block);
+					block = next;
+				}
+			}
+
+			Bucket* next = bucket->next.load();
+			delete bucket;
+			bucket = next;
+		}
 	}
 
 	void EventQueueSingleton::Dispatch(const EventBase& e) const
@@ -29,19 +91,162 @@ namespace Jwl
 	void EventQueueSingleton::Dispatch()
 	{
 #ifdef _DEBUG
-		// Events should not be posted during this call.
+		ASSERT(!inDispatch, "Dispatch() cannot be called recursively from a listener.");
 		inDispatch = true;
 #endif
 
-		while (!eventQueue.empty())
+		// New events are allocated from the other arenas from now on.
+		// Once the pushes already in progress have finished, every event in these arenas is ready.
+		const unsigned index = activeArena.load();
+		activeArena.store(1 - index);
+
+		while (writers[index].load() != 0)
+		{
+			std::this_thread::yield();
+		}
+
+		for (Bucket* bucket = buckets.load(std::memory_order_acquire); bucket; bucket = bucket->next.load(std::memory_order_acquire))
 		{
-			eventQueue.front()->Raise();
-			eventQueue.pop();
+			Drain(*bucket, bucket->arenas[index]);
 		}
 
 #ifdef _DEBUG
-		// Events can be posted again.
 		inDispatch = false;
 #endif
 	}
+
+	EventQueueSingleton::Bucket& EventQueueSingleton::AddBucket(size_t eventSize, bool isCoalesced, void (*raise)(const std::byte*, unsigned), void (*destroy)(std::byte*, unsigned))
+	{
+		Bucket* bucket = new Bucket;
+		bucket->eventSize = eventSize;
+		bucket->isCoalesced = isCoalesced;
+		bucket->raise = raise;
+		bucket->destroy = destroy;
+
+		// Append to the end of the list, so that types are dispatched in the order they were first pushed.
+		// If another thread appends first, we continue from their bucket instead.
+		std::atomic<Bucket*>* link = &buckets;
+		Bucket* expected = nullptr;
+		while (!link->compare_exchange_strong(expected, bucket, std::memory_order_acq_rel))
+		{
+			link = &expected->next;
+			expected = nullptr;
+		}
+
+		return *bucket;
+	}
+
+	unsigned EventQueueSingleton::BeginPush()
+	{
+		// Register as a writer of the active arenas, so that Dispatch() waits for the event before draining them.
+		// If the active arenas changed while registering, the new ones are used instead.
+		unsigned index = activeArena.load();
+		while (true)
+		{
+			writers[index].fetch_add(1);
+
+			const unsigned active = activeArena.load();
+			if (active == index)
+			{
+				return index;
+			}
+
+			writers[index].fetch_sub(1);
+			index = active;
+		}
+	}
+
+	void EventQueueSingleton::EndPush(unsigned arena)
+	{
+		writers[arena].fetch_sub(1);
+	}
+
+	void* EventQueueSingleton::Allocate(Arena& arena, size_t size)
+	{
+		// Each arena holds a single type of event, so they can be packed together without padding.
+		while (true)
+		{
+			Block* block = arena.current.load(std::memory_order_acquire);
+			if (block)
+			{
+				const size_t offset = block->used.fetch_add(size, std::memory_order_relaxed);
+				if (offset + size <= block->capacity)
+				{
+					return block->GetStorage() + offset;
+				}
+			}
+
+			// The block is full, so a larger one replaces it. If another thread replaces it first, we use theirs instead.
+			Block* replacement = Block::Create(block ? std::max(block->capacity * 2, size) : std::max(DEFAULT_BLOCK_SIZE, size), size);
+			replacement->next = block;
+			if (arena.current.compare_exchange_strong(block, replacement, std::memory_order_acq_rel))
+			{
+				return replacement->GetStorage();
+			}
+
+			Block::Destroy(replacement);
+		}
+	}
+
+	void EventQueueSingleton::Drain(const Bucket& bucket, Arena& arena)
+	{
+		Block* newest = arena.current.load(std::memory_order_acquire);
+		if (!newest)
+		{
+			return;
+		}
+
+		const size_t stride = bucket.eventSize;
+		auto GetCount = [stride](const Block& block) {
+			return static_cast<unsigned>(std::min(block.used.load(std::memory_order_relaxed), block.capacity) / stride);
+		};
+
+		if (bucket.isCoalesced)
+		{
+			if (const unsigned count = GetCount(*newest))
+			{
+				bucket.raise(newest->GetStorage() + (count - 1) * stride, 1);
+			}
+		}
+		else
+		{
+			// Blocks are linked from newest to oldest, so the oldest are visited first on the way back.
+			auto RaiseFrom = [&](auto& self, Block& block) -> void {
+				if (block.next)
+				{
+					self(self, *block.next);
+				}
+
+				if (const unsigned count = GetCount(block))
+				{
+					bucket.raise(block.GetStorage(), count);
+				}
+			};
+
+			RaiseFrom(RaiseFrom, *newest);
+		}
+
+		for (Block* block = newest; block; block = block->next)
+		{
+			bucket.destroy(block->GetStorage(), GetCount(*block));
+		}
+
+		if (!newest->next)
+		{
+			newest->used = 0;
+			return;
+		}
+
+		// The arena outgrew its first block, so it is replaced by one that can hold everything at once.
+		size_t capacity = 0;
+		for (Block* block = newest; block;)
+		{
+			Block* next = block->next;
+			capacity += block->capacity;
+			Block::Destroy(block);
+			block = next;
+		}
+
+		arena.current = Block::Create(capacity, 0);
+	}
 }
@@ -1,8 +1,9 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
-#include <functional>
-#include <memory>
-#include <queue>
+#include "Jewel3D/Utilities/Delegate.h"
+
+#include <atomic>
+#include <cstddef>
 #include <vector>
 
 namespace Jwl
@@ -34,17 +35,15 @@ namespace Jwl
 
 		// Subscribes to the event.
 		Listener();
-		Listener(const std::function<EventFunc>& callback);
-		Listener(std::function<EventFunc>&& callback);
+		Listener(Delegate<EventFunc> callback);
 
 		// Unsubscribes from the event.
 		~Listener();
 
-		Listener& operator=(const std::function<EventFunc>& callback);
-		Listener& operator=(std::function<EventFunc>&& callback);
+		Listener& operator=(Delegate<EventFunc> callback);
 
 	private:
-		std::function<EventFunc> callback;
+		Delegate<EventFunc> callback;
 	};
 
 	// You can inherit from this class to create your own custom events.
@@ -54,6 +53,7 @@ namespace Jwl
 	class Event : public EventBase
 	{
 		friend Listener<derived>;
+		friend class EventQueueSingleton;
 	public:
 		virtual ~Event() = default;
 
@@ -64,8 +64,14 @@ namespace Jwl
 		// Returns a vector of all objects currently listening for this type of event.
 		static const auto& GetListenersStatic() { return listeners; }
 
+		// When several events of this type are queued between dispatches, only the last one is distributed.
+		// Derived events can hide this with their own 'static constexpr bool IsCoalesced = true;'.
+		static constexpr bool IsCoalesced = false;
+
 	private:
 		void Raise() const final override;
+		// Notifies each listener of all the events, one listener at a time.
+		static void RaiseAll(const derived* events, unsigned count);
 
 		// Subscribes a listener to be notified from this type of event.
 		static void Subscribe(Listener<derived>& listener);
@@ -77,27 +83,80 @@ namespace Jwl
 	};
 
 	// This singleton class handles queuing and distribution of events.
+	// Events can be pushed from any thread. Each type of event is stored contiguously in its own linear arena,
+	// which is recycled on each Dispatch().
 	extern class EventQueueSingleton EventQueue;
 	class EventQueueSingleton
 	{
 	public:
-		// Add a new event to the queue.
+		EventQueueSingleton() = default;
+		EventQueueSingleton(const EventQueueSingleton&) = delete;
+		~EventQueueSingleton();
+
+		EventQueueSingleton& operator=(const EventQueueSingleton&) = delete;
+
+		// Constructs a new event in the queue from the given arguments.
 		// The event will be distributed to all listeners of its type when Dispatch() is called.
-		void Push(std::unique_ptr<EventBase> e);
+		// This is safe to call from any thread, including from listeners during Dispatch().
+		template<class EventObj, typename... Args>
+		void Push(Args&&... args);
 
 		// Instantly distributes an event across listeners. It is not added to the queue.
 		void Dispatch(const EventBase& e) const;
 
-		// Sequences through the queue of events and distributes them to all the listeners.
-		// There will be no events in the queue when this function returns.
-		// It is illegal, and unsafe, to post new events while this function is executing.
+		// Distributes the queued events to all the listeners, one type of event at a time.
+		// Types are distributed in the order they were first pushed, and events of the same type in the order they were pushed.
+		// Events pushed while this function is executing are held until the next call.
+		// This must only be called from one thread, and not recursively from a listener.
 		void Dispatch();
 
 	private:
-		std::queue<std::unique_ptr<EventBase>> eventQueue;
+		struct Block;
+		struct Arena
+		{
+			// The block currently being allocated from, linked to those filled before it.
+			std::atomic<Block*> current = nullptr;
+		};
+
+		// The queued events of one type.
+		struct Bucket
+		{
+			// Events are allocated from one arena while the events from the other are being dispatched.
+			Arena arenas[2];
+			size_t eventSize;
+			bool isCoalesced;
+			void (*raise)(const std::byte* events, unsigned count);
+			void (*destroy)(std::byte* events, unsigned count);
+			std::atomic<Bucket*> next = nullptr;
+		};
+
+		// Returns the bucket for the type, creating it on first use.
+		template<class EventObj>
+		Bucket& GetBucket();
+		Bucket& AddBucket(size_t eventSize, bool isCoalesced, void (*raise)(const std::byte*, unsigned), void (*destroy)(std::byte*, unsigned));
+
+		template<class EventObj>
+		static void RaiseEvents(const std::byte* events, unsigned count);
+		template<class EventObj>
+		static void DestroyEvents(std::byte* events, unsigned count);
+
+		// Returns the index of the arena to allocate from. Must be followed by a call to EndPush() once the event is constructed.
+		unsigned BeginPush();
+		void EndPush(unsigned arena);
+
+		static void* Allocate(Arena& arena, size_t size);
+		// Distributes, destroys, and releases all the events in the arena. The arena must not have any writers.
+		static void Drain(const Bucket& bucket, Arena& arena);
+
+		// Every type of event pushed so far, in the order they were first pushed.
+		std::atomic<Bucket*> buckets = nullptr;
+
+		std::atomic<unsigned> activeArena = 0;
+		// The number of threads currently pushing an event into each arena.
+		std::atomic<unsigned> writers[2] = {};
 
 #ifdef _DEBUG
-		// Stops events from being queued during a call to Dispatch().
+		// Detects recursive calls to Dispatch().
 		bool inDispatch = false;
 #endif
 	};
@@ -1,4 +1,7 @@
 // Copyright (c) 2017 Emilian Cioca
+#include <new>
+#include <utility>
+
 namespace Jwl
 {
 	template<class derived> std::vector<Listener<derived>*> Event<derived>::listeners;
@@ -10,14 +13,7 @@ namespace Jwl
 	}
 
 	template<class EventObj>
-	Listener<EventObj>::Listener(const std::function<EventFunc>& _callback)
-		: callback(_callback)
-	{
-		EventObj::Subscribe(*this);
-	}
-
-	template<class EventObj>
-	Listener<EventObj>::Listener(std::function<EventFunc>&& _callback)
+	Listener<EventObj>::Listener(Delegate<EventFunc> _callback)
 		: callback(std::move(_callback))
 	{
 		EventObj::Subscribe(*this);
@@ -30,14 +26,7 @@ namespace Jwl
 	}
 
 	template<class EventObj>
-	Listener<EventObj>& Listener<EventObj>::operator=(const std::function<EventFunc>& _callback)
-	{
-		callback = _callback;
-		return *this;
-	}
-
-	template<class EventObj>
-	Listener<EventObj>& Listener<EventObj>::operator=(std::function<EventFunc>&& _callback)
+	Listener<EventObj>& Listener<EventObj>::operator=(Delegate<EventFunc> _callback)
 	{
 		callback = std::move(_callback);
 		return *this;
@@ -67,6 +56,23 @@ namespace Jwl
 		}
 	}
 
+	template<class derived>
+	void Event<derived>::RaiseAll(const derived* events, unsigned count)
+	{
+		for (unsigned i = 0; i < listeners.size(); ++i)
+		{
+			if (!listeners[i]->callback)
+			{
+				continue;
+			}
+
+			for (unsigned j = 0; j < count; ++j)
+			{
+				listeners[i]->callback(events[j]);
+			}
+		}
+	}
+
 	template<class derived>
 	void Event<derived>::Subscribe(Listener<derived>& listener)
 	{
@@ -78,4 +84,42 @@ namespace Jwl
 	{
 		listeners.erase(std::find(listeners.begin(), listeners.end(), &listener));
 	}
+
+	template<class EventObj, typename... Args>
+	void EventQueueSingleton::Push(Args&&... args)
+	{
+		static_assert(std::is_base_of_v<EventBase, EventObj>, "Template argument must inherit from Event.");
+		static_assert(alignof(EventObj) <= alignof(std::max_align_t), "Over-aligned events cannot be queued.");
+
+		Bucket& bucket = GetBucket<EventObj>();
+		const unsigned arena = BeginPush();
+		new (Allocate(bucket.arenas[arena], sizeof(EventObj))) EventObj(std::forward<Args>(args)...);
+		EndPush(arena);
+	}
+
+	template<class EventObj>
+	EventQueueSingleton::Bucket& EventQueueSingleton::GetBucket()
+	{
+		static Bucket& bucket = AddBucket(sizeof(EventObj), EventObj::IsCoalesced, &RaiseEvents<EventObj>, &DestroyEvents<EventObj>);
+		return bucket;
+	}
+
+	template<class EventObj>
+	void EventQueueSingleton::RaiseEvents(const std::byte* events, unsigned count)
+	{
+		EventObj::RaiseAll(reinterpret_cast<const EventObj*>(events), count);
+	}
+
+	template<class EventObj>
+	void EventQueueSingleton::DestroyEvents(std::byte* events, unsigned count)
+	{
+		if constexpr (!std::is_trivially_destructible_v<EventObj>)
+		{
+			EventObj* objects = reinterpret_cast<EventObj*>(events);
+			for (unsigned i = 0; i < count; ++i)
+			{
+				objects[i].~EventObj();
+			}
+		}
+	}
 }
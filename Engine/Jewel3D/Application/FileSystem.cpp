@@ -1,12 +1,15 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Jewel3D/Precompiled.h"
 #include "FileSystem.h"
+#include "Archive.h"
 #include "Logging.h"
 
+#include <algorithm>
 #include <Dirent/dirent.h>
 #include <direct.h>
 #include <sstream>
 #include <stack>
+#include <Windows.h>
 
 #define SUCCESS 0
 
@@ -17,6 +20,43 @@
 namespace
 {
 	std::stack<std::string> currentDirectoryStack;
+
+	// Owns the operating system handles of a mapped file.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile()
+		{
+			if (data != nullptr) UnmapViewOfFile(data);
+			if (mappingHandle != NULL) CloseHandle(mappingHandle);
+			if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+		}
+
+		HANDLE fileHandle = INVALID_HANDLE_VALUE;
+		HANDLE mappingHandle = NULL;
+		const unsigned char* data = nullptr;
+		size_t size = 0;
+	};
+
+	// Owns a view of part of a mapped file. The view remains valid even once the file's handles are closed.
+	class MappedRange
+	{
+	public:
+		MappedRange() = default;
+		MappedRange(const MappedRange&) = delete;
+		MappedRange& operator=(const MappedRange&) = delete;
+
+		~MappedRange()
+		{
+			if (data != nullptr) UnmapViewOfFile(data);
+		}
+
+		const unsigned char* data = nullptr;
+	};
 }
 
 namespace Jwl
@@ -110,6 +150,52 @@ namespace Jwl
 		return DeleteFile(file.data()) == TRUE;
 	}
 
+	bool OverwriteFile(std::string_view file, std::string_view replacement)
+	{
+		if (!FileExists(file))
+		{
+			return MoveFileEx(replacement.data(), file.data(), MOVEFILE_REPLACE_EXISTING) == TRUE;
+		}
+
+		// A mapped file cannot be deleted or truncated, but it can be renamed out of the way.
+		// Old files that are still mapped are skipped, and removed by a later call once they are released.
+		constexpr unsigned MAX_OLD_FILES = 16;
+		std::string oldFile;
+		for (unsigned i = 0; i < MAX_OLD_FILES; ++i)
+		{
+			std::string name = std::string(file) + ".old" + std::to_string(i);
+			if (!FileExists(name) || DeleteFile(name.c_str()) == TRUE)
+			{
+				if (oldFile.empty())
+				{
+					oldFile = std::move(name);
+				}
+			}
+		}
+
+		if (oldFile.empty())
+		{
+			Error("FileSystem: Could not overwrite ( %s ) because too many old versions of it are still in use.", file.data());
+			return false;
+		}
+
+		if (MoveFileEx(file.data(), oldFile.c_str(), 0) == FALSE)
+		{
+			return false;
+		}
+
+		if (MoveFileEx(replacement.data(), file.data(), 0) == FALSE)
+		{
+			MoveFileEx(oldFile.c_str(), file.data(), 0);
+			return false;
+		}
+
+		// Fails if the old file is still mapped.
+		DeleteFile(oldFile.c_str());
+
+		return true;
+	}
+
 	bool MakeDirectory(std::string_view directory)
 	{
 		if (directory.empty())
@@ -265,6 +351,17 @@ namespace Jwl
 
 	bool LoadFileAsString(std::string_view file, std::string& output)
 	{
+		FileView archived;
+		if (OpenFromArchive(file, archived))
+		{
+			output.assign(reinterpret_cast<const char*>(archived.GetData()), archived.GetSize());
+
+			// Match the newline conversion of a file opened in text mode.
+			output.erase(std::remove(output.begin(), output.end(), '\r'), output.end());
+
+			return true;
+		}
+
 		std::ifstream inStream(file.data());
 		if (!inStream.good())
 		{
@@ -278,6 +375,206 @@ namespace Jwl
 		return true;
 	}
 
+	FileView FileView::FromBuffer(std::vector<unsigned char> buffer)
+	{
+		auto storage = std::make_shared<const std::vector<unsigned char>>(std::move(buffer));
+
+		FileView result;
+		result.data = storage->data();
+		result.size = storage->size();
+		result.owner = std::move(storage);
+
+		return result;
+	}
+
+	bool FileView::Open(std::string_view filePath)
+	{
+		Close();
+
+		if (OpenFromArchive(filePath, *this))
+		{
+			return true;
+		}
+
+		// Sharing allows the file to be replaced with OverwriteFile() while it is mapped, such as when assets are re-encoded.
+		auto file = std::make_shared<MappedFile>();
+		file->fileHandle = CreateFile(filePath.data(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file->fileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file->fileHandle, &fileSize))
+		{
+			return false;
+		}
+
+		// Empty files cannot be mapped, but they are still valid views.
+		if (fileSize.QuadPart > 0)
+		{
+			file->mappingHandle = CreateFileMapping(file->fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (file->mappingHandle == NULL)
+			{
+				return false;
+			}
+
+			file->data = static_cast<const unsigned char*>(MapViewOfFile(file->mappingHandle, FILE_MAP_READ, 0, 0, 0));
+			if (file->data == nullptr)
+			{
+				return false;
+			}
+
+			file->size = static_cast<size_t>(fileSize.QuadPart);
+		}
+
+		data = file->data;
+		size = file->size;
+		owner = std::move(file);
+
+		return true;
+	}
+
+	void FileView::Close()
+	{
+		owner.reset();
+		data = nullptr;
+		size = 0;
+	}
+
+	bool FileView::IsOpen() const
+	{
+		return owner != nullptr;
+	}
+
+	FileView FileView::GetSubView(size_t offset, size_t _size) const
+	{
+		FileView result;
+		if (offset > size || _size > size - offset)
+		{
+			return result;
+		}
+
+		result.owner = owner;
+		result.data = data + offset;
+		result.size = _size;
+
+		return result;
+	}
+
+	const unsigned char* FileView::GetData() const
+	{
+		return data;
+	}
+
+	size_t FileView::GetSize() const
+	{
+		return size;
+	}
+
+	void FileView::Prefetch() const
+	{
+		constexpr size_t PAGE_SIZE = 4096;
+
+		unsigned char sum = 0;
+		for (size_t i = 0; i < size; i += PAGE_SIZE)
+		{
+			sum += data[i];
+		}
+
+		// Keeps the reads from being optimized away.
+		volatile unsigned char touched = sum;
+		(void)touched;
+	}
+
+	bool FileMapping::Open(std::string_view filePath)
+	{
+		Close();
+
+		auto file = std::make_shared<MappedFile>();
+		file->fileHandle = CreateFile(filePath.data(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+		if (file->fileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file->fileHandle, &fileSize))
+		{
+			return false;
+		}
+
+		// Empty files cannot be mapped, but they can still be opened.
+		if (fileSize.QuadPart > 0)
+		{
+			file->mappingHandle = CreateFileMapping(file->fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (file->mappingHandle == NULL)
+			{
+				return false;
+			}
+		}
+
+		size = static_cast<uint64_t>(fileSize.QuadPart);
+		handles = std::move(file);
+
+		return true;
+	}
+
+	void FileMapping::Close()
+	{
+		handles.reset();
+		size = 0;
+	}
+
+	bool FileMapping::IsOpen() const
+	{
+		return handles != nullptr;
+	}
+
+	FileView FileMapping::Map(uint64_t offset, size_t _size) const
+	{
+		FileView result;
+		if (!IsOpen() || offset > size || _size > size - offset)
+		{
+			return result;
+		}
+
+		if (_size == 0)
+		{
+			return FileView::FromBuffer({});
+		}
+
+		// Views must start on the allocation granularity, which is usually 64KB.
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		const uint64_t start = offset - offset % info.dwAllocationGranularity;
+		const size_t padding = static_cast<size_t>(offset - start);
+		if (_size > SIZE_MAX - padding)
+		{
+			return result;
+		}
+
+		auto& file = *static_cast<const MappedFile*>(handles.get());
+		auto range = std::make_shared<MappedRange>();
+		range->data = static_cast<const unsigned char*>(MapViewOfFile(file.mappingHandle, FILE_MAP_READ,
+			static_cast<DWORD>(start >> 32), static_cast<DWORD>(start & 0xFFFFFFFF), padding + _size));
+		if (range->data == nullptr)
+		{
+			return result;
+		}
+
+		result.data = range->data + padding;
+		result.size = _size;
+		result.owner = std::move(range);
+
+		return result;
+	}
+
+	uint64_t FileMapping::GetSize() const
+	{
+		return size;
+	}
+
 	FileReader::~FileReader()
 	{
 		Close();
@@ -1,6 +1,8 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include <cstdint>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -38,6 +40,10 @@ namespace Jwl
 	// Deletes the specified file.
 	bool RemoveFile(std::string_view file);
 
+	// Moves the replacement file into the place of the specified file.
+	// Unlike writing to the file directly, this works while the file is open in a FileView, which keeps reading the old contents.
+	bool OverwriteFile(std::string_view file, std::string_view replacement);
+
 	// Attempts to create the specified directory. Returns true on success.
 	bool MakeDirectory(std::string_view directory);
 
@@ -71,6 +77,65 @@ namespace Jwl
 	// Loads all the contents of a file into the provided string.
 	bool LoadFileAsString(std::string_view file, std::string& output);
 
+	// A read-only range of bytes that remains valid for as long as the view exists.
+	// Opening a file maps it directly into memory, so pages are read from disk on first access
+	// rather than being copied into a buffer up front. Views are cheap to copy and share the mapping.
+	class FileView
+	{
+	public:
+		FileView() = default;
+
+		// Creates a view that owns the buffer, such as the decompressed contents of a file.
+		static FileView FromBuffer(std::vector<unsigned char> buffer);
+
+		// Maps the entire file into memory. Files inside mounted archives are found first.
+		bool Open(std::string_view filePath);
+		// Releases this view's reference to the mapping.
+		void Close();
+
+		bool IsOpen() const;
+
+		// Returns a view of a range within this one. Returns an empty view if the range is out of bounds.
+		FileView GetSubView(size_t offset, size_t size) const;
+
+		const unsigned char* GetData() const;
+		size_t GetSize() const;
+
+		// Reads from each page of a mapped file so that it is loaded from disk now, rather than whenever the data is first used.
+		// Called from worker threads so that the main thread does not stall on the disk.
+		void Prefetch() const;
+
+	private:
+		friend class FileMapping;
+
+		// Keeps the underlying mapping or buffer alive.
+		std::shared_ptr<const void> owner;
+		const unsigned char* data = nullptr;
+		size_t size = 0;
+	};
+
+	// A file that is mapped into memory one range at a time, rather than all at once like a FileView.
+	// This allows files larger than the address space to be read, such as archives on 32-bit systems.
+	class FileMapping
+	{
+	public:
+		bool Open(std::string_view filePath);
+		void Close();
+
+		bool IsOpen() const;
+
+		// Maps a range of the file. Returns an empty view if the range is out of bounds or could not be mapped.
+		// The view remains valid after the FileMapping is closed.
+		FileView Map(uint64_t offset, size_t size) const;
+
+		uint64_t GetSize() const;
+
+	private:
+		// Keeps the file and mapping handles open.
+		std::shared_ptr<const void> handles;
+		uint64_t size = 0;
+	};
+
 	// Streams input from a file or loads a file as a buffer.
 	class FileReader
 	{
@@ -0,0 +1,201 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "FileWatcher.h"
+#include "Logging.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <Windows.h>
+
+namespace
+{
+	double GetTimeMS()
+	{
+		return static_cast<double>(Jwl::Timer::GetCurrentTick()) / static_cast<double>(Jwl::Timer::GetTicksPerMS());
+	}
+}
+
+namespace Jwl
+{
+	void ChangeCoalescer::Add(std::string_view path, double timeMS)
+	{
+		auto itr = std::find_if(changes.begin(), changes.end(), [path](const Change& change) {
+			return change.path == path;
+		});
+
+		if (itr != changes.end())
+		{
+			itr->lastChange = timeMS;
+		}
+		else
+		{
+			changes.push_back({ std::string(path), timeMS });
+		}
+	}
+
+	void ChangeCoalescer::Collect(double timeMS, double delayMS, std::vector<std::string>& out)
+	{
+		auto settled = std::stable_partition(changes.begin(), changes.end(), [timeMS, delayMS](const Change& change) {
+			return timeMS - change.lastChange >= delayMS;
+		});
+
+		for (auto itr = changes.begin(); itr != settled; ++itr)
+		{
+			out.push_back(std::move(itr->path));
+		}
+
+		changes.erase(changes.begin(), settled);
+	}
+
+	bool ChangeCoalescer::IsEmpty() const
+	{
+		return changes.empty();
+	}
+
+	//-----------------------------------------------------------------------------------------------------
+
+	FileWatcher::~FileWatcher()
+	{
+		Stop();
+	}
+
+	bool FileWatcher::Start(std::string_view directory)
+	{
+		ASSERT(!IsRunning(), "FileWatcher is already running.");
+
+		const std::string path(directory);
+		HANDLE directoryFile = CreateFile(path.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+		if (directoryFile == INVALID_HANDLE_VALUE)
+		{
+			Error("FileWatcher: ( %s )\nUnable to open directory.", path.c_str());
+			return false;
+		}
+
+		directoryHandle = directoryFile;
+		changeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		stopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+		thread = std::thread(&FileWatcher::Run, this);
+
+		return true;
+	}
+
+	void FileWatcher::Stop()
+	{
+		if (!IsRunning())
+		{
+			return;
+		}
+
+		SetEvent(stopEvent);
+		thread.join();
+
+		CloseHandle(directoryHandle);
+		CloseHandle(changeEvent);
+		CloseHandle(stopEvent);
+		directoryHandle = nullptr;
+		changeEvent = nullptr;
+		stopEvent = nullptr;
+
+		std::lock_guard lock(changesMutex);
+		changes = ChangeCoalescer();
+	}
+
+	bool FileWatcher::IsRunning() const
+	{
+		return thread.joinable();
+	}
+
+	void FileWatcher::SetDelay(double ms)
+	{
+		ASSERT(ms >= 0.0, "Delay cannot be negative.");
+
+		delay = ms;
+	}
+
+	double FileWatcher::GetDelay() const
+	{
+		return delay;
+	}
+
+	std::vector<std::string> FileWatcher::Poll()
+	{
+		std::vector<std::string> result;
+
+		std::lock_guard lock(changesMutex);
+		changes.Collect(GetTimeMS(), delay, result);
+
+		return result;
+	}
+
+	void FileWatcher::Run()
+	{
+		// FILE_NOTIFY_INFORMATION records must be DWORD aligned.
+		alignas(DWORD) char buffer[64 * 1024];
+		std::string name;
+
+		while (true)
+		{
+			OVERLAPPED overlapped = {};
+			overlapped.hEvent = changeEvent;
+
+			const DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE;
+			if (!ReadDirectoryChangesW(directoryHandle, buffer, sizeof(buffer), TRUE, filter, NULL, &overlapped, NULL))
+			{
+				Error("FileWatcher: Unable to read directory changes.");
+				return;
+			}
+
+			HANDLE events[2] = { changeEvent, stopEvent };
+			if (WaitForMultipleObjects(2, events, FALSE, INFINITE) != WAIT_OBJECT_0)
+			{
+				// Stopping. The pending read must finish before its buffer goes out of scope.
+				CancelIo(directoryHandle);
+				DWORD ignored = 0;
+				GetOverlappedResult(directoryHandle, &overlapped, &ignored, TRUE);
+				return;
+			}
+
+			DWORD numBytes = 0;
+			if (!GetOverlappedResult(directoryHandle, &overlapped, &numBytes, FALSE))
+			{
+				continue;
+			}
+
+			if (numBytes == 0)
+			{
+				Warning("FileWatcher: Too many changes at once. Some files might not be reloaded.");
+				continue;
+			}
+
+			const double now = GetTimeMS();
+			std::lock_guard lock(changesMutex);
+
+			const char* itr = buffer;
+			while (true)
+			{
+				auto& info = *reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(itr);
+
+				// Removed files and the old names of renamed files have nothing to reload.
+				if (info.Action == FILE_ACTION_MODIFIED || info.Action == FILE_ACTION_ADDED || info.Action == FILE_ACTION_RENAMED_NEW_NAME)
+				{
+					const int length = static_cast<int>(info.FileNameLength / sizeof(WCHAR));
+					const int size = WideCharToMultiByte(CP_ACP, 0, info.FileName, length, NULL, 0, NULL, NULL);
+					name.resize(size);
+					WideCharToMultiByte(CP_ACP, 0, info.FileName, length, name.data(), size, NULL, NULL);
+					std::replace(name.begin(), name.end(), '\\', '/');
+
+					changes.Add(name, now);
+				}
+
+				if (info.NextEntryOffset == 0)
+				{
+					break;
+				}
+
+				itr += info.NextEntryOffset;
+			}
+		}
+	}
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Jwl
+{
+	// Merges bursts of change events for the same file.
+	// Saving a file often produces several events in quick succession, such as when an editor truncates and then writes
+	// the file, or when a tool writes a temporary file and renames it. A file is only reported once it has been quiet for a while.
+	class ChangeCoalescer
+	{
+	public:
+		// Records that the file changed at the given time. Another change before the file is collected restarts its quiet period.
+		void Add(std::string_view path, double timeMS);
+
+		// Appends the files that have not changed for at least 'delayMS' to 'out', in the order they first changed, and forgets them.
+		void Collect(double timeMS, double delayMS, std::vector<std::string>& out);
+
+		bool IsEmpty() const;
+
+	private:
+		struct Change
+		{
+			std::string path;
+			double lastChange = 0.0;
+		};
+
+		std::vector<Change> changes;
+	};
+
+	// Watches a directory and its subdirectories for files that are written, created, or renamed.
+	// The operating system's events are received on a background thread and coalesced until the files settle.
+	class FileWatcher
+	{
+	public:
+		FileWatcher() = default;
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+		~FileWatcher();
+
+		bool Start(std::string_view directory);
+		void Stop();
+		bool IsRunning() const;
+
+		// Sets how long a file must go without changing before it is reported.
+		void SetDelay(double ms);
+		double GetDelay() const;
+
+		// Returns the files that have settled since the last call, relative to the watched directory and separated with '/'.
+		std::vector<std::string> Poll();
+
+	private:
+		// Receives events until the stop event is signaled. Runs on the background thread.
+		void Run();
+
+		std::thread thread;
+		// Operating system handles for the directory and the events used to wait on it.
+		void* directoryHandle = nullptr;
+		void* changeEvent = nullptr;
+		void* stopEvent = nullptr;
+
+		double delay = 100.0;
+
+		ChangeCoalescer changes;
+		std::mutex changesMutex;
+	};
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "FrameStats.h"
+#include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Application/Timer.h"
+#include "Jewel3D/Entity/Entity.h"
+#include "Jewel3D/Resource/Font.h"
+#include "Jewel3D/Resource/Material.h"
+#include "Jewel3D/Resource/Model.h"
+#include "Jewel3D/Resource/Shader.h"
+#include "Jewel3D/Resource/Sound.h"
+#include "Jewel3D/Resource/Texture.h"
+
+namespace
+{
+	using namespace Jwl;
+
+	template<class Asset>
+	CacheStats GetCacheStats(std::string_view type)
+	{
+		const ResourceStats stats = Resource<Asset>::GetStats();
+		return { type, stats.count, stats.cpuBytes, stats.gpuBytes };
+	}
+
+	// Always in the same order, so that they line up with the CSV columns.
+	void GetCaches(std::vector<CacheStats>& out_caches)
+	{
+		out_caches.clear();
+		out_caches.push_back(GetCacheStats<Model>("Model"));
+		out_caches.push_back(GetCacheStats<Texture>("Texture"));
+		out_caches.push_back(GetCacheStats<Shader>("Shader"));
+		out_caches.push_back(GetCacheStats<Material>("Material"));
+		out_caches.push_back(GetCacheStats<Font>("Font"));
+		out_caches.push_back(GetCacheStats<Sound>("Sound"));
+	}
+
+	template<typename Index>
+	unsigned GetTableSize(const Index& index, unsigned componentId)
+	{
+		auto itr = index.find(componentId);
+		return itr == index.end() ? 0 : static_cast<unsigned>(itr->second.size());
+	}
+}
+
+namespace Jwl
+{
+	FrameStatsSingleton FrameStats;
+
+	const FrameCounters& FrameStatsSingleton::GetCurrentCounters() const
+	{
+		return current;
+	}
+
+	void FrameStatsSingleton::EndFrame()
+	{
+		const int64_t now = Timer::GetCurrentTick();
+
+		last.frame = frameCount++;
+		last.frameMS = frameStart != 0 ? static_cast<double>(now - frameStart) / static_cast<double>(Timer::GetTicksPerMS()) : 0.0;
+		frameStart = now;
+
+		last.counters = current;
+		current = FrameCounters();
+
+		const unsigned numIds = ComponentBase::GetNumIDs();
+		last.indexTables.resize(numIds + 1);
+		for (unsigned id = 0; id <= numIds; ++id)
+		{
+			IndexTableStats& table = last.indexTables[id];
+			table.componentId = id;
+			table.typeName = id != 0 ? ComponentBase::GetTypeName(id) : std::string_view();
+			table.entities = GetTableSize(detail::entityIndex, id);
+			table.components = GetTableSize(detail::componentIndex, id);
+		}
+
+		GetCaches(last.caches);
+
+		if (csv.is_open())
+		{
+			WriteCSVRow();
+		}
+	}
+
+	const FrameReport& FrameStatsSingleton::GetLastFrame() const
+	{
+		return last;
+	}
+
+	bool FrameStatsSingleton::OpenCSV(std::string_view file)
+	{
+		CloseCSV();
+
+		csv.open(file.data());
+		if (!csv)
+		{
+			Error("FrameStats: Could not open ( %s ) for writing.", file.data());
+			return false;
+		}
+
+		numCSVIndexTables = ComponentBase::GetNumIDs();
+		WriteCSVHeader();
+
+		return true;
+	}
+
+	void FrameStatsSingleton::CloseCSV()
+	{
+		if (csv.is_open())
+		{
+			csv.close();
+		}
+
+		csv.clear();
+	}
+
+	bool FrameStatsSingleton::IsWritingCSV() const
+	{
+		return csv.is_open();
+	}
+
+	void FrameStatsSingleton::WriteCSVHeader()
+	{
+		csv << "Frame,Frame MS,Draw Calls,Primitives,Shader Binds,Texture Binds,Uniform Buffer Binds,Bytes Uploaded,Shader Variants Compiled";
+
+		std::vector<CacheStats> caches;
+		GetCaches(caches);
+		for (const CacheStats& cache : caches)
+		{
+			csv << ',' << cache.type << " Count," << cache.type << " CPU Bytes," << cache.type << " GPU Bytes";
+		}
+
+		// Names are quoted, since template arguments can contain commas.
+		for (unsigned id = 1; id <= numCSVIndexTables; ++id)
+		{
+			const std::string_view name = ComponentBase::GetTypeName(id);
+			csv << ",\"Entities " << name << "\",\"Components " << name << '"';
+		}
+
+		csv << '\n';
+	}
+
+	void FrameStatsSingleton::WriteCSVRow()
+	{
+		const FrameCounters& counters = last.counters;
+		csv << last.frame << ',' << last.frameMS << ','
+			<< counters.drawCalls << ',' << counters.primitives << ','
+			<< counters.shaderBinds << ',' << counters.textureBinds << ',' << counters.uniformBufferBinds << ','
+			<< counters.bytesUploaded << ',' << counters.shaderVariantsCompiled;
+
+		for (const CacheStats& cache : last.caches)
+		{
+			csv << ',' << cache.count << ',' << cache.cpuBytes << ',' << cache.gpuBytes;
+		}
+
+		for (unsigned id = 1; id <= numCSVIndexTables; ++id)
+		{
+			const IndexTableStats& table = last.indexTables[id];
+			csv << ',' << table.entities << ',' << table.components;
+		}
+
+		csv << '\n';
+	}
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+/*
+ FrameStats records what the engine did during each frame, such as the number of draw calls and the bytes
+ uploaded to the GPU, along with the size of each entity index table and asset cache at the end of the frame.
+
+ The engine updates the counters as it renders, and the Application ends a frame after each one is presented.
+ The last completed frame is returned by FrameStats.GetLastFrame(), and every frame can also be written as a
+ row of a CSV file with FrameStats.OpenCSV().
+*/
+
+namespace Jwl
+{
+	// The GPU work submitted during a frame.
+	struct FrameCounters
+	{
+		unsigned drawCalls = 0;
+		// Triangles, along with any lines and points.
+		uint64_t primitives = 0;
+		unsigned shaderBinds = 0;
+		unsigned textureBinds = 0;
+		unsigned uniformBufferBinds = 0;
+		// Bytes written to GPU buffers, such as from uniform buffers, particles and text.
+		uint64_t bytesUploaded = 0;
+		// Shader variants compiled from source, rather than loaded from the shader cache.
+		unsigned shaderVariantsCompiled = 0;
+	};
+
+	// The size of the entity index table for one component or tag type.
+	struct IndexTableStats
+	{
+		// Matches the type's GetComponentId().
+		unsigned componentId = 0;
+		// Unlike the Id, the name of the type is the same in every build. Empty for the unused first entry.
+		std::string_view typeName;
+		// Entities with the component or tag enabled.
+		unsigned entities = 0;
+		// Enabled components. Always zero for tags.
+		unsigned components = 0;
+	};
+
+	// The size of the asset cache for one type of resource.
+	struct CacheStats
+	{
+		std::string_view type;
+		unsigned count = 0;
+		size_t cpuBytes = 0;
+		size_t gpuBytes = 0;
+	};
+
+	// Everything recorded about a single frame.
+	struct FrameReport
+	{
+		// The number of frames ended before this one.
+		uint64_t frame = 0;
+		// The time since the previous frame ended.
+		double frameMS = 0.0;
+
+		FrameCounters counters;
+		// Indexed by component Id. The first entry is unused, since Ids start at 1.
+		std::vector<IndexTableStats> indexTables;
+		std::vector<CacheStats> caches;
+	};
+
+	// Counts the work done by the engine each frame.
+	// The counters should only be updated from the main thread, where all rendering takes place.
+	extern class FrameStatsSingleton FrameStats;
+	class FrameStatsSingleton
+	{
+	public:
+		FrameStatsSingleton() = default;
+		FrameStatsSingleton(const FrameStatsSingleton&) = delete;
+
+		FrameStatsSingleton& operator=(const FrameStatsSingleton&) = delete;
+
+		void CountDrawCall(uint64_t primitives)
+		{
+			current.drawCalls++;
+			current.primitives += primitives;
+		}
+
+		void CountShaderBind()
+		{
+			current.shaderBinds++;
+		}
+
+		void CountTextureBind()
+		{
+			current.textureBinds++;
+		}
+
+		void CountUniformBufferBind()
+		{
+			current.uniformBufferBinds++;
+		}
+
+		void CountUpload(uint64_t bytes)
+		{
+			current.bytesUploaded += bytes;
+		}
+
+		void CountShaderVariantCompiled()
+		{
+			current.shaderVariantsCompiled++;
+		}
+
+		// Returns the counters of the frame in progress.
+		const FrameCounters& GetCurrentCounters() const;
+
+		// Completes the frame's report and resets the counters. Called once per frame by the Application.
+		void EndFrame();
+		// Returns the report of the last completed frame.
+		const FrameReport& GetLastFrame() const;
+
+		// Begins writing each frame's report as a row of a CSV file. Any previous file is closed first.
+		bool OpenCSV(std::string_view file);
+		void CloseCSV();
+		bool IsWritingCSV() const;
+
+	private:
+		void WriteCSVHeader();
+		void WriteCSVRow();
+
+		FrameCounters current;
+		FrameReport last;
+		int64_t frameStart = 0;
+		uint64_t frameCount = 0;
+
+		std::ofstream csv;
+		// The number of index tables in the CSV file's header. Component types registered later are not written.
+		// The columns are named after each type, since Ids can change between builds.
+		unsigned numCSVIndexTables = 0;
+	};
+}
@@ -5,6 +5,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <mutex>
 #include <Windows.h>
 
 namespace
@@ -12,8 +13,13 @@ namespace
 	std::ofstream logOutput;
 	HANDLE stdOutputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
 
+	// Messages can be logged from worker threads, such as while streaming assets.
+	std::recursive_mutex logMutex;
+
 	void PushMessage(std::string_view header, std::string_view message)
 	{
+		std::lock_guard lock(logMutex);
+
 		if (logOutput.is_open())
 		{
 			logOutput << header << message << std::endl;
@@ -33,6 +39,9 @@ namespace
 
 	void PushMessage(std::string_view header, std::string_view message, Jwl::ConsoleColor color)
 	{
+		// Held for the whole message so that another thread cannot change the color mid-message.
+		std::lock_guard lock(logMutex);
+
 		Jwl::SetConsoleColor(color);
 		PushMessage(header, message);
 		Jwl::ResetConsoleColor();
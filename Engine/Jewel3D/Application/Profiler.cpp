@@ -0,0 +1,268 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "Profiler.h"
+#include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Application/Timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+	// Appends the text as a quoted JSON string.
+	void AppendJsonString(std::string& json, std::string_view text)
+	{
+		json += '"';
+		for (char c : text)
+		{
+			switch (c)
+			{
+			case '"':  json += "\\\""; break;
+			case '\\': json += "\\\\"; break;
+			case '\n': json += "\\n"; break;
+			case '\t': json += "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					char escaped[8];
+					snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+					json += escaped;
+				}
+				else
+				{
+					json += c;
+				}
+			}
+		}
+		json += '"';
+	}
+}
+
+namespace Jwl
+{
+	ProfilerSingleton Profiler;
+
+	void ProfilerSingleton::SetThreadName(std::string name)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+
+		std::lock_guard lock(mutex);
+		buffer.name = std::move(name);
+	}
+
+	void ProfilerSingleton::EndFrame()
+	{
+		const int64_t now = Timer::GetCurrentTick();
+		const double ticksPerMS = static_cast<double>(Timer::GetTicksPerMS());
+
+		std::vector<ZoneRecord> zones;
+		{
+			std::lock_guard lock(mutex);
+			for (auto& buffer : buffers)
+			{
+				buffer->summarized = ReadZones(*buffer, buffer->summarized, zones);
+			}
+		}
+
+		summary.clear();
+		for (const ZoneRecord& zone : zones)
+		{
+			const std::string_view name = zone.name;
+			auto itr = std::find_if(summary.begin(), summary.end(), [name](const ZoneSummary& entry) { return entry.name == name; });
+			if (itr == summary.end())
+			{
+				itr = summary.insert(summary.end(), ZoneSummary{ name });
+			}
+
+			const double ms = static_cast<double>(zone.end - zone.start) / ticksPerMS;
+			itr->count++;
+			itr->totalMS += ms;
+			itr->maxMS = std::max(itr->maxMS, ms);
+		}
+
+		std::sort(summary.begin(), summary.end(), [](const ZoneSummary& a, const ZoneSummary& b) {
+			return a.totalMS > b.totalMS;
+		});
+
+		frameMS = frameStart != 0 ? static_cast<double>(now - frameStart) / ticksPerMS : 0.0;
+		frameStart = now;
+	}
+
+	const std::vector<ZoneSummary>& ProfilerSingleton::GetFrameSummary() const
+	{
+		return summary;
+	}
+
+	void ProfilerSingleton::LogFrameSummary() const
+	{
+		std::string text = "Frame: " + std::to_string(frameMS) + "ms";
+		for (const ZoneSummary& zone : summary)
+		{
+			char line[128];
+			snprintf(line, sizeof(line), "\n  %-32.*s %8.3fms total %8.3fms max %6u calls",
+				static_cast<int>(zone.name.size()), zone.name.data(), zone.totalMS, zone.maxMS, zone.count);
+			text += line;
+		}
+
+		Log(text);
+	}
+
+	bool ProfilerSingleton::ExportChromeTrace(std::string_view file) const
+	{
+		std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		bool isFirst = true;
+
+		{
+			std::lock_guard lock(mutex);
+
+			std::vector<std::vector<ZoneRecord>> threadZones(buffers.size());
+			int64_t origin = INT64_MAX;
+			for (size_t i = 0; i < buffers.size(); ++i)
+			{
+				ReadZones(*buffers[i], 0, threadZones[i]);
+				for (const ZoneRecord& zone : threadZones[i])
+				{
+					origin = std::min(origin, zone.start);
+				}
+			}
+
+			const double ticksPerUS = static_cast<double>(Timer::GetTicksPerSecond()) / 1000000.0;
+			for (size_t i = 0; i < buffers.size(); ++i)
+			{
+				const ThreadBuffer& buffer = *buffers[i];
+
+				json += isFirst ? "" : ",";
+				json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" + std::to_string(buffer.id) + ",\"args\":{\"name\":";
+				AppendJsonString(json, buffer.name);
+				json += "}}";
+				isFirst = false;
+
+				for (const ZoneRecord& zone : threadZones[i])
+				{
+					char times[96];
+					snprintf(times, sizeof(times), ",\"ts\":%.3f,\"dur\":%.3f}",
+						static_cast<double>(zone.start - origin) / ticksPerUS,
+						static_cast<double>(zone.end - zone.start) / ticksPerUS);
+
+					json += ",{\"name\":";
+					AppendJsonString(json, zone.name);
+					json += ",\"ph\":\"X\",\"pid\":0,\"tid\":" + std::to_string(buffer.id);
+					json += times;
+				}
+			}
+		}
+
+		json += "]}\n";
+
+		std::ofstream output(file.data(), std::ios::binary);
+		if (!output)
+		{
+			Error("Profiler: Could not open ( %s ) for writing.", file.data());
+			return false;
+		}
+
+		output.write(json.data(), json.size());
+		return static_cast<bool>(output);
+	}
+
+	ProfilerSingleton::ThreadBuffer& ProfilerSingleton::GetThreadBuffer()
+	{
+		// Hands the buffer back when the thread exits, so that short-lived threads such as those of a ThreadPool do not
+		// each leave a buffer behind.
+		struct Owner
+		{
+			~Owner()
+			{
+				if (buffer)
+				{
+					Profiler.ReleaseThreadBuffer(*buffer);
+				}
+			}
+
+			ThreadBuffer* buffer = nullptr;
+		};
+
+		thread_local Owner owner;
+		if (!owner.buffer)
+		{
+			std::lock_guard lock(mutex);
+
+			// Unread zones of the previous thread are kept, so that they are still summarized.
+			auto itr = std::find_if(buffers.begin(), buffers.end(), [](const auto& buffer) { return !buffer->isInUse; });
+			if (itr == buffers.end())
+			{
+				auto buffer = std::make_unique<ThreadBuffer>();
+				buffer->id = static_cast<unsigned>(buffers.size());
+				itr = buffers.insert(buffers.end(), std::move(buffer));
+			}
+
+			// Threads are only named once they call SetThreadName(), since any of them could be the first to record a zone.
+			owner.buffer = itr->get();
+			owner.buffer->name = "Thread " + std::to_string(owner.buffer->id);
+			owner.buffer->isInUse = true;
+		}
+
+		return *owner.buffer;
+	}
+
+	void ProfilerSingleton::ReleaseThreadBuffer(ThreadBuffer& buffer)
+	{
+		std::lock_guard lock(mutex);
+		buffer.isInUse = false;
+	}
+
+	void ProfilerSingleton::Record(const char* name, int64_t start, int64_t end)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+
+		// Only this thread writes to the buffer, so the count is published once the zone is complete.
+		const uint64_t index = buffer.count.load(std::memory_order_relaxed);
+		Zone& zone = buffer.zones[index % BUFFER_SIZE];
+		zone.name.store(name, std::memory_order_relaxed);
+		zone.start.store(start, std::memory_order_relaxed);
+		zone.end.store(end, std::memory_order_relaxed);
+		buffer.count.store(index + 1, std::memory_order_release);
+	}
+
+	uint64_t ProfilerSingleton::ReadZones(const ThreadBuffer& buffer, uint64_t first, std::vector<ZoneRecord>& out_zones)
+	{
+		const uint64_t count = buffer.count.load(std::memory_order_acquire);
+		first = std::max(first, count > BUFFER_SIZE ? count - BUFFER_SIZE : 0);
+
+		const size_t offset = out_zones.size();
+		for (uint64_t i = first; i < count; ++i)
+		{
+			const Zone& zone = buffer.zones[i % BUFFER_SIZE];
+			out_zones.push_back({
+				zone.name.load(std::memory_order_relaxed),
+				zone.start.load(std::memory_order_relaxed),
+				zone.end.load(std::memory_order_relaxed)
+			});
+		}
+
+		// The thread might have kept recording, overwriting the oldest zones while they were being copied.
+		// Zone 'latest' might also be in the middle of being written, which overwrites zone 'latest - BUFFER_SIZE'.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t latest = buffer.count.load(std::memory_order_relaxed);
+		const uint64_t oldestIntact = latest + 1 > BUFFER_SIZE ? latest + 1 - BUFFER_SIZE : 0;
+		if (oldestIntact > first)
+		{
+			const uint64_t numOverwritten = std::min(oldestIntact, count) - first;
+			out_zones.erase(out_zones.begin() + offset, out_zones.begin() + offset + static_cast<size_t>(numOverwritten));
+		}
+
+		return count;
+	}
+
+	ProfileScope::ProfileScope(const char* _name)
+		: name(_name)
+		, start(Timer::GetCurrentTick())
+	{
+	}
+
+	ProfileScope::~ProfileScope()
+	{
+		Profiler.Record(name, start, Timer::GetCurrentTick());
+	}
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include "Jewel3D/Utilities/ScopeGuard.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ PROFILE_SCOPE("Name") times the rest of the enclosing scope and records it as a zone.
+ Zones can be nested, and can be recorded from any thread.
+
+ Each thread writes its zones into its own ring buffer without locking, so only the most recent
+ zones of each thread are kept. Profiler.EndFrame() summarizes the zones of each frame, and
+ Profiler.ExportChromeTrace() writes what is still buffered for chrome://tracing or Perfetto.
+ The buffers of threads that have exited are reused by new threads, which then share a row in the trace.
+
+ The name must be a string literal, or otherwise outlive the profiler.
+ To compile all zones out, define JWL_DISABLE_PROFILER.
+*/
+
+namespace Jwl
+{
+	// The combined time of all zones with the same name over one frame.
+	struct ZoneSummary
+	{
+		std::string_view name;
+		unsigned count = 0;
+		double totalMS = 0.0;
+		double maxMS = 0.0;
+	};
+
+	// Collects the zones recorded by PROFILE_SCOPE().
+	extern class ProfilerSingleton Profiler;
+	class ProfilerSingleton
+	{
+		friend class ProfileScope;
+	public:
+		// The number of zones kept for each thread.
+		static constexpr unsigned BUFFER_SIZE = 1 << 16;
+
+		ProfilerSingleton() = default;
+		ProfilerSingleton(const ProfilerSingleton&) = delete;
+
+		ProfilerSingleton& operator=(const ProfilerSingleton&) = delete;
+
+		// Names the calling thread in exported traces.
+		void SetThreadName(std::string name);
+
+		// Summarizes the zones that finished since the previous call. Called once per frame by the Application.
+		// Should only be called from one thread.
+		void EndFrame();
+		// The zones of the last frame, by name, from the most to least total time.
+		const std::vector<ZoneSummary>& GetFrameSummary() const;
+		// Writes the last frame's summary to the log.
+		void LogFrameSummary() const;
+
+		// Writes every buffered zone to a file, in the Chrome trace event format.
+		bool ExportChromeTrace(std::string_view file) const;
+
+	private:
+		// A finished zone. Written by its thread and read by the exporter at the same time, so each field is atomic.
+		struct Zone
+		{
+			std::atomic<const char*> name = nullptr;
+			std::atomic<int64_t> start = 0;
+			std::atomic<int64_t> end = 0;
+		};
+
+		struct ZoneRecord
+		{
+			const char* name;
+			int64_t start;
+			int64_t end;
+		};
+
+		// The zones recorded by one thread. Only that thread writes to it.
+		struct ThreadBuffer
+		{
+			unsigned id = 0;
+			std::string name;
+			// Whether a running thread owns the buffer.
+			bool isInUse = false;
+			// The number of zones ever written. The oldest are overwritten once the buffer is full.
+			std::atomic<uint64_t> count = 0;
+			// How many zones have been summarized by EndFrame().
+			uint64_t summarized = 0;
+			Zone zones[BUFFER_SIZE];
+		};
+
+		// Returns the calling thread's buffer, taking a free one or creating it on first use.
+		ThreadBuffer& GetThreadBuffer();
+		// Called when the thread that owns the buffer exits, so that another thread can use it.
+		void ReleaseThreadBuffer(ThreadBuffer& buffer);
+		void Record(const char* name, int64_t start, int64_t end);
+		// Copies the zones recorded since 'first' which have not been overwritten yet. Returns the number of zones recorded so far.
+		static uint64_t ReadZones(const ThreadBuffer& buffer, uint64_t first, std::vector<ZoneRecord>& out_zones);
+
+		// Creating buffers and reading them is synchronized. Recording is not.
+		mutable std::mutex mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+		std::vector<ZoneSummary> summary;
+		int64_t frameStart = 0;
+		double frameMS = 0.0;
+	};
+
+	// Records the time from its construction to its destruction. Used by PROFILE_SCOPE().
+	class ProfileScope
+	{
+	public:
+		ProfileScope(const char* name);
+		ProfileScope(const ProfileScope&) = delete;
+		~ProfileScope();
+
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+	private:
+		const char* name;
+		int64_t start;
+	};
+}
+
+#ifndef JWL_DISABLE_PROFILER
+	#define PROFILE_SCOPE(name) Jwl::ProfileScope ANONYMOUS_VARIABLE(PROFILE_SCOPE_)(name)
+#else
+	#define PROFILE_SCOPE __noop
+#endif
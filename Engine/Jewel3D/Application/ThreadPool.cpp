@@ -0,0 +1,93 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "ThreadPool.h"
+
+namespace Jwl
+{
+	ThreadPool::ThreadPool(unsigned numThreads)
+	{
+		if (numThreads == 0)
+		{
+			const unsigned cores = std::thread::hardware_concurrency();
+			numThreads = cores > 1 ? cores - 1 : 1;
+		}
+
+		threads.reserve(numThreads);
+		for (unsigned i = 0; i < numThreads; ++i)
+		{
+			threads.emplace_back(&ThreadPool::WorkerLoop, this);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard lock(mutex);
+			exiting = true;
+		}
+
+		jobAvailable.notify_all();
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	void ThreadPool::Submit(std::function<void()> job)
+	{
+		ASSERT(job, "Job must be a valid function.");
+
+		{
+			std::lock_guard lock(mutex);
+			jobs.push_back(std::move(job));
+			++unfinishedJobs;
+		}
+
+		jobAvailable.notify_one();
+	}
+
+	void ThreadPool::Wait()
+	{
+		std::unique_lock lock(mutex);
+		jobsFinished.wait(lock, [this] { return unfinishedJobs == 0; });
+	}
+
+	unsigned ThreadPool::GetThreadCount() const
+	{
+		return static_cast<unsigned>(threads.size());
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock lock(mutex);
+				jobAvailable.wait(lock, [this] { return exiting || !jobs.empty(); });
+
+				// Remaining jobs are still run before exiting so that no work is silently dropped.
+				if (jobs.empty())
+				{
+					return;
+				}
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			job();
+
+			bool allFinished;
+			{
+				std::lock_guard lock(mutex);
+				allFinished = --unfinishedJobs == 0;
+			}
+
+			if (allFinished)
+			{
+				jobsFinished.notify_all();
+			}
+		}
+	}
+}
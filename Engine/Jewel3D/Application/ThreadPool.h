@@ -0,0 +1,44 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Jwl
+{
+	// A fixed set of worker threads that run submitted jobs in the order they were received.
+	class ThreadPool
+	{
+	public:
+		// A count of 0 uses one thread per hardware core, minus one for the main thread.
+		explicit ThreadPool(unsigned numThreads = 0);
+		ThreadPool(const ThreadPool&) = delete;
+		~ThreadPool();
+
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Queues the job to be run on the next available worker.
+		void Submit(std::function<void()> job);
+
+		// Blocks until every submitted job has finished running.
+		void Wait();
+
+		unsigned GetThreadCount() const;
+
+	private:
+		void WorkerLoop();
+
+		std::vector<std::thread> threads;
+		std::deque<std::function<void()>> jobs;
+		// The number of jobs that have been submitted but have not finished running.
+		unsigned unfinishedJobs = 0;
+		bool exiting = false;
+
+		std::mutex mutex;
+		std::condition_variable jobAvailable;
+		std::condition_variable jobsFinished;
+	};
+}
@@ -13,6 +13,15 @@ namespace Jwl
 	{
 		std::unordered_map<unsigned, std::vector<Entity*>> entityIndex;
 		std::unordered_map<unsigned, std::vector<ComponentBase*>> componentIndex;
+		// Constant initialized, so it is ready before any component-Ids are generated.
+		unsigned numComponentIds = 0;
+
+		// Indexed by component-Id. Created on first use, since Ids are generated during static initialization.
+		std::vector<std::string_view>& GetTypeNames()
+		{
+			static std::vector<std::string_view> typeNames(1);
+			return typeNames;
+		}
 	}
 
 	ComponentBase::ComponentBase(Entity& _owner, unsigned _componentId)
@@ -31,10 +40,21 @@ namespace Jwl
 		return isEnabled;
 	}
 
-	unsigned ComponentBase::GenerateID()
+	unsigned ComponentBase::GenerateID(std::string_view typeName)
+	{
+		detail::GetTypeNames().push_back(typeName);
+		return ++detail::numComponentIds;
+	}
+
+	unsigned ComponentBase::GetNumIDs()
+	{
+		return detail::numComponentIds;
+	}
+
+	std::string_view ComponentBase::GetTypeName(unsigned componentId)
 	{
-		static unsigned counter = 1;
-		return counter++;
+		ASSERT(componentId >= 1 && componentId <= detail::numComponentIds, "Invalid component-Id.");
+		return detail::GetTypeNames()[componentId];
 	}
 
 	Entity::Entity(std::string name)
@@ -6,6 +6,7 @@
 #include "Jewel3D/Resource/Shareable.h"
 #include "Jewel3D/Utilities/Meta.h"
 
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -30,6 +31,12 @@ namespace Jwl
 		// Returns true if the component itself is enabled, regardless of the owner's state.
 		bool IsComponentEnabled() const;
 
+		// Returns the number of component-Ids consumed so far. Ids range from 1 to this value, inclusive.
+		static unsigned GetNumIDs();
+		// Returns the name of the component type with the Id, such as "Jwl::Mesh".
+		// Ids depend on the order that types are initialized in, so names should be used to identify types outside of the program.
+		static std::string_view GetTypeName(unsigned componentId);
+
 		// The Entity to which this component is attached.
 		Entity& owner;
 
@@ -39,8 +46,8 @@ namespace Jwl
 		// Called when the component is added from queries.
 		virtual void OnEnable() {}
 
-		// Consumes a new component-Id. Used statically by derived components.
-		static unsigned GenerateID();
+		// Consumes a new component-Id for the named type. Used statically by derived components.
+		static unsigned GenerateID(std::string_view typeName);
 
 	private:
 		// The unique ID used by the derived component.
@@ -69,7 +76,7 @@ namespace Jwl
 		static unsigned componentId;
 	};
 
-	template<class derived> unsigned Component<derived>::componentId = ComponentBase::GenerateID();
+	template<class derived> unsigned Component<derived>::componentId = ComponentBase::GenerateID(Meta::TypeName<derived>());
 
 	struct TagBase {};
 	// Base class for all tags. Cannot be instantiated.
@@ -31,6 +31,36 @@ namespace
 
 		return new_vk;
 	}
+
+	// Presses and releases are queued as a single type of event, so that they are distributed in the order they happened.
+	struct KeyChanged : public Jwl::Event<KeyChanged>
+	{
+		KeyChanged(Jwl::Key _key, bool _isPressed)
+			: key(_key)
+			, isPressed(_isPressed)
+		{
+		}
+
+		const Jwl::Key key;
+		const bool isPressed;
+	};
+
+	void PushKeyChanged(Jwl::Key key, bool isPressed)
+	{
+		// Subscribed on first use, rather than during static initialization.
+		static Jwl::Listener<KeyChanged> onKeyChanged([](const KeyChanged& e) {
+			if (e.isPressed)
+			{
+				Jwl::EventQueue.Dispatch(Jwl::KeyPressed(e.key));
+			}
+			else
+			{
+				Jwl::EventQueue.Dispatch(Jwl::KeyReleased(e.key));
+			}
+		});
+
+		Jwl::EventQueue.Push<KeyChanged>(key, isPressed);
+	}
 }
 
 namespace Jwl
@@ -62,21 +92,27 @@ namespace Jwl
 		return vec2(static_cast<float>(x), static_cast<float>(y));
 	}
 
+	void InputSingleton::BeginDispatch()
+	{
+		dispatchX = x;
+		dispatchY = y;
+	}
+
 	bool InputSingleton::Update(const MSG& msg)
 	{
 		switch (msg.message)
 		{
 		case WM_MOUSEMOVE:
 			{
-				auto lastX = x;
-				auto lastY = y;
-				vec2 lastPos(static_cast<float>(lastX), static_cast<float>(lastY));
+				// MouseMoved events are coalesced, so the delta covers all of the movement since the last dispatch rather than the previous message.
+				// Several message pumps can happen between dispatches, since they only occur on fixed update steps.
+				vec2 lastPos(static_cast<float>(dispatchX), static_cast<float>(dispatchY));
 
 				x = GET_X_LPARAM(msg.lParam);
 				y = -(static_cast<int>(GET_Y_LPARAM(msg.lParam)) - Application.GetScreenHeight());
 				vec2 pos(static_cast<float>(x), static_cast<float>(y));
 
-				EventQueue.Push(std::make_unique<MouseMoved>(pos, pos - lastPos));
+				EventQueue.Push<MouseMoved>(pos, pos - lastPos);
 				break;
 			}
 
@@ -88,7 +124,7 @@ namespace Jwl
 
 				// We only distribute the event if the previous key-state was KeyUp.
 				keys[key] = true;
-				EventQueue.Push(std::make_unique<KeyPressed>(static_cast<Key>(key)));
+				PushKeyChanged(static_cast<Key>(key), true);
 			}
 			break;
 
@@ -97,42 +133,42 @@ namespace Jwl
 				auto key = MapLeftRightKeys(msg.wParam, msg.lParam);
 
 				keys[key] = false;
-				EventQueue.Push(std::make_unique<KeyReleased>(static_cast<Key>(key)));
+				PushKeyChanged(static_cast<Key>(key), false);
 				break;
 			}
 
 		case WM_LBUTTONDOWN:
 			keys[static_cast<unsigned>(Key::MouseLeft)] = true;
-			EventQueue.Push(std::make_unique<KeyPressed>(Key::MouseLeft));
+			PushKeyChanged(Key::MouseLeft, true);
 			break;
 
 		case WM_LBUTTONUP:
 			keys[static_cast<unsigned>(Key::MouseLeft)] = false;
-			EventQueue.Push(std::make_unique<KeyReleased>(Key::MouseLeft));
+			PushKeyChanged(Key::MouseLeft, false);
 			break;
 
 		case WM_RBUTTONDOWN:
 			keys[static_cast<unsigned>(Key::MouseRight)] = true;
-			EventQueue.Push(std::make_unique<KeyPressed>(Key::MouseRight));
+			PushKeyChanged(Key::MouseRight, true);
 			break;
 
 		case WM_RBUTTONUP:
 			keys[static_cast<unsigned>(Key::MouseRight)] = false;
-			EventQueue.Push(std::make_unique<KeyReleased>(Key::MouseRight));
+			PushKeyChanged(Key::MouseRight, false);
 			break;
 
 		case WM_MBUTTONDOWN:
 			keys[static_cast<unsigned>(Key::MouseMiddle)] = true;
-			EventQueue.Push(std::make_unique<KeyPressed>(Key::MouseMiddle));
+			PushKeyChanged(Key::MouseMiddle, true);
 			break;
 
 		case WM_MBUTTONUP:
 			keys[static_cast<unsigned>(Key::MouseMiddle)] = false;
-			EventQueue.Push(std::make_unique<KeyReleased>(Key::MouseMiddle));
+			PushKeyChanged(Key::MouseMiddle, false);
 			break;
 
 		case WM_MOUSEWHEEL:
-			EventQueue.Push(std::make_unique<MouseScrolled>(static_cast<int>(GET_WHEEL_DELTA_WPARAM(msg.wParam) / WHEEL_DELTA)));
+			EventQueue.Push<MouseScrolled>(static_cast<int>(GET_WHEEL_DELTA_WPARAM(msg.wParam) / WHEEL_DELTA));
 			break;
 
 		default:
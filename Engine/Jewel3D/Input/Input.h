@@ -48,7 +48,6 @@ namespace Jwl
 	extern class InputSingleton Input;
 	class InputSingleton
 	{
-		friend class ApplicationSingleton;
 	public:
 		bool IsDown(Key key) const;
 		bool IsUp(Key key) const;
@@ -57,22 +56,32 @@ namespace Jwl
 		int GetMouseY() const;
 		vec2 GetMousePos() const;
 
-	private:
+		// Called by the Application just before the EventQueue is dispatched.
+		// The next MouseMoved event will measure its delta from the current position.
+		void BeginDispatch();
+		// Called by the Application for each keyboard and mouse message. Returns false if the message was not handled.
 		bool Update(const MSG& msg);
 
+	private:
 		bool keys[static_cast<unsigned>(Key::NUM_KEYS)] = { false };
 		int x = 0;
 		int y = 0;
+		// The mouse position when the EventQueue was last dispatched.
+		int dispatchX = 0;
+		int dispatchY = 0;
 	};
 
-	// An event distributed by the engine when the mouse position has changed from the previous frame.
+	// An event distributed by the engine when the mouse position has changed since the EventQueue was last dispatched.
+	// Only the last movement before each dispatch is distributed.
 	struct MouseMoved : public Event<MouseMoved>
 	{
+		static constexpr bool IsCoalesced = true;
+
 		MouseMoved(const vec2& pos, const vec2& delta);
 
 		// The new mouse position.
 		const vec2 pos;
-		// The different between this position and the last.
+		// The difference between this position and the one when the EventQueue was last dispatched.
 		const vec2 delta;
 	};
 
@@ -86,6 +95,7 @@ namespace Jwl
 	};
 
 	// An event distributed by the engine when a key is first pressed.
+	// Presses and releases are distributed together, in the order they happened.
 	struct KeyPressed : public Event<KeyPressed>
 	{
 		KeyPressed(Key key);
@@ -0,0 +1,425 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "BitStream.h"
+#include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Math/Math.h"
+#include "Jewel3D/Math/Quaternion.h"
+#include "Jewel3D/Math/Vector.h"
+
+namespace
+{
+	// The smallest three components of a unit quaternion are never larger than this.
+	constexpr float QUAT_COMPONENT_RANGE = 0.707107f;
+
+	uint32_t GetNumSteps(float min, float max, float precision)
+	{
+		ASSERT(max > min, "Quantization range is empty.");
+		ASSERT(precision > 0.0f, "Quantization precision must be positive.");
+
+		const double steps = std::ceil((static_cast<double>(max) - min) / precision);
+		ASSERT(steps < 4294967296.0, "Quantization range is too large for its precision.");
+
+		return static_cast<uint32_t>(Jwl::Max(steps, 1.0));
+	}
+}
+
+namespace Jwl
+{
+	unsigned GetBitsRequired(uint32_t maxValue)
+	{
+		unsigned bits = 0;
+		while (maxValue > 0)
+		{
+			++bits;
+			maxValue >>= 1;
+		}
+
+		return bits;
+	}
+
+	uint32_t Quantize(float value, float min, float max, float precision)
+	{
+		const uint32_t steps = GetNumSteps(min, max, precision);
+		const double normalized = (static_cast<double>(Clamp(value, min, max)) - min) / (static_cast<double>(max) - min);
+
+		return static_cast<uint32_t>(std::round(normalized * steps));
+	}
+
+	float Dequantize(uint32_t value, float min, float max, float precision)
+	{
+		const uint32_t steps = GetNumSteps(min, max, precision);
+		const double normalized = static_cast<double>(Min(value, steps)) / steps;
+
+		return static_cast<float>(min + normalized * (static_cast<double>(max) - min));
+	}
+
+	unsigned GetQuantizedBits(float min, float max, float precision)
+	{
+		return GetBitsRequired(GetNumSteps(min, max, precision));
+	}
+
+	uint32_t QuantizeQuat(const quat& rotation, unsigned bitsPerComponent)
+	{
+		ASSERT(bitsPerComponent > 0 && bitsPerComponent <= 10, "Quaternions can be quantized with 1 to 10 bits per component.");
+
+		unsigned largest = 0;
+		for (unsigned i = 1; i < 4; ++i)
+		{
+			if (Abs(rotation[i]) > Abs(rotation[largest]))
+			{
+				largest = i;
+			}
+		}
+
+		// 'q' and '-q' are the same rotation, so the largest component can always be made positive.
+		const float sign = rotation[largest] < 0.0f ? -1.0f : 1.0f;
+		const uint32_t maxValue = (1u << bitsPerComponent) - 1;
+
+		uint32_t result = largest;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+			{
+				continue;
+			}
+
+			const float normalized = (rotation[i] * sign / QUAT_COMPONENT_RANGE + 1.0f) * 0.5f;
+			const uint32_t component = static_cast<uint32_t>(std::round(Clamp(normalized, 0.0f, 1.0f) * maxValue));
+
+			result = (result << bitsPerComponent) | component;
+		}
+
+		return result;
+	}
+
+	quat DequantizeQuat(uint32_t value, unsigned bitsPerComponent)
+	{
+		ASSERT(bitsPerComponent > 0 && bitsPerComponent <= 10, "Quaternions can be quantized with 1 to 10 bits per component.");
+
+		const uint32_t maxValue = (1u << bitsPerComponent) - 1;
+		const unsigned largest = (value >> (bitsPerComponent * 3)) & 3;
+
+		quat result;
+		float sumSquares = 0.0f;
+		for (int i = 3; i >= 0; --i)
+		{
+			if (static_cast<unsigned>(i) == largest)
+			{
+				continue;
+			}
+
+			const float normalized = static_cast<float>(value & maxValue) / maxValue;
+			value >>= bitsPerComponent;
+
+			result[i] = (normalized * 2.0f - 1.0f) * QUAT_COMPONENT_RANGE;
+			sumSquares += result[i] * result[i];
+		}
+
+		result[largest] = std::sqrt(Max(1.0f - sumSquares, 0.0f));
+		result.Normalize();
+
+		return result;
+	}
+
+	void BitWriter::Write(uint32_t value, unsigned bits)
+	{
+		ASSERT(bits <= 32, "Cannot write more than 32 bits at once.");
+
+		if (bits < 32)
+		{
+			value &= (1u << bits) - 1;
+		}
+
+		while (bits > 0)
+		{
+			const unsigned offset = bitCount % 8;
+			if (offset == 0)
+			{
+				data.push_back('\0');
+			}
+
+			const unsigned count = Min(8 - offset, bits);
+			data.back() |= static_cast<char>((value & ((1u << count) - 1)) << offset);
+
+			value >>= count;
+			bits -= count;
+			bitCount += count;
+		}
+	}
+
+	void BitWriter::WriteBool(bool value)
+	{
+		Write(value ? 1 : 0, 1);
+	}
+
+	void BitWriter::WriteInt(int value, int min, int max)
+	{
+		ASSERT(max >= min, "Range is empty.");
+		ASSERT(value >= min && value <= max, "Value (%d) is outside of the range [%d, %d].", value, min, max);
+
+		const uint32_t range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min);
+		Write(static_cast<uint32_t>(value) - static_cast<uint32_t>(min), GetBitsRequired(range));
+	}
+
+	void BitWriter::WriteVarUint(uint32_t value)
+	{
+		do
+		{
+			Write(value, 4);
+			value >>= 4;
+			WriteBool(value != 0);
+		} while (value != 0);
+	}
+
+	void BitWriter::WriteFloat(float value, float min, float max, float precision)
+	{
+		Write(Quantize(value, min, max, precision), GetQuantizedBits(min, max, precision));
+	}
+
+	void BitWriter::WriteVec3(const vec3& value, float min, float max, float precision)
+	{
+		const unsigned bits = GetQuantizedBits(min, max, precision);
+
+		Write(Quantize(value.x, min, max, precision), bits);
+		Write(Quantize(value.y, min, max, precision), bits);
+		Write(Quantize(value.z, min, max, precision), bits);
+	}
+
+	void BitWriter::WriteQuat(const quat& value, unsigned bitsPerComponent)
+	{
+		Write(QuantizeQuat(value, bitsPerComponent), 2 + bitsPerComponent * 3);
+	}
+
+	void BitWriter::WriteBits(std::string_view bits, unsigned count)
+	{
+		ASSERT(count <= bits.size() * 8, "Not enough data to write %u bits.", count);
+
+		for (unsigned i = 0; count > 0; ++i)
+		{
+			const unsigned chunk = Min(count, 8u);
+			Write(static_cast<unsigned char>(bits[i]), chunk);
+			count -= chunk;
+		}
+	}
+
+	void BitWriter::WriteBytes(std::string_view bytes)
+	{
+		if (bitCount % 8 == 0)
+		{
+			data += bytes;
+			bitCount += static_cast<unsigned>(bytes.size()) * 8;
+			return;
+		}
+
+		WriteBits(bytes, static_cast<unsigned>(bytes.size()) * 8);
+	}
+
+	void BitWriter::AlignToByte()
+	{
+		bitCount = static_cast<unsigned>(data.size()) * 8;
+	}
+
+	void BitWriter::Clear()
+	{
+		data.clear();
+		bitCount = 0;
+	}
+
+	std::string_view BitWriter::GetData() const
+	{
+		return data;
+	}
+
+	unsigned BitWriter::GetBitCount() const
+	{
+		return bitCount;
+	}
+
+	unsigned BitWriter::GetByteCount() const
+	{
+		return static_cast<unsigned>(data.size());
+	}
+
+	BitReader::BitReader(std::string_view _data)
+		: data(_data)
+	{
+	}
+
+	bool BitReader::Read(unsigned bits, uint32_t& out_value)
+	{
+		ASSERT(bits <= 32, "Cannot read more than 32 bits at once.");
+
+		if (bits > GetRemaining())
+		{
+			return false;
+		}
+
+		out_value = ReadUnchecked(bits);
+		return true;
+	}
+
+	bool BitReader::ReadBool(bool& out_value)
+	{
+		uint32_t value;
+		if (!Read(1, value))
+		{
+			return false;
+		}
+
+		out_value = value != 0;
+		return true;
+	}
+
+	bool BitReader::ReadInt(int min, int max, int& out_value)
+	{
+		ASSERT(max >= min, "Range is empty.");
+
+		const uint32_t range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min);
+
+		uint32_t value;
+		if (!Read(GetBitsRequired(range), value) || value > range)
+		{
+			return false;
+		}
+
+		out_value = static_cast<int>(value + static_cast<uint32_t>(min));
+		return true;
+	}
+
+	bool BitReader::ReadVarUint(uint32_t& out_value)
+	{
+		const unsigned start = position;
+
+		uint32_t result = 0;
+		for (unsigned shift = 0; shift < 32; shift += 4)
+		{
+			uint32_t group;
+			bool hasMore;
+			if (!Read(4, group) || !ReadBool(hasMore))
+			{
+				position = start;
+				return false;
+			}
+
+			result |= group << shift;
+			if (!hasMore)
+			{
+				out_value = result;
+				return true;
+			}
+		}
+
+		// Too many groups to fit in 32 bits.
+		position = start;
+		return false;
+	}
+
+	bool BitReader::ReadFloat(float min, float max, float precision, float& out_value)
+	{
+		uint32_t value;
+		if (!Read(GetQuantizedBits(min, max, precision), value))
+		{
+			return false;
+		}
+
+		out_value = Dequantize(value, min, max, precision);
+		return true;
+	}
+
+	bool BitReader::ReadVec3(float min, float max, float precision, vec3& out_value)
+	{
+		const unsigned bits = GetQuantizedBits(min, max, precision);
+		if (bits * 3 > GetRemaining())
+		{
+			return false;
+		}
+
+		out_value.x = Dequantize(ReadUnchecked(bits), min, max, precision);
+		out_value.y = Dequantize(ReadUnchecked(bits), min, max, precision);
+		out_value.z = Dequantize(ReadUnchecked(bits), min, max, precision);
+		return true;
+	}
+
+	bool BitReader::ReadQuat(unsigned bitsPerComponent, quat& out_value)
+	{
+		uint32_t value;
+		if (!Read(2 + bitsPerComponent * 3, value))
+		{
+			return false;
+		}
+
+		out_value = DequantizeQuat(value, bitsPerComponent);
+		return true;
+	}
+
+	bool BitReader::ReadBits(unsigned bitCount, std::string& out_data)
+	{
+		if (bitCount > GetRemaining())
+		{
+			return false;
+		}
+
+		out_data.clear();
+		out_data.reserve((bitCount + 7) / 8);
+		while (bitCount > 0)
+		{
+			const unsigned chunk = Min(bitCount, 8u);
+			out_data.push_back(static_cast<char>(ReadUnchecked(chunk)));
+			bitCount -= chunk;
+		}
+
+		return true;
+	}
+
+	bool BitReader::ReadBytes(unsigned count, std::string& out_bytes)
+	{
+		if (count > GetRemaining() / 8)
+		{
+			return false;
+		}
+
+		if (position % 8 == 0)
+		{
+			out_bytes.assign(data.substr(position / 8, count));
+			position += count * 8;
+			return true;
+		}
+
+		return ReadBits(count * 8, out_bytes);
+	}
+
+	void BitReader::AlignToByte()
+	{
+		position = Min((position + 7) / 8 * 8, static_cast<unsigned>(data.size()) * 8);
+	}
+
+	unsigned BitReader::GetPosition() const
+	{
+		return position;
+	}
+
+	unsigned BitReader::GetRemaining() const
+	{
+		return static_cast<unsigned>(data.size()) * 8 - position;
+	}
+
+	uint32_t BitReader::ReadUnchecked(unsigned bits)
+	{
+		uint32_t result = 0;
+		unsigned shift = 0;
+		while (bits > 0)
+		{
+			const unsigned offset = position % 8;
+			const unsigned count = Min(8 - offset, bits);
+			const uint32_t byte = static_cast<unsigned char>(data[position / 8]);
+
+			result |= ((byte >> offset) & ((1u << count) - 1)) << shift;
+
+			shift += count;
+			bits -= count;
+			position += count;
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Jwl
+{
+	struct vec3;
+	struct quat;
+
+	// The number of bits needed to store any value from 0 to maxValue.
+	unsigned GetBitsRequired(uint32_t maxValue);
+
+	// Maps a value in [min, max] to an integer, with steps no larger than 'precision'. Values outside the range are clamped.
+	uint32_t Quantize(float value, float min, float max, float precision);
+	float Dequantize(uint32_t value, float min, float max, float precision);
+	// The number of bits needed to store values quantized with the same parameters.
+	unsigned GetQuantizedBits(float min, float max, float precision);
+
+	// Packs a rotation into 2 + 3 * bitsPerComponent bits by storing only its three smallest components.
+	// The largest is recovered from the fact that the quaternion has unit length. Up to 10 bits per component are supported.
+	uint32_t QuantizeQuat(const quat& rotation, unsigned bitsPerComponent);
+	quat DequantizeQuat(uint32_t value, unsigned bitsPerComponent);
+
+	// Packs values into a buffer using only as many bits as they need.
+	// Bits are written starting from the lowest bit of each byte, so the data is identical on all platforms.
+	class BitWriter
+	{
+	public:
+		// Writes the lowest 'bits' bits of the value, from 0 to 32.
+		void Write(uint32_t value, unsigned bits);
+		void WriteBool(bool value);
+		// Writes a value in [min, max] using just enough bits to cover the range.
+		void WriteInt(int value, int min, int max);
+		// Writes small values in fewer bits, in groups of 4 with a continuation bit.
+		void WriteVarUint(uint32_t value);
+		void WriteFloat(float value, float min, float max, float precision);
+		void WriteVec3(const vec3& value, float min, float max, float precision);
+		void WriteQuat(const quat& value, unsigned bitsPerComponent);
+		// Copies 'count' bits from a buffer written by another BitWriter.
+		void WriteBits(std::string_view bits, unsigned count);
+		void WriteBytes(std::string_view bytes);
+
+		// Pads with zeros up to the next whole byte.
+		void AlignToByte();
+		void Clear();
+
+		// The written data. Unused bits in the last byte are zero.
+		std::string_view GetData() const;
+		unsigned GetBitCount() const;
+		unsigned GetByteCount() const;
+
+	private:
+		std::string data;
+		unsigned bitCount = 0;
+	};
+
+	// Reads values packed by a BitWriter. Each read must use the same parameters that the value was written with.
+	// Reads that would go past the end of the data fail and leave the output untouched.
+	class BitReader
+	{
+	public:
+		BitReader(std::string_view data);
+
+		bool Read(unsigned bits, uint32_t& out_value);
+		bool ReadBool(bool& out_value);
+		bool ReadInt(int min, int max, int& out_value);
+		bool ReadVarUint(uint32_t& out_value);
+		bool ReadFloat(float min, float max, float precision, float& out_value);
+		bool ReadVec3(float min, float max, float precision, vec3& out_value);
+		bool ReadQuat(unsigned bitsPerComponent, quat& out_value);
+		// Extracts the next 'bitCount' bits into a buffer laid out the same way as BitWriter's.
+		bool ReadBits(unsigned bitCount, std::string& out_data);
+		bool ReadBytes(unsigned count, std::string& out_bytes);
+
+		// Skips to the start of the next whole byte.
+		void AlignToByte();
+
+		unsigned GetPosition() const;
+		unsigned GetRemaining() const;
+
+	private:
+		// Reads without checking the size. The caller must ensure that enough bits remain.
+		uint32_t ReadUnchecked(unsigned bits);
+
+		std::string_view data;
+		unsigned position = 0;
+	};
+}
@@ -0,0 +1,177 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "MessageBuffer.h"
+#include "Jewel3D/Application/Logging.h"
+
+#include <algorithm>
+
+namespace Jwl
+{
+	MessageBuffer::MessageBuffer(unsigned capacity)
+		: storage(std::max(capacity, HEADER_SIZE))
+	{
+	}
+
+	void MessageBuffer::WriteMessage(std::string_view message)
+	{
+		ASSERT(message.size() <= MAX_MESSAGE_SIZE, "Messages cannot be larger than %u bytes.", MAX_MESSAGE_SIZE);
+
+		const unsigned length = static_cast<unsigned>(message.size());
+		if (storage.size() - size < HEADER_SIZE + length)
+		{
+			Grow(size + HEADER_SIZE + length);
+		}
+
+		const char header[HEADER_SIZE] = {
+			static_cast<char>(length >> 24),
+			static_cast<char>(length >> 16),
+			static_cast<char>(length >> 8),
+			static_cast<char>(length)
+		};
+
+		CopyIn(header, HEADER_SIZE);
+		CopyIn(message.data(), length);
+	}
+
+	char* MessageBuffer::Reserve(unsigned minSize, unsigned& out_size)
+	{
+		if (storage.size() - size < minSize)
+		{
+			Grow(size + minSize);
+		}
+
+		if (size == 0)
+		{
+			// Start over from the beginning to leave as much contiguous space as possible.
+			head = 0;
+		}
+
+		const unsigned capacity = static_cast<unsigned>(storage.size());
+		const unsigned tail = (head + size) % capacity;
+		out_size = tail >= head && size != capacity ? capacity - tail : head - tail;
+
+		return storage.data() + tail;
+	}
+
+	void MessageBuffer::Commit(unsigned count)
+	{
+		ASSERT(size + count <= storage.size(), "Committing more data than was reserved.");
+
+		size += count;
+	}
+
+	bool MessageBuffer::ReadMessage(std::string_view& out_message)
+	{
+		if (size < HEADER_SIZE)
+		{
+			return false;
+		}
+
+		const unsigned length = ReadLength();
+		if (length > MAX_MESSAGE_SIZE || size - HEADER_SIZE < length)
+		{
+			return false;
+		}
+
+		const unsigned capacity = static_cast<unsigned>(storage.size());
+		const unsigned start = (head + HEADER_SIZE) % capacity;
+		if (start + length <= capacity)
+		{
+			out_message = std::string_view(storage.data() + start, length);
+		}
+		else
+		{
+			// Only one message at a time can cross the end of the buffer, so the copy is rare.
+			wrapped.resize(length);
+			CopyOut(HEADER_SIZE, wrapped.data(), length);
+			out_message = wrapped;
+		}
+
+		Consume(HEADER_SIZE + length);
+
+		return true;
+	}
+
+	bool MessageBuffer::HasInvalidMessage() const
+	{
+		return size >= HEADER_SIZE && ReadLength() > MAX_MESSAGE_SIZE;
+	}
+
+	std::string_view MessageBuffer::Peek() const
+	{
+		const unsigned count = std::min<unsigned>(size, static_cast<unsigned>(storage.size()) - head);
+
+		return std::string_view(storage.data() + head, count);
+	}
+
+	void MessageBuffer::Consume(unsigned count)
+	{
+		ASSERT(count <= size, "Consuming more data than is buffered.");
+
+		head = (head + count) % storage.size();
+		size -= count;
+	}
+
+	void MessageBuffer::Clear()
+	{
+		head = 0;
+		size = 0;
+		wrapped.clear();
+	}
+
+	bool MessageBuffer::IsEmpty() const
+	{
+		return size == 0;
+	}
+
+	unsigned MessageBuffer::GetSize() const
+	{
+		return size;
+	}
+
+	unsigned MessageBuffer::GetCapacity() const
+	{
+		return static_cast<unsigned>(storage.size());
+	}
+
+	unsigned MessageBuffer::ReadLength() const
+	{
+		unsigned char header[HEADER_SIZE];
+		CopyOut(0, reinterpret_cast<char*>(header), HEADER_SIZE);
+
+		return (header[0] << 24) | (header[1] << 16) | (header[2] << 8) | header[3];
+	}
+
+	void MessageBuffer::Grow(unsigned minCapacity)
+	{
+		std::vector<char> newStorage(std::max<size_t>(storage.size() * 2, minCapacity));
+		if (size > 0)
+		{
+			CopyOut(0, newStorage.data(), size);
+		}
+
+		storage = std::move(newStorage);
+		head = 0;
+	}
+
+	void MessageBuffer::CopyOut(unsigned offset, char* dest, unsigned count) const
+	{
+		const unsigned capacity = static_cast<unsigned>(storage.size());
+		const unsigned start = (head + offset) % capacity;
+		const unsigned first = std::min(count, capacity - start);
+
+		memcpy(dest, storage.data() + start, first);
+		memcpy(dest + first, storage.data(), count - first);
+	}
+
+	void MessageBuffer::CopyIn(const char* src, unsigned count)
+	{
+		const unsigned capacity = static_cast<unsigned>(storage.size());
+		const unsigned tail = (head + size) % capacity;
+		const unsigned first = std::min(count, capacity - tail);
+
+		memcpy(storage.data() + tail, src, first);
+		memcpy(storage.data(), src + first, count - first);
+		size += count;
+	}
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Jwl
+{
+	// A growable ring buffer holding the bytes of a TCP stream.
+	// Each message is preceded by its length as a 4 byte integer in network byte order, so messages can contain any binary data
+	// and are received whole, no matter how the stream was split up or merged along the way. Data is received directly into the
+	// buffer's free space and complete messages are read out as views, without being copied.
+	class MessageBuffer
+	{
+	public:
+		static constexpr unsigned HEADER_SIZE = 4;
+		// Longer messages are treated as a corrupt or malicious stream, rather than growing the buffer to fit them.
+		static constexpr unsigned MAX_MESSAGE_SIZE = 16 * 1024 * 1024;
+
+		MessageBuffer(unsigned capacity = 4096);
+
+		// Appends the message along with its length prefix.
+		void WriteMessage(std::string_view message);
+
+		// Returns the free space following the buffered data, growing the buffer first if less than 'minSize' bytes are free.
+		// The space might be smaller than 'minSize' if it wraps around the end of the buffer.
+		// Once data has been placed there, such as by recv(), it must be added with Commit().
+		char* Reserve(unsigned minSize, unsigned& out_size);
+		void Commit(unsigned count);
+
+		// Removes the next message from the buffer. Returns false if it has not been completely received yet.
+		// The view remains valid until the buffer is written to again.
+		bool ReadMessage(std::string_view& out_message);
+		// Returns true if the next message's length exceeds MAX_MESSAGE_SIZE. It will never be read, so the connection should be closed.
+		bool HasInvalidMessage() const;
+
+		// Returns the bytes at the front of the buffer, such as to be passed to send().
+		// This is only part of the data if it wraps around the end of the buffer.
+		std::string_view Peek() const;
+		// Discards bytes from the front of the buffer.
+		void Consume(unsigned count);
+
+		void Clear();
+		bool IsEmpty() const;
+		unsigned GetSize() const;
+		unsigned GetCapacity() const;
+
+	private:
+		// Decodes the length prefix at the front of the buffer. There must be at least HEADER_SIZE bytes buffered.
+		unsigned ReadLength() const;
+		void Grow(unsigned minCapacity);
+		// Copies bytes out of the buffer starting 'offset' bytes after the front, taking care of wrapping.
+		void CopyOut(unsigned offset, char* dest, unsigned count) const;
+		// Copies bytes to the back of the buffer, taking care of wrapping. There must be enough free space.
+		void CopyIn(const char* src, unsigned count);
+
+		std::vector<char> storage;
+		// The position of the first buffered byte.
+		unsigned head = 0;
+		unsigned size = 0;
+
+		// Holds a message which wraps around the end of the buffer, so that it can be viewed contiguously.
+		std::string wrapped;
+	};
+}
@@ -4,6 +4,89 @@
 #include "Network.h"
 #include "Jewel3D/Application/Logging.h"
 
+#include <algorithm>
+#include <charconv>
+#include <random>
+
+namespace
+{
+	// How much free space to provide for each call to recv().
+	constexpr unsigned RECEIVE_SIZE = 16 * 1024;
+	// The most data received from one socket per call to ReceiveInto(), so that a single peer cannot starve the others.
+	// Anything left over is still waiting on the socket for the next call.
+	constexpr unsigned MAX_RECEIVE_SIZE = 256 * 1024;
+
+	// Receives the data available on the socket into the buffer, up to MAX_RECEIVE_SIZE bytes.
+	// Returns false if the connection has been closed or has failed, or has sent a message longer than MessageBuffer::MAX_MESSAGE_SIZE.
+	bool ReceiveInto(int socket, Jwl::MessageBuffer& buffer)
+	{
+		unsigned total = 0;
+		while (total < MAX_RECEIVE_SIZE)
+		{
+			// Nothing more is received once the stream is known to be invalid.
+			if (buffer.HasInvalidMessage())
+			{
+				return false;
+			}
+
+			unsigned space = 0;
+			char* dest = buffer.Reserve(RECEIVE_SIZE, space);
+
+			const int length = recv(socket, dest, static_cast<int>(std::min(space, MAX_RECEIVE_SIZE - total)), 0);
+			if (length > 0)
+			{
+				buffer.Commit(length);
+				total += length;
+				continue;
+			}
+
+			// A length of 0 means the connection was closed gracefully.
+			return length == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK;
+		}
+
+		return !buffer.HasInvalidMessage();
+	}
+
+	void WriteToken(uint64_t token, char* dest)
+	{
+		for (unsigned i = 0; i < CONNECTION_TOKEN_SIZE; ++i)
+		{
+			dest[i] = static_cast<char>(token >> (56 - i * 8));
+		}
+	}
+
+	uint64_t ReadToken(const char* src)
+	{
+		uint64_t token = 0;
+		for (unsigned i = 0; i < CONNECTION_TOKEN_SIZE; ++i)
+		{
+			token = (token << 8) | static_cast<unsigned char>(src[i]);
+		}
+
+		return token;
+	}
+
+	// Sends as much of the buffer as the socket will accept without blocking.
+	// Returns false if the connection has failed.
+	bool SendFrom(int socket, Jwl::MessageBuffer& buffer)
+	{
+		while (!buffer.IsEmpty())
+		{
+			const std::string_view data = buffer.Peek();
+
+			const int length = send(socket, data.data(), static_cast<int>(data.size()), 0);
+			if (length == SOCKET_ERROR)
+			{
+				return WSAGetLastError() == WSAEWOULDBLOCK;
+			}
+
+			buffer.Consume(length);
+		}
+
+		return true;
+	}
+}
+
 namespace Jwl
 {
 	bool InitWinSock()
@@ -103,18 +186,17 @@ namespace Jwl
 	bool NetworkUDP::Receive(std::string& out_packet)
 	{
 		out_packet.clear();
-		memset(receiveBuffer, '\0', PACKET_LENGTH);
 
 		int length = recvfrom(inputSocket, receiveBuffer, PACKET_LENGTH, 0, nullptr, nullptr);
 
 		// Did we receive anything?
-		if (length == SOCKET_ERROR || WSAGetLastError() == WSAEWOULDBLOCK)
+		if (length == SOCKET_ERROR)
 		{
 			return false;
 		}
 		else
 		{
-			out_packet = receiveBuffer;
+			out_packet.assign(receiveBuffer, length);
 			return true;
 		}
 	}
@@ -126,7 +208,6 @@ namespace Jwl
 		, socketId(-1)
 	{
 		memset(&address, 0, sizeof(sockaddr_in));
-		memset(receiveBuffer, '\0', PACKET_LENGTH);
 	}
 
 	bool NetworkTCP::Init()
@@ -158,7 +239,8 @@ namespace Jwl
 		}
 
 		memset(&address, 0, sizeof(sockaddr_in));
-		memset(receiveBuffer, '\0', PACKET_LENGTH);
+		inbox.Clear();
+		outbox.Clear();
 	}
 
 	bool NetworkTCP::OpenToConnectionRequests(int localPortNum)
@@ -251,34 +333,51 @@ namespace Jwl
 	{
 		ASSERT(isConnected, "Network must have a connection to call this function.");
 
-		return send(socketId, packet.data(), packet.size(), 0) != SOCKET_ERROR;
+		outbox.WriteMessage(packet);
+
+		return SendFrom(socketId, outbox);
 	}
 
-	bool NetworkTCP::Receive(std::string& out_packet)
+	bool NetworkTCP::Flush()
 	{
 		ASSERT(isConnected, "Network must have a connection to call this function.");
 
-		out_packet.clear();
-		memset(receiveBuffer, '\0', PACKET_LENGTH);
+		return SendFrom(socketId, outbox);
+	}
 
-		int length = recv(socketId, receiveBuffer, PACKET_LENGTH, 0);
+	bool NetworkTCP::Receive(std::string_view& out_packet)
+	{
+		ASSERT(isConnected, "Network must have a connection to call this function.");
 
-		// Did we receive anything?
-		if (length == SOCKET_ERROR || WSAGetLastError() == WSAEWOULDBLOCK)
+		SendFrom(socketId, outbox);
+
+		if (inbox.ReadMessage(out_packet))
 		{
-			return false;
+			return true;
 		}
-		else
+
+		ReceiveInto(socketId, inbox);
+
+		return inbox.ReadMessage(out_packet);
+	}
+
+	bool NetworkTCP::Receive(std::string& out_packet)
+	{
+		out_packet.clear();
+
+		std::string_view message;
+		if (!Receive(message))
 		{
-			out_packet = receiveBuffer;
-			return true;
+			return false;
 		}
+
+		out_packet = message;
+		return true;
 	}
 
 	NetworkClient::NetworkClient()
 		: TCPSocket(-1)
-		, UDPSendSocket(-1)
-		, UDPReceiveSocket(-1)
+		, UDPSocket(-1)
 		, localPortTCP(-1)
 		, localPortUDP(-1)
 		, remotePortTCP(-1)
@@ -308,9 +407,9 @@ namespace Jwl
 			return false;
 		}
 
-		/* Create Receiving UDP Socket */
+		/* Create UDP Socket */
 		sockaddr_in address;
-		if ((UDPReceiveSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == SOCKET_ERROR)
+		if ((UDPSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == SOCKET_ERROR)
 		{
 			Destroy();
 			return false;
@@ -319,27 +418,27 @@ namespace Jwl
 		address.sin_port = htons(static_cast<u_short>(localPortUDP));
 		address.sin_addr.S_un.S_addr = INADDR_ANY;
 		// Bind to retrieve IP address.
-		if (bind(UDPReceiveSocket, reinterpret_cast<sockaddr*>(&address), sizeof(sockaddr)) == SOCKET_ERROR)
+		if (bind(UDPSocket, reinterpret_cast<sockaddr*>(&address), sizeof(sockaddr)) == SOCKET_ERROR)
 		{
 			Destroy();
 			return false;
 		}
 		// Set as Non-Blocking.
 		u_long iMode = 1;
-		ioctlsocket(UDPReceiveSocket, FIONBIO, &iMode);
+		ioctlsocket(UDPSocket, FIONBIO, &iMode);
 
-		/* Create Sending UDP Socket */
-		if ((UDPSendSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == SOCKET_ERROR)
-		{
-			Destroy();
-			return false;
-		}
 		UDPAddress.sin_family = AF_INET;
 		UDPAddress.sin_port = htons(static_cast<u_short>(remotePortUDP));
-		UDPAddress.sin_addr.S_un.S_addr = inet_addr(remoteIP.data());
-		// Set as Non-Blocking.
-		iMode = 1;
-		ioctlsocket(UDPSendSocket, FIONBIO, &iMode);
+		UDPAddress.sin_addr.S_un.S_addr = inet_addr(remoteIp.c_str());
+
+		// Zero is reserved for clients which have not been given a token.
+		std::random_device device;
+		do
+		{
+			token = (static_cast<uint64_t>(device()) << 32) | device();
+		} while (token == 0);
+
+		WriteToken(token, sendBuffer);
 
 		return true;
 	}
@@ -353,9 +452,18 @@ namespace Jwl
 			TCPSocket = -1;
 		}
 
+		if (UDPSocket != -1)
+		{
+			closesocket(UDPSocket);
+			UDPSocket = -1;
+		}
+
 		memset(&TCPAddress, 0, sizeof(sockaddr_in));
 		memset(&UDPAddress, 0, sizeof(sockaddr_in));
 		memset(receiveBuffer, '\0', PACKET_LENGTH);
+		token = 0;
+		inbox.Clear();
+		outbox.Clear();
 	}
 
 	bool NetworkClient::SendConnectionRequest()
@@ -388,8 +496,8 @@ namespace Jwl
 			u_long iMode = 1;
 			ioctlsocket(TCPSocket, FIONBIO, &iMode);
 
-			// Send our UDP port information to the server.
-			if (!SendTCP(std::to_string(localPortUDP)))
+			// Send our UDP port and connection token to the server.
+			if (!SendTCP(std::to_string(localPortUDP) + ' ' + std::to_string(token)))
 			{
 				return false;
 			}
@@ -407,53 +515,76 @@ namespace Jwl
 
 	bool NetworkClient::SendUDP(std::string_view packet)
 	{
-		return sendto(UDPSendSocket, packet.data(), packet.size(), 0, reinterpret_cast<sockaddr*>(&UDPAddress), sizeof(sockaddr)) != SOCKET_ERROR;
+		// The packet must fit in the buffer behind the token.
+		if (packet.size() > PACKET_LENGTH)
+		{
+			Error("NetworkClient: UDP packets cannot be larger than %d bytes.", PACKET_LENGTH);
+			return false;
+		}
+
+		// The token is already at the front of the buffer.
+		memcpy(sendBuffer + CONNECTION_TOKEN_SIZE, packet.data(), packet.size());
+		const int length = static_cast<int>(CONNECTION_TOKEN_SIZE + packet.size());
+
+		return sendto(UDPSocket, sendBuffer, length, 0, reinterpret_cast<sockaddr*>(&UDPAddress), sizeof(sockaddr)) != SOCKET_ERROR;
 	}
 
 	bool NetworkClient::ReceiveUDP(std::string& out_packet)
 	{
-		// Empty buffers.
 		out_packet.clear();
-		memset(receiveBuffer, '\0', PACKET_LENGTH);
 
-		int length = recvfrom(UDPReceiveSocket, receiveBuffer, PACKET_LENGTH, 0, NULL, NULL);
+		int length = recvfrom(UDPSocket, receiveBuffer, PACKET_LENGTH, 0, NULL, NULL);
 
-		if (length == SOCKET_ERROR || WSAGetLastError() == WSAEWOULDBLOCK)
+		if (length == SOCKET_ERROR)
 		{
 			// No error, we just didn't receive a packet.
 			return false;
 		}
 		else
 		{
-			out_packet = receiveBuffer;
+			out_packet.assign(receiveBuffer, length);
 			return true;
 		}
 	}
 
 	bool NetworkClient::SendTCP(std::string_view packet)
 	{
-		return send(TCPSocket, packet.data(), packet.size(), 0) != SOCKET_ERROR;
+		outbox.WriteMessage(packet);
+
+		return SendFrom(TCPSocket, outbox);
 	}
 
-	bool NetworkClient::ReceiveTCP(std::string& out_packet)
+	bool NetworkClient::FlushTCP()
 	{
-		// Empty buffers.
-		out_packet.clear();
-		memset(receiveBuffer, '\0', PACKET_LENGTH);
+		return SendFrom(TCPSocket, outbox);
+	}
 
-		int length = recv(TCPSocket, receiveBuffer, PACKET_LENGTH, 0);
+	bool NetworkClient::ReceiveTCP(std::string_view& out_packet)
+	{
+		SendFrom(TCPSocket, outbox);
 
-		// Did we receive anything?
-		if (length == SOCKET_ERROR || WSAGetLastError() == WSAEWOULDBLOCK)
+		if (inbox.ReadMessage(out_packet))
 		{
-			// No error, we just didn't receive a packet.
-			return false;
+			return true;
 		}
-		else
+
+		ReceiveInto(TCPSocket, inbox);
+
+		return inbox.ReadMessage(out_packet);
+	}
+
+	bool NetworkClient::ReceiveTCP(std::string& out_packet)
+	{
+		out_packet.clear();
+
+		std::string_view message;
+		if (!ReceiveTCP(message))
 		{
-			out_packet = receiveBuffer;
-			return true;
+			return false;
 		}
+
+		out_packet = message;
+		return true;
 	}
 
 	NetworkServer::NetworkServer()
@@ -466,7 +597,6 @@ namespace Jwl
 	{
 		memset(&TCPAddress, 0, sizeof(sockaddr_in));
 		memset(&UDPAddress, 0, sizeof(sockaddr_in));
-		memset(receiveBuffer, '\0', PACKET_LENGTH);
 	}
 
 	bool NetworkServer::Init(int localPortNumTCP, int localPortNumUDP)
@@ -518,6 +648,21 @@ namespace Jwl
 
 	void NetworkServer::Destroy()
 	{
+		for (auto& client : clients)
+		{
+			shutdown(client.TCPSocket, SD_BOTH);
+			closesocket(client.TCPSocket);
+		}
+
+		clients.clear();
+		clientTokens.clear();
+		pollList.clear();
+		numPending = 0;
+		newClients.clear();
+		closedClients.clear();
+		closedInboxes.clear();
+		nextClient = 0;
+
 		if (TCPSocket != -1)
 		{
 			shutdown(TCPSocket, SD_BOTH);
@@ -525,9 +670,21 @@ namespace Jwl
 			TCPSocket = -1;
 		}
 
+		if (UDPSendSocket != -1)
+		{
+			closesocket(UDPSendSocket);
+			UDPSendSocket = -1;
+		}
+
+		if (UDPReceiveSocket != -1)
+		{
+			closesocket(UDPReceiveSocket);
+			UDPReceiveSocket = -1;
+		}
+
 		memset(&TCPAddress, 0, sizeof(sockaddr_in));
 		memset(&UDPAddress, 0, sizeof(sockaddr_in));
-		memset(receiveBuffer, '\0', PACKET_LENGTH);
+		datagrams.clear();
 	}
 
 	bool NetworkServer::OpenToConnectionRequests()
@@ -544,45 +701,129 @@ namespace Jwl
 		}
 
 		/* Open Socket to connections */
-		listen(TCPSocket, 1);
+		// A long backlog lets many clients connect between two calls to Poll().
+		listen(TCPSocket, SOMAXCONN);
 
 		/* Set as Non-Blocking */
 		u_long iMode = 1;
 		ioctlsocket(TCPSocket, FIONBIO, &iMode);
 
+		WSAPOLLFD listener = {};
+		listener.fd = TCPSocket;
+		listener.events = POLLRDNORM;
+		pollList.assign(1, listener);
+
+		return true;
+	}
+
+	bool NetworkServer::Poll(int timeoutMS)
+	{
+		if (pollList.empty())
+		{
+			return false;
+		}
+
+		closedInboxes.clear();
+
+		const int numReady = WSAPoll(pollList.data(), static_cast<ULONG>(pollList.size()), timeoutMS);
+		if (numReady == SOCKET_ERROR)
+		{
+			return false;
+		}
+
+		if (numReady == 0)
+		{
+			return true;
+		}
+
+		// Every ready client is read before returning, so that a busy client cannot delay the others.
+		std::vector<unsigned> closed;
+		for (unsigned i = 0; i < clients.size(); ++i)
+		{
+			const short events = pollList[i + 1].revents;
+			if (events == 0)
+			{
+				continue;
+			}
+
+			bool isOpen = true;
+			if (events & POLLWRNORM)
+			{
+				isOpen = FlushClient(i);
+			}
+
+			if (events & (POLLRDNORM | POLLHUP | POLLERR))
+			{
+				isOpen = ReadClient(i) && isOpen;
+			}
+
+			if (!isOpen)
+			{
+				closed.push_back(i);
+			}
+		}
+
+		// Removing from the back keeps the remaining indices valid.
+		for (auto itr = closed.rbegin(); itr != closed.rend(); ++itr)
+		{
+			Client& client = clients[*itr];
+			if (!client.isPending)
+			{
+				closedClients.push_back(client.ID);
+
+				if (!client.inbox.IsEmpty())
+				{
+					ClosedInbox& closedInbox = closedInboxes.emplace_back();
+					closedInbox.ID = client.ID;
+					closedInbox.inbox = std::move(client.inbox);
+				}
+			}
+
+			CloseClient(*itr);
+		}
+
+		if (pollList[0].revents != 0)
+		{
+			AcceptClients();
+		}
+
 		return true;
 	}
 
 	int NetworkServer::CheckForConnectionRequests()
 	{
-		Client newClient;
-		SOCKET tempSocket = accept(TCPSocket, reinterpret_cast<sockaddr*>(&newClient.TCPAddress), &newClient.TCPAddressSize);
+		if (newClients.empty())
+		{
+			Poll();
+		}
 
-		if (tempSocket == SOCKET_ERROR)
+		if (newClients.empty())
 		{
 			return -1;
 		}
-		else
-		{
-			/* Initialize new client */
-			newClient.TCPSocket = tempSocket;
-			newClient.ID = ++idCounter;
 
-			// Wait for message with client's port.
-			memset(receiveBuffer, '\0', PACKET_LENGTH);
-			while (recv(newClient.TCPSocket, receiveBuffer, PACKET_LENGTH, 0) == SOCKET_ERROR || WSAGetLastError() == WSAEWOULDBLOCK)
-			{}
+		const int ID = newClients.front();
+		newClients.pop_front();
 
-			int port = std::atoi(receiveBuffer);
+		return ID;
+	}
 
-			// Set up address for sending data back with UDPs.
-			newClient.UDPAddress.sin_family = AF_INET;
-			newClient.UDPAddress.sin_port = htons(static_cast<u_short>(port));
-			newClient.UDPAddress.sin_addr.S_un.S_addr = newClient.TCPAddress.sin_addr.S_un.S_addr;
-			clients.push_back(newClient);
+	int NetworkServer::CheckForDisconnections()
+	{
+		if (closedClients.empty())
+		{
+			Poll();
+		}
 
-			return newClient.ID;
+		if (closedClients.empty())
+		{
+			return -1;
 		}
+
+		const int ID = closedClients.front();
+		closedClients.pop_front();
+
+		return ID;
 	}
 
 	bool NetworkServer::IsConnected(int ID) const
@@ -592,7 +833,7 @@ namespace Jwl
 
 	unsigned NetworkServer::GetNumClients() const
 	{
-		return clients.size();
+		return clients.size() - numPending;
 	}
 
 	void NetworkServer::RemoveClient(int ID)
@@ -600,10 +841,125 @@ namespace Jwl
 		unsigned i = GetClientIndex(ID);
 		ASSERT(i != -1, "Client with ID %d could not be found.", ID);
 
-		shutdown(clients[i].TCPSocket, SD_BOTH);
-		closesocket(clients[i].TCPSocket);
+		CloseClient(i);
+	}
+
+	void NetworkServer::AcceptClients()
+	{
+		while (true)
+		{
+			Client newClient;
+			SOCKET tempSocket = accept(TCPSocket, reinterpret_cast<sockaddr*>(&newClient.TCPAddress), &newClient.TCPAddressSize);
+			if (tempSocket == SOCKET_ERROR)
+			{
+				return;
+			}
+
+			/* Set as Non-Blocking */
+			u_long iMode = 1;
+			ioctlsocket(tempSocket, FIONBIO, &iMode);
+
+			/* Initialize new client */
+			newClient.TCPSocket = tempSocket;
+			newClient.ID = ++idCounter;
+
+			WSAPOLLFD entry = {};
+			entry.fd = tempSocket;
+			entry.events = POLLRDNORM;
+
+			clients.push_back(std::move(newClient));
+			pollList.push_back(entry);
+			++numPending;
+
+			// The client's port might have arrived along with the connection.
+			if (!ReadClient(static_cast<unsigned>(clients.size() - 1)))
+			{
+				CloseClient(clients.size() - 1);
+			}
+		}
+	}
+
+	bool NetworkServer::ReadClient(unsigned index)
+	{
+		Client& client = clients[index];
+		const bool isOpen = ReceiveInto(client.TCPSocket, client.inbox);
+
+		std::string_view message;
+		if (client.isPending && client.inbox.ReadMessage(message))
+		{
+			// The first message is the port that the client receives UDP packets on, followed by its connection token.
+			const char* end = message.data() + message.size();
+			int port = 0;
+			auto result = std::from_chars(message.data(), end, port);
+			if (result.ec != std::errc() || result.ptr == end || *result.ptr != ' ' || port < 1 || port > 65535)
+			{
+				return false;
+			}
+
+			// Datagrams are matched to clients by their token, so a client without a valid one is not accepted.
+			// A token that is already in use is also rejected, so that one client cannot receive another's datagrams.
+			uint64_t token = 0;
+			result = std::from_chars(result.ptr + 1, end, token);
+			if (result.ec != std::errc() || token == 0 || !clientTokens.emplace(token, index).second)
+			{
+				return false;
+			}
+
+			client.token = token;
+
+			// Set up address for sending data back with UDPs.
+			client.UDPAddress.sin_family = AF_INET;
+			client.UDPAddress.sin_port = htons(static_cast<u_short>(port));
+			client.UDPAddress.sin_addr.S_un.S_addr = client.TCPAddress.sin_addr.S_un.S_addr;
+			client.isPending = false;
+			--numPending;
+
+			newClients.push_back(client.ID);
+		}
+
+		return isOpen;
+	}
+
+	bool NetworkServer::FlushClient(unsigned index)
+	{
+		Client& client = clients[index];
+		const bool isOpen = SendFrom(client.TCPSocket, client.outbox);
+
+		// Find out when the connection can take more if not everything was sent.
+		pollList[index + 1].events = client.outbox.IsEmpty() ? POLLRDNORM : POLLRDNORM | POLLWRNORM;
 
-		clients.erase(clients.begin() + i);
+		return isOpen;
+	}
+
+	void NetworkServer::CloseClient(unsigned index)
+	{
+		Client& client = clients[index];
+
+		shutdown(client.TCPSocket, SD_BOTH);
+		closesocket(client.TCPSocket);
+
+		if (client.isPending)
+		{
+			--numPending;
+		}
+
+		// The clients after this one move down to fill its place.
+		auto itr = clientTokens.find(client.token);
+		if (itr != clientTokens.end() && itr->second == index)
+		{
+			clientTokens.erase(itr);
+		}
+
+		for (auto& [token, clientIndex] : clientTokens)
+		{
+			if (clientIndex > index)
+			{
+				--clientIndex;
+			}
+		}
+
+		clients.erase(clients.begin() + index);
+		pollList.erase(pollList.begin() + index + 1);
 	}
 
 	bool NetworkServer::SendUDP(std::string_view packet, int ID)
@@ -619,6 +975,9 @@ namespace Jwl
 		bool okay = true;
 		for (auto& client : clients)
 		{
+			if (client.isPending)
+				continue;
+
 			bool result = sendto(UDPSendSocket, packet.data(), packet.size(), 0, reinterpret_cast<sockaddr*>(&client.UDPAddress), client.UDPAddressSize) != SOCKET_ERROR;
 			okay = okay && result;
 		}
@@ -631,7 +990,7 @@ namespace Jwl
 		bool okay = true;
 		for (auto& client : clients)
 		{
-			if (client.ID == excludedID)
+			if (client.ID == excludedID || client.isPending)
 				continue;
 
 			bool result = sendto(UDPSendSocket, packet.data(), packet.size(), 0, reinterpret_cast<sockaddr*>(&client.UDPAddress), client.UDPAddressSize) != SOCKET_ERROR;
@@ -641,38 +1000,117 @@ namespace Jwl
 		return okay;
 	}
 
+	int NetworkServer::ReceiveUDP(std::string_view& out_packet)
+	{
+		int ID = -1;
+		unsigned length = 0;
+		while (ReadDatagram(0, ID, length))
+		{
+			if (ID != -1)
+			{
+				out_packet = std::string_view(datagrams.data(), length);
+				return ID;
+			}
+		}
+
+		return -1;
+	}
+
 	int NetworkServer::ReceiveUDP(std::string& out_packet)
 	{
-		// Empty buffers.
 		out_packet.clear();
-		memset(receiveBuffer, '\0', PACKET_LENGTH);
 
-		sockaddr_in addr;
-		int addrSize = sizeof(sockaddr);
+		std::string_view packet;
+		const int ID = ReceiveUDP(packet);
+		if (ID != -1)
+		{
+			out_packet = packet;
+		}
 
-		int length = recvfrom(UDPReceiveSocket, receiveBuffer, PACKET_LENGTH, 0, reinterpret_cast<sockaddr*>(&addr), &addrSize);
+		return ID;
+	}
+
+	unsigned NetworkServer::ReceiveUDP(std::vector<NetworkMessage>& out)
+	{
+		// The views can only be made once all datagrams are received, since the buffer might be reallocated.
+		std::vector<std::pair<int, unsigned>> received;
 
-		if (length == SOCKET_ERROR || WSAGetLastError() == WSAEWOULDBLOCK)
+		unsigned offset = 0;
+		int ID = -1;
+		unsigned length = 0;
+		while (ReadDatagram(offset, ID, length))
 		{
-			// No error, we just didn't receive a packet.
-			return -1;
+			if (ID != -1)
+			{
+				received.emplace_back(ID, length);
+				offset += length;
+			}
 		}
-		else
+
+		offset = 0;
+		for (auto& [clientID, size] : received)
+		{
+			NetworkMessage& message = out.emplace_back();
+			message.clientID = clientID;
+			message.data = std::string_view(datagrams.data() + offset, size);
+			offset += size;
+		}
+
+		return static_cast<unsigned>(received.size());
+	}
+
+	bool NetworkServer::ReadDatagram(unsigned offset, int& out_ID, unsigned& out_length)
+	{
+		constexpr unsigned MAX_SIZE = CONNECTION_TOKEN_SIZE + PACKET_LENGTH;
+		if (datagrams.size() < offset + MAX_SIZE)
 		{
-			out_packet = receiveBuffer;
+			datagrams.resize(std::max<size_t>(datagrams.size() * 2, offset + MAX_SIZE));
+		}
 
-			// Identify the client.
-			for (auto& client : clients)
-			{
-				// Clients are assumed to have unique IP addresses.
-				if (client.UDPAddress.sin_addr.S_un.S_addr == addr.sin_addr.S_un.S_addr)
-				{
-					return client.ID;
-				}
-			}
+		sockaddr_in address;
+		int addressSize = sizeof(sockaddr);
+		char* dest = datagrams.data() + offset;
+
+		out_ID = -1;
+		out_length = 0;
+
+		int length = recvfrom(UDPReceiveSocket, dest, MAX_SIZE, 0, reinterpret_cast<sockaddr*>(&address), &addressSize);
+		if (length == SOCKET_ERROR)
+		{
+			// Oversized datagrams are discarded.
+			return WSAGetLastError() == WSAEMSGSIZE;
 		}
 
-		return -1;
+		if (length < CONNECTION_TOKEN_SIZE)
+		{
+			return true;
+		}
+
+		// Identify the client.
+		auto itr = clientTokens.find(ReadToken(dest));
+		if (itr == clientTokens.end())
+		{
+			return true;
+		}
+
+		// The datagram must come from the client's address, and from the same port as its previous datagrams.
+		Client& client = clients[itr->second];
+		if (client.UDPAddress.sin_addr.S_un.S_addr != address.sin_addr.S_un.S_addr ||
+			(client.isUDPConfirmed && client.UDPAddress.sin_port != address.sin_port))
+		{
+			return true;
+		}
+
+		// Reply to the port that was actually used, in case it was changed along the way by a NAT.
+		client.UDPAddress.sin_port = address.sin_port;
+		client.isUDPConfirmed = true;
+
+		// Remove the token so the packets are contiguous.
+		out_ID = client.ID;
+		out_length = length - CONNECTION_TOKEN_SIZE;
+		memmove(dest, dest + CONNECTION_TOKEN_SIZE, out_length);
+
+		return true;
 	}
 
 	bool NetworkServer::SendTCP(std::string_view packet, int ID)
@@ -680,15 +1118,21 @@ namespace Jwl
 		unsigned i = GetClientIndex(ID);
 		ASSERT(i != -1, "Client with ID %d could not be found.", ID);
 
-		return send(clients[i].TCPSocket, packet.data(), packet.size(), 0) != SOCKET_ERROR;
+		clients[i].outbox.WriteMessage(packet);
+
+		return FlushClient(i);
 	}
 
 	bool NetworkServer::SendTCP(std::string_view packet)
 	{
 		bool okay = true;
-		for (auto& client : clients)
+		for (unsigned i = 0; i < clients.size(); ++i)
 		{
-			bool result = send(client.TCPSocket, packet.data(), packet.size(), 0) != SOCKET_ERROR;
+			if (clients[i].isPending)
+				continue;
+
+			clients[i].outbox.WriteMessage(packet);
+			bool result = FlushClient(i);
 			okay = okay && result;
 		}
 
@@ -698,39 +1142,77 @@ namespace Jwl
 	bool NetworkServer::SendToAllButOneTCP(std::string_view packet, int excludedID)
 	{
 		bool okay = true;
-		for (auto& client : clients)
+		for (unsigned i = 0; i < clients.size(); ++i)
 		{
-			if (client.ID == excludedID)
+			if (clients[i].ID == excludedID || clients[i].isPending)
 				continue;
 
-			bool result = send(client.TCPSocket, packet.data(), packet.size(), 0) != SOCKET_ERROR;
+			clients[i].outbox.WriteMessage(packet);
+			bool result = FlushClient(i);
 			okay = okay && result;
 		}
 
 		return okay;
 	}
 
+	int NetworkServer::ReceiveTCP(std::string_view& out_packet)
+	{
+		int ID = NextMessage(out_packet);
+		if (ID == -1)
+		{
+			Poll();
+			ID = NextMessage(out_packet);
+		}
+
+		return ID;
+	}
+
 	int NetworkServer::ReceiveTCP(std::string& out_packet)
 	{
-		// Empty buffers.
 		out_packet.clear();
-		memset(receiveBuffer, '\0', PACKET_LENGTH);
 
-		// Look through all clients for packets.
-		for (auto& client : clients)
+		std::string_view message;
+		const int ID = ReceiveTCP(message);
+		if (ID != -1)
 		{
-			int length = recv(client.TCPSocket, receiveBuffer, PACKET_LENGTH, 0);
+			out_packet = message;
+		}
+
+		return ID;
+	}
 
-			// Did we receive anything?
-			if (length == SOCKET_ERROR || WSAGetLastError() == WSAEWOULDBLOCK)
+	unsigned NetworkServer::ReceiveTCP(std::vector<NetworkMessage>& out)
+	{
+		Poll();
+
+		const size_t count = out.size();
+
+		NetworkMessage message;
+		while ((message.clientID = NextMessage(message.data)) != -1)
+		{
+			out.push_back(message);
+		}
+
+		return static_cast<unsigned>(out.size() - count);
+	}
+
+	int NetworkServer::NextMessage(std::string_view& out_packet)
+	{
+		for (auto& closedInbox : closedInboxes)
+		{
+			if (closedInbox.inbox.ReadMessage(out_packet))
 			{
-				// No error, we just didn't receive a packet.
-				continue;
+				return closedInbox.ID;
 			}
-			else
+		}
+
+		for (unsigned i = 0; i < clients.size(); ++i)
+		{
+			const unsigned index = (nextClient + i) % clients.size();
+			if (clients[index].inbox.ReadMessage(out_packet))
 			{
-				out_packet = receiveBuffer;
-				return client.ID;
+				nextClient = index + 1;
+				return clients[index].ID;
 			}
 		}
 
@@ -741,7 +1223,7 @@ namespace Jwl
 	{
 		for (unsigned i = 0; i < clients.size(); ++i)
 		{
-			if (clients[i].ID == ID)
+			if (clients[i].ID == ID && !clients[i].isPending)
 			{
 				return i;
 			}
@@ -1,13 +1,20 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include "MessageBuffer.h"
+
 #include <WinSock2.h>
+#include <cstdint>
+#include <deque>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace Jwl
 {
 	#define PACKET_LENGTH 512
+	// Datagrams sent to a NetworkServer begin with the client's connection token.
+	#define CONNECTION_TOKEN_SIZE 8
 
 	// Prepares Windows Sockets for use.
 	bool InitWinSock();
@@ -62,7 +69,13 @@ namespace Jwl
 		// Returns true if a TCP connection is established.
 		bool IsConnected() const;
 
+		// Messages are delivered whole and can contain any binary data.
+		// If the connection is busy, the rest of the message is sent by later calls to Send(), Receive(), or Flush().
 		bool Send(std::string_view packet);
+		// Sends any data held back because the connection was busy.
+		bool Flush();
+		// The message is a view into the receive buffer and remains valid until the next call to Receive().
+		bool Receive(std::string_view& out_packet);
 		bool Receive(std::string& out_packet);
 
 	private:
@@ -75,7 +88,8 @@ namespace Jwl
 
 		int socketId;
 
-		char receiveBuffer[PACKET_LENGTH];
+		MessageBuffer inbox;
+		MessageBuffer outbox;
 	};
 
 	class NetworkClient
@@ -91,18 +105,25 @@ namespace Jwl
 		// Returns true if a connection is established.
 		bool IsConnected() const;
 
+		// The packet is sent from the same port it is received on, so that the server can reply through a NAT.
+		// Returns false without sending if the packet is larger than PACKET_LENGTH.
 		bool SendUDP(std::string_view packet);
 		bool ReceiveUDP(std::string& out_packet);
 
+		// Messages are delivered whole and can contain any binary data.
+		// If the connection is busy, the rest of the message is sent by later calls to SendTCP(), ReceiveTCP(), or FlushTCP().
 		bool SendTCP(std::string_view packet);
+		// Sends any data held back because the connection was busy.
+		bool FlushTCP();
+		// The message is a view into the receive buffer and remains valid until the next call to ReceiveTCP().
+		bool ReceiveTCP(std::string_view& out_packet);
 		bool ReceiveTCP(std::string& out_packet);
 
 	private:
 		sockaddr_in TCPAddress;
 		sockaddr_in UDPAddress;
 		int TCPSocket;
-		int UDPSendSocket;
-		int UDPReceiveSocket;
+		int UDPSocket;
 		int localPortTCP;
 		int localPortUDP;
 		int remotePortTCP;
@@ -110,9 +131,29 @@ namespace Jwl
 		std::string remoteIp;
 		bool isConnected;
 
+		// A random value sent with the connection request and with every datagram, so the server can tell apart
+		// clients sharing an address, such as behind a NAT, and ignore datagrams that are not from its clients.
+		uint64_t token = 0;
+
 		char receiveBuffer[PACKET_LENGTH];
+		// Holds the token followed by the packet being sent.
+		char sendBuffer[CONNECTION_TOKEN_SIZE + PACKET_LENGTH];
+
+		MessageBuffer inbox;
+		MessageBuffer outbox;
+	};
+
+	// A message received from one of a NetworkServer's clients.
+	// The data is a view into the client's receive buffer and remains valid until the server's next call to Poll().
+	struct NetworkMessage
+	{
+		int clientID = -1;
+		std::string_view data;
 	};
 
+	// Serves many clients from a single thread. The listening socket and every client's socket are
+	// checked for readiness with one call to WSAPoll(), after which only the sockets with pending
+	// connections or data are accessed. Each client's data is gathered in its own receive buffer until whole messages have arrived.
 	class NetworkServer
 	{
 	public:
@@ -123,9 +164,16 @@ namespace Jwl
 
 		// Allow other hosts to request a connection with us.
 		bool OpenToConnectionRequests();
-		// Check for pending connection requests. 
-		// Returns the new client's unique ID.
+
+		// Waits up to 'timeoutMS' for network activity, then accepts every pending connection, reads everything
+		// that the clients have sent, and continues sending to busy clients. A timeout of 0 returns immediately.
+		// The Check* and Receive* functions call this when they have nothing to report.
+		bool Poll(int timeoutMS = 0);
+
+		// Returns the unique ID of a newly connected client, or -1 if there are none.
 		int CheckForConnectionRequests();
+		// Returns the ID of a client that closed its connection, or -1 if there are none. The client has already been removed.
+		int CheckForDisconnections();
 		// Returns true a client with ID is connected.
 		bool IsConnected(int ID) const;
 
@@ -137,13 +185,30 @@ namespace Jwl
 		// Sends the message to all clients.
 		bool SendUDP(std::string_view packet);
 		bool SendToAllButOneUDP(std::string_view packet, int excludedID);
+		// Datagrams are only accepted from the address, port, and connection token of a connected client.
+		// The client's port is taken from the first datagram it sends, and replies are sent there from then on.
+		// Returns the ID of the client that sent the packet, or -1 if there are none.
+		// The view remains valid until the next call to ReceiveUDP().
+		int ReceiveUDP(std::string_view& out_packet);
 		int ReceiveUDP(std::string& out_packet);
+		// Receives every datagram waiting on the socket into a single buffer and appends them to 'out'.
+		// The views remain valid until the next call to ReceiveUDP(). Returns the number of datagrams added.
+		unsigned ReceiveUDP(std::vector<NetworkMessage>& out);
 
+		// Messages are delivered whole and can contain any binary data.
+		// If a client's connection is busy, the rest of the message is sent by Poll().
 		bool SendTCP(std::string_view packet, int ID);
 		// Sends the message to all clients
 		bool SendTCP(std::string_view packet);
 		bool SendToAllButOneTCP(std::string_view packet, int excludedID);
+		// Returns the ID of the client that sent the message, or -1 if there are none.
+		// Clients take turns, so one that sends many messages cannot hold up the others.
+		// The view remains valid until the next call to Poll(), which happens here if no messages are waiting.
+		int ReceiveTCP(std::string_view& out_packet);
 		int ReceiveTCP(std::string& out_packet);
+		// Polls, then appends every complete message that has been received to 'out'.
+		// Returns the number of messages added.
+		unsigned ReceiveTCP(std::vector<NetworkMessage>& out);
 
 	private:
 		struct Client
@@ -160,8 +225,37 @@ namespace Jwl
 			int UDPAddressSize = sizeof(sockaddr);
 			int TCPSocket = -1;
 			int ID = -1;
+			// Clients are hidden until they have sent the port that they receive UDP packets on.
+			bool isPending = true;
+			// Set once a datagram has been received from the client, confirming its port.
+			bool isUDPConfirmed = false;
+			uint64_t token = 0;
+			MessageBuffer inbox;
+			MessageBuffer outbox;
+		};
+
+		// The remaining messages of a client that closed its connection.
+		struct ClosedInbox
+		{
+			int ID = -1;
+			MessageBuffer inbox;
 		};
 
+		// Accepts connections until none are left waiting.
+		void AcceptClients();
+		// Reads everything available from the client. Returns false if the connection has closed, or should be closed because the
+		// client sent an invalid connection message.
+		bool ReadClient(unsigned index);
+		// Sends as much of the client's pending data as possible. Returns false if the connection has failed.
+		bool FlushClient(unsigned index);
+		// Reads the next complete message, taking turns between the clients. Returns the sender's ID, or -1 if there are none.
+		int NextMessage(std::string_view& out_packet);
+		// Receives one datagram into 'datagrams' at the offset. Returns false if none are waiting.
+		// The ID is -1 if the datagram did not come from a connected client.
+		bool ReadDatagram(unsigned offset, int& out_ID, unsigned& out_length);
+		// Closes the client's socket and removes it from the client and poll lists, and from the token lookup.
+		void CloseClient(unsigned index);
+
 		sockaddr_in TCPAddress;
 		sockaddr_in UDPAddress;
 		int TCPSocket;
@@ -171,9 +265,22 @@ namespace Jwl
 		int localPortUDP;
 		int idCounter;
 
-		char receiveBuffer[PACKET_LENGTH];
+		// Received datagrams, without their connection tokens.
+		std::vector<char> datagrams;
 
 		std::vector<Client> clients;
+		// The index of each client that has sent its connection token, so that datagrams can be matched to their sender quickly.
+		std::unordered_map<uint64_t, unsigned> clientTokens;
+		// The listening socket followed by each client's socket, in the same order as 'clients'.
+		std::vector<WSAPOLLFD> pollList;
+		unsigned numPending = 0;
+
+		std::deque<int> newClients;
+		std::deque<int> closedClients;
+		// Kept until the next Poll() so that messages sent just before disconnecting can still be received.
+		std::vector<ClosedInbox> closedInboxes;
+		// The client to check first for the next message.
+		unsigned nextClient = 0;
 
 		// Returns the array index of the client with the ID, or -1 if no client is found.
 		unsigned GetClientIndex(int ID) const;
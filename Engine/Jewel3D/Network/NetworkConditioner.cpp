@@ -0,0 +1,89 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "NetworkConditioner.h"
+#include "Jewel3D/Application/Logging.h"
+
+#include <algorithm>
+
+namespace Jwl
+{
+	NetworkConditioner::NetworkConditioner(SendFunc _send, unsigned seed)
+		: send(std::move(_send))
+		, engine(seed)
+		, distribution(0.0, 1.0)
+	{
+		ASSERT(send, "NetworkConditioner needs a function to send packets with.");
+	}
+
+	void NetworkConditioner::SetLoss(double fraction)
+	{
+		ASSERT(fraction >= 0.0 && fraction <= 1.0, "Loss must be between 0 and 1.");
+
+		loss = fraction;
+	}
+
+	void NetworkConditioner::SetDuplication(double fraction)
+	{
+		ASSERT(fraction >= 0.0 && fraction <= 1.0, "Duplication must be between 0 and 1.");
+
+		duplication = fraction;
+	}
+
+	void NetworkConditioner::SetLatency(double ms, double jitterMS)
+	{
+		ASSERT(ms >= 0.0 && jitterMS >= 0.0, "Latency cannot be negative.");
+
+		latency = ms;
+		jitter = jitterMS;
+	}
+
+	void NetworkConditioner::Send(std::string_view packet)
+	{
+		if (distribution(engine) < loss)
+		{
+			return;
+		}
+
+		Queue(packet);
+
+		if (distribution(engine) < duplication)
+		{
+			Queue(packet);
+		}
+	}
+
+	void NetworkConditioner::Update(double timeMS)
+	{
+		currentTime = timeMS;
+
+		// Released in the order of their delays, which is not necessarily the order they were sent in.
+		std::stable_sort(pending.begin(), pending.end(), [](const DelayedPacket& a, const DelayedPacket& b) {
+			return a.releaseTime < b.releaseTime;
+		});
+
+		auto ready = std::find_if(pending.begin(), pending.end(), [timeMS](const DelayedPacket& packet) {
+			return packet.releaseTime > timeMS;
+		});
+
+		// Sending might cause more packets to be queued, so the ready ones are taken out first.
+		std::vector<DelayedPacket> released(std::make_move_iterator(pending.begin()), std::make_move_iterator(ready));
+		pending.erase(pending.begin(), ready);
+
+		for (auto& packet : released)
+		{
+			send(packet.data);
+		}
+	}
+
+	unsigned NetworkConditioner::GetNumPending() const
+	{
+		return static_cast<unsigned>(pending.size());
+	}
+
+	void NetworkConditioner::Queue(std::string_view packet)
+	{
+		DelayedPacket& delayed = pending.emplace_back();
+		delayed.releaseTime = currentTime + latency + jitter * distribution(engine);
+		delayed.data = packet;
+	}
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Jwl
+{
+	// Simulates a poor connection by dropping, delaying, reordering, and duplicating packets before passing them on.
+	// Place it between a ReliableEndpoint and its socket to test how a game holds up over the internet.
+	class NetworkConditioner
+	{
+	public:
+		using SendFunc = std::function<void(std::string_view packet)>;
+
+		// The seed makes the simulated conditions repeatable.
+		NetworkConditioner(SendFunc send, unsigned seed = 0);
+
+		// The fraction of packets to drop, from 0 to 1.
+		void SetLoss(double fraction);
+		// The fraction of packets to send twice, from 0 to 1.
+		void SetDuplication(double fraction);
+		// How long to hold each packet. Jitter adds up to that much again at random, which can reorder packets.
+		void SetLatency(double ms, double jitterMS = 0.0);
+
+		// Drops the packet or holds on to it until its delay has passed.
+		void Send(std::string_view packet);
+		// Passes on the packets whose delay has passed.
+		void Update(double timeMS);
+
+		// The number of packets being held.
+		unsigned GetNumPending() const;
+
+	private:
+		struct DelayedPacket
+		{
+			double releaseTime;
+			std::string data;
+		};
+
+		void Queue(std::string_view packet);
+
+		SendFunc send;
+		std::mt19937 engine;
+		std::uniform_real_distribution<double> distribution;
+
+		double loss = 0.0;
+		double duplication = 0.0;
+		double latency = 0.0;
+		double jitter = 0.0;
+
+		double currentTime = 0.0;
+		std::vector<DelayedPacket> pending;
+	};
+}
@@ -0,0 +1,585 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "ReliableEndpoint.h"
+#include "Jewel3D/Application/Logging.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Sequence number, whether anything has been received, acknowledged sequence number, and acknowledgement bits.
+	constexpr unsigned PACKET_HEADER_SIZE = 9;
+	// Channel, ID, fragment index, fragment count, and size.
+	constexpr unsigned FRAGMENT_HEADER_SIZE = 9;
+
+	constexpr unsigned SENT_PACKET_BUFFER_SIZE = 1024;
+	constexpr unsigned RECEIVED_ID_BUFFER_SIZE = 1024;
+	// How many of a reliable channel's fragments can be waiting for acknowledgement at once.
+	// This keeps the IDs in use far enough apart that an old ID is never mistaken for a new one after wrapping around.
+	constexpr unsigned MAX_IN_FLIGHT = 256;
+	// How far ahead of the next expected fragment an ordered channel will buffer.
+	constexpr unsigned RECEIVE_WINDOW = 1024;
+	constexpr unsigned MAX_FRAGMENTS = 256;
+
+	constexpr double MIN_RESEND_DELAY_MS = 20.0;
+	constexpr double MIN_LOSS_TIMEOUT_MS = 100.0;
+	// Incomplete unreliable messages are abandoned after this long.
+	constexpr double ASSEMBLY_TIMEOUT_MS = 5000.0;
+
+	// Whether sequence number 'a' comes after 'b', allowing for wrapping around.
+	bool IsNewer(uint16_t a, uint16_t b)
+	{
+		return static_cast<int16_t>(a - b) > 0;
+	}
+
+	void Write8(std::string& out, uint8_t value)
+	{
+		out.push_back(static_cast<char>(value));
+	}
+
+	void Write16(std::string& out, uint16_t value)
+	{
+		out.push_back(static_cast<char>(value >> 8));
+		out.push_back(static_cast<char>(value));
+	}
+
+	void Write32(std::string& out, uint32_t value)
+	{
+		Write16(out, static_cast<uint16_t>(value >> 16));
+		Write16(out, static_cast<uint16_t>(value));
+	}
+
+	// Reads big-endian values from a packet. The caller must check that enough data remains.
+	class PacketReader
+	{
+	public:
+		PacketReader(std::string_view _data)
+			: data(_data)
+		{
+		}
+
+		uint8_t Read8()
+		{
+			return static_cast<uint8_t>(data[position++]);
+		}
+
+		uint16_t Read16()
+		{
+			const uint16_t high = Read8();
+			return static_cast<uint16_t>((high << 8) | Read8());
+		}
+
+		uint32_t Read32()
+		{
+			const uint32_t high = Read16();
+			return (high << 16) | Read16();
+		}
+
+		std::string_view ReadBytes(unsigned count)
+		{
+			std::string_view result = data.substr(position, count);
+			position += count;
+
+			return result;
+		}
+
+		unsigned GetRemaining() const
+		{
+			return static_cast<unsigned>(data.size()) - position;
+		}
+
+	private:
+		std::string_view data;
+		unsigned position = 0;
+	};
+}
+
+namespace Jwl
+{
+	ReliableEndpoint::ReliableEndpoint(std::vector<ChannelType> _channels, SendFunc _send, unsigned _maxPacketSize)
+		: channels(_channels.size())
+		, send(std::move(_send))
+		, maxPacketSize(_maxPacketSize)
+		, sentPackets(SENT_PACKET_BUFFER_SIZE)
+	{
+		ASSERT(!_channels.empty() && _channels.size() <= 256, "ReliableEndpoint must have between 1 and 256 channels.");
+		ASSERT(maxPacketSize > PACKET_HEADER_SIZE + FRAGMENT_HEADER_SIZE, "Maximum packet size is too small.");
+		ASSERT(send, "ReliableEndpoint needs a function to send packets with.");
+
+		for (unsigned i = 0; i < _channels.size(); ++i)
+		{
+			channels[i].type = _channels[i];
+
+			if (_channels[i] == ChannelType::Reliable)
+			{
+				channels[i].receivedIDs.assign(RECEIVED_ID_BUFFER_SIZE, -1);
+			}
+		}
+	}
+
+	void ReliableEndpoint::Send(unsigned channelIndex, std::string_view message)
+	{
+		ASSERT(channelIndex < channels.size(), "Channel index is out of range.");
+		ASSERT(message.size() <= GetMaxMessageSize(), "Message is too large. The limit is %u bytes.", GetMaxMessageSize());
+
+		Channel& channel = channels[channelIndex];
+		const unsigned fragmentSize = maxPacketSize - PACKET_HEADER_SIZE - FRAGMENT_HEADER_SIZE;
+		const unsigned count = std::max(1u, static_cast<unsigned>((message.size() + fragmentSize - 1) / fragmentSize));
+
+		for (unsigned i = 0; i < count; ++i)
+		{
+			Fragment& fragment = channel.outgoing.emplace_back();
+			fragment.id = channel.nextID++;
+			fragment.fragmentIndex = static_cast<uint16_t>(i);
+			fragment.fragmentCount = static_cast<uint16_t>(count);
+			fragment.data = message.substr(i * fragmentSize, fragmentSize);
+		}
+	}
+
+	bool ReliableEndpoint::Receive(unsigned channelIndex, std::string& out_message)
+	{
+		ASSERT(channelIndex < channels.size(), "Channel index is out of range.");
+
+		Channel& channel = channels[channelIndex];
+		if (channel.received.empty())
+		{
+			return false;
+		}
+
+		out_message = std::move(channel.received.front());
+		channel.received.pop_front();
+
+		return true;
+	}
+
+	void ReliableEndpoint::ProcessPacket(std::string_view packet, double timeMS)
+	{
+		if (packet.size() < PACKET_HEADER_SIZE)
+		{
+			return;
+		}
+
+		PacketReader reader(packet);
+		const uint16_t packetSequence = reader.Read16();
+		const bool hasAcks = reader.Read8() != 0;
+		const uint16_t ack = reader.Read16();
+		const uint32_t ackBits = reader.Read32();
+
+		// Remember the packet so that it can be acknowledged, and ignore it if it is a duplicate.
+		if (!hasReceived)
+		{
+			latestReceived = packetSequence;
+			receivedBits = 0;
+			hasReceived = true;
+		}
+		else if (IsNewer(packetSequence, latestReceived))
+		{
+			const unsigned shift = static_cast<uint16_t>(packetSequence - latestReceived);
+			if (shift > 32)
+			{
+				receivedBits = 0;
+			}
+			else
+			{
+				receivedBits = (shift < 32 ? receivedBits << shift : 0) | (1u << (shift - 1));
+			}
+
+			latestReceived = packetSequence;
+		}
+		else
+		{
+			const unsigned age = static_cast<uint16_t>(latestReceived - packetSequence);
+			if (age == 0)
+			{
+				return;
+			}
+
+			// Packets older than this can no longer be acknowledged, but their contents are still used.
+			if (age <= 32)
+			{
+				const uint32_t bit = 1u << (age - 1);
+				if (receivedBits & bit)
+				{
+					return;
+				}
+
+				receivedBits |= bit;
+			}
+		}
+
+		++numPacketsReceived;
+
+		// Until the other side receives something, its acknowledgement fields are meaningless.
+		if (hasAcks)
+		{
+			ProcessAck(ack, timeMS);
+			for (unsigned i = 0; i < 32; ++i)
+			{
+				if (ackBits & (1u << i))
+				{
+					ProcessAck(static_cast<uint16_t>(ack - 1 - i), timeMS);
+				}
+			}
+		}
+
+		// Packets which only carry acknowledgements are not acknowledged themselves, otherwise they would never stop.
+		if (reader.GetRemaining() > 0)
+		{
+			isAckPending = true;
+		}
+
+		while (reader.GetRemaining() > 0)
+		{
+			if (reader.GetRemaining() < FRAGMENT_HEADER_SIZE)
+			{
+				return;
+			}
+
+			const unsigned channelIndex = reader.Read8();
+
+			Fragment fragment;
+			fragment.id = reader.Read16();
+			fragment.fragmentIndex = reader.Read16();
+			fragment.fragmentCount = reader.Read16();
+			const unsigned size = reader.Read16();
+
+			if (channelIndex >= channels.size() ||
+				fragment.fragmentCount == 0 ||
+				fragment.fragmentCount > MAX_FRAGMENTS ||
+				fragment.fragmentIndex >= fragment.fragmentCount ||
+				size > reader.GetRemaining())
+			{
+				return;
+			}
+
+			fragment.data = reader.ReadBytes(size);
+
+			ProcessFragment(channels[channelIndex], std::move(fragment), timeMS);
+		}
+	}
+
+	void ReliableEndpoint::Update(double timeMS)
+	{
+		// Packets which have gone unacknowledged for long enough are counted as lost.
+		// A packet must also be counted before its record is reused.
+		const double lossTimeout = std::max(roundTripTime * 2.0, MIN_LOSS_TIMEOUT_MS);
+		while (oldestUnevaluated != sequence)
+		{
+			SentPacket& record = sentPackets[oldestUnevaluated % SENT_PACKET_BUFFER_SIZE];
+			if (record.isValid && record.sequence == oldestUnevaluated)
+			{
+				const bool isRecent = timeMS - record.timeSent < lossTimeout;
+				const bool isReused = static_cast<uint16_t>(sequence - oldestUnevaluated) >= SENT_PACKET_BUFFER_SIZE;
+				if (!record.isAcked && isRecent && !isReused)
+				{
+					break;
+				}
+
+				packetLoss += ((record.isAcked ? 0.0 : 1.0) - packetLoss) * 0.1;
+			}
+
+			++oldestUnevaluated;
+		}
+
+		for (auto& channel : channels)
+		{
+			if (channel.type != ChannelType::Unreliable)
+			{
+				continue;
+			}
+
+			for (auto itr = channel.assemblies.begin(); itr != channel.assemblies.end();)
+			{
+				if (timeMS - itr->second.firstArrival > ASSEMBLY_TIMEOUT_MS)
+				{
+					itr = channel.assemblies.erase(itr);
+				}
+				else
+				{
+					++itr;
+				}
+			}
+		}
+
+		// Fill as many packets as needed to send everything that is due.
+		const double resendDelay = std::max(roundTripTime * 1.5, MIN_RESEND_DELAY_MS);
+		std::string packet;
+		while (true)
+		{
+			packet.clear();
+			Write16(packet, sequence);
+			Write8(packet, hasReceived ? 1 : 0);
+			Write16(packet, latestReceived);
+			Write32(packet, receivedBits);
+
+			std::vector<std::pair<uint8_t, uint16_t>> reliableFragments;
+			bool isFull = false;
+
+			for (unsigned i = 0; i < channels.size() && !isFull; ++i)
+			{
+				Channel& channel = channels[i];
+
+				if (channel.type == ChannelType::Unreliable)
+				{
+					while (!channel.outgoing.empty() && !isFull)
+					{
+						isFull = !WriteFragment(packet, i, channel.outgoing.front());
+						if (!isFull)
+						{
+							channel.outgoing.pop_front();
+						}
+					}
+
+					continue;
+				}
+
+				const size_t numInFlight = std::min<size_t>(channel.outgoing.size(), MAX_IN_FLIGHT);
+				for (size_t j = 0; j < numInFlight && !isFull; ++j)
+				{
+					Fragment& fragment = channel.outgoing[j];
+					if (fragment.isAcked || (fragment.lastSent >= 0.0 && timeMS - fragment.lastSent < resendDelay))
+					{
+						continue;
+					}
+
+					isFull = !WriteFragment(packet, i, fragment);
+					if (!isFull)
+					{
+						fragment.lastSent = timeMS;
+						reliableFragments.emplace_back(static_cast<uint8_t>(i), fragment.id);
+					}
+				}
+			}
+
+			const bool hasFragments = packet.size() > PACKET_HEADER_SIZE;
+			if (!hasFragments && !isAckPending)
+			{
+				break;
+			}
+
+			// Only packets with content are tracked, since acknowledgements are not acknowledged.
+			SentPacket& record = sentPackets[sequence % SENT_PACKET_BUFFER_SIZE];
+			record.sequence = sequence;
+			record.isValid = hasFragments;
+			record.isAcked = false;
+			record.timeSent = timeMS;
+			record.fragments = std::move(reliableFragments);
+
+			send(packet);
+			++sequence;
+			++numPacketsSent;
+			isAckPending = false;
+
+			if (!isFull)
+			{
+				break;
+			}
+		}
+	}
+
+	double ReliableEndpoint::GetRoundTripTime() const
+	{
+		return roundTripTime;
+	}
+
+	double ReliableEndpoint::GetPacketLoss() const
+	{
+		return packetLoss;
+	}
+
+	unsigned ReliableEndpoint::GetNumPacketsSent() const
+	{
+		return numPacketsSent;
+	}
+
+	unsigned ReliableEndpoint::GetNumPacketsReceived() const
+	{
+		return numPacketsReceived;
+	}
+
+	unsigned ReliableEndpoint::GetNumPacketsAcked() const
+	{
+		return numPacketsAcked;
+	}
+
+	unsigned ReliableEndpoint::GetMaxMessageSize() const
+	{
+		return MAX_FRAGMENTS * (maxPacketSize - PACKET_HEADER_SIZE - FRAGMENT_HEADER_SIZE);
+	}
+
+	void ReliableEndpoint::ProcessAck(uint16_t ackSequence, double timeMS)
+	{
+		SentPacket& record = sentPackets[ackSequence % SENT_PACKET_BUFFER_SIZE];
+		if (!record.isValid || record.sequence != ackSequence || record.isAcked)
+		{
+			return;
+		}
+
+		record.isAcked = true;
+		++numPacketsAcked;
+
+		const double sample = timeMS - record.timeSent;
+		if (hasRoundTripTime)
+		{
+			roundTripTime += (sample - roundTripTime) * 0.1;
+		}
+		else
+		{
+			roundTripTime = sample;
+			hasRoundTripTime = true;
+		}
+
+		for (auto [channelIndex, id] : record.fragments)
+		{
+			auto& outgoing = channels[channelIndex].outgoing;
+			if (outgoing.empty())
+			{
+				continue;
+			}
+
+			// IDs are consecutive, so the fragment's position follows from its ID. Only the first MAX_IN_FLIGHT fragments are ever sent,
+			// and fragments that were already removed wrap around out of that range.
+			const uint16_t offset = static_cast<uint16_t>(id - outgoing.front().id);
+			if (offset < std::min<size_t>(outgoing.size(), MAX_IN_FLIGHT))
+			{
+				outgoing[offset].isAcked = true;
+			}
+
+			while (!outgoing.empty() && outgoing.front().isAcked)
+			{
+				outgoing.pop_front();
+			}
+		}
+	}
+
+	void ReliableEndpoint::ProcessFragment(Channel& channel, Fragment fragment, double timeMS)
+	{
+		const uint16_t firstID = static_cast<uint16_t>(fragment.id - fragment.fragmentIndex);
+
+		switch (channel.type)
+		{
+		case ChannelType::Unreliable:
+			Assemble(channel, firstID, fragment, timeMS);
+			break;
+
+		case ChannelType::Reliable:
+		{
+			int& slot = channel.receivedIDs[fragment.id % RECEIVED_ID_BUFFER_SIZE];
+			if (slot == fragment.id)
+			{
+				return;
+			}
+
+			slot = fragment.id;
+			Assemble(channel, firstID, fragment, timeMS);
+			break;
+		}
+
+		case ChannelType::ReliableOrdered:
+		{
+			// Fragments before the expected one have already been delivered.
+			const uint16_t offset = static_cast<uint16_t>(fragment.id - channel.nextExpectedID);
+			if (offset >= RECEIVE_WINDOW)
+			{
+				return;
+			}
+
+			const uint16_t id = fragment.id;
+			channel.buffered.try_emplace(id, std::move(fragment));
+			DeliverOrdered(channel);
+			break;
+		}
+		}
+	}
+
+	void ReliableEndpoint::DeliverOrdered(Channel& channel)
+	{
+		while (true)
+		{
+			auto first = channel.buffered.find(channel.nextExpectedID);
+			if (first == channel.buffered.end())
+			{
+				return;
+			}
+
+			const uint16_t count = first->second.fragmentCount;
+			for (uint16_t i = 1; i < count; ++i)
+			{
+				if (channel.buffered.count(static_cast<uint16_t>(channel.nextExpectedID + i)) == 0)
+				{
+					return;
+				}
+			}
+
+			std::string message;
+			for (uint16_t i = 0; i < count; ++i)
+			{
+				auto itr = channel.buffered.find(static_cast<uint16_t>(channel.nextExpectedID + i));
+				message += itr->second.data;
+				channel.buffered.erase(itr);
+			}
+
+			channel.received.push_back(std::move(message));
+			channel.nextExpectedID += count;
+		}
+	}
+
+	void ReliableEndpoint::Assemble(Channel& channel, uint16_t firstID, Fragment& fragment, double timeMS)
+	{
+		if (fragment.fragmentCount == 1)
+		{
+			channel.received.push_back(std::move(fragment.data));
+			return;
+		}
+
+		Assembly& assembly = channel.assemblies[firstID];
+		if (assembly.fragments.empty())
+		{
+			assembly.fragments.resize(fragment.fragmentCount);
+			assembly.firstArrival = timeMS;
+		}
+		else if (assembly.fragments.size() != fragment.fragmentCount)
+		{
+			return;
+		}
+
+		// Only single fragment messages can be empty, so an empty part has not been received yet.
+		std::string& part = assembly.fragments[fragment.fragmentIndex];
+		if (!part.empty())
+		{
+			return;
+		}
+
+		part = std::move(fragment.data);
+		if (++assembly.numReceived < assembly.fragments.size())
+		{
+			return;
+		}
+
+		std::string message;
+		for (auto& data : assembly.fragments)
+		{
+			message += data;
+		}
+
+		channel.received.push_back(std::move(message));
+		channel.assemblies.erase(firstID);
+	}
+
+	bool ReliableEndpoint::WriteFragment(std::string& packet, unsigned channel, const Fragment& fragment) const
+	{
+		if (packet.size() + FRAGMENT_HEADER_SIZE + fragment.data.size() > maxPacketSize)
+		{
+			return false;
+		}
+
+		Write8(packet, static_cast<uint8_t>(channel));
+		Write16(packet, fragment.id);
+		Write16(packet, fragment.fragmentIndex);
+		Write16(packet, fragment.fragmentCount);
+		Write16(packet, static_cast<uint16_t>(fragment.data.size()));
+		packet += fragment.data;
+
+		return true;
+	}
+}
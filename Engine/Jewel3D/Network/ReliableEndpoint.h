@@ -0,0 +1,138 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Jwl
+{
+	enum class ChannelType
+	{
+		// Messages are sent once. They might be lost or arrive out of order.
+		Unreliable,
+		// Messages are resent until they arrive, and are delivered as soon as they do.
+		Reliable,
+		// Messages are resent until they arrive, and are delivered in the order they were sent.
+		ReliableOrdered
+	};
+
+	// Exchanges messages with another endpoint over an unreliable transport, such as NetworkUDP or NetworkClient.
+	// Each packet is numbered and acknowledges the last 33 packets received from the other side. Reliable messages are
+	// resent until a packet containing them is acknowledged, so a lost packet only holds up the messages that were in it,
+	// and channels of other types are never held up at all. Messages larger than a packet are split up and reassembled.
+	// The endpoint does not own a socket. Outgoing packets are handed to a function and incoming ones to ProcessPacket().
+	class ReliableEndpoint
+	{
+	public:
+		using SendFunc = std::function<void(std::string_view packet)>;
+
+		// The default packet size fits in the receive buffers of NetworkUDP and NetworkClient.
+		ReliableEndpoint(std::vector<ChannelType> channels, SendFunc send, unsigned maxPacketSize = 512);
+
+		// Queues the message to be sent by the next Update().
+		void Send(unsigned channel, std::string_view message);
+		// Gets the next message received on the channel.
+		bool Receive(unsigned channel, std::string& out_message);
+
+		// Handles a packet that arrived from the other endpoint. Malformed data is ignored.
+		void ProcessPacket(std::string_view packet, double timeMS);
+		// Sends the queued messages, resends reliable messages that might have been lost, and acknowledges received packets.
+		void Update(double timeMS);
+
+		// The smoothed time for a packet to be acknowledged, in milliseconds.
+		double GetRoundTripTime() const;
+		// The smoothed fraction of packets that were never acknowledged, from 0 to 1.
+		double GetPacketLoss() const;
+
+		unsigned GetNumPacketsSent() const;
+		unsigned GetNumPacketsReceived() const;
+		unsigned GetNumPacketsAcked() const;
+
+		// The largest message that can be sent.
+		unsigned GetMaxMessageSize() const;
+
+	private:
+		// A message, or a part of one.
+		struct Fragment
+		{
+			uint16_t id = 0;
+			uint16_t fragmentIndex = 0;
+			uint16_t fragmentCount = 1;
+			std::string data;
+			double lastSent = -1.0;
+			bool isAcked = false;
+		};
+
+		// A message being put back together from its fragments.
+		struct Assembly
+		{
+			std::vector<std::string> fragments;
+			unsigned numReceived = 0;
+			double firstArrival = 0.0;
+		};
+
+		struct Channel
+		{
+			ChannelType type = ChannelType::Unreliable;
+
+			// Fragments are numbered consecutively, so those waiting to be sent or acknowledged always have consecutive IDs.
+			uint16_t nextID = 0;
+			std::deque<Fragment> outgoing;
+
+			// Ordered channels hold fragments until all of the ones before them have arrived.
+			uint16_t nextExpectedID = 0;
+			std::unordered_map<uint16_t, Fragment> buffered;
+			// Unordered channels reassemble messages as soon as all of their fragments arrive, keyed by the first fragment's ID.
+			std::unordered_map<uint16_t, Assembly> assemblies;
+			// The most recent fragment IDs received by reliable unordered channels, used to discard duplicates.
+			std::vector<int> receivedIDs;
+
+			std::deque<std::string> received;
+		};
+
+		struct SentPacket
+		{
+			uint16_t sequence = 0;
+			bool isValid = false;
+			bool isAcked = false;
+			double timeSent = 0.0;
+			// The channel and ID of each reliable fragment in the packet.
+			std::vector<std::pair<uint8_t, uint16_t>> fragments;
+		};
+
+		void ProcessAck(uint16_t sequence, double timeMS);
+		void ProcessFragment(Channel& channel, Fragment fragment, double timeMS);
+		void DeliverOrdered(Channel& channel);
+		void Assemble(Channel& channel, uint16_t firstID, Fragment& fragment, double timeMS);
+		// Writes the fragment into the packet, if it has room. Returns false if it does not.
+		bool WriteFragment(std::string& packet, unsigned channel, const Fragment& fragment) const;
+
+		std::vector<Channel> channels;
+		SendFunc send;
+		unsigned maxPacketSize;
+
+		// The sequence number of the next packet to be sent.
+		uint16_t sequence = 0;
+		std::vector<SentPacket> sentPackets;
+		// The oldest sent packet which has not yet been counted as either acknowledged or lost.
+		uint16_t oldestUnevaluated = 0;
+
+		// The newest packet received, and which of the 32 before it have also been received.
+		uint16_t latestReceived = 0;
+		uint32_t receivedBits = 0;
+		bool hasReceived = false;
+		bool isAckPending = false;
+
+		double roundTripTime = 0.0;
+		double packetLoss = 0.0;
+		bool hasRoundTripTime = false;
+
+		unsigned numPacketsSent = 0;
+		unsigned numPacketsReceived = 0;
+		unsigned numPacketsAcked = 0;
+	};
+}
@@ -0,0 +1,1058 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "Replication.h"
+#include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Application/ThreadPool.h"
+#include "Jewel3D/Math/Math.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+namespace
+{
+	// How many snapshots are kept to be used as baselines.
+	constexpr unsigned SNAPSHOT_HISTORY_SIZE = 64;
+	// The sequence numbers and terminators of a packet.
+	constexpr unsigned PACKET_HEADER_BITS = 16 + 1 + 16 + 2;
+	// Entities at the edge of a client's view still gain this fraction of their priority.
+	constexpr float MIN_CLOSENESS = 0.1f;
+	// Position changes this small, in quantized steps, are sent as offsets from the baseline instead of in full.
+	constexpr unsigned SMALL_DELTA_BITS = 8;
+	constexpr int SMALL_DELTA_LIMIT = 1 << (SMALL_DELTA_BITS - 1);
+
+	// Whether sequence number 'a' comes after 'b', allowing for wrapping around.
+	bool IsNewer(uint16_t a, uint16_t b)
+	{
+		return static_cast<int16_t>(a - b) > 0;
+	}
+
+	// The size of a value written with BitWriter::WriteVarUint().
+	unsigned GetVarUintBits(uint32_t value)
+	{
+		unsigned bits = 5;
+		while (value >>= 4)
+		{
+			bits += 5;
+		}
+
+		return bits;
+	}
+
+	int GetCell(float coordinate, float cellSize)
+	{
+		return static_cast<int>(std::floor(coordinate / cellSize));
+	}
+
+	// Packs the coordinates of a grid cell into a single key. Each coordinate keeps 21 bits.
+	uint64_t GetCellKey(int x, int y, int z)
+	{
+		constexpr uint64_t MASK = (1ull << 21) - 1;
+		return (static_cast<uint64_t>(x) & MASK) | ((static_cast<uint64_t>(y) & MASK) << 21) | ((static_cast<uint64_t>(z) & MASK) << 42);
+	}
+
+	// Interleaves negative and positive values so that small magnitudes become small unsigned values.
+	uint32_t ZigZagEncode(int value)
+	{
+		return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+	}
+
+	int ZigZagDecode(uint32_t value)
+	{
+		return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+	}
+}
+
+namespace Jwl
+{
+	Replicated::Replicated(Entity& _owner)
+		: Component(_owner)
+	{
+	}
+
+	unsigned Replicated::GetNetworkID() const
+	{
+		return networkID;
+	}
+
+	bool ReplicationBase::ComponentState::operator==(const ComponentState& other) const
+	{
+		return bitCount == other.bitCount && data == other.data;
+	}
+
+	bool ReplicationBase::ComponentState::operator!=(const ComponentState& other) const
+	{
+		return !(*this == other);
+	}
+
+	bool ReplicationBase::EntityState::operator==(const EntityState& other) const
+	{
+		return
+			id == other.id &&
+			std::equal(position, position + 3, other.position) &&
+			rotation == other.rotation &&
+			std::equal(scale, scale + 3, other.scale) &&
+			componentMask == other.componentMask &&
+			components == other.components;
+	}
+
+	bool ReplicationBase::EntityState::operator!=(const EntityState& other) const
+	{
+		return !(*this == other);
+	}
+
+	ReplicationBase::ReplicationBase(const ReplicationSettings& _settings)
+		: settings(_settings)
+		, positionBits(GetQuantizedBits(-_settings.worldSize, _settings.worldSize, _settings.positionPrecision))
+		, scaleBits(GetQuantizedBits(-_settings.maxScale, _settings.maxScale, _settings.scalePrecision))
+		, unitScale(Quantize(1.0f, -_settings.maxScale, _settings.maxScale, _settings.scalePrecision))
+	{
+		ASSERT(settings.rotationBits > 0 && settings.rotationBits <= 10, "Rotations can be replicated with 1 to 10 bits per component.");
+	}
+
+	ReplicationBase::EntityState ReplicationBase::CaptureEntity(const Entity& entity, unsigned id) const
+	{
+		EntityState state;
+		state.id = id;
+		state.rotation = QuantizeQuat(entity.rotation, settings.rotationBits);
+
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			state.position[i] = Quantize(entity.position[i], -settings.worldSize, settings.worldSize, settings.positionPrecision);
+			state.scale[i] = Quantize(entity.scale[i], -settings.maxScale, settings.maxScale, settings.scalePrecision);
+		}
+
+		state.components.resize(serializers.size());
+		BitWriter writer;
+		for (unsigned i = 0; i < serializers.size(); ++i)
+		{
+			writer.Clear();
+			if (serializers[i].write(entity, writer))
+			{
+				state.componentMask |= 1u << i;
+				state.components[i].data = writer.GetData();
+				state.components[i].bitCount = writer.GetBitCount();
+			}
+		}
+
+		return state;
+	}
+
+	void ReplicationBase::ApplyEntity(Entity& entity, const EntityState& state, const EntityState* previous) const
+	{
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			entity.position[i] = Dequantize(state.position[i], -settings.worldSize, settings.worldSize, settings.positionPrecision);
+			entity.scale[i] = Dequantize(state.scale[i], -settings.maxScale, settings.maxScale, settings.scalePrecision);
+		}
+
+		entity.rotation = DequantizeQuat(state.rotation, settings.rotationBits);
+
+		for (unsigned i = 0; i < serializers.size(); ++i)
+		{
+			const uint32_t bit = 1u << i;
+			const bool hadComponent = previous && (previous->componentMask & bit);
+
+			if ((state.componentMask & bit) == 0)
+			{
+				if (hadComponent)
+				{
+					serializers[i].remove(entity);
+				}
+
+				continue;
+			}
+
+			if (hadComponent && previous->components[i] == state.components[i])
+			{
+				continue;
+			}
+
+			BitReader reader(state.components[i].data);
+			if (!serializers[i].read(entity, reader))
+			{
+				Warning("Replicated component (%u) on entity (%u) could not be read.", i, state.id);
+			}
+		}
+	}
+
+	void ReplicationBase::WriteEntity(BitWriter& writer, const EntityState& state, const EntityState* baseline) const
+	{
+		if (baseline == nullptr)
+		{
+			for (uint32_t value : state.position)
+			{
+				writer.Write(value, positionBits);
+			}
+
+			writer.Write(state.rotation, 2 + settings.rotationBits * 3);
+
+			const bool isUnitScale = std::all_of(state.scale, state.scale + 3, [this](uint32_t value) { return value == unitScale; });
+			writer.WriteBool(isUnitScale);
+			if (!isUnitScale)
+			{
+				for (uint32_t value : state.scale)
+				{
+					writer.Write(value, scaleBits);
+				}
+			}
+
+			writer.Write(state.componentMask, static_cast<unsigned>(serializers.size()));
+		}
+		else
+		{
+			const bool isPositionChanged = !std::equal(state.position, state.position + 3, baseline->position);
+			writer.WriteBool(isPositionChanged);
+			if (isPositionChanged)
+			{
+				int delta[3];
+				bool isSmall = true;
+				for (unsigned i = 0; i < 3; ++i)
+				{
+					const int64_t difference = static_cast<int64_t>(state.position[i]) - baseline->position[i];
+					isSmall = isSmall && difference >= -SMALL_DELTA_LIMIT && difference < SMALL_DELTA_LIMIT;
+					delta[i] = static_cast<int>(difference);
+				}
+
+				writer.WriteBool(isSmall);
+				for (unsigned i = 0; i < 3; ++i)
+				{
+					if (isSmall)
+					{
+						writer.Write(ZigZagEncode(delta[i]), SMALL_DELTA_BITS);
+					}
+					else
+					{
+						writer.Write(state.position[i], positionBits);
+					}
+				}
+			}
+
+			const bool isRotationChanged = state.rotation != baseline->rotation;
+			writer.WriteBool(isRotationChanged);
+			if (isRotationChanged)
+			{
+				writer.Write(state.rotation, 2 + settings.rotationBits * 3);
+			}
+
+			const bool isScaleChanged = !std::equal(state.scale, state.scale + 3, baseline->scale);
+			writer.WriteBool(isScaleChanged);
+			if (isScaleChanged)
+			{
+				for (uint32_t value : state.scale)
+				{
+					writer.Write(value, scaleBits);
+				}
+			}
+
+			const bool isMaskChanged = state.componentMask != baseline->componentMask;
+			writer.WriteBool(isMaskChanged);
+			if (isMaskChanged)
+			{
+				writer.Write(state.componentMask, static_cast<unsigned>(serializers.size()));
+			}
+		}
+
+		// Component data is prefixed with its size so that it can be decoded without knowing the component's type.
+		for (unsigned i = 0; i < serializers.size(); ++i)
+		{
+			const uint32_t bit = 1u << i;
+			if ((state.componentMask & bit) == 0)
+			{
+				continue;
+			}
+
+			const ComponentState& component = state.components[i];
+			if (baseline && (baseline->componentMask & bit))
+			{
+				const bool isChanged = component != baseline->components[i];
+				writer.WriteBool(isChanged);
+				if (!isChanged)
+				{
+					continue;
+				}
+			}
+
+			writer.WriteVarUint(component.bitCount);
+			writer.WriteBits(component.data, component.bitCount);
+		}
+	}
+
+	bool ReplicationBase::ReadEntity(BitReader& reader, EntityState& out_state, const EntityState* baseline) const
+	{
+		const unsigned rotationSize = 2 + settings.rotationBits * 3;
+		const unsigned maskSize = static_cast<unsigned>(serializers.size());
+
+		EntityState state;
+		if (baseline == nullptr)
+		{
+			for (uint32_t& value : state.position)
+			{
+				if (!reader.Read(positionBits, value))
+				{
+					return false;
+				}
+			}
+
+			bool isUnitScale;
+			if (!reader.Read(rotationSize, state.rotation) ||
+				!reader.ReadBool(isUnitScale))
+			{
+				return false;
+			}
+
+			for (uint32_t& value : state.scale)
+			{
+				if (isUnitScale)
+				{
+					value = unitScale;
+				}
+				else if (!reader.Read(scaleBits, value))
+				{
+					return false;
+				}
+			}
+
+			if (!reader.Read(maskSize, state.componentMask))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			state = *baseline;
+
+			bool isPositionChanged;
+			if (!reader.ReadBool(isPositionChanged))
+			{
+				return false;
+			}
+
+			if (isPositionChanged)
+			{
+				bool isSmall;
+				if (!reader.ReadBool(isSmall))
+				{
+					return false;
+				}
+
+				for (uint32_t& value : state.position)
+				{
+					uint32_t encoded;
+					if (!reader.Read(isSmall ? SMALL_DELTA_BITS : positionBits, encoded))
+					{
+						return false;
+					}
+
+					value = isSmall ? value + ZigZagDecode(encoded) : encoded;
+				}
+			}
+
+			bool isRotationChanged;
+			if (!reader.ReadBool(isRotationChanged) ||
+				(isRotationChanged && !reader.Read(rotationSize, state.rotation)))
+			{
+				return false;
+			}
+
+			bool isScaleChanged;
+			if (!reader.ReadBool(isScaleChanged))
+			{
+				return false;
+			}
+
+			if (isScaleChanged)
+			{
+				for (uint32_t& value : state.scale)
+				{
+					if (!reader.Read(scaleBits, value))
+					{
+						return false;
+					}
+				}
+			}
+
+			bool isMaskChanged;
+			if (!reader.ReadBool(isMaskChanged) ||
+				(isMaskChanged && !reader.Read(maskSize, state.componentMask)))
+			{
+				return false;
+			}
+		}
+
+		state.components.resize(serializers.size());
+		for (unsigned i = 0; i < serializers.size(); ++i)
+		{
+			const uint32_t bit = 1u << i;
+			if ((state.componentMask & bit) == 0)
+			{
+				state.components[i] = ComponentState();
+				continue;
+			}
+
+			if (baseline && (baseline->componentMask & bit))
+			{
+				bool isChanged;
+				if (!reader.ReadBool(isChanged))
+				{
+					return false;
+				}
+
+				if (!isChanged)
+				{
+					continue;
+				}
+			}
+
+			ComponentState& component = state.components[i];
+			if (!reader.ReadVarUint(component.bitCount) ||
+				!reader.ReadBits(component.bitCount, component.data))
+			{
+				return false;
+			}
+		}
+
+		out_state = std::move(state);
+		return true;
+	}
+
+	const ReplicationBase::EntityState* ReplicationBase::FindEntity(const Snapshot& snapshot, unsigned id)
+	{
+		auto itr = std::lower_bound(snapshot.entities.begin(), snapshot.entities.end(), id, [](const EntityState& state, unsigned value) {
+			return state.id < value;
+		});
+
+		if (itr == snapshot.entities.end() || itr->id != id)
+		{
+			return nullptr;
+		}
+
+		return &*itr;
+	}
+
+	ReplicationServer::ReplicationServer(const ReplicationSettings& _settings)
+		: ReplicationBase(_settings)
+	{
+		ASSERT(settings.cellSize > 0.0f, "Grid cells must have a positive size.");
+	}
+
+	void ReplicationServer::AddClient(int clientID)
+	{
+		ClientState& client = clients[clientID];
+		client = ClientState();
+		client.history.resize(SNAPSHOT_HISTORY_SIZE);
+	}
+
+	void ReplicationServer::RemoveClient(int clientID)
+	{
+		clients.erase(clientID);
+	}
+
+	void ReplicationServer::SetClientView(int clientID, const vec3& position, float radius)
+	{
+		auto client = clients.find(clientID);
+		ASSERT(client != clients.end(), "Client (%d) has not been added.", clientID);
+		ASSERT(radius >= 0.0f, "View radius cannot be negative.");
+
+		client->second.viewPosition = position;
+		client->second.viewRadius = radius;
+		client->second.hasView = true;
+	}
+
+	void ReplicationServer::Capture()
+	{
+		auto snapshot = std::make_shared<Snapshot>();
+		snapshot->sequence = current ? static_cast<uint16_t>(current->sequence + 1) : 0;
+
+		std::vector<std::pair<Replicated*, EntityState>> captured;
+		for (Replicated& replicated : All<Replicated>())
+		{
+			if (replicated.networkID == 0)
+			{
+				replicated.networkID = nextNetworkID++;
+			}
+
+			captured.emplace_back(&replicated, CaptureEntity(replicated.owner, replicated.networkID));
+		}
+
+		std::sort(captured.begin(), captured.end(), [](const auto& a, const auto& b) {
+			return a.second.id < b.second.id;
+		});
+
+		positions.clear();
+		priorities.clear();
+		grid.clear();
+		snapshot->entities.reserve(captured.size());
+
+		for (auto& [replicated, state] : captured)
+		{
+			const vec3& position = replicated->owner.position;
+			const unsigned index = static_cast<unsigned>(snapshot->entities.size());
+
+			grid[GetCellKey(GetCell(position.x, settings.cellSize), GetCell(position.y, settings.cellSize), GetCell(position.z, settings.cellSize))].push_back(index);
+			positions.push_back(position);
+			priorities.push_back(replicated->priority);
+			snapshot->entities.push_back(std::move(state));
+		}
+
+		current = std::move(snapshot);
+	}
+
+	void ReplicationServer::WritePacket(int clientID, BitWriter& out_packet)
+	{
+		ASSERT(current, "Capture() must be called before writing packets.");
+
+		auto itr = clients.find(clientID);
+		ASSERT(itr != clients.end(), "Client (%d) has not been added.", clientID);
+		ClientState& client = itr->second;
+
+		// The baseline must still be in the history, otherwise the client has fallen too far behind and gets a full update.
+		const View* baseline = nullptr;
+		if (client.hasAck && static_cast<uint16_t>(current->sequence - client.ackedSequence) < SNAPSHOT_HISTORY_SIZE)
+		{
+			const View& candidate = client.history[client.ackedSequence % SNAPSHOT_HISTORY_SIZE];
+			if (candidate.isValid && candidate.sequence == client.ackedSequence)
+			{
+				baseline = &candidate;
+			}
+		}
+
+		// Pair each relevant entity with its baseline state. Both are sorted by ID, so they are walked together.
+		// Entities in the baseline which are no longer relevant are removed.
+		GatherRelevant(client, client.relevant);
+		client.candidates.clear();
+		client.removals.clear();
+
+		const size_t baselineCount = baseline ? baseline->entities.size() : 0;
+		size_t baselineIndex = 0;
+		for (unsigned index : client.relevant)
+		{
+			const EntityState& state = current->entities[index];
+			while (baselineIndex < baselineCount && baseline->entities[baselineIndex]->id < state.id)
+			{
+				client.removals.push_back(baseline->entities[baselineIndex++]->id);
+			}
+
+			Candidate& candidate = client.candidates.emplace_back();
+			candidate.index = index;
+
+			if (baselineIndex < baselineCount && baseline->entities[baselineIndex]->id == state.id)
+			{
+				candidate.baseline = &baseline->entities[baselineIndex++];
+			}
+
+			candidate.isSent = candidate.baseline == nullptr || **candidate.baseline != state;
+		}
+
+		while (baselineIndex < baselineCount)
+		{
+			client.removals.push_back(baseline->entities[baselineIndex++]->id);
+		}
+
+		if (settings.maxPacketSize > 0)
+		{
+			SelectCandidates(client, baseline);
+		}
+
+		out_packet.Write(current->sequence, 16);
+		out_packet.WriteBool(baseline != nullptr);
+		if (baseline)
+		{
+			out_packet.Write(baseline->sequence, 16);
+		}
+
+		// Entities which are new or have changed. IDs are written as the gap from the previous one.
+		unsigned previousID = 0;
+		for (const Candidate& candidate : client.candidates)
+		{
+			if (!candidate.isSent)
+			{
+				continue;
+			}
+
+			const EntityState& state = current->entities[candidate.index];
+			out_packet.WriteBool(true);
+			out_packet.WriteVarUint(state.id - previousID - 1);
+			previousID = state.id;
+
+			if (settings.maxPacketSize > 0)
+			{
+				out_packet.WriteBits(client.scratch.GetData().substr(candidate.byteOffset), candidate.bitCount);
+			}
+			else
+			{
+				WriteEntity(out_packet, state, candidate.baseline ? candidate.baseline->get() : nullptr);
+			}
+		}
+		out_packet.WriteBool(false);
+
+		previousID = 0;
+		for (unsigned id : client.removals)
+		{
+			out_packet.WriteBool(true);
+			out_packet.WriteVarUint(id - previousID - 1);
+			previousID = id;
+		}
+		out_packet.WriteBool(false);
+
+		// Remember what the client will have if this packet arrives, so that it can be used as a baseline.
+		// States are shared with the capture they came from, which is kept alive for as long as they are referenced.
+		View& view = client.history[current->sequence % SNAPSHOT_HISTORY_SIZE];
+		view.sequence = current->sequence;
+		view.isValid = true;
+		view.entities.clear();
+		for (const Candidate& candidate : client.candidates)
+		{
+			if (candidate.isSent)
+			{
+				view.entities.emplace_back(current, &current->entities[candidate.index]);
+			}
+			else if (candidate.baseline)
+			{
+				view.entities.push_back(*candidate.baseline);
+			}
+		}
+	}
+
+	void ReplicationServer::WritePackets(ThreadPool* pool)
+	{
+		// Each client's packet only touches that client's state, so they can all be written at once.
+		for (auto& [clientID, client] : clients)
+		{
+			auto job = [this, id = clientID, &client = client] {
+				client.packet.Clear();
+				WritePacket(id, client.packet);
+			};
+
+			if (pool)
+			{
+				pool->Submit(job);
+			}
+			else
+			{
+				job();
+			}
+		}
+
+		if (pool)
+		{
+			pool->Wait();
+		}
+	}
+
+	std::string_view ReplicationServer::GetPacket(int clientID) const
+	{
+		auto client = clients.find(clientID);
+		ASSERT(client != clients.end(), "Client (%d) has not been added.", clientID);
+
+		return client->second.packet.GetData();
+	}
+
+	bool ReplicationServer::ProcessAck(int clientID, std::string_view packet)
+	{
+		auto client = clients.find(clientID);
+		if (client == clients.end())
+		{
+			return false;
+		}
+
+		BitReader reader(packet);
+		uint32_t ackedSequence;
+		if (!reader.Read(16, ackedSequence))
+		{
+			return false;
+		}
+
+		// Acknowledgements can arrive out of order. Only the newest is useful.
+		ClientState& state = client->second;
+		if (!state.hasAck || IsNewer(static_cast<uint16_t>(ackedSequence), state.ackedSequence))
+		{
+			state.ackedSequence = static_cast<uint16_t>(ackedSequence);
+			state.hasAck = true;
+		}
+
+		return true;
+	}
+
+	uint16_t ReplicationServer::GetSequence() const
+	{
+		return current ? current->sequence : 0;
+	}
+
+	void ReplicationServer::GatherRelevant(const ClientState& client, std::vector<unsigned>& out_indices) const
+	{
+		out_indices.clear();
+
+		const unsigned count = static_cast<unsigned>(current->entities.size());
+		if (!client.hasView)
+		{
+			out_indices.resize(count);
+			std::iota(out_indices.begin(), out_indices.end(), 0u);
+			return;
+		}
+
+		const vec3& center = client.viewPosition;
+		const float radius = client.viewRadius;
+		const float radiusSquared = radius * radius;
+
+		const int minX = GetCell(center.x - radius, settings.cellSize);
+		const int minY = GetCell(center.y - radius, settings.cellSize);
+		const int minZ = GetCell(center.z - radius, settings.cellSize);
+		const int maxX = GetCell(center.x + radius, settings.cellSize);
+		const int maxY = GetCell(center.y + radius, settings.cellSize);
+		const int maxZ = GetCell(center.z + radius, settings.cellSize);
+
+		// A view covering more cells than are occupied is faster to check entity by entity.
+		const double numCells = (maxX - minX + 1.0) * (maxY - minY + 1.0) * (maxZ - minZ + 1.0);
+		if (numCells >= grid.size())
+		{
+			for (unsigned i = 0; i < count; ++i)
+			{
+				if (LengthSquared(positions[i] - center) <= radiusSquared)
+				{
+					out_indices.push_back(i);
+				}
+			}
+
+			return;
+		}
+
+		for (int x = minX; x <= maxX; ++x)
+		{
+			for (int y = minY; y <= maxY; ++y)
+			{
+				for (int z = minZ; z <= maxZ; ++z)
+				{
+					auto cell = grid.find(GetCellKey(x, y, z));
+					if (cell == grid.end())
+					{
+						continue;
+					}
+
+					for (unsigned index : cell->second)
+					{
+						if (LengthSquared(positions[index] - center) <= radiusSquared)
+						{
+							out_indices.push_back(index);
+						}
+					}
+				}
+			}
+		}
+
+		std::sort(out_indices.begin(), out_indices.end());
+	}
+
+	void ReplicationServer::SelectCandidates(ClientState& client, const View* baseline) const
+	{
+		// Entities waiting for an update gain priority every tick until they are sent.
+		// Closer entities gain it faster, but even those at the edge of the view are not starved.
+		// Entities sent since the baseline go first, otherwise the client would fall back to the baseline's older state.
+		struct Entry
+		{
+			bool isUrgent;
+			float priority;
+			Candidate* candidate;
+		};
+
+		std::unordered_map<unsigned, float> waiting;
+		std::vector<Entry> order;
+		for (Candidate& candidate : client.candidates)
+		{
+			if (!candidate.isSent)
+			{
+				continue;
+			}
+
+			float closeness = 1.0f;
+			if (client.hasView && client.viewRadius > 0.0f)
+			{
+				closeness = Max(1.0f - Distance(positions[candidate.index], client.viewPosition) / client.viewRadius, MIN_CLOSENESS);
+			}
+
+			const unsigned id = current->entities[candidate.index].id;
+			auto previous = client.priorities.find(id);
+			const float priority = (previous != client.priorities.end() ? previous->second : 0.0f) + priorities[candidate.index] * closeness;
+
+			auto lastSent = client.lastSent.find(id);
+			const bool isUrgent = baseline && lastSent != client.lastSent.end() && IsNewer(lastSent->second, baseline->sequence);
+
+			order.push_back({ isUrgent, priority, &candidate });
+			waiting[id] = priority;
+		}
+
+		std::stable_sort(order.begin(), order.end(), [](const Entry& a, const Entry& b) {
+			if (a.isUrgent != b.isUrgent)
+			{
+				return a.isUrgent;
+			}
+
+			return a.priority > b.priority;
+		});
+
+		// Encode the entities in order of priority to measure them, and take those that fit.
+		// The header and removals are counted first. An ID's gap from the previous one is never larger than the ID itself.
+		unsigned usedBits = PACKET_HEADER_BITS;
+		for (unsigned id : client.removals)
+		{
+			usedBits += 1 + GetVarUintBits(id);
+		}
+
+		const unsigned budgetBits = settings.maxPacketSize * 8;
+
+		client.scratch.Clear();
+		for (Entry& entry : order)
+		{
+			Candidate& candidate = *entry.candidate;
+			const EntityState& state = current->entities[candidate.index];
+			const unsigned start = client.scratch.GetByteCount();
+			WriteEntity(client.scratch, state, candidate.baseline ? candidate.baseline->get() : nullptr);
+
+			// Each entity starts on a whole byte so that it can be copied into the packet.
+			const unsigned bitCount = client.scratch.GetBitCount() - start * 8;
+			client.scratch.AlignToByte();
+
+			const unsigned totalBits = 1 + GetVarUintBits(state.id) + bitCount;
+			if (usedBits + totalBits > budgetBits)
+			{
+				candidate.isSent = false;
+				continue;
+			}
+
+			usedBits += totalBits;
+			candidate.byteOffset = start;
+			candidate.bitCount = bitCount;
+			waiting.erase(state.id);
+		}
+
+		// Only the entities sent since the baseline need to be remembered.
+		std::unordered_map<unsigned, uint16_t> sent;
+		for (const Candidate& candidate : client.candidates)
+		{
+			const unsigned id = current->entities[candidate.index].id;
+			if (candidate.isSent)
+			{
+				sent[id] = current->sequence;
+			}
+			else if (auto lastSent = client.lastSent.find(id); lastSent != client.lastSent.end() && baseline && IsNewer(lastSent->second, baseline->sequence))
+			{
+				sent[id] = lastSent->second;
+			}
+		}
+
+		client.priorities = std::move(waiting);
+		client.lastSent = std::move(sent);
+	}
+
+	ReplicationClient::ReplicationClient(const ReplicationSettings& _settings)
+		: ReplicationBase(_settings)
+		, history(SNAPSHOT_HISTORY_SIZE)
+	{
+	}
+
+	bool ReplicationClient::ProcessPacket(std::string_view packet)
+	{
+		BitReader reader(packet);
+
+		uint32_t packetSequence;
+		bool hasBaseline;
+		if (!reader.Read(16, packetSequence) ||
+			!reader.ReadBool(hasBaseline))
+		{
+			return false;
+		}
+
+		if (hasReceived && !IsNewer(static_cast<uint16_t>(packetSequence), sequence))
+		{
+			return true;
+		}
+
+		const Snapshot* baseline = nullptr;
+		if (hasBaseline)
+		{
+			uint32_t baselineSequence;
+			if (!reader.Read(16, baselineSequence))
+			{
+				return false;
+			}
+
+			const auto& candidate = history[baselineSequence % SNAPSHOT_HISTORY_SIZE];
+			if (!candidate || candidate->sequence != baselineSequence)
+			{
+				return false;
+			}
+
+			baseline = candidate.get();
+		}
+
+		// Decode the whole packet before touching any entities, so that a malformed one changes nothing.
+		std::vector<EntityState> updates;
+		unsigned previousID = 0;
+		while (true)
+		{
+			bool hasMore;
+			if (!reader.ReadBool(hasMore))
+			{
+				return false;
+			}
+
+			if (!hasMore)
+			{
+				break;
+			}
+
+			uint32_t gap;
+			if (!reader.ReadVarUint(gap))
+			{
+				return false;
+			}
+
+			const unsigned id = previousID + gap + 1;
+
+			EntityState& state = updates.emplace_back();
+			if (!ReadEntity(reader, state, baseline ? FindEntity(*baseline, id) : nullptr))
+			{
+				return false;
+			}
+
+			state.id = id;
+			previousID = id;
+		}
+
+		std::vector<unsigned> removals;
+		previousID = 0;
+		while (true)
+		{
+			bool hasMore;
+			if (!reader.ReadBool(hasMore))
+			{
+				return false;
+			}
+
+			if (!hasMore)
+			{
+				break;
+			}
+
+			uint32_t gap;
+			if (!reader.ReadVarUint(gap))
+			{
+				return false;
+			}
+
+			removals.push_back(previousID + gap + 1);
+			previousID = removals.back();
+		}
+
+		// The new snapshot is the baseline with the updates merged in and the removed entities left out.
+		// Both lists are sorted by ID.
+		auto snapshot = std::make_shared<Snapshot>();
+		snapshot->sequence = static_cast<uint16_t>(packetSequence);
+		if (baseline)
+		{
+			auto update = updates.begin();
+			auto removal = removals.begin();
+			for (const EntityState& state : baseline->entities)
+			{
+				while (update != updates.end() && update->id < state.id)
+				{
+					snapshot->entities.push_back(std::move(*update++));
+				}
+
+				while (removal != removals.end() && *removal < state.id)
+				{
+					++removal;
+				}
+
+				if (update != updates.end() && update->id == state.id)
+				{
+					snapshot->entities.push_back(std::move(*update++));
+				}
+				else if (removal == removals.end() || *removal != state.id)
+				{
+					snapshot->entities.push_back(state);
+				}
+			}
+
+			std::move(update, updates.end(), std::back_inserter(snapshot->entities));
+		}
+		else
+		{
+			snapshot->entities = std::move(updates);
+		}
+
+		// Copies which are no longer part of the snapshot are released, and the rest are brought up to date with it.
+		for (auto itr = replicas.begin(); itr != replicas.end();)
+		{
+			if (FindEntity(*snapshot, itr->first))
+			{
+				++itr;
+			}
+			else
+			{
+				itr = replicas.erase(itr);
+			}
+		}
+
+		for (const EntityState& state : snapshot->entities)
+		{
+			UpdateReplica(state);
+		}
+
+		sequence = snapshot->sequence;
+		hasReceived = true;
+		history[sequence % SNAPSHOT_HISTORY_SIZE] = std::move(snapshot);
+
+		return true;
+	}
+
+	void ReplicationClient::WriteAck(BitWriter& out_packet) const
+	{
+		if (hasReceived)
+		{
+			out_packet.Write(sequence, 16);
+		}
+	}
+
+	Entity::Ptr ReplicationClient::GetEntity(unsigned networkID) const
+	{
+		auto itr = replicas.find(networkID);
+		if (itr == replicas.end())
+		{
+			return nullptr;
+		}
+
+		return itr->second.entity;
+	}
+
+	unsigned ReplicationClient::GetNumEntities() const
+	{
+		return static_cast<unsigned>(replicas.size());
+	}
+
+	uint16_t ReplicationClient::GetSequence() const
+	{
+		return sequence;
+	}
+
+	void ReplicationClient::UpdateReplica(const EntityState& state)
+	{
+		Replica& replica = replicas[state.id];
+		if (replica.entity)
+		{
+			if (replica.state == state)
+			{
+				return;
+			}
+
+			ApplyEntity(*replica.entity, state, &replica.state);
+		}
+		else
+		{
+			replica.entity = Entity::MakeNew();
+			ApplyEntity(*replica.entity, state, nullptr);
+		}
+
+		replica.state = state;
+	}
+}
@@ -0,0 +1,261 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include "Jewel3D/Entity/Entity.h"
+#include "Jewel3D/Network/BitStream.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Jwl
+{
+	class ThreadPool;
+
+	// Marks an entity to be replicated from a ReplicationServer to its clients.
+	class Replicated : public Component<Replicated>
+	{
+		friend class ReplicationServer;
+	public:
+		Replicated(Entity& owner);
+
+		// The ID shared by the entity and its copies on clients. Zero until the server first captures it.
+		unsigned GetNetworkID() const;
+
+		// How quickly the entity's updates gain priority while they wait to be sent.
+		// When a client's packets are full, entities with a higher priority are updated more often.
+		float priority = 1.0f;
+
+	private:
+		unsigned networkID = 0;
+	};
+
+	// Controls how finely entity transforms are quantized. Servers and clients must use the same settings.
+	struct ReplicationSettings
+	{
+		// Positions are clamped to [-worldSize, worldSize] on each axis.
+		float worldSize = 4096.0f;
+		float positionPrecision = 0.001f;
+		// Scales are clamped to [-maxScale, maxScale] on each axis.
+		float maxScale = 64.0f;
+		float scalePrecision = 0.001f;
+		// Up to 10.
+		unsigned rotationBits = 10;
+
+		// The size of the grid cells used to find the entities near each client. Only used by the server.
+		float cellSize = 64.0f;
+		// The most bytes to send to a client per packet, or 0 for no limit. Only used by the server.
+		// Updates that do not fit wait for a later packet, ordered by how long they have waited, their priority, and their closeness to the client.
+		// The default matches PACKET_LENGTH, the size of the buffers that clients receive UDP packets into.
+		// Without a limit, packets must be split up before they are sent, such as by a ReliableEndpoint.
+		unsigned maxPacketSize = 512;
+	};
+
+	// The component types and quantization shared by ReplicationServer and ReplicationClient.
+	class ReplicationBase
+	{
+	public:
+		// Replicates the component along with the Transform of each entity.
+		// T must implement 'void Write(BitWriter&) const' and 'bool Read(BitReader&)'.
+		// Components must be registered in the same order on the server and clients. Up to 32 types are supported.
+		template<class T>
+		void Register();
+
+	protected:
+		ReplicationBase(const ReplicationSettings& settings);
+
+		// A component's serialized data.
+		struct ComponentState
+		{
+			bool operator==(const ComponentState&) const;
+			bool operator!=(const ComponentState&) const;
+
+			std::string data;
+			unsigned bitCount = 0;
+		};
+
+		// The quantized state of an entity.
+		struct EntityState
+		{
+			bool operator==(const EntityState&) const;
+			bool operator!=(const EntityState&) const;
+
+			unsigned id = 0;
+			uint32_t position[3] = { 0, 0, 0 };
+			uint32_t rotation = 0;
+			uint32_t scale[3] = { 0, 0, 0 };
+			// Which of the registered components the entity has.
+			uint32_t componentMask = 0;
+			std::vector<ComponentState> components;
+		};
+
+		// The state of all replicated entities at one point in time, sorted by ID.
+		struct Snapshot
+		{
+			uint16_t sequence = 0;
+			std::vector<EntityState> entities;
+		};
+
+		struct Serializer
+		{
+			// Returns false if the entity does not have the component.
+			bool (*write)(const Entity&, BitWriter&);
+			bool (*read)(Entity&, BitReader&);
+			void (*remove)(Entity&);
+		};
+
+		EntityState CaptureEntity(const Entity& entity, unsigned id) const;
+		// Updates the entity to match the state. Components that have not changed since the previous state are left alone.
+		void ApplyEntity(Entity& entity, const EntityState& state, const EntityState* previous) const;
+
+		// Writes the entity's state, with only the parts that differ from the baseline if there is one.
+		void WriteEntity(BitWriter& writer, const EntityState& state, const EntityState* baseline) const;
+		bool ReadEntity(BitReader& reader, EntityState& out_state, const EntityState* baseline) const;
+
+		// Finds the entity in a snapshot, or returns null.
+		static const EntityState* FindEntity(const Snapshot& snapshot, unsigned id);
+
+		const ReplicationSettings settings;
+		const unsigned positionBits;
+		const unsigned scaleBits;
+		// The quantized value of a scale of 1.
+		const uint32_t unitScale;
+
+		std::vector<Serializer> serializers;
+	};
+
+	// Sends the state of entities with a Replicated component to clients.
+	// Each client is only sent the entities within its view, and only what has changed since the last snapshot it acknowledged.
+	class ReplicationServer : public ReplicationBase
+	{
+	public:
+		ReplicationServer(const ReplicationSettings& settings = ReplicationSettings());
+
+		void AddClient(int clientID);
+		void RemoveClient(int clientID);
+
+		// Limits the client to the entities within 'radius' of 'position'. By default, clients see every entity.
+		void SetClientView(int clientID, const vec3& position, float radius);
+
+		// Records the state of all replicated entities. Call once per network tick, before writing packets.
+		void Capture();
+		// Writes the latest capture for the client, delta encoded against the newest snapshot it has acknowledged.
+		// The packet is meant to be sent unreliably, since a newer one will replace it on the next tick.
+		void WritePacket(int clientID, BitWriter& out_packet);
+		// Writes every client's packet, in parallel if a pool is provided. The call waits for the whole pool to finish.
+		void WritePackets(ThreadPool* pool = nullptr);
+		// The packet written for the client by the last call to WritePackets().
+		std::string_view GetPacket(int clientID) const;
+		// Handles an acknowledgement written by ReplicationClient::WriteAck(). Returns false if it is malformed.
+		bool ProcessAck(int clientID, std::string_view packet);
+
+		// The sequence number of the latest capture.
+		uint16_t GetSequence() const;
+
+	private:
+		// The entities in a packet sent to a client, as the client will see them once it arrives. Sorted by ID.
+		// Entities that were left out of the packet keep their state from the baseline.
+		struct View
+		{
+			uint16_t sequence = 0;
+			bool isValid = false;
+			std::vector<std::shared_ptr<const EntityState>> entities;
+		};
+
+		// An entity within a client's view.
+		struct Candidate
+		{
+			// The index of the entity in the latest capture.
+			unsigned index = 0;
+			// The entity's state in the baseline, if the client has it.
+			const std::shared_ptr<const EntityState>* baseline = nullptr;
+			bool isSent = false;
+			// Where the entity was encoded while measuring it against the packet size limit.
+			unsigned byteOffset = 0;
+			unsigned bitCount = 0;
+		};
+
+		struct ClientState
+		{
+			uint16_t ackedSequence = 0;
+			bool hasAck = false;
+
+			vec3 viewPosition;
+			float viewRadius = 0.0f;
+			bool hasView = false;
+
+			std::vector<View> history;
+			// The accumulated priority of each entity waiting for an update.
+			std::unordered_map<unsigned, float> priorities;
+			// The sequence number of the last packet to include each entity that has been sent since the baseline.
+			std::unordered_map<unsigned, uint16_t> lastSent;
+
+			BitWriter packet;
+			// Reused between packets to avoid allocations.
+			std::vector<unsigned> relevant;
+			std::vector<Candidate> candidates;
+			std::vector<unsigned> removals;
+			BitWriter scratch;
+		};
+
+		// Finds the entities within the client's view, as indices into the latest capture, in order.
+		void GatherRelevant(const ClientState& client, std::vector<unsigned>& out_indices) const;
+		// Chooses which of the entities needing an update fit within the packet size limit.
+		void SelectCandidates(ClientState& client, const View* baseline) const;
+
+		std::shared_ptr<const Snapshot> current;
+		// The position and priority of each entity in the latest capture.
+		std::vector<vec3> positions;
+		std::vector<float> priorities;
+		// The entities in each occupied grid cell, as indices into the latest capture.
+		std::unordered_map<uint64_t, std::vector<unsigned>> grid;
+
+		unsigned nextNetworkID = 1;
+
+		std::unordered_map<int, ClientState> clients;
+	};
+
+	// Mirrors the entities of a ReplicationServer. Entities are created, updated, and released as snapshots arrive.
+	// The copies do not have a Replicated component, so a server and client can run in the same process.
+	class ReplicationClient : public ReplicationBase
+	{
+	public:
+		ReplicationClient(const ReplicationSettings& settings = ReplicationSettings());
+
+		// Applies a packet written by ReplicationServer::WritePacket(). Packets older than the latest one applied are ignored.
+		// Returns false if the packet is malformed or its baseline is no longer available.
+		bool ProcessPacket(std::string_view packet);
+		// Writes an acknowledgement of the latest snapshot applied, to be sent back to the server.
+		// Nothing is written if no snapshot has been applied yet.
+		void WriteAck(BitWriter& out_packet) const;
+
+		// Returns the entity with the given network ID, or null if it does not exist.
+		Entity::Ptr GetEntity(unsigned networkID) const;
+		unsigned GetNumEntities() const;
+
+		// The sequence number of the latest snapshot applied.
+		uint16_t GetSequence() const;
+
+	private:
+		// A local copy of an entity, and the state it was last updated to.
+		struct Replica
+		{
+			Entity::Ptr entity;
+			EntityState state;
+		};
+
+		// Recent snapshots, kept as baselines for the packets that follow them.
+		std::vector<std::shared_ptr<const Snapshot>> history;
+		uint16_t sequence = 0;
+		bool hasReceived = false;
+
+		// Creates or updates the local copy of the entity.
+		void UpdateReplica(const EntityState& state);
+
+		std::unordered_map<unsigned, Replica> replicas;
+	};
+}
+
+#include "Replication.inl"
@@ -0,0 +1,30 @@
+// Copyright (c) 2020 Emilian Cioca
+namespace Jwl
+{
+	template<class T>
+	void ReplicationBase::Register()
+	{
+		static_assert(std::is_base_of_v<ComponentBase, T>, "Only components can be replicated.");
+		ASSERT(serializers.size() < 32, "Cannot replicate more than 32 component types.");
+
+		Serializer serializer;
+		serializer.write = [](const Entity& entity, BitWriter& writer) {
+			const T* component = entity.Try<T>();
+			if (component == nullptr)
+			{
+				return false;
+			}
+
+			component->Write(writer);
+			return true;
+		};
+		serializer.read = [](Entity& entity, BitReader& reader) {
+			return entity.Require<T>().Read(reader);
+		};
+		serializer.remove = [](Entity& entity) {
+			entity.Remove<T>();
+		};
+
+		serializers.push_back(serializer);
+	}
+}
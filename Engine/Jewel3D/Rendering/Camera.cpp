@@ -177,6 +177,24 @@ namespace Jwl
 		return (farBottomLeft + farBottomRight + farTopRight + farTopLeft + nearBottomLeft + nearBottomRight + nearTopRight + nearTopLeft) / 8.0f;
 	}
 
+	float Camera::GetScreenSize(const vec3& center, float radius) const
+	{
+		if (!isPerspective)
+		{
+			return (radius * 2.0f) / Abs(top - bottom);
+		}
+
+		const vec4 viewCenter = GetViewMatrix() * vec4(center, 1.0f);
+		const float distance = Length(vec3(viewCenter));
+		if (distance <= radius)
+		{
+			return FLT_MAX;
+		}
+
+		// The screen's height at the given distance is (2 * distance * tan(fovy / 2)).
+		return radius / (distance * tan(ToRadian(fovyDegrees) / 2.0f));
+	}
+
 	void Camera::SetPerspective()
 	{
 		isPerspective = true;
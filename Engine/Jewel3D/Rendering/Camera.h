@@ -39,6 +39,10 @@ namespace Jwl
 		// Returns the center of the viewing volume, compute as average of corners.
 		vec3 GetCenterOfVolume() const;
 
+		// Returns the fraction of the screen's height covered by a world-space sphere.
+		// Values above 1 mean the sphere is larger than the screen, or that the camera is inside of it.
+		float GetScreenSize(const vec3& center, float radius) const;
+
 		// Sets the camera to Perspective mode with the current settings.
 		void SetPerspective();
 		// Sets the camera to Perspective mode, overriding the settings.
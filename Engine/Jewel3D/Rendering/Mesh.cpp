@@ -25,4 +25,58 @@ namespace Jwl
 		, array(std::move(_array))
 	{
 	}
+
+	unsigned Mesh::GetLod() const
+	{
+		return lod;
+	}
+
+	void Mesh::SetLod(unsigned level)
+	{
+		lod = level;
+	}
+
+	unsigned Mesh::UpdateLod(const Model& model, float screenSize) const
+	{
+		const float boundsSize = Length(model.GetMaxBounds() - model.GetMinBounds());
+
+		lod = SelectLod(model.GetLods(), screenSize, boundsSize, lod, lodThreshold, lodHysteresis);
+		return lod;
+	}
+
+	unsigned SelectLod(const std::vector<Model::Lod>& lods, float screenSize, float boundsSize, unsigned currentLod, float threshold, float hysteresis)
+	{
+		if (lods.empty())
+		{
+			return 0;
+		}
+
+		// The fraction of the screen's height covered by one unit in local-space.
+		const float scale = boundsSize > 0.0f ? screenSize / boundsSize : 0.0f;
+		auto projectedError = [&](unsigned level) {
+			return lods[level].error * scale;
+		};
+
+		unsigned level = std::min(currentLod, static_cast<unsigned>(lods.size()) - 1);
+
+		// Move to a finer level as soon as the current one is visibly inaccurate.
+		if (projectedError(level) > threshold)
+		{
+			while (level > 0 && projectedError(level) > threshold)
+			{
+				--level;
+			}
+
+			return level;
+		}
+
+		// Only move to a coarser level once it is comfortably within the threshold.
+		const float coarseThreshold = threshold * (1.0f - hysteresis);
+		while (level + 1 < lods.size() && projectedError(level + 1) <= coarseThreshold)
+		{
+			++level;
+		}
+
+		return level;
+	}
 }
@@ -1,6 +1,7 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
 #include "Jewel3D/Rendering/Renderable.h"
+#include "Jewel3D/Resource/Model.h"
 #include "Jewel3D/Resource/VertexArray.h"
 
 namespace Jwl
@@ -14,6 +15,29 @@ namespace Jwl
 		Mesh(Entity& owner, Material::Ptr material);
 		Mesh(Entity& owner, VertexArray::Ptr array, Material::Ptr material);
 
+		// Returns the level of detail that will be rendered.
+		unsigned GetLod() const;
+		// Renders a specific level of detail of a Model. Overridden every frame while 'autoLod' is enabled.
+		void SetLod(unsigned level);
+		// Selects the level of detail for a mesh covering 'screenSize' of the screen's height. Called while rendering.
+		unsigned UpdateLod(const Model& model, float screenSize) const;
+
 		VertexArray::Ptr array;
+
+		// Chooses the level of detail of a Model each frame based on how large its bounds appear on screen.
+		bool autoLod = false;
+		// The largest simplification error allowed, as a fraction of the screen's height.
+		float lodThreshold = 0.002f;
+		// A coarser level is only used once its error falls this far below the threshold, as a fraction of the threshold.
+		// This keeps a mesh that is near the threshold from switching back and forth every frame.
+		float lodHysteresis = 0.25f;
+
+	private:
+		mutable unsigned lod = 0;
 	};
+
+	// Returns the coarsest level of detail whose error is within 'threshold' when projected onto the screen.
+	// 'screenSize' is the fraction of the screen's height covered by bounds of the given size.
+	// Levels finer than 'currentLod' are used as soon as they are needed, while coarser ones are subject to 'hysteresis'.
+	unsigned SelectLod(const std::vector<Model::Lod>& lods, float screenSize, float boundsSize, unsigned currentLod, float threshold, float hysteresis);
 }
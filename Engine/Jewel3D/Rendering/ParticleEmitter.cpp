@@ -3,6 +3,18 @@
 #include "ParticleEmitter.h"
 #include "Jewel3D/Application/Application.h"
 #include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Application/Profiler.h"
+
+namespace
+{
+	// Interned once so that switching variants does not need to look up the names.
+	const Jwl::ShaderDefine localSpaceDefine = "JWL_PARTICLE_LOCAL_SPACE";
+	const Jwl::ShaderDefine sizeDefine       = "JWL_PARTICLE_SIZE";
+	const Jwl::ShaderDefine colorDefine      = "JWL_PARTICLE_COLOR";
+	const Jwl::ShaderDefine alphaDefine      = "JWL_PARTICLE_ALPHA";
+	const Jwl::ShaderDefine rotationDefine   = "JWL_PARTICLE_ROTATION";
+	const Jwl::ShaderDefine ageRatioDefine   = "JWL_PARTICLE_AGERATIO";
+}
 
 namespace Jwl
 {
@@ -79,6 +91,8 @@ namespace Jwl
 
 	void ParticleEmitter::Update()
 	{
+		PROFILE_SCOPE("ParticleEmitter::Update");
+
 		if (!isPaused)
 		{
 			UpdateInternal(Application.GetDeltaTime());
@@ -157,7 +171,7 @@ namespace Jwl
 		if (localSpace == isLocal)
 			return;
 
-		variants.Switch("JWL_PARTICLE_LOCAL_SPACE", isLocal);
+		variants.Switch(localSpaceDefine, isLocal);
 
 		vec3 transform;
 		if (isLocal)
@@ -213,11 +227,11 @@ namespace Jwl
 				!requirements.Has(ParticleBuffers::Alpha);
 
 			/* Update shader variant to match the buffers and effect requirements */
-			variants.Switch("JWL_PARTICLE_SIZE", requirements.Has(ParticleBuffers::Size));
-			variants.Switch("JWL_PARTICLE_COLOR", requirements.Has(ParticleBuffers::Color));
-			variants.Switch("JWL_PARTICLE_ALPHA", requirements.Has(ParticleBuffers::Alpha));
-			variants.Switch("JWL_PARTICLE_ROTATION", requirements.Has(ParticleBuffers::Rotation));
-			variants.Switch("JWL_PARTICLE_AGERATIO", requiresAgeRatio);
+			variants.Switch(sizeDefine, requirements.Has(ParticleBuffers::Size));
+			variants.Switch(colorDefine, requirements.Has(ParticleBuffers::Color));
+			variants.Switch(alphaDefine, requirements.Has(ParticleBuffers::Alpha));
+			variants.Switch(rotationDefine, requirements.Has(ParticleBuffers::Rotation));
+			variants.Switch(ageRatioDefine, requiresAgeRatio);
 
 			if (requiresAgeRatio)
 			{
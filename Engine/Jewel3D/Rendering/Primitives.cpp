@@ -1,6 +1,7 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Jewel3D/Precompiled.h"
 #include "Primitives.h"
+#include "Jewel3D/Application/FrameStats.h"
 #include "Jewel3D/Application/Logging.h"
 #include "Jewel3D/Math/Vector.h"
 #include "Jewel3D/Resource/Texture.h"
@@ -597,6 +598,7 @@ namespace Jwl
 
 		glBindVertexArray(primitivesVAO);
 		glDrawArrays(GL_POINTS, 0, 1);
+		FrameStats.CountDrawCall(1);
 		glBindVertexArray(GL_NONE);
 
 		lineProgram.UnBind();
@@ -614,6 +616,7 @@ namespace Jwl
 
 		glBindVertexArray(primitivesVAO);
 		glDrawArrays(GL_POINTS, 0, 1);
+		FrameStats.CountDrawCall(1);
 		glBindVertexArray(GL_NONE);
 
 		lineProgram.UnBind();
@@ -640,6 +643,7 @@ namespace Jwl
 
 		glBindVertexArray(primitivesVAO);
 		glDrawArrays(GL_POINTS, 0, 1);
+		FrameStats.CountDrawCall(1);
 		glBindVertexArray(GL_NONE);
 
 		triangleProgram.UnBind();
@@ -658,6 +662,7 @@ namespace Jwl
 
 		glBindVertexArray(primitivesVAO);
 		glDrawArrays(GL_POINTS, 0, 1);
+		FrameStats.CountDrawCall(1);
 		glBindVertexArray(GL_NONE);
 
 		texturedTriangleProgram.UnBind();
@@ -686,6 +691,7 @@ namespace Jwl
 
 		glBindVertexArray(primitivesVAO);
 		glDrawArrays(GL_POINTS, 0, 1);
+		FrameStats.CountDrawCall(2);
 		glBindVertexArray(GL_NONE);
 
 		rectangleProgram.UnBind();
@@ -705,6 +711,7 @@ namespace Jwl
 
 		glBindVertexArray(primitivesVAO);
 		glDrawArrays(GL_POINTS, 0, 1);
+		FrameStats.CountDrawCall(2);
 		glBindVertexArray(GL_NONE);
 
 		rectangleProgram.UnBind();
@@ -718,6 +725,7 @@ namespace Jwl
 
 		glBindVertexArray(quadVAO);
 		glDrawArrays(GL_TRIANGLES, 0, 6);
+		FrameStats.CountDrawCall(2);
 		glBindVertexArray(GL_NONE);
 	}
 
@@ -755,6 +763,7 @@ namespace Jwl
 
 		glBindVertexArray(fullScreenVAO);
 		glDrawArrays(GL_TRIANGLES, 0, 6);
+		FrameStats.CountDrawCall(2);
 		glBindVertexArray(GL_NONE);
 
 		program.UnBind();
@@ -769,6 +778,7 @@ namespace Jwl
 
 		glBindVertexArray(fullScreenVAO);
 		glDrawArrays(GL_TRIANGLES, 0, 6);
+		FrameStats.CountDrawCall(2);
 		glBindVertexArray(GL_NONE);
 
 		texturedFullScreenQuadProgram.UnBind();
@@ -791,6 +801,7 @@ namespace Jwl
 		glDepthMask(false);
 		glBindVertexArray(skyboxVAO);
 		glDrawArrays(GL_TRIANGLES, 0, 6 * 2 * 3);
+		FrameStats.CountDrawCall(12);
 		glBindVertexArray(GL_NONE);
 		glDepthMask(true);
 
@@ -2,9 +2,12 @@
 #include "Jewel3D/Precompiled.h"
 #include "RenderPass.h"
 #include "Jewel3D/Application/Application.h"
+#include "Jewel3D/Application/FrameStats.h"
 #include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Application/Profiler.h"
 #include "Jewel3D/Entity/Entity.h"
 #include "Jewel3D/Entity/Hierarchy.h"
+#include "Jewel3D/Math/Math.h"
 #include "Jewel3D/Math/Transform.h"
 #include "Jewel3D/Rendering/Camera.h"
 #include "Jewel3D/Rendering/Primitives.h"
@@ -13,6 +16,7 @@
 #include "Jewel3D/Rendering/Viewport.h"
 #include "Jewel3D/Resource/Font.h"
 #include "Jewel3D/Resource/Material.h"
+#include "Jewel3D/Resource/Model.h"
 #include "Jewel3D/Resource/Shader.h"
 #include "Jewel3D/Resource/Texture.h"
 #include "Jewel3D/Resource/UniformBuffer.h"
@@ -23,6 +27,7 @@
 #include "Sprite.h"
 #include "Text.h"
 
+#include <cfloat>
 #include <GLEW/GL/glew.h>
 
 namespace
@@ -65,6 +70,61 @@ namespace
 		renderable.buffers.UnBind();
 		material.textures.UnBind();
 	}
+
+	// Draws the mesh's index buffer. Models store every level of detail in one buffer, so only the selected level is drawn.
+	void DrawIndexed(const Jwl::VertexArray& array, unsigned level, unsigned instances)
+	{
+		auto& indices = array.GetIndexBuffer();
+		unsigned firstIndex = 0;
+		unsigned count = indices.GetCount();
+
+		if (auto* model = dynamic_cast<const Jwl::Model*>(&array))
+		{
+			auto& lods = model->GetLods();
+			if (!lods.empty())
+			{
+				auto& lod = lods[Jwl::Min(level, static_cast<unsigned>(lods.size()) - 1)];
+				firstIndex = lod.firstIndex;
+				count = lod.indexCount;
+			}
+		}
+
+		const auto* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(firstIndex) * Jwl::CountBytes(indices.GetFormat()));
+		if (instances > 1)
+		{
+			glDrawElementsInstanced(GL_TRIANGLES, count, Jwl::ResolveIndexFormat(indices.GetFormat()), offset, instances);
+		}
+		else
+		{
+			glDrawElements(GL_TRIANGLES, count, Jwl::ResolveIndexFormat(indices.GetFormat()), offset);
+		}
+
+		Jwl::FrameStats.CountDrawCall(static_cast<uint64_t>(count / 3) * instances);
+	}
+
+	// Returns the fraction of the screen's height covered by the model's bounds.
+	float GetScreenSize(const Jwl::Model& model, const Jwl::mat4& worldTransform, const Jwl::Camera& camera)
+	{
+		const Jwl::vec3 center = (model.GetMinBounds() + model.GetMaxBounds()) * 0.5f;
+		const Jwl::vec4 worldCenter = worldTransform * Jwl::vec4(center, 1.0f);
+
+		const float scale = Jwl::Max(
+			Jwl::Length(worldTransform.GetRight()),
+			Jwl::Length(worldTransform.GetUp()),
+			Jwl::Length(worldTransform.GetForward()));
+		const float radius = Jwl::Length(model.GetMaxBounds() - model.GetMinBounds()) * 0.5f * scale;
+
+		return camera.GetScreenSize(Jwl::vec3(worldCenter), radius);
+	}
+
+	// Lets streamed textures know how much detail they need. The texture is assumed to span the renderable once.
+	void RequestTextureResolution(const Jwl::Renderable& renderable, float pixels)
+	{
+		for (auto& slot : renderable.GetMaterial()->textures.GetAll())
+		{
+			slot.tex->RequestResolution(pixels);
+		}
+	}
 }
 
 namespace Jwl
@@ -202,6 +262,8 @@ namespace Jwl
 
 	void RenderPass::Render(const Entity& root)
 	{
+		PROFILE_SCOPE("RenderPass::Render");
+
 		Bind();
 
 		RenderEntityRecursive(root);
@@ -216,6 +278,8 @@ namespace Jwl
 
 	void RenderPass::Render(const std::vector<Entity::Ptr>& entities)
 	{
+		PROFILE_SCOPE("RenderPass::Render");
+
 		Bind();
 
 		for (auto& entity : entities)
@@ -248,22 +312,36 @@ namespace Jwl
 		Bind();
 		BindRenderable(*renderable, shader.get());
 
-		// Update transform uniforms.
-		MVP.Set(mat4::Identity);
-		modelView.Set(mat4::Identity);
-		model.Set(mat4::Identity);
-		invModel.Set(mat4::Identity);
+		// Instances are spread over the scene, so full detail is assumed.
+		RequestTextureResolution(*renderable, FLT_MAX);
+
+		// Each instance is placed by the shader, so the transform uniforms only expand quantized positions.
+		auto& mesh = instance.Get<Mesh>();
+		const bool hasPositionTransform = mesh.array && mesh.array->HasPositionTransform();
+		const mat4 positionTransform = hasPositionTransform ? mesh.array->GetPositionTransform() : mat4::Identity;
+
+		MVP.Set(positionTransform);
+		modelView.Set(positionTransform);
+		model.Set(positionTransform);
+		invModel.Set(hasPositionTransform ? positionTransform.GetInverse() : mat4::Identity);
 		normalMatrix.Set(mat3::Identity);
 		transformBuffer.Bind(static_cast<unsigned>(UniformBufferSlot::Model));
 
-		auto& mesh = instance.Get<Mesh>();
 		if (mesh.IsComponentEnabled())
 		{
 			auto& vertexArray = mesh.array;
 			ASSERT(vertexArray, "Entity has a Mesh component but does not have a VertexArray to render.");
 
 			vertexArray->Bind();
-			glDrawArraysInstanced(GL_TRIANGLES, 0, vertexArray->GetVertexCount(), count);
+			if (vertexArray->HasIndexBuffer())
+			{
+				DrawIndexed(*vertexArray, mesh.GetLod(), count);
+			}
+			else
+			{
+				glDrawArraysInstanced(GL_TRIANGLES, 0, vertexArray->GetVertexCount(), count);
+				FrameStats.CountDrawCall(static_cast<uint64_t>(vertexArray->GetVertexCount() / 3) * count);
+			}
 		}
 
 		UnBindRenderable(*renderable, shader.get());
@@ -293,12 +371,22 @@ namespace Jwl
 
 		// Update transform uniforms.
 		const mat4 worldTransform = ent.GetWorldTransform();
+		const auto* mesh = dynamic_cast<const Mesh*>(renderable);
+
+		// Quantized positions are expanded as part of the model transform. Normals are not quantized this way,
+		// so the normal matrix is still derived from the world transform alone.
+		mat4 modelTransform = worldTransform;
+		const bool hasPositionTransform = mesh && mesh->array && mesh->array->HasPositionTransform();
+		if (hasPositionTransform)
+		{
+			modelTransform = worldTransform * mesh->array->GetPositionTransform();
+		}
 
 		if (camera)
 		{
 			auto& cameraComponent = camera->Get<Camera>();
 
-			const mat4 mv = cameraComponent.GetViewMatrix() * worldTransform;
+			const mat4 mv = cameraComponent.GetViewMatrix() * modelTransform;
 			const mat4 mvp = cameraComponent.GetProjMatrix() * mv;
 
 			MVP.Set(mvp);
@@ -310,19 +398,43 @@ namespace Jwl
 			modelView.Set(mat4::Identity);
 		}
 
-		model.Set(worldTransform);
-		invModel.Set(worldTransform.GetFastInverse());
+		model.Set(modelTransform);
+		invModel.Set(hasPositionTransform ? modelTransform.GetInverse() : worldTransform.GetFastInverse());
 		normalMatrix.Set(mat3(worldTransform).GetInverse().GetTranspose());
 
 		transformBuffer.Bind(static_cast<unsigned>(UniformBufferSlot::Model));
 
-		if (auto* mesh = dynamic_cast<const Mesh*>(renderable))
+		// Only models have bounds to measure. Otherwise the size on screen is unknown, so full detail is assumed.
+		const auto* meshModel = mesh ? dynamic_cast<const Model*>(mesh->array.get()) : nullptr;
+		float screenSize = FLT_MAX;
+		if (meshModel && camera)
+		{
+			screenSize = GetScreenSize(*meshModel, worldTransform, camera->Get<Camera>());
+		}
+
+		RequestTextureResolution(*renderable, screenSize * GetViewportHeight());
+
+		if (mesh)
 		{
 			auto& vertexArray = mesh->array;
 			ASSERT(vertexArray, "Entity has a Mesh component but does not have a VertexArray to render.");
 
+			unsigned level = mesh->GetLod();
+			if (mesh->autoLod && meshModel && camera)
+			{
+				level = mesh->UpdateLod(*meshModel, screenSize);
+			}
+
 			vertexArray->Bind();
-			glDrawArrays(GL_TRIANGLES, 0, vertexArray->GetVertexCount());
+			if (vertexArray->HasIndexBuffer())
+			{
+				DrawIndexed(*vertexArray, level, 1);
+			}
+			else
+			{
+				glDrawArrays(GL_TRIANGLES, 0, vertexArray->GetVertexCount());
+				FrameStats.CountDrawCall(vertexArray->GetVertexCount() / 3);
+			}
 		}
 		else if (auto* text = dynamic_cast<const Text*>(renderable))
 		{
@@ -421,6 +533,7 @@ namespace Jwl
 
 				/* Update buffers with the new polygon. */
 				glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * 18, points);
+				FrameStats.CountUpload(sizeof(float) * 18);
 
 				/* Render */
 				if (camera)
@@ -441,6 +554,8 @@ namespace Jwl
 
 				glBindTexture(GL_TEXTURE_2D, font->GetTextures()[charIndex]);
 				glDrawArrays(GL_TRIANGLES, 0, 6);
+				FrameStats.CountTextureBind();
+				FrameStats.CountDrawCall(2);
 
 				/* Adjust position for the next node. */
 				// Undo character translate.
@@ -461,6 +576,7 @@ namespace Jwl
 
 				glBindVertexArray(emitter->GetVAO());
 				glDrawArrays(GL_POINTS, 0, emitter->GetNumAliveParticles());
+				FrameStats.CountDrawCall(emitter->GetNumAliveParticles());
 			}
 		}
 		else if (auto* sprite = dynamic_cast<const Sprite*>(renderable))
@@ -490,6 +606,22 @@ namespace Jwl
 		}
 	}
 
+	unsigned RenderPass::GetViewportHeight() const
+	{
+		if (viewport)
+		{
+			return viewport->height;
+		}
+		else if (target)
+		{
+			return target->GetViewport().height;
+		}
+		else
+		{
+			return static_cast<unsigned>(Application.GetScreenHeight());
+		}
+	}
+
 	void RenderPass::CreateUniformBuffer()
 	{
 		MVP = transformBuffer.AddUniform<mat4>("MVP");
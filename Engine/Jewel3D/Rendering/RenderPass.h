@@ -44,7 +44,9 @@ namespace Jwl
 		// Renders all Entities in the list in order.
 		void Render(const std::vector<Entity::Ptr>& entities);
 		// Renders 'count' copies of the instance.
-		// Jwl_MVP, Jwl_ModelView, Jwl_Model, Jwl_InvModel, and Jwl_NormalToWorld shader uniforms will not be set.
+		// Jwl_MVP, Jwl_ModelView, and Jwl_Model shader uniforms only hold the mesh's position transform, which expands quantized
+		// positions and is otherwise the identity. Instancing shaders should apply Jwl_Model to positions before their own transforms.
+		// Jwl_InvModel holds its inverse, and Jwl_NormalToWorld is the identity.
 		void RenderInstanced(const Entity& instance, unsigned count);
 
 		// These textures will be bound during the execution of the render pass.
@@ -59,6 +61,9 @@ namespace Jwl
 		void RenderEntity(const Entity& ent);
 		void RenderEntityRecursive(const Entity& ent);
 
+		// Returns the height in pixels of the area being rendered to.
+		unsigned GetViewportHeight() const;
+
 		void CreateUniformBuffer();
 
 		std::optional<Viewport> viewport;
@@ -27,7 +27,11 @@ namespace
 		GL_SHORT,
 		GL_UNSIGNED_SHORT,
 		GL_BYTE,
-		GL_UNSIGNED_BYTE
+		GL_UNSIGNED_BYTE,
+		GL_HALF_FLOAT,
+		GL_UNSIGNED_SHORT,
+		GL_UNSIGNED_SHORT,
+		GL_INT_2_10_10_10_REV
 	};
 
 	const int vertexFormatSize_Resolve[] = {
@@ -44,7 +48,11 @@ namespace
 		2,  // short
 		2,  // unsigned short
 		1,  // char
-		1   // unsigned char
+		1,  // unsigned char
+		4,  // half vec2
+		4,  // unsigned short vec2
+		8,  // unsigned short vec4
+		4   // packed int 2_10_10_10
 	};
 
 	const int vertexAccess_Resolve[] = {
@@ -59,6 +67,11 @@ namespace
 		GL_STREAM_DRAW
 	};
 
+	const int indexFormat_Resolve[] = {
+		GL_UNSIGNED_SHORT,
+		GL_UNSIGNED_INT
+	};
+
 	const int filterMin_Resolve[] = {
 		GL_NEAREST,
 		GL_LINEAR,
@@ -87,7 +100,14 @@ namespace
 		GL_RGBA32F,
 		GL_DEPTH_COMPONENT24,
 		GL_SRGB8,
-		GL_SRGB8_ALPHA8
+		GL_SRGB8_ALPHA8,
+		GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+		GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,
+		GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+		GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,
+		GL_COMPRESSED_RG_RGTC2,
+		GL_COMPRESSED_RGBA_BPTC_UNORM,
+		GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
 	};
 }
 
@@ -118,6 +138,11 @@ namespace Jwl
 		return vertexBufferUsage_Resolve[static_cast<unsigned>(usage)];
 	}
 
+	int ResolveIndexFormat(IndexFormat format)
+	{
+		return indexFormat_Resolve[static_cast<unsigned>(format)];
+	}
+
 	int ResolveFilterMag(TextureFilter filter)
 	{
 		if (filter == TextureFilter::Point)
@@ -215,6 +240,11 @@ namespace Jwl
 		return vertexFormatSize_Resolve[static_cast<unsigned>(format)];
 	}
 
+	unsigned CountBytes(IndexFormat format)
+	{
+		return format == IndexFormat::uShort ? sizeof(unsigned short) : sizeof(unsigned);
+	}
+
 	unsigned CountMipLevels(unsigned width, unsigned height, TextureFilter filter)
 	{
 		unsigned numLevels = 1;
@@ -237,6 +267,8 @@ namespace Jwl
 		case TextureFormat::RGB_32:
 		case TextureFormat::RGB_32F:
 		case TextureFormat::sRGB_8:
+		case TextureFormat::RGB_BC1:
+		case TextureFormat::sRGB_BC1:
 			return 3;
 		case TextureFormat::RGBA_8:
 		case TextureFormat::RGBA_16:
@@ -244,7 +276,13 @@ namespace Jwl
 		case TextureFormat::RGBA_32:
 		case TextureFormat::RGBA_32F:
 		case TextureFormat::sRGBA_8:
+		case TextureFormat::RGBA_BC3:
+		case TextureFormat::sRGBA_BC3:
+		case TextureFormat::RGBA_BC7:
+		case TextureFormat::sRGBA_BC7:
 			return 4;
+		case TextureFormat::RG_BC5:
+			return 2;
 		case TextureFormat::DEPTH_24:
 			return 1;
 		default:
@@ -252,6 +290,57 @@ namespace Jwl
 		}
 	}
 
+	unsigned CountBytes(TextureFormat format, unsigned width, unsigned height)
+	{
+		const unsigned numBlocks = ((width + 3) / 4) * ((height + 3) / 4);
+
+		switch (format)
+		{
+		case TextureFormat::RGB_BC1:
+		case TextureFormat::sRGB_BC1:
+			return numBlocks * 8;
+		case TextureFormat::RGBA_BC3:
+		case TextureFormat::sRGBA_BC3:
+		case TextureFormat::RG_BC5:
+		case TextureFormat::RGBA_BC7:
+		case TextureFormat::sRGBA_BC7:
+			return numBlocks * 16;
+		case TextureFormat::RGB_16:
+		case TextureFormat::RGB_16F:
+		case TextureFormat::RGBA_16:
+		case TextureFormat::RGBA_16F:
+			return width * height * CountChannels(format) * 2;
+		case TextureFormat::RGB_32:
+		case TextureFormat::RGB_32F:
+		case TextureFormat::RGBA_32:
+		case TextureFormat::RGBA_32F:
+		case TextureFormat::DEPTH_24:
+			return width * height * CountChannels(format) * 4;
+		default:
+			return width * height * CountChannels(format);
+		}
+	}
+
+	bool IsCompressed(TextureFormat format)
+	{
+		return format >= TextureFormat::RGB_BC1;
+	}
+
+	bool IsSRGB(TextureFormat format)
+	{
+		switch (format)
+		{
+		case TextureFormat::sRGB_8:
+		case TextureFormat::sRGBA_8:
+		case TextureFormat::sRGB_BC1:
+		case TextureFormat::sRGBA_BC3:
+		case TextureFormat::sRGBA_BC7:
+			return true;
+		default:
+			return false;
+		}
+	}
+
 	void ClearBackBuffer()
 	{
 		SetDepthFunc(DepthFunc::Normal);
@@ -31,7 +31,14 @@ namespace Jwl
 		Short,
 		uShort,
 		Byte,
-		uByte
+		uByte,
+		// Compact formats that are read as floating point vectors in a shader.
+		// Integer formats are mapped to [0, 1] or [-1, 1] if the stream is normalized.
+		HalfVec2,
+		uShortVec2,
+		uShortVec4,
+		// Three signed 10-bit components and a signed 2-bit w component packed into 32 bits.
+		Int_2_10_10_10
 	};
 
 	enum class VertexAccess
@@ -51,6 +58,12 @@ namespace Jwl
 		Stream
 	};
 
+	enum class IndexFormat
+	{
+		uShort,
+		uInt
+	};
+
 	enum class TextureFormat
 	{
 		RGB_8,
@@ -65,7 +78,15 @@ namespace Jwl
 		RGBA_32F,
 		DEPTH_24,
 		sRGB_8,
-		sRGBA_8
+		sRGBA_8,
+		// Block-compressed formats. Each 4x4 block of pixels is stored in 8 (BC1) or 16 bytes.
+		RGB_BC1,
+		sRGB_BC1,
+		RGBA_BC3,
+		sRGBA_BC3,
+		RG_BC5,
+		RGBA_BC7,
+		sRGBA_BC7
 	};
 
 	enum class TextureWrap
@@ -142,6 +163,7 @@ namespace Jwl
 	int ResolveVertexFormat(VertexFormat);
 	int ResolveVertexAccess(VertexAccess);
 	int ResolveVertexBufferUsage(VertexBufferUsage);
+	int ResolveIndexFormat(IndexFormat);
 	int ResolveFilterMag(TextureFilter);
 	int ResolveFilterMin(TextureFilter);
 	bool ResolveMipMapping(TextureFilter);
@@ -155,8 +177,13 @@ namespace Jwl
 	DepthFunc StringToDepthFunc(std::string_view);
 
 	unsigned CountBytes(VertexFormat);
+	unsigned CountBytes(IndexFormat);
 	unsigned CountMipLevels(unsigned width, unsigned height, TextureFilter);
 	unsigned CountChannels(TextureFormat);
+	// Returns the size of a single image of the given dimensions, such as one face of one mip level.
+	unsigned CountBytes(TextureFormat, unsigned width, unsigned height);
+	bool IsCompressed(TextureFormat);
+	bool IsSRGB(TextureFormat);
 
 	void ClearBackBuffer();
 	void ClearBackBufferDepth();
@@ -2,6 +2,14 @@
 #include "Jewel3D/Precompiled.h"
 #include "Sprite.h"
 
+namespace
+{
+	// Interned once so that switching variants does not need to look up the names.
+	const Jwl::ShaderDefine centeredXDefine = "JWL_SPRITE_CENTERED_X";
+	const Jwl::ShaderDefine centeredYDefine = "JWL_SPRITE_CENTERED_Y";
+	const Jwl::ShaderDefine billBoardDefine = "JWL_SPRITE_BILLBOARD";
+}
+
 namespace Jwl
 {
 	Sprite::Sprite(Entity& owner)
@@ -40,8 +48,8 @@ namespace Jwl
 		if (alignment == pivot)
 			return;
 
-		variants.Switch("JWL_SPRITE_CENTERED_X", pivot == Alignment::Center || pivot == Alignment::BottomCenter);
-		variants.Switch("JWL_SPRITE_CENTERED_Y", pivot == Alignment::Center || pivot == Alignment::LeftCenter);
+		variants.Switch(centeredXDefine, pivot == Alignment::Center || pivot == Alignment::BottomCenter);
+		variants.Switch(centeredYDefine, pivot == Alignment::Center || pivot == Alignment::LeftCenter);
 
 		alignment = pivot;
 	}
@@ -56,7 +64,7 @@ namespace Jwl
 		if (billBoarded == state)
 			return;
 
-		variants.Switch("JWL_SPRITE_BILLBOARD", state);
+		variants.Switch(billBoardDefine, state);
 
 		billBoarded = state;
 	}
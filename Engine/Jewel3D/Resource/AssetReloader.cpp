@@ -0,0 +1,222 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "AssetReloader.h"
+#include "AssetStreamer.h"
+#include "Material.h"
+#include "Model.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "Jewel3D/Application/FileSystem.h"
+#include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Utilities/String.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Paths are compared without regard to case or the style of separator, like the file system does.
+	std::string NormalizePath(std::string path)
+	{
+		Jwl::ToLowercase(path);
+		std::replace(path.begin(), path.end(), '\\', '/');
+
+		return path;
+	}
+
+	// Whether the asset cached under 'key' was loaded from the normalized 'path'.
+	// Assets loaded without an extension were given the default extension of their type.
+	bool IsSameFile(std::string_view key, std::string_view path, std::string_view defaultExtension)
+	{
+		std::string file = NormalizePath(std::string(key));
+		if (Jwl::ExtractFileExtension(file).empty())
+		{
+			file += defaultExtension;
+		}
+
+		return file == path;
+	}
+}
+
+namespace Jwl
+{
+	template<class Asset>
+	class AssetReloaderSingleton::ReloadRequest : public StreamRequest
+	{
+	public:
+		ReloadRequest(std::string _filePath, std::shared_ptr<Asset> _asset)
+			: filePath(std::move(_filePath)), asset(std::move(_asset))
+		{
+		}
+
+	protected:
+		bool Read() override
+		{
+			return Asset::Decode(filePath, data);
+		}
+
+		bool Upload() override
+		{
+			return asset->Reload(data);
+		}
+
+		void Complete(bool success) override
+		{
+			data = {};
+			AssetReloader.Complete(filePath, success);
+		}
+
+	private:
+		const std::string filePath;
+		const std::shared_ptr<Asset> asset;
+		typename Asset::StreamData data;
+	};
+
+	//-----------------------------------------------------------------------------------------------------
+
+	AssetReloaderSingleton AssetReloader;
+
+	bool AssetReloaderSingleton::Enable()
+	{
+		if (watcher.IsRunning())
+		{
+			return true;
+		}
+
+		return watcher.Start(RootAssetDirectory);
+	}
+
+	void AssetReloaderSingleton::Disable()
+	{
+		watcher.Stop();
+		deferred.clear();
+	}
+
+	bool AssetReloaderSingleton::IsEnabled() const
+	{
+		return watcher.IsRunning();
+	}
+
+	void AssetReloaderSingleton::SetDelay(double ms)
+	{
+		watcher.SetDelay(ms);
+	}
+
+	double AssetReloaderSingleton::GetDelay() const
+	{
+		return watcher.GetDelay();
+	}
+
+	void AssetReloaderSingleton::Reload(std::string_view file)
+	{
+		const std::string filePath = RootAssetDirectory + std::string(file);
+		const std::string path = NormalizePath(filePath);
+
+		Resource<Texture>::ForEach([&](const std::string& key, std::shared_ptr<Texture> texture) {
+			if (IsSameFile(key, path, ".texture"))
+			{
+				Submit(filePath, std::move(texture), file);
+			}
+		});
+
+		Resource<Model>::ForEach([&](const std::string& key, std::shared_ptr<Model> model) {
+			if (IsSameFile(key, path, ".model"))
+			{
+				Submit(filePath, std::move(model), file);
+			}
+		});
+
+		// Shaders are also rebuilt when one of their included files changes, in which case their own file is read again.
+		Resource<Shader>::ForEach([&](const std::string& key, std::shared_ptr<Shader> shader) {
+			if (IsSameFile(key, path, ".shader"))
+			{
+				Submit(filePath, std::move(shader), file);
+				return;
+			}
+
+			const auto& includes = shader->GetIncludes();
+			const bool isIncluded = std::any_of(includes.begin(), includes.end(), [&path](const std::string& include) {
+				return NormalizePath(include) == path;
+			});
+
+			if (isIncluded)
+			{
+				Submit(key, std::move(shader), file);
+			}
+		});
+
+		// Materials only reference other assets, so they are small enough to reload immediately.
+		std::vector<std::pair<std::string, std::shared_ptr<Material>>> materials;
+		Resource<Material>::ForEach([&](const std::string& key, std::shared_ptr<Material> material) {
+			if (IsSameFile(key, path, ".material"))
+			{
+				materials.emplace_back(key, std::move(material));
+			}
+		});
+
+		// Reloading a material might load new shaders and textures, so this cannot be done while iterating the cache.
+		for (auto& [key, material] : materials)
+		{
+			if (material->Reload(key))
+			{
+				Log("AssetReloader: Reloaded ( %s ).", key.c_str());
+			}
+			else
+			{
+				Error("AssetReloader: ( %s )\nFailed to reload. The previous version will continue to be used.", key.c_str());
+			}
+		}
+	}
+
+	template<class Asset>
+	void AssetReloaderSingleton::Submit(std::string filePath, std::shared_ptr<Asset> asset, std::string_view file)
+	{
+		// The file might still be changing, so the latest version is read once the current reload finishes.
+		if (reloading.count(filePath) != 0)
+		{
+			if (std::find(deferred.begin(), deferred.end(), file) == deferred.end())
+			{
+				deferred.emplace_back(file);
+			}
+
+			return;
+		}
+
+		reloading.insert(filePath);
+		AssetStreamer.Submit(std::make_shared<ReloadRequest<Asset>>(std::move(filePath), std::move(asset)));
+	}
+
+	void AssetReloaderSingleton::Complete(const std::string& filePath, bool success)
+	{
+		reloading.erase(filePath);
+
+		if (success)
+		{
+			Log("AssetReloader: Reloaded ( %s ).", filePath.c_str());
+		}
+		else
+		{
+			Error("AssetReloader: ( %s )\nFailed to reload. The previous version will continue to be used.", filePath.c_str());
+		}
+
+		// Files that are still busy are simply deferred again.
+		auto files = std::move(deferred);
+		deferred.clear();
+		for (auto& file : files)
+		{
+			Reload(file);
+		}
+	}
+
+	void AssetReloaderSingleton::Update()
+	{
+		if (!watcher.IsRunning())
+		{
+			return;
+		}
+
+		for (auto& file : watcher.Poll())
+		{
+			Reload(file);
+		}
+	}
+}
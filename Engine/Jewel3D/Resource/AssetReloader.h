@@ -0,0 +1,55 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include "Jewel3D/Application/FileWatcher.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace Jwl
+{
+	// Applies changes to asset files while the program is running.
+	// While enabled, the RootAssetDirectory is watched for files that are rewritten, such as by the encoders or a text editor.
+	// Changed textures, models, and shaders are read on the AssetStreamer's I/O threads and swapped into the assets that are
+	// already loaded, so everything holding on to them sees the new version. Shaders only recompile the variants that were
+	// in use, and are also reloaded when one of their included files changes. Materials are reloaded immediately.
+	// Files that are not currently loaded are ignored.
+	extern class AssetReloaderSingleton AssetReloader;
+	class AssetReloaderSingleton
+	{
+		friend class ApplicationSingleton;
+	public:
+		// Begins watching the RootAssetDirectory.
+		bool Enable();
+		void Disable();
+		bool IsEnabled() const;
+
+		// Sets how long a file must go without changing before it is reloaded.
+		// Many tools write a file in several steps, which would otherwise cause a reload for each one.
+		void SetDelay(double ms);
+		double GetDelay() const;
+
+		// Reloads any asset using the file, which is relative to the RootAssetDirectory.
+		// Can be called whether or not the directory is being watched.
+		void Reload(std::string_view file);
+
+	private:
+		// Decodes the new version of an asset in the background and swaps it in on the main thread.
+		template<class Asset> class ReloadRequest;
+
+		template<class Asset>
+		void Submit(std::string filePath, std::shared_ptr<Asset> asset, std::string_view file);
+		void Complete(const std::string& filePath, bool success);
+
+		// Reloads the files that have settled since the last frame.
+		void Update();
+
+		FileWatcher watcher;
+		// The files of the assets currently being reloaded.
+		std::unordered_set<std::string> reloading;
+		// Files that changed again while their asset was still being reloaded. They are reloaded once it finishes.
+		std::vector<std::string> deferred;
+	};
+}
@@ -0,0 +1,156 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "AssetStreamer.h"
+#include "Jewel3D/Application/ThreadPool.h"
+#include "Jewel3D/Application/Timer.h"
+
+namespace Jwl
+{
+	StreamStatus StreamRequest::GetStatus() const
+	{
+		return status;
+	}
+
+	//-----------------------------------------------------------------------------------------------------
+
+	AssetStreamerSingleton AssetStreamer;
+
+	AssetStreamerSingleton::AssetStreamerSingleton() = default;
+
+	AssetStreamerSingleton::~AssetStreamerSingleton() = default;
+
+	void AssetStreamerSingleton::SetWorkerCount(unsigned count)
+	{
+		ASSERT(count > 0, "There must be at least one worker thread.");
+		ASSERT(pendingCount == 0, "The worker count cannot be changed while requests are pending.");
+
+		if (count != workerCount)
+		{
+			workerCount = count;
+
+			// Recreated with the new count on the next request.
+			workers.reset();
+		}
+	}
+
+	unsigned AssetStreamerSingleton::GetWorkerCount() const
+	{
+		return workerCount;
+	}
+
+	void AssetStreamerSingleton::SetUploadBudget(double ms)
+	{
+		ASSERT(ms >= 0.0, "Budget cannot be negative.");
+
+		uploadBudget = ms;
+	}
+
+	double AssetStreamerSingleton::GetUploadBudget() const
+	{
+		return uploadBudget;
+	}
+
+	unsigned AssetStreamerSingleton::GetPendingCount() const
+	{
+		return pendingCount;
+	}
+
+	void AssetStreamerSingleton::Submit(std::shared_ptr<StreamRequest> request)
+	{
+		ASSERT(request, "Request cannot be null.");
+		ASSERT(request->status == StreamStatus::Reading, "Request has already been submitted.");
+
+		if (!workers)
+		{
+			workers = std::make_unique<ThreadPool>(workerCount);
+		}
+
+		++pendingCount;
+		workers->Submit([this, request = std::move(request)]() mutable {
+			const bool success = request->Read();
+
+			{
+				std::lock_guard lock(uploadMutex);
+				request->status = success ? StreamStatus::Uploading : StreamStatus::Failed;
+				uploadQueue.push_back(std::move(request));
+			}
+
+			readFinished.notify_all();
+		});
+	}
+
+	void AssetStreamerSingleton::Finish(StreamRequest& request)
+	{
+		{
+			std::unique_lock lock(uploadMutex);
+			readFinished.wait(lock, [&request] { return request.status != StreamStatus::Reading; });
+		}
+
+		// The request stays in the queue and will be skipped by Update().
+		Upload(request);
+	}
+
+	void AssetStreamerSingleton::FinishAll()
+	{
+		if (workers)
+		{
+			workers->Wait();
+		}
+
+		// Update() stops once its budget is spent, so we drain the queue directly.
+		std::deque<std::shared_ptr<StreamRequest>> queue;
+		{
+			std::lock_guard lock(uploadMutex);
+			queue.swap(uploadQueue);
+		}
+
+		for (auto& request : queue)
+		{
+			Upload(*request);
+		}
+	}
+
+	void AssetStreamerSingleton::Update()
+	{
+		Timer timer;
+
+		do
+		{
+			std::shared_ptr<StreamRequest> request;
+			{
+				std::lock_guard lock(uploadMutex);
+				if (uploadQueue.empty())
+				{
+					return;
+				}
+
+				request = std::move(uploadQueue.front());
+				uploadQueue.pop_front();
+			}
+
+			Upload(*request);
+		} while (!timer.IsElapsedMS(uploadBudget));
+	}
+
+	void AssetStreamerSingleton::Upload(StreamRequest& request)
+	{
+		// Requests completed by Finish() are still in the queue, so they might be seen twice.
+		if (request.completed || request.status == StreamStatus::Reading)
+		{
+			return;
+		}
+
+		const bool success = request.status == StreamStatus::Uploading && request.Upload();
+		request.status = success ? StreamStatus::Ready : StreamStatus::Failed;
+		request.completed = true;
+		--pendingCount;
+
+		request.Complete(success);
+	}
+
+	void AssetStreamerSingleton::Unload()
+	{
+		FinishAll();
+		workers.reset();
+	}
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace Jwl
+{
+	class ThreadPool;
+
+	enum class StreamStatus
+	{
+		// Waiting for, or being read by, an I/O worker thread.
+		Reading,
+		// The data is in memory and is waiting for its turn to be uploaded by the main thread.
+		Uploading,
+		Ready,
+		Failed
+	};
+
+	// An asset load that is split between an I/O worker thread and the main thread.
+	class StreamRequest
+	{
+		friend class AssetStreamerSingleton;
+	public:
+		virtual ~StreamRequest() = default;
+
+		StreamStatus GetStatus() const;
+
+	protected:
+		// Reads and decodes the file. Called on an I/O worker thread, so no graphics or audio calls may be made.
+		virtual bool Read() = 0;
+		// Sends the decoded data to the GPU. Called on the main thread.
+		virtual bool Upload() = 0;
+		// Called on the main thread once the request has succeeded or failed.
+		virtual void Complete(bool success) = 0;
+
+	private:
+		std::atomic<StreamStatus> status = StreamStatus::Reading;
+		// Only accessed by the main thread.
+		bool completed = false;
+	};
+
+	// Streams assets from disk in the background. Files are read and decoded by I/O worker threads
+	// while the GPU uploads are spread over the following frames on the main thread.
+	// Requests are normally made with Resource<Asset>::LoadAsync().
+	extern class AssetStreamerSingleton AssetStreamer;
+	class AssetStreamerSingleton
+	{
+		friend class ApplicationSingleton;
+	public:
+		AssetStreamerSingleton();
+		~AssetStreamerSingleton();
+
+		// Sets the number of I/O worker threads. Can only be changed while no requests are pending.
+		void SetWorkerCount(unsigned count);
+		unsigned GetWorkerCount() const;
+
+		// Sets the time in milliseconds that each frame may spend uploading streamed assets.
+		// At least one asset is always uploaded per frame so that streaming keeps moving.
+		void SetUploadBudget(double ms);
+		double GetUploadBudget() const;
+
+		// Returns the number of requests that have not yet succeeded or failed.
+		unsigned GetPendingCount() const;
+
+		// Begins reading the request in the background. Must be called from the main thread.
+		void Submit(std::shared_ptr<StreamRequest> request);
+
+		// Blocks until the request is read and uploads it immediately. Must be called from the main thread.
+		void Finish(StreamRequest& request);
+
+		// Blocks until all requests have been read and uploaded. Must be called from the main thread.
+		void FinishAll();
+
+	private:
+		// Uploads as many read requests as the budget allows.
+		void Update();
+
+		// Uploads the request if it has not been already.
+		void Upload(StreamRequest& request);
+
+		// Completes all requests and stops the worker threads.
+		void Unload();
+
+		std::unique_ptr<ThreadPool> workers;
+		unsigned workerCount = 2;
+		double uploadBudget = 2.0;
+		unsigned pendingCount = 0;
+
+		// Requests that have been read and are ready to upload, in the order they finished.
+		std::deque<std::shared_ptr<StreamRequest>> uploadQueue;
+		std::mutex uploadMutex;
+		std::condition_variable readFinished;
+	};
+}
@@ -4,19 +4,31 @@
 #include "Jewel3D/Application/CmdArgs.h"
 #include "Jewel3D/Application/FileSystem.h"
 #include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Application/ThreadPool.h"
+#include "Jewel3D/Utilities/Hash.h"
 #include "Jewel3D/Utilities/ScopeGuard.h"
 #include "Jewel3D/Utilities/String.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
 #include <memory>
+#include <vector>
 
 namespace Jwl
 {
 	// A base class for all asset packers that exposes a common interface to the AssetManager.
 	// Derive from this class to create a custom asset packing tool for integration with the AssetManager.
+	//
+	// Encoders that provide the extension of the file they output keep a build record beside each output.
+	// The record holds a hash of the source file, its metadata, and the encoder's version, so that packing
+	// can skip files whose output is already up to date, even if their timestamps have changed.
 	class Encoder
 	{
 	public:
-		Encoder(unsigned version) : version(version) {}
+		Encoder(unsigned version, std::string_view outputExtension = {}, unsigned outputVersion = 0)
+			: version(version), outputExtension(outputExtension), outputVersion(outputVersion) {}
 		virtual ~Encoder() = default;
 
 		// Loads a .meta file and ensures that it has a valid version number.
@@ -95,15 +107,44 @@ namespace Jwl
 			const char* usage = 
 				"Jewel3D asset Encoder.\nUsage:\n"
 				"  Encoder.exe -update -src <file>\n"
-				"  Encoder.exe -pack -src <file> -dest <folder>\n"
+				"  Encoder.exe -pack -src <file> [<file>...] -dest <folder> [-threads <count>] [-jobs <count>] [-force]\n"
 				"Options:\n"
-				"  -pack       Package the file into the destination folder.\n"
-				"  -update     Ensures that the asset's metadata file is up to date.";
+				"  -pack       Package the files into the destination folder.\n"
+				"  -update     Ensures that the asset's metadata file is up to date.\n"
+				"  -threads    The number of worker threads the encoder may use for each file. Defaults to one per core, shared between the jobs.\n"
+				"  -jobs       The number of files to encode at the same time. Defaults to one.\n"
+				"  -force      Encode the files even if their output is up to date.";
 
 			if (HasCommandLineArg("-pack"))
 			{
-				const char* src = nullptr;
-				if (!GetCommandLineArg("-src", src))
+				if (HasCommandLineArg("-threads") && !GetCommandLineArg("-threads", encoder.numThreads))
+				{
+					Error("Invalid command line parameters: '-threads' must be followed by a number.");
+					Log(usage);
+					return false;
+				}
+
+				unsigned numJobs = 1;
+				if (HasCommandLineArg("-jobs") && (!GetCommandLineArg("-jobs", numJobs) || numJobs == 0))
+				{
+					Error("Invalid command line parameters: '-jobs' must be followed by a positive number.");
+					Log(usage);
+					return false;
+				}
+
+				encoder.forceRebuild = HasCommandLineArg("-force");
+
+				// Every argument after '-src' up to the next option is a source file.
+				std::vector<const char*> sources;
+				if (int index = FindCommandLineArg("-src"); index != -1)
+				{
+					for (int i = index + 1; i < GetArgc() && GetArgv()[i][0] != '-'; ++i)
+					{
+						sources.push_back(GetArgv()[i]);
+					}
+				}
+
+				if (sources.empty())
 				{
 					Error("Invalid command line parameters: Missing '-src <file>'");
 					Log(usage);
@@ -118,7 +159,7 @@ namespace Jwl
 					return false;
 				}
 
-				return encoder.Pack(src, dest);
+				return encoder.Pack(sources, dest, numJobs);
 			}
 			else if (HasCommandLineArg("-update"))
 			{
@@ -194,8 +235,9 @@ namespace Jwl
 		{
 			defer { ResetConsoleColor(); };
 
+			const std::string metaFile = std::string(src) + ".meta";
 			ConfigTable metadata;
-			if (!Encoder::LoadMetaData(std::string(src) + ".meta", metadata))
+			if (!Encoder::LoadMetaData(metaFile, metadata))
 			{
 				return false;
 			}
@@ -205,14 +247,81 @@ namespace Jwl
 				return false;
 			}
 
+			uint64_t inputHash = 0;
+			const bool useBuildRecord = !outputExtension.empty() && HashInputs(src, metaFile, inputHash);
+			const std::string outputFile = GetOutputFile(src, dest);
+			const std::string recordFile = outputFile + ".build";
+
+			if (useBuildRecord && !forceRebuild && FileExists(outputFile) && ReadBuildRecord(recordFile) == inputHash)
+			{
+				Log("Up to date: ( %s )", src);
+				return true;
+			}
+
+			// A failed conversion must not leave behind a record claiming that the old output is up to date.
+			std::remove(recordFile.c_str());
+
 			if (!Convert(src, dest, metadata))
 			{
 				return false;
 			}
 
+			if (useBuildRecord && !WriteBuildRecord(recordFile, inputHash))
+			{
+				Warning("Could not save the build record ( %s ). The file will be encoded again next time.", recordFile.c_str());
+			}
+
 			return true;
 		}
 
+		// Packs each file into the destination folder, encoding up to 'numJobs' files at the same time.
+		// Every file is attempted even if some fail. Returns true if all of them succeeded.
+		bool Pack(const std::vector<const char*>& sources, const char* dest, unsigned numJobs)
+		{
+			numJobs = std::min(numJobs, static_cast<unsigned>(sources.size()));
+			std::atomic<unsigned> numFailed = 0;
+
+			auto packFile = [this, dest, &numFailed](const char* src) {
+				if (!Pack(src, dest))
+				{
+					Error("Failed to encode ( %s ).", src);
+					++numFailed;
+				}
+			};
+
+			if (numJobs <= 1)
+			{
+				for (const char* src : sources)
+				{
+					packFile(src);
+				}
+			}
+			else
+			{
+				// Share the cores between the files being encoded at the same time.
+				if (numThreads == 0)
+				{
+					numThreads = std::max(1u, std::thread::hardware_concurrency() / numJobs);
+				}
+
+				ThreadPool pool(numJobs);
+				for (const char* src : sources)
+				{
+					pool.Submit([&packFile, src] { packFile(src); });
+				}
+
+				pool.Wait();
+			}
+
+			return numFailed == 0;
+		}
+
+		// Returns the file that Convert() writes for the source file. Only valid if the encoder provided its output extension.
+		std::string GetOutputFile(std::string_view source, std::string_view destination) const
+		{
+			return std::string(destination) + ExtractFilename(source) + outputExtension;
+		}
+
 		// Returns the default settings for the asset.
 		virtual ConfigTable GetDefault() const = 0;
 		
@@ -231,5 +340,61 @@ namespace Jwl
 
 		// The newest version of the metaData.
 		const unsigned version;
+		// The number of worker threads that Convert() may use, as requested with '-threads'.
+		// 0 means that no limit was given and one thread per core can be used.
+		unsigned numThreads = 0;
+		// The extension of the file written by Convert(), such as ".texture". Build records are not kept without it.
+		const std::string outputExtension;
+		// Set by '-force' to ignore the build records.
+		bool forceRebuild = false;
+		// The version of the format written by Convert(). Changing it rebuilds every output.
+		const unsigned outputVersion;
+
+	private:
+		// Hashes everything that affects the output of Convert().
+		bool HashInputs(std::string_view source, std::string_view metaFile, uint64_t& out) const
+		{
+			FileView sourceData;
+			std::string metaData;
+			if (!sourceData.Open(source) || !LoadFileAsString(metaFile, metaData))
+			{
+				return false;
+			}
+
+			out = HashFNV(sourceData.GetData(), sourceData.GetSize());
+			out = HashCombine(out, HashFNV(metaData));
+			out = HashCombine(out, version);
+			if (outputVersion != 0)
+			{
+				out = HashCombine(out, outputVersion);
+			}
+
+			return true;
+		}
+
+		// Returns the hash saved in the record, or 0 if there is no valid record.
+		static uint64_t ReadBuildRecord(const std::string& file)
+		{
+			std::string record;
+			if (!FileExists(file) || !LoadFileAsString(file, record))
+			{
+				return 0;
+			}
+
+			return std::strtoull(record.c_str(), nullptr, 16);
+		}
+
+		static bool WriteBuildRecord(const std::string& file, uint64_t hash)
+		{
+			FILE* recordFile = fopen(file.c_str(), "w");
+			if (recordFile == nullptr)
+			{
+				return false;
+			}
+
+			const bool success = fprintf(recordFile, "%016llx\n", static_cast<unsigned long long>(hash)) > 0;
+
+			return fclose(recordFile) == 0 && success;
+		}
 	};
 }
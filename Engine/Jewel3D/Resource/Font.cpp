@@ -2,10 +2,12 @@
 #include "Jewel3D/Precompiled.h"
 #include "Font.h"
 #include "Texture.h"
+#include "Jewel3D/Application/FileSystem.h"
 #include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Application/Profiler.h"
 #include "Jewel3D/Math/Math.h"
 #include "Jewel3D/Rendering/Rendering.h"
-#include "Jewel3D/Utilities/ScopeGuard.h"
+#include "Jewel3D/Utilities/BinaryReader.h"
 #include "Jewel3D/Utilities/String.h"
 
 #include <cstdio>
@@ -32,6 +34,66 @@ namespace Jwl
 
 	bool Font::Load(std::string filePath)
 	{
+		StreamData data;
+		return Decode(std::move(filePath), data) && Upload(data);
+	}
+
+	bool Font::Decode(std::string filePath, StreamData& out)
+	{
+		PROFILE_SCOPE("Font::Decode");
+
+		auto ext = ExtractFileExtension(filePath);
+		if (ext.empty())
+		{
+			filePath += ".font";
+		}
+		else if (!CompareLowercase(ExtractFileExtension(filePath), ".font"))
+		{
+			Error("Font: ( %s )\nAttempted to load unknown file type as a font.", filePath.c_str());
+			return false;
+		}
+
+		FileView file;
+		if (!file.Open(filePath))
+		{
+			Error("Font: ( %s )\nUnable to open file.", filePath.c_str());
+			return false;
+		}
+
+		BinaryReader reader(file.GetData(), file.GetSize());
+
+		// Read header.
+		unsigned long int bitmapSize = 0;
+		if (!reader.Read(bitmapSize) ||
+			!reader.Read(out.width) ||
+			!reader.Read(out.height) ||
+			!reader.Read(out.filter))
+		{
+			Error("Font: ( %s )\nFile is missing header data.", filePath.c_str());
+			return false;
+		}
+
+		// Load Data.
+		const unsigned char* bitmap = reader.ReadBytes(bitmapSize);
+		if (bitmap == nullptr ||
+			!reader.Read(out.dimensions) ||
+			!reader.Read(out.positions) ||
+			!reader.Read(out.advances) ||
+			!reader.Read(out.masks))
+		{
+			Error("Font: ( %s )\nFile is missing character data.", filePath.c_str());
+			return false;
+		}
+
+		out.bitmap.assign(bitmap, bitmap + bitmapSize);
+
+		return true;
+	}
+
+	bool Font::Upload(const StreamData& data)
+	{
+		PROFILE_SCOPE("Font::Upload");
+
 		if (VAO == GL_NONE)
 		{
 			// Prepare VBO's and VAO.
@@ -90,71 +152,42 @@ namespace Jwl
 			glBindVertexArray(GL_NONE);
 		}
 
-		/* Load Font from file */
-		auto ext = ExtractFileExtension(filePath);
-		if (ext.empty())
-		{
-			filePath += ".font";
-		}
-		else if (!CompareLowercase(ExtractFileExtension(filePath), ".font"))
-		{
-			Error("Font: ( %s )\nAttempted to load unknown file type as a font.", filePath.c_str());
-			return false;
-		}
-
-		FILE* fontFile = fopen(filePath.c_str(), "rb");
-		if (fontFile == nullptr)
-		{
-			Error("Font: ( %s )\nUnable to open file.", filePath.c_str());
-			return false;
-		}
-
-		// Load bitmap data.
-		TextureFilter filter;
-		unsigned long int bitmapSize = 0;
-		unsigned char* bitmap = nullptr;
-		defer{ free(bitmap); };
-
-		// Read header.
-		fread(&bitmapSize, sizeof(unsigned long int), 1, fontFile);
-		fread(&width, sizeof(unsigned), 1, fontFile);
-		fread(&height, sizeof(unsigned), 1, fontFile);
-		fread(&filter, sizeof(TextureFilter), 1, fontFile);
-
-		// Load Data.
-		bitmap = static_cast<unsigned char*>(malloc(sizeof(unsigned char) * bitmapSize));
-		fread(bitmap, sizeof(unsigned char), bitmapSize, fontFile);
-		fread(dimensions, sizeof(CharData), 94, fontFile);
-		fread(positions, sizeof(CharData), 94, fontFile);
-		fread(advances, sizeof(CharData), 94, fontFile);
-		fread(masks, sizeof(bool), 94, fontFile);
-
-		fclose(fontFile);
+		width = data.width;
+		height = data.height;
+		memcpy(dimensions, data.dimensions, sizeof(CharData) * 94);
+		memcpy(positions, data.positions, sizeof(CharData) * 94);
+		memcpy(advances, data.advances, sizeof(CharData) * 94);
+		memcpy(masks, data.masks, sizeof(bool) * 94);
 
 		// Upload data to OpenGL.
 		glGenTextures(94, textures);
 
-		unsigned char* bitmapItr = bitmap;
+		const unsigned char* bitmapItr = data.bitmap.data();
 		for (unsigned i = 0; i < 94; ++i)
 		{
 			if (!masks[i])
 				continue;
 
 			glBindTexture(GL_TEXTURE_2D, textures[i]);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, ResolveFilterMag(filter));
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, ResolveFilterMin(filter));
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, ResolveFilterMag(data.filter));
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, ResolveFilterMin(data.filter));
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
 			// Send the texture data.
 			int numLevels = 1;
-			if (ResolveMipMapping(filter))
+			if (ResolveMipMapping(data.filter))
 			{
 				float max = static_cast<float>(Max(dimensions[i].x, dimensions[i].y));
 				numLevels = static_cast<int>(std::floor(std::log2(max))) + 1;
 			}
 
 			glTexStorage2D(GL_TEXTURE_2D, numLevels, GL_R8, dimensions[i].x, dimensions[i].y);
+			for (int level = 0; level < numLevels; ++level)
+			{
+				textureBytes += Max(dimensions[i].x >> level, 1) * Max(dimensions[i].y >> level, 1);
+			}
+
 			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, dimensions[i].x, dimensions[i].y, GL_RED, GL_UNSIGNED_BYTE, bitmapItr);
 
 			if (numLevels > 1)
@@ -176,6 +209,15 @@ namespace Jwl
 		glDeleteTextures(94, textures);
 
 		memset(textures, GL_NONE, sizeof(unsigned) * 94);
+		textureBytes = 0;
+	}
+
+	MemoryUsage Font::GetMemoryUsage() const
+	{
+		MemoryUsage usage;
+		usage.gpuBytes = textureBytes;
+
+		return usage;
 	}
 
 	int Font::GetStringWidth(std::string_view text) const
@@ -2,8 +2,10 @@
 #pragma once
 #include "Resource.h"
 #include "Shareable.h"
+#include "Jewel3D/Rendering/Rendering.h"
 
 #include <string_view>
+#include <vector>
 
 namespace Jwl
 {
@@ -25,6 +27,25 @@ namespace Jwl
 		bool Load(std::string filePath);
 		void Unload();
 
+		// The decoded contents of a *.font file, ready to be uploaded.
+		struct StreamData
+		{
+			unsigned width = 0;
+			unsigned height = 0;
+			TextureFilter filter = TextureFilter::Point;
+			// Each character's bitmap, back to back.
+			std::vector<unsigned char> bitmap;
+			CharData dimensions[94] = {};
+			CharData positions[94] = {};
+			CharData advances[94] = {};
+			bool masks[94] = {};
+		};
+
+		// Reads the file from disk. Safe to call from any thread.
+		static bool Decode(std::string filePath, StreamData& out);
+		// Creates the character textures from decoded data. Must be called from the main thread.
+		bool Upload(const StreamData& data);
+
 		// Returns the real world unit width of the string.
 		// If the string is multi-line, the length of the longest line is returned.
 		int GetStringWidth(std::string_view text) const;
@@ -38,6 +59,9 @@ namespace Jwl
 		unsigned GetFontWidth() const;
 		unsigned GetFontHeight() const;
 
+		// Returns the video memory used by the character textures.
+		MemoryUsage GetMemoryUsage() const;
+
 		static unsigned GetVAO();
 		static unsigned GetVBO();
 
@@ -53,6 +77,7 @@ namespace Jwl
 		bool masks[94];
 		unsigned width  = 0;
 		unsigned height = 0;
+		size_t textureBytes = 0;
 
 		static unsigned VBO;
 		static unsigned VAO;
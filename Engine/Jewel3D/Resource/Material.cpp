@@ -1,8 +1,10 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Jewel3D/Precompiled.h"
 #include "Material.h"
+#include "Jewel3D/Application/FileSystem.h"
 #include "Jewel3D/Application/Logging.h"
-#include "Jewel3D/Utilities/ScopeGuard.h"
+#include "Jewel3D/Application/Profiler.h"
+#include "Jewel3D/Utilities/BinaryReader.h"
 #include "Jewel3D/Utilities/String.h"
 
 #include <Dirent/dirent.h>
@@ -11,6 +13,8 @@ namespace Jwl
 {
 	bool Material::Load(std::string filePath)
 	{
+		PROFILE_SCOPE("Material::Load");
+
 		auto ext = ExtractFileExtension(filePath);
 		if (ext.empty())
 		{
@@ -23,42 +27,51 @@ namespace Jwl
 		}
 
 		// Load binary file.
-		FILE* binaryFile = fopen(filePath.c_str(), "rb");
-		if (binaryFile == nullptr)
+		FileView file;
+		if (!file.Open(filePath))
 		{
 			Error("Material: ( %s )\nUnable to open file.", filePath.c_str());
 			return false;
 		}
-		defer{ fclose(binaryFile); };
 
-		char pathBuffer[MAX_PATH + 1];
+		BinaryReader reader(file.GetData(), file.GetSize());
 
 		size_t shaderLen = 0;
-		fread(&shaderLen, sizeof(size_t), 1, binaryFile);
+		if (!reader.Read(shaderLen))
+		{
+			Error("Material: ( %s )\nFile is missing data.", filePath.c_str());
+			return false;
+		}
+
 		if (shaderLen == 0)
 		{
 			shader = Shader::MakeNewPassThrough();
 		}
 		else
 		{
-			if (shaderLen > MAX_PATH)
+			const unsigned char* shaderPath = reader.ReadBytes(shaderLen);
+			if (shaderLen > MAX_PATH || shaderPath == nullptr)
 			{
 				Error("Material: ( %s )\nInvalid Shader file path length.", filePath.c_str());
 				return false;
 			}
-			fread(pathBuffer, sizeof(char), shaderLen, binaryFile);
-			pathBuffer[shaderLen] = '\0';
 
-			shader = Jwl::Load<Shader>(pathBuffer);
+			const std::string shaderFile(reinterpret_cast<const char*>(shaderPath), shaderLen);
+			shader = Jwl::Load<Shader>(shaderFile);
 			if (!shader)
 			{
-				Error("Material: ( %s )\nFailed to load Shader ( %s ).", filePath.c_str(), pathBuffer);
+				Error("Material: ( %s )\nFailed to load Shader ( %s ).", filePath.c_str(), shaderFile.c_str());
 				return false;
 			}
 		}
 
 		size_t textureCount = 0;
-		fread(&textureCount, sizeof(size_t), 1, binaryFile);
+		if (!reader.Read(textureCount))
+		{
+			Error("Material: ( %s )\nFile is missing data.", filePath.c_str());
+			return false;
+		}
+
 		if (textureCount > GPUInfo.GetMaxTextureSlots())
 		{
 			Error("Material: ( %s )\nMaterial contains more texture units than is supported ( %d ).", filePath.c_str(), GPUInfo.GetMaxTextureSlots());
@@ -68,32 +81,55 @@ namespace Jwl
 		for (size_t i = 0; i < textureCount; ++i)
 		{
 			int unit = 0;
-			fread(&unit, sizeof(int), 1, binaryFile);
-
 			size_t textureLen = 0;
-			fread(&textureLen, sizeof(size_t), 1, binaryFile);
-			if (textureLen == 0 || textureLen > MAX_PATH)
+			if (!reader.Read(unit) || !reader.Read(textureLen))
 			{
-				Error("Material: ( %s )\nInvalid Texture file path length.", filePath.c_str());
+				Error("Material: ( %s )\nFile is missing data.", filePath.c_str());
 				return false;
 			}
 
-			fread(pathBuffer, sizeof(char), textureLen, binaryFile);
-			pathBuffer[textureLen] = '\0';
+			const unsigned char* texturePath = reader.ReadBytes(textureLen);
+			if (textureLen == 0 || textureLen > MAX_PATH || texturePath == nullptr)
+			{
+				Error("Material: ( %s )\nInvalid Texture file path length.", filePath.c_str());
+				return false;
+			}
 
-			auto texture = Jwl::Load<Texture>(pathBuffer);
+			const std::string textureFile(reinterpret_cast<const char*>(texturePath), textureLen);
+			auto texture = Jwl::Load<Texture>(textureFile);
 			if (!texture)
 			{
-				Error("Material: ( %s )\nFailed to load Texture ( %s ).", filePath.c_str(), pathBuffer);
+				Error("Material: ( %s )\nFailed to load Texture ( %s ).", filePath.c_str(), textureFile.c_str());
 				return false;
 			}
 
 			textures.Add(std::move(texture), unit);
 		}
 
-		fread(&blendMode, sizeof(BlendFunc), 1, binaryFile);
-		fread(&depthMode, sizeof(DepthFunc), 1, binaryFile);
-		fread(&cullMode, sizeof(CullFunc), 1, binaryFile);
+		if (!reader.Read(blendMode) ||
+			!reader.Read(depthMode) ||
+			!reader.Read(cullMode))
+		{
+			Error("Material: ( %s )\nFile is missing data.", filePath.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool Material::Reload(std::string filePath)
+	{
+		Material reloaded;
+		if (!reloaded.Load(std::move(filePath)))
+		{
+			return false;
+		}
+
+		blendMode = reloaded.blendMode;
+		depthMode = reloaded.depthMode;
+		cullMode = reloaded.cullMode;
+		shader = std::move(reloaded.shader);
+		textures = std::move(reloaded.textures);
 
 		return true;
 	}
@@ -18,6 +18,9 @@ namespace Jwl
 		Material() = default;
 
 		bool Load(std::string filePath);
+		// Loads the file again and replaces the settings, shader, and textures of the material.
+		// If the file fails to load, the material is left unchanged and false is returned.
+		bool Reload(std::string filePath);
 
 		BlendFunc blendMode = BlendFunc::None;
 		DepthFunc depthMode = DepthFunc::Normal;
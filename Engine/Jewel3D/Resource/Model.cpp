@@ -2,9 +2,57 @@
 #include "Jewel3D/Precompiled.h"
 #include "Model.h"
 #include "Jewel3D/Application/Logging.h"
-#include "Jewel3D/Utilities/ScopeGuard.h"
+#include "Jewel3D/Application/Profiler.h"
+#include "Jewel3D/Utilities/BinaryReader.h"
 #include "Jewel3D/Utilities/String.h"
 
+#include <algorithm>
+
+namespace
+{
+	// Returns the size of an attribute with the given number of components, or 0 if the encoding is not supported.
+	unsigned GetAttributeSize(Jwl::VertexEncoding encoding, unsigned components)
+	{
+		switch (encoding)
+		{
+		case Jwl::VertexEncoding::Float:
+			return sizeof(float) * components;
+
+		case Jwl::VertexEncoding::Half:
+			return components == 2 ? sizeof(unsigned short) * 2 : 0;
+
+		case Jwl::VertexEncoding::Unorm16:
+			// Three components are padded to four to stay 4-byte aligned.
+			return components == 2 ? sizeof(unsigned short) * 2 : sizeof(unsigned short) * 4;
+
+		case Jwl::VertexEncoding::Snorm10:
+			return components >= 3 ? sizeof(unsigned) : 0;
+		}
+
+		return 0;
+	}
+
+	Jwl::VertexFormat GetAttributeFormat(Jwl::VertexEncoding encoding, unsigned components)
+	{
+		switch (encoding)
+		{
+		case Jwl::VertexEncoding::Half:
+			return Jwl::VertexFormat::HalfVec2;
+
+		case Jwl::VertexEncoding::Unorm16:
+			return components == 2 ? Jwl::VertexFormat::uShortVec2 : Jwl::VertexFormat::uShortVec4;
+
+		case Jwl::VertexEncoding::Snorm10:
+			return Jwl::VertexFormat::Int_2_10_10_10;
+
+		default:
+			if (components == 2) return Jwl::VertexFormat::Vec2;
+			if (components == 3) return Jwl::VertexFormat::Vec3;
+			return Jwl::VertexFormat::Vec4;
+		}
+	}
+}
+
 namespace Jwl
 {
 	bool Model::Load(std::string filePath)
@@ -14,6 +62,14 @@ namespace Jwl
 
 	bool Model::Load(std::string filePath, VertexBufferUsage usage)
 	{
+		StreamData data;
+		return Decode(std::move(filePath), data) && Upload(data, usage);
+	}
+
+	bool Model::Decode(std::string filePath, StreamData& out)
+	{
+		PROFILE_SCOPE("Model::Decode");
+
 		auto ext = ExtractFileExtension(filePath);
 		if (ext.empty())
 		{
@@ -25,90 +81,268 @@ namespace Jwl
 			return false;
 		}
 
-		// Load binary file.
-		FILE* binaryFile = fopen(filePath.c_str(), "rb");
-		if (binaryFile == nullptr)
+		// Map the file so that the vertex data can be uploaded without an intermediate copy.
+		FileView file;
+		if (!file.Open(filePath))
 		{
 			Error("Model: ( %s )\nUnable to open file.", filePath.c_str());
 			return false;
 		}
-		defer { fclose(binaryFile); };
 
-		int numVertices;
-		fread(&minBounds, sizeof(vec3), 1, binaryFile);
-		fread(&maxBounds, sizeof(vec3), 1, binaryFile);
-		fread(&hasUvs, sizeof(bool), 1, binaryFile);
-		fread(&hasNormals, sizeof(bool), 1, binaryFile);
-		fread(&hasTangents, sizeof(bool), 1, binaryFile);
-		fread(&numVertices, sizeof(int), 1, binaryFile);
+		if (!Parse(std::move(file), out, filePath))
+		{
+			return false;
+		}
+
+		// Load the whole file from disk now, so that the main thread does not stall on it during the upload.
+		out.file.Prefetch();
+
+		return true;
+	}
+
+	bool Model::Parse(FileView file, StreamData& out, std::string_view name)
+	{
+		out.file = std::move(file);
+
+		BinaryReader reader(out.file.GetData(), out.file.GetSize());
+
+		char magic[4];
+		unsigned version = 0;
+		if (!reader.Read(magic) ||
+			memcmp(magic, MODEL_MAGIC, sizeof(MODEL_MAGIC)) != 0 ||
+			!reader.Read(version) ||
+			version != MODEL_VERSION)
+		{
+			Error("Model: ( %s )\nNot a valid model, or was created by a different version of the MeshEncoder.", name.data());
+			return false;
+		}
+
+		int numLods = 0;
+		if (!reader.Read(out.minBounds) ||
+			!reader.Read(out.maxBounds) ||
+			!reader.Read(out.hasUvs) ||
+			!reader.Read(out.hasNormals) ||
+			!reader.Read(out.hasTangents) ||
+			!reader.Read(out.positionEncoding) ||
+			!reader.Read(out.uvEncoding) ||
+			!reader.Read(out.normalEncoding) ||
+			!reader.Read(out.numVertices) ||
+			!reader.Read(out.numIndices) ||
+			!reader.Read(numLods) ||
+			out.numVertices < 0 ||
+			out.numIndices < 0 ||
+			numLods < 0 ||
+			static_cast<size_t>(numLods) > reader.GetRemaining() / sizeof(Lod))
+		{
+			Error("Model: ( %s )\nFile has an invalid header.", name.data());
+			return false;
+		}
+
+		out.lods.resize(static_cast<size_t>(numLods));
+		for (auto& lod : out.lods)
+		{
+			if (!reader.Read(lod.firstIndex) ||
+				!reader.Read(lod.indexCount) ||
+				!reader.Read(lod.error) ||
+				lod.firstIndex > static_cast<unsigned>(out.numIndices) ||
+				lod.indexCount > static_cast<unsigned>(out.numIndices) - lod.firstIndex)
+			{
+				Error("Model: ( %s )\nFile has an invalid level of detail.", name.data());
+				return false;
+			}
+		}
 
 		// Determine mesh properties.
-		int bufferSize = numVertices * 3;
-		int stride = sizeof(float) * 3;
-		if (hasUvs)
+		const unsigned vertexSize = GetVertexSize(out);
+		if (vertexSize == 0)
 		{
-			bufferSize += numVertices * 2;
-			stride += sizeof(float) * 2;
+			Error("Model: ( %s )\nFile has an unsupported vertex encoding.", name.data());
+			return false;
 		}
-		if (hasNormals)
+
+		// The sizes are computed in 64 bits, then checked against the file, so that a corrupt header cannot wrap them around.
+		out.indexFormat = out.numVertices <= 0x10000 ? IndexFormat::uShort : IndexFormat::uInt;
+		const uint64_t verticesSize = static_cast<uint64_t>(vertexSize) * static_cast<uint64_t>(out.numVertices);
+		const uint64_t indicesSize = static_cast<uint64_t>(CountBytes(out.indexFormat)) * static_cast<uint64_t>(out.numIndices);
+
+		// The vertex data is used in place. It is not aligned, so it must only be accessed with memcpy.
+		out.verticesSize = static_cast<size_t>(verticesSize);
+		out.vertices = verticesSize <= reader.GetRemaining() ? reader.ReadBytes(out.verticesSize) : nullptr;
+		if (out.vertices == nullptr)
 		{
-			bufferSize += numVertices * 3;
-			stride += sizeof(float) * 3;
+			Error("Model: ( %s )\nFile is missing vertex data.", name.data());
+			return false;
 		}
-		if (hasTangents)
+
+		out.indicesSize = static_cast<size_t>(indicesSize);
+		out.indices = indicesSize <= reader.GetRemaining() ? reader.ReadBytes(out.indicesSize) : nullptr;
+		if (out.indices == nullptr)
+		{
+			Error("Model: ( %s )\nFile is missing index data.", name.data());
+			return false;
+		}
+
+		// Out of range indices would read past the end of the vertex buffer.
+		const bool isShort = out.indexFormat == IndexFormat::uShort;
+		for (size_t i = 0; i < static_cast<size_t>(out.numIndices); ++i)
 		{
-			bufferSize += numVertices * 4;
-			stride += sizeof(float) * 4;
+			unsigned index = 0;
+			if (isShort)
+			{
+				unsigned short shortIndex;
+				memcpy(&shortIndex, out.indices + i * sizeof(unsigned short), sizeof(unsigned short));
+				index = shortIndex;
+			}
+			else
+			{
+				memcpy(&index, out.indices + i * sizeof(unsigned), sizeof(unsigned));
+			}
+
+			if (index >= static_cast<unsigned>(out.numVertices))
+			{
+				Error("Model: ( %s )\nFile has an index that is out of range.", name.data());
+				return false;
+			}
 		}
 
-		auto buffer = VertexBuffer::MakeNew(sizeof(float) * bufferSize, usage);
+		return true;
+	}
+
+	bool Model::Upload(const StreamData& data)
+	{
+		return Upload(data, VertexBufferUsage::Static);
+	}
+
+	bool Model::Upload(const StreamData& data, VertexBufferUsage usage)
+	{
+		PROFILE_SCOPE("Model::Upload");
 
-		// Read the data buffer from the file.
-		void* data = buffer->MapBuffer(VertexAccess::WriteOnly);
-		fread(data, sizeof(float), bufferSize, binaryFile);
+		minBounds = data.minBounds;
+		maxBounds = data.maxBounds;
+		hasUvs = data.hasUvs;
+		hasNormals = data.hasNormals;
+		hasTangents = data.hasTangents;
+		lods = data.lods;
+
+		const unsigned stride = GetVertexSize(data);
+		const unsigned bufferSize = static_cast<unsigned>(data.verticesSize);
+		auto buffer = VertexBuffer::MakeNew(bufferSize, usage);
+
+		// Copy straight from the mapped file into the buffer's storage.
+		void* bufferData = buffer->MapBuffer(VertexAccess::WriteOnly);
+		memcpy(bufferData, data.vertices, bufferSize);
 		buffer->UnmapBuffer();
 
 		// Enable vertex attribute streams.
 		VertexStream stream = {};
 		stream.buffer       = std::move(buffer);
 		stream.bindingUnit  = 0;
-		stream.format       = VertexFormat::Vec3;
-		stream.normalized   = false;
+		stream.format       = GetAttributeFormat(data.positionEncoding, 3);
+		stream.normalized   = data.positionEncoding == VertexEncoding::Unorm16;
 		stream.startOffset  = 0;
 		stream.stride       = stride;
 
 		AddStream(stream);
-		stream.startOffset += sizeof(float) * 3;
+		stream.startOffset += GetAttributeSize(data.positionEncoding, 3);
 
 		if (hasUvs)
 		{
 			stream.bindingUnit = 1;
-			stream.format = VertexFormat::Vec2;
+			stream.format = GetAttributeFormat(data.uvEncoding, 2);
+			stream.normalized = data.uvEncoding == VertexEncoding::Unorm16;
 
 			AddStream(stream);
-			stream.startOffset += sizeof(float) * 2;
+			stream.startOffset += GetAttributeSize(data.uvEncoding, 2);
 		}
 		if (hasNormals)
 		{
 			stream.bindingUnit = 2;
-			stream.format = VertexFormat::Vec3;
+			stream.format = GetAttributeFormat(data.normalEncoding, 3);
+			stream.normalized = data.normalEncoding == VertexEncoding::Snorm10;
 
 			AddStream(stream);
-			stream.startOffset += sizeof(float) * 3;
+			stream.startOffset += GetAttributeSize(data.normalEncoding, 3);
 		}
 		if (hasTangents)
 		{
 			stream.bindingUnit = 3;
-			stream.format = VertexFormat::Vec4;
+			stream.format = GetAttributeFormat(data.normalEncoding, 4);
+			stream.normalized = data.normalEncoding == VertexEncoding::Snorm10;
 
 			AddStream(stream);
 		}
 
-		SetVertexCount(numVertices);
+		// Quantized positions are expanded back to local-space by the model transform.
+		if (data.positionEncoding == VertexEncoding::Unorm16)
+		{
+			SetPositionTransform(mat4(mat3::Identity, minBounds, GetQuantizationScale(minBounds, maxBounds)));
+		}
+
+		if (data.numIndices > 0)
+		{
+			auto indexBuffer = IndexBuffer::MakeNew(static_cast<unsigned>(data.numIndices), data.indexFormat, usage);
+
+			void* indexData = indexBuffer->MapBuffer(VertexAccess::WriteOnly);
+			memcpy(indexData, data.indices, data.indicesSize);
+			indexBuffer->UnmapBuffer();
+
+			SetIndexBuffer(std::move(indexBuffer));
+		}
+
+		SetVertexCount(data.numVertices);
 
 		return true;
 	}
 
+	bool Model::Reload(const StreamData& data)
+	{
+		const VertexBufferUsage usage = HasStream(0) ? GetBuffer(0).GetBufferUsage() : VertexBufferUsage::Static;
+
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			if (HasStream(i))
+			{
+				RemoveStream(i);
+			}
+		}
+
+		RemoveIndexBuffer();
+		RemovePositionTransform();
+
+		return Upload(data, usage);
+	}
+
+	unsigned Model::GetVertexSize(const StreamData& data)
+	{
+		const bool validPosition = data.positionEncoding == VertexEncoding::Float || data.positionEncoding == VertexEncoding::Unorm16;
+		const bool validUvs = data.uvEncoding == VertexEncoding::Float || data.uvEncoding == VertexEncoding::Half || data.uvEncoding == VertexEncoding::Unorm16;
+		const bool validNormals = data.normalEncoding == VertexEncoding::Float || data.normalEncoding == VertexEncoding::Snorm10;
+
+		if (!validPosition ||
+			(data.hasUvs && !validUvs) ||
+			((data.hasNormals || data.hasTangents) && !validNormals))
+		{
+			return 0;
+		}
+
+		unsigned size = GetAttributeSize(data.positionEncoding, 3);
+		if (data.hasUvs) size += GetAttributeSize(data.uvEncoding, 2);
+		if (data.hasNormals) size += GetAttributeSize(data.normalEncoding, 3);
+		if (data.hasTangents) size += GetAttributeSize(data.normalEncoding, 4);
+
+		return size;
+	}
+
+	vec3 Model::GetQuantizationScale(const vec3& minBounds, const vec3& maxBounds)
+	{
+		vec3 scale = maxBounds - minBounds;
+		if (scale.x <= 0.0f) scale.x = 1.0f;
+		if (scale.y <= 0.0f) scale.y = 1.0f;
+		if (scale.z <= 0.0f) scale.z = 1.0f;
+
+		return scale;
+	}
+
 	const vec3& Model::GetMinBounds() const
 	{
 		return minBounds;
@@ -133,4 +367,33 @@ namespace Jwl
 	{
 		return hasTangents;
 	}
+
+	const std::vector<Model::Lod>& Model::GetLods() const
+	{
+		return lods;
+	}
+
+	MemoryUsage Model::GetMemoryUsage() const
+	{
+		MemoryUsage usage;
+		usage.cpuBytes = lods.size() * sizeof(Lod);
+
+		// Streams often share one interleaved buffer, which should only be counted once.
+		std::vector<const VertexBuffer*> buffers;
+		for (auto& stream : GetStreams())
+		{
+			if (std::find(buffers.begin(), buffers.end(), stream.buffer.get()) == buffers.end())
+			{
+				buffers.push_back(stream.buffer.get());
+				usage.gpuBytes += stream.buffer->GetSize();
+			}
+		}
+
+		if (HasIndexBuffer())
+		{
+			usage.gpuBytes += GetIndexBuffer().GetSize();
+		}
+
+		return usage;
+	}
 }
@@ -6,6 +6,23 @@
 
 namespace Jwl
 {
+	// Every *.model file begins with these, so that files written by other versions of the MeshEncoder are rejected.
+	constexpr char MODEL_MAGIC[4] = { 'J', 'W', 'M', 'D' };
+	constexpr unsigned MODEL_VERSION = 1;
+
+	// How a vertex attribute is stored in a *.model file.
+	enum class VertexEncoding : unsigned char
+	{
+		// 32-bit floats.
+		Float,
+		// 16-bit floats. Used for UVs.
+		Half,
+		// 16-bit integers normalized to [0, 1]. Positions are relative to the model's bounds.
+		Unorm16,
+		// Three 10-bit integers normalized to [-1, 1], packed with a 2-bit w component. Used for normals and tangents.
+		Snorm10
+	};
+
 	// A 3D model resource. Can be attached to an Entity's Mesh component.
 	//
 	// Provides the following attributes and bindings:
@@ -20,6 +37,60 @@ namespace Jwl
 		bool Load(std::string filePath);
 		bool Load(std::string filePath, VertexBufferUsage usage);
 
+		// A simplified version of the model, stored as a range of the index buffer.
+		struct Lod
+		{
+			unsigned firstIndex = 0;
+			unsigned indexCount = 0;
+			// The approximate distance that the surface deviates from the full-detail model, in local-space.
+			float error = 0.0f;
+		};
+
+		// The decoded contents of a *.model file, ready to be uploaded.
+		struct StreamData
+		{
+			vec3 minBounds;
+			vec3 maxBounds;
+			bool hasUvs = false;
+			bool hasNormals = false;
+			bool hasTangents = false;
+			VertexEncoding positionEncoding = VertexEncoding::Float;
+			VertexEncoding uvEncoding = VertexEncoding::Float;
+			// Shared by normals and tangents.
+			VertexEncoding normalEncoding = VertexEncoding::Float;
+			int numVertices = 0;
+			int numIndices = 0;
+			// Interleaved position, uv, normal, and tangent attributes. Points into 'file'.
+			const unsigned char* vertices = nullptr;
+			size_t verticesSize = 0;
+			// Triangle indices. 16-bit when every vertex can be addressed by one, otherwise 32-bit. Points into 'file'.
+			const unsigned char* indices = nullptr;
+			size_t indicesSize = 0;
+			IndexFormat indexFormat = IndexFormat::uShort;
+			// Each level of detail, starting with the full-detail model.
+			std::vector<Lod> lods;
+			// Keeps the vertex data alive until it is uploaded.
+			FileView file;
+		};
+
+		// Maps the file from disk. Safe to call from any thread.
+		static bool Decode(std::string filePath, StreamData& out);
+		// Reads the contents of a *.model file that is already in memory, such as an entry in an archive.
+		// The view is kept in 'out' so that the data remains valid until it is uploaded.
+		static bool Parse(FileView file, StreamData& out, std::string_view name);
+		// Creates the vertex buffer from decoded data. Must be called from the main thread.
+		bool Upload(const StreamData& data);
+		bool Upload(const StreamData& data, VertexBufferUsage usage);
+		// Replaces the contents of a loaded model with newly decoded data, keeping the usage of the previous buffers.
+		// Used to apply changes to the model's file while it is in use. Must be called from the main thread.
+		bool Reload(const StreamData& data);
+
+		// Returns the size of one vertex with the given attributes, or 0 if an attribute does not support its encoding.
+		static unsigned GetVertexSize(const StreamData& data);
+		// Returns the scale that maps positions encoded as Unorm16 back to local-space.
+		// Axes with no extent use a scale of 1 so that the mapping can be inverted.
+		static vec3 GetQuantizationScale(const vec3& minBounds, const vec3& maxBounds);
+
 		// Returns the extents of each axis in local-space.
 		const vec3& GetMinBounds() const;
 		const vec3& GetMaxBounds() const;
@@ -28,6 +99,13 @@ namespace Jwl
 		bool HasNormals() const;
 		bool HasTangents() const;
 
+		// Level 0 is the full-detail model, and each following level is simpler than the last.
+		// Models without an index buffer have no levels of detail.
+		const std::vector<Lod>& GetLods() const;
+
+		// Returns the size of the vertex and index buffers.
+		MemoryUsage GetMemoryUsage() const;
+
 	private:
 		vec3 minBounds;
 		vec3 maxBounds;
@@ -35,5 +113,7 @@ namespace Jwl
 		bool hasUvs = false;
 		bool hasNormals = false;
 		bool hasTangents = false;
+
+		std::vector<Lod> lods;
 	};
 }
@@ -1,6 +1,7 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Jewel3D/Precompiled.h"
 #include "ParticleBuffer.h"
+#include "Jewel3D/Application/FrameStats.h"
 #include "Jewel3D/Application/Logging.h"
 #include "Jewel3D/Math/Vector.h"
 
@@ -246,39 +247,47 @@ namespace Jwl
 		void* buffer = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
 
 		memcpy(buffer, &positions[0], sizeof(vec3) * _numParticles);
+		size_t bytes = sizeof(vec3) * _numParticles;
 		buffer = static_cast<vec3*>(buffer) + numParticles;
 
 		if (buffers.Has(ParticleBuffers::Size))
 		{
 			memcpy(buffer, sizes, sizeof(vec2) * _numParticles);
+			bytes += sizeof(vec2) * _numParticles;
 			buffer = static_cast<vec2*>(buffer) + numParticles;
 		}
 
 		if (buffers.Has(ParticleBuffers::Color))
 		{
 			memcpy(buffer, colors, sizeof(vec3) * _numParticles);
+			bytes += sizeof(vec3) * _numParticles;
 			buffer = static_cast<vec3*>(buffer) + numParticles;
 		}
 
 		if (buffers.Has(ParticleBuffers::Alpha))
 		{
 			memcpy(buffer, alphas, sizeof(float) * _numParticles);
+			bytes += sizeof(float) * _numParticles;
 			buffer = static_cast<float*>(buffer) + numParticles;
 		}
 
 		if (buffers.Has(ParticleBuffers::Rotation))
 		{
 			memcpy(buffer, rotations, sizeof(float) * _numParticles);
+			bytes += sizeof(float) * _numParticles;
 			buffer = static_cast<float*>(buffer) + numParticles;
 		}
 
 		if (buffers.Has(ParticleBuffers::AgeRatio))
 		{
 			memcpy(buffer, ageRatios, sizeof(float) * _numParticles);
+			bytes += sizeof(float) * _numParticles;
 		}
 
 		glUnmapBuffer(GL_ARRAY_BUFFER);
 		glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+
+		FrameStats.CountUpload(bytes);
 	}
 
 	void ParticleBuffer::Kill(unsigned index, unsigned last)
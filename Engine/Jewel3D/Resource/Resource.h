@@ -1,16 +1,102 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include "AssetStreamer.h"
 #include "Jewel3D/Application/FileSystem.h"
 #include "Jewel3D/Application/Logging.h"
 #include "Jewel3D/Utilities/Container.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace Jwl
 {
 	extern std::string RootAssetDirectory;
 
+	// The memory held by an asset. Resources report this by hiding Resource<Asset>::GetMemoryUsage() with their own version.
+	struct MemoryUsage
+	{
+		// System memory, including buffers owned by the audio driver.
+		size_t cpuBytes = 0;
+		// Video memory, such as textures and vertex buffers.
+		size_t gpuBytes = 0;
+	};
+
+	// A snapshot of the cache of one type of asset, returned by Resource<Asset>::GetStats().
+	struct ResourceStats
+	{
+		// The number of cached assets, and how many of those are not used outside of the cache.
+		unsigned count = 0;
+		unsigned unreferencedCount = 0;
+		size_t cpuBytes = 0;
+		size_t gpuBytes = 0;
+		size_t budget = 0;
+		// Loads that were served by the cache or by a load that was already streaming.
+		unsigned hits = 0;
+		// Loads that had to read the asset from disk.
+		unsigned misses = 0;
+		// Assets released to stay within the budget or by EvictUnused().
+		unsigned evictions = 0;
+	};
+
+	enum class CachePolicy
+	{
+		// Assets stay in the cache until they are evicted or UnloadAll() is called.
+		Strong,
+		// The cache does not keep assets alive. They are released as soon as they are no longer used elsewhere.
+		Weak
+	};
+
+	// A handle to an asset being loaded in the background by Resource<Asset>::LoadAsync().
+	template<class Asset>
+	class AsyncLoad
+	{
+		template<class> friend class Resource;
+	public:
+		AsyncLoad() = default;
+
+		// Returns true once the asset has finished loading and can be used.
+		bool IsReady() const
+		{
+			return asset && (!request || request->GetStatus() == StreamStatus::Ready);
+		}
+
+		// Returns true if the asset could not be loaded.
+		bool IsFailed() const
+		{
+			return request && request->GetStatus() == StreamStatus::Failed;
+		}
+
+		// Returns true once the load has either succeeded or failed.
+		bool IsFinished() const
+		{
+			return IsReady() || IsFailed();
+		}
+
+		// Returns the asset if it is ready, otherwise nullptr.
+		std::shared_ptr<Asset> Get() const
+		{
+			return IsReady() ? asset : nullptr;
+		}
+
+		// Blocks until the asset has loaded, then returns it. Returns nullptr if the load failed.
+		std::shared_ptr<Asset> Wait()
+		{
+			if (request)
+			{
+				AssetStreamer.Finish(*request);
+			}
+
+			return Get();
+		}
+
+	private:
+		std::shared_ptr<StreamRequest> request;
+		std::shared_ptr<Asset> asset;
+	};
+
 	// Base resource class. Provides an interface for cached loading.
 	template<class Asset>
 	class Resource
@@ -27,22 +113,26 @@ namespace Jwl
 		template<typename... Args>
 		static std::shared_ptr<Asset> Load(std::string filePath, Args&&... params)
 		{
-			if (IsPathRelative(filePath))
-			{
-				filePath = RootAssetDirectory + filePath;
-			}
-			else
-			{
-				Warning("Asset loaded with an absolute path. To ensure proper asset caching, it is recommended to use only relative paths.");
-			}
+			ResolvePath(filePath);
 
 			// Search for the cached asset.
 			if (auto ptr = Find(filePath))
 			{
+				++stats.hits;
 				return ptr;
 			}
 
+			// If the asset is already streaming in the background, we complete it immediately.
+			auto itr = pendingLoads.find(filePath);
+			if (itr != pendingLoads.end())
+			{
+				++stats.hits;
+				AsyncLoad<Asset> handle = itr->second;
+				return handle.Wait();
+			}
+
 			// Create the new asset.
+			++stats.misses;
 			auto resourcePtr = std::make_shared<Asset>();
 
 			if (!resourcePtr->Load(filePath, std::forward<Args>(params)...))
@@ -52,12 +142,47 @@ namespace Jwl
 			}
 
 			// Add new asset to cache.
-			resourceCache.insert(std::pair(std::move(filePath), resourcePtr));
+			Insert(std::move(filePath), resourcePtr);
 
 			return resourcePtr;
 		}
 
+		// Begins loading an asset from the specified file in the background, if it wasn't loaded already.
+		// The file is read by an I/O worker thread and the asset is uploaded by the main thread during a later frame.
+		// Requests for a file that is already streaming share the same load.
+		// The derived class must provide a StreamData type along with Decode() and Upload() functions.
+		static AsyncLoad<Asset> LoadAsync(std::string filePath)
+		{
+			ResolvePath(filePath);
+
+			AsyncLoad<Asset> handle;
+			if (auto ptr = Find(filePath))
+			{
+				++stats.hits;
+				handle.asset = std::move(ptr);
+				return handle;
+			}
+
+			auto itr = pendingLoads.find(filePath);
+			if (itr != pendingLoads.end())
+			{
+				++stats.hits;
+				return itr->second;
+			}
+
+			++stats.misses;
+			auto request = std::make_shared<Request>(filePath);
+			handle.request = request;
+			handle.asset = request->asset;
+			pendingLoads.emplace(std::move(filePath), handle);
+
+			AssetStreamer.Submit(std::move(request));
+
+			return handle;
+		}
+
 		// Searches for a loaded asset previously loaded from the specified file path.
+		// The asset is marked as recently used, which delays its eviction.
 		static std::shared_ptr<Asset> Find(std::string_view filePath)
 		{
 			auto itr = resourceCache.find(filePath);
@@ -65,9 +190,29 @@ namespace Jwl
 			{
 				return nullptr;
 			}
-			else
+
+			// Weakly cached assets might have been released since they were added.
+			auto ptr = itr->second.weakAsset.lock();
+			if (!ptr)
 			{
-				return itr->second;
+				resourceCache.erase(itr);
+				return nullptr;
+			}
+
+			itr->second.lastUsed = ++useCounter;
+			return ptr;
+		}
+
+		// Calls 'func' with the file path and the asset of each cached asset.
+		// Assets must not be loaded or unloaded until the iteration is complete.
+		template<typename Func>
+		static void ForEach(Func&& func)
+		{
+			RemoveExpired();
+
+			for (auto& [path, entry] : resourceCache)
+			{
+				func(path, entry.weakAsset.lock());
 			}
 		}
 
@@ -77,12 +222,251 @@ namespace Jwl
 			resourceCache.clear();
 		}
 
+		// Sets the combined CPU and GPU bytes that the cached assets may use. When the budget is exceeded, assets that are
+		// not used outside of the cache are evicted, least recently used first. Assets in use are never evicted, so the
+		// budget can still be exceeded. The budget is checked whenever an asset is added to the cache.
+		static void SetBudget(size_t bytes)
+		{
+			budget = bytes;
+			Trim();
+		}
+
+		static size_t GetBudget()
+		{
+			return budget;
+		}
+
+		static void SetCachePolicy(CachePolicy policy)
+		{
+			cachePolicy = policy;
+
+			for (auto& [path, entry] : resourceCache)
+			{
+				entry.asset = policy == CachePolicy::Strong ? entry.weakAsset.lock() : nullptr;
+			}
+
+			RemoveExpired();
+		}
+
+		static CachePolicy GetCachePolicy()
+		{
+			return cachePolicy;
+		}
+
+		// Evicts every asset that is not used outside of the cache, such as when changing levels.
+		// Returns the number of assets evicted.
+		static unsigned EvictUnused()
+		{
+			RemoveExpired();
+
+			unsigned count = 0;
+			for (auto itr = resourceCache.begin(); itr != resourceCache.end();)
+			{
+				if (IsUnreferenced(itr->second))
+				{
+					itr = resourceCache.erase(itr);
+					++count;
+				}
+				else
+				{
+					++itr;
+				}
+			}
+
+			stats.evictions += count;
+			return count;
+		}
+
+		// Returns the current memory usage of the cache, along with counters that are kept since the start of the program.
+		static ResourceStats GetStats()
+		{
+			RemoveExpired();
+
+			ResourceStats result = stats;
+			result.count = static_cast<unsigned>(resourceCache.size());
+			result.budget = budget;
+
+			for (auto& [path, entry] : resourceCache)
+			{
+				const MemoryUsage usage = entry.weakAsset.lock()->GetMemoryUsage();
+				result.cpuBytes += usage.cpuBytes;
+				result.gpuBytes += usage.gpuBytes;
+				result.unreferencedCount += IsUnreferenced(entry);
+			}
+
+			return result;
+		}
+
+		// Returns the memory held by the asset. This default is used by assets that do not report their usage.
+		MemoryUsage GetMemoryUsage() const
+		{
+			return {};
+		}
+
 	private:
-		static std::unordered_map<std::string, std::shared_ptr<Asset>, string_hash, std::equal_to<>> resourceCache;
+		struct CacheEntry
+		{
+			// Keeps the asset alive. Empty when the cache policy is weak.
+			std::shared_ptr<Asset> asset;
+			std::weak_ptr<Asset> weakAsset;
+			// The value of 'useCounter' when the asset was last loaded or found.
+			uint64_t lastUsed = 0;
+		};
+
+		static void Insert(std::string filePath, std::shared_ptr<Asset> asset)
+		{
+			CacheEntry entry;
+			entry.weakAsset = asset;
+			entry.lastUsed = ++useCounter;
+			if (cachePolicy == CachePolicy::Strong)
+			{
+				entry.asset = std::move(asset);
+			}
+
+			resourceCache.insert_or_assign(std::move(filePath), std::move(entry));
+			Trim();
+		}
+
+		// Whether the cache holds the only reference to the asset.
+		static bool IsUnreferenced(const CacheEntry& entry)
+		{
+			return entry.asset && entry.asset.use_count() == 1;
+		}
+
+		// Removes weakly cached assets that have been released.
+		static void RemoveExpired()
+		{
+			for (auto itr = resourceCache.begin(); itr != resourceCache.end();)
+			{
+				if (itr->second.weakAsset.expired())
+				{
+					itr = resourceCache.erase(itr);
+				}
+				else
+				{
+					++itr;
+				}
+			}
+		}
+
+		// Evicts unreferenced assets, least recently used first, until the cache is within its budget.
+		static void Trim()
+		{
+			if (budget == SIZE_MAX)
+			{
+				return;
+			}
+
+			RemoveExpired();
+
+			size_t total = 0;
+			std::vector<typename decltype(resourceCache)::iterator> candidates;
+			for (auto itr = resourceCache.begin(); itr != resourceCache.end(); ++itr)
+			{
+				const MemoryUsage usage = itr->second.weakAsset.lock()->GetMemoryUsage();
+				total += usage.cpuBytes + usage.gpuBytes;
+
+				if (IsUnreferenced(itr->second))
+				{
+					candidates.push_back(itr);
+				}
+			}
+
+			std::sort(candidates.begin(), candidates.end(), [](auto a, auto b) {
+				return a->second.lastUsed < b->second.lastUsed;
+			});
+
+			for (auto itr : candidates)
+			{
+				if (total <= budget)
+				{
+					break;
+				}
+
+				const MemoryUsage usage = itr->second.asset->GetMemoryUsage();
+				total -= usage.cpuBytes + usage.gpuBytes;
+
+				resourceCache.erase(itr);
+				++stats.evictions;
+			}
+		}
+
+		static void ResolvePath(std::string& filePath)
+		{
+			if (IsPathRelative(filePath))
+			{
+				filePath = RootAssetDirectory + filePath;
+			}
+			else
+			{
+				Warning("Asset loaded with an absolute path. To ensure proper asset caching, it is recommended to use only relative paths.");
+			}
+		}
+
+		// Streams the asset with the derived class's Decode() and Upload() functions.
+		class Request : public StreamRequest
+		{
+		public:
+			Request(std::string path)
+				: path(std::move(path)), asset(std::make_shared<Asset>()) {}
+
+			const std::string path;
+			const std::shared_ptr<Asset> asset;
+
+		private:
+			bool Read() override
+			{
+				return Asset::Decode(path, data);
+			}
+
+			bool Upload() override
+			{
+				return asset->Upload(data);
+			}
+
+			void Complete(bool success) override
+			{
+				if (success)
+				{
+					Insert(path, asset);
+				}
+
+				// Release the decoded data now rather than when the last handle is destroyed.
+				data = {};
+				pendingLoads.erase(path);
+			}
+
+			typename Asset::StreamData data;
+		};
+
+		static std::unordered_map<std::string, CacheEntry, string_hash, std::equal_to<>> resourceCache;
+		// Assets that are currently streaming. Only accessed from the main thread.
+		static std::unordered_map<std::string, AsyncLoad<Asset>, string_hash, std::equal_to<>> pendingLoads;
+
+		static ResourceStats stats;
+		static size_t budget;
+		static CachePolicy cachePolicy;
+		// Increases each time an asset is used, to order assets from least to most recently used.
+		static uint64_t useCounter;
 	};
 
 	template<class Asset>
-	std::unordered_map<std::string, std::shared_ptr<Asset>, string_hash, std::equal_to<>> Resource<Asset>::resourceCache;
+	std::unordered_map<std::string, typename Resource<Asset>::CacheEntry, string_hash, std::equal_to<>> Resource<Asset>::resourceCache;
+
+	template<class Asset>
+	std::unordered_map<std::string, AsyncLoad<Asset>, string_hash, std::equal_to<>> Resource<Asset>::pendingLoads;
+
+	template<class Asset>
+	ResourceStats Resource<Asset>::stats;
+
+	template<class Asset>
+	size_t Resource<Asset>::budget = SIZE_MAX;
+
+	template<class Asset>
+	CachePolicy Resource<Asset>::cachePolicy = CachePolicy::Strong;
+
+	template<class Asset>
+	uint64_t Resource<Asset>::useCounter = 0;
 
 	// Helper function to load an asset.
 	template<class Asset, typename... Args>
@@ -91,6 +475,13 @@ namespace Jwl
 		return Resource<Asset>::Load(filePath, std::forward<Args>(params)...);
 	}
 
+	// Helper function to load an asset in the background.
+	template<class Asset>
+	AsyncLoad<Asset> LoadAsync(const std::string& filePath)
+	{
+		return Resource<Asset>::LoadAsync(filePath);
+	}
+
 	// Helper function to unload all managed instances of an asset.
 	template<class Asset>
 	void UnloadAll()
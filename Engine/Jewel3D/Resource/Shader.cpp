@@ -2,14 +2,20 @@
 #include "Jewel3D/Precompiled.h"
 #include "Shader.h"
 #include "Jewel3D/Application/FileSystem.h"
+#include "Jewel3D/Application/FrameStats.h"
 #include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Application/Profiler.h"
 #include "Jewel3D/Math/Vector.h"
+#include "Jewel3D/Utilities/Hash.h"
 #include "Jewel3D/Utilities/ScopeGuard.h"
 #include "Jewel3D/Utilities/String.h"
 
 #include <GLEW/GL/glew.h>
+#include <algorithm>
 #include <cctype>
+#include <deque>
 #include <functional>
+#include <mutex>
 
 namespace
 {
@@ -173,17 +179,27 @@ namespace
 		"#define is_spot_light(light) JWL_IS_SPOT_LIGHT(light##.Type)\n"
 		"#define compute_light(light, normal, pos) JWL_COMPUTE_LIGHT(normal, pos, light##.Color, light##.Position, light##.Direction, light##.AttenuationLinear, light##.AttenuationQuadratic, light##.Angle, light##.Type)\n";
 
+	// Vendor, renderer, and version strings of the driver. Program binaries are only valid on the driver that created them.
+	std::string driverIdentity;
+
+	// Issues the compile command for a shader stage and attaches it to the program.
 	unsigned CompileShader(unsigned program, unsigned type, std::string_view _header, std::string_view body)
 	{
 		unsigned shader = glCreateShader(type);
-		defer { glDeleteShader(shader); };
 
 		const char* sources[] = { _header.data(), body.data() };
 		const int lengths[] = { static_cast<int>(_header.size()), static_cast<int>(body.size()) };
 
 		glShaderSource(shader, 2, sources, lengths);
 		glCompileShader(shader);
+		glAttachShader(program, shader);
+
+		return shader;
+	}
 
+	// Outputs the compilation log of the shader stage if it failed to compile.
+	bool CheckShader(unsigned shader)
+	{
 		GLint success = GL_FALSE;
 		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 		if (success == GL_FALSE)
@@ -205,17 +221,16 @@ namespace
 
 			Jwl::Error(infoLog);
 
-			return GL_NONE;
+			return false;
 		}
 
-		glAttachShader(program, shader);
-		return shader;
+		return true;
 	}
 
-	bool LinkProgram(unsigned program)
+	// Outputs the link log of the program if it failed to link.
+	bool CheckProgram(unsigned program)
 	{
 		GLint success = GL_FALSE;
-		glLinkProgram(program);
 		glGetProgramiv(program, GL_LINK_STATUS, &success);
 
 		// Output GL error to log on failure.
@@ -243,31 +258,122 @@ namespace
 
 		return true;
 	}
+
+	// Interned strings are shared by define names and values. ID 0 is always the empty string.
+	struct InternTable
+	{
+		InternTable()
+		{
+			strings.emplace_back();
+			ids.emplace(strings.back(), 0);
+		}
+
+		// A deque never moves its elements, so the views in 'ids' and references returned to users remain valid.
+		std::deque<std::string> strings;
+		std::unordered_map<std::string_view, unsigned> ids;
+	};
+
+	constexpr unsigned EMPTY_STRING_ID = 0;
+
+	std::mutex internMutex;
+
+	// Constructed on first use so that ShaderDefines can safely be created during static initialization.
+	InternTable& GetInternTable()
+	{
+		static InternTable table;
+		return table;
+	}
+
+	constexpr uint64_t MakeEntry(unsigned nameId, unsigned valueId)
+	{
+		return (static_cast<uint64_t>(nameId) << 32) | valueId;
+	}
+
+	constexpr unsigned GetNameId(uint64_t entry)
+	{
+		return static_cast<unsigned>(entry >> 32);
+	}
+
+	constexpr unsigned GetValueId(uint64_t entry)
+	{
+		return static_cast<unsigned>(entry & 0xFFFFFFFF);
+	}
+
+	// Returns the position of the define in the sorted list, or the position at which it should be inserted.
+	template<typename Container>
+	auto FindEntry(Container& defines, unsigned nameId)
+	{
+		return std::lower_bound(defines.begin(), defines.end(), MakeEntry(nameId, 0));
+	}
 }
 
 namespace Jwl
 {
-	void ShaderVariantControl::Define(std::string_view name, std::string_view value)
+	ShaderDefine::ShaderDefine(std::string_view name)
+		: id(Intern(name))
 	{
 		ASSERT(!name.empty(), "Name cannot be empty.");
+	}
 
-		defer{ UpdateHash(); };
+	const std::string& ShaderDefine::GetName() const
+	{
+		return GetString(id);
+	}
 
-		// Search for and update the define if it already exists.
-		for (auto& define : defines)
+	unsigned ShaderDefine::Intern(std::string_view str)
+	{
+		std::lock_guard lock(internMutex);
+
+		auto& table = GetInternTable();
+		auto itr = table.ids.find(str);
+		if (itr != table.ids.end())
+		{
+			return itr->second;
+		}
+
+		const unsigned id = static_cast<unsigned>(table.strings.size());
+		table.strings.emplace_back(str);
+		table.ids.emplace(table.strings.back(), id);
+
+		return id;
+	}
+
+	const std::string& ShaderDefine::GetString(unsigned id)
+	{
+		std::lock_guard lock(internMutex);
+
+		auto& table = GetInternTable();
+		ASSERT(id < table.strings.size(), "Invalid interned string ID.");
+
+		return table.strings[id];
+	}
+
+	//-----------------------------------------------------------------------------------------------------
+
+	void ShaderVariantControl::Define(ShaderDefine name, std::string_view value)
+	{
+		const uint64_t entry = MakeEntry(name.GetId(), ShaderDefine::Intern(value));
+
+		auto itr = FindEntry(defines, name.GetId());
+		if (itr != defines.end() && GetNameId(*itr) == name.GetId())
 		{
-			if (define.name == name)
+			// Update the value if it has changed.
+			if (*itr == entry)
 			{
-				define.value = value;
 				return;
 			}
+
+			*itr = entry;
+		}
+		else
+		{
+			defines.insert(itr, entry);
 		}
 
-		// Add as a new define.
-		defines.push_back({ std::string(name), std::string(value) });
+		UpdateHash();
 	}
 
-	void ShaderVariantControl::Switch(std::string_view name, bool state)
+	void ShaderVariantControl::Switch(ShaderDefine name, bool state)
 	{
 		if (state)
 		{
@@ -279,35 +385,25 @@ namespace Jwl
 		}
 	}
 
-	void ShaderVariantControl::Toggle(std::string_view name)
+	void ShaderVariantControl::Toggle(ShaderDefine name)
 	{
-		ASSERT(!name.empty(), "Name cannot be empty.");
-
-		defer { UpdateHash(); };
-
-		for (unsigned i = 0; i < defines.size(); ++i)
+		auto itr = FindEntry(defines, name.GetId());
+		if (itr != defines.end() && GetNameId(*itr) == name.GetId())
 		{
-			if (defines[i].name == name)
-			{
-				defines.erase(defines.begin() + i);
-				return;
-			}
+			defines.erase(itr);
+		}
+		else
+		{
+			defines.insert(itr, MakeEntry(name.GetId(), EMPTY_STRING_ID));
 		}
 
-		defines.push_back({std::string(name), ""});
+		UpdateHash();
 	}
 
-	bool ShaderVariantControl::IsDefined(std::string_view name) const
+	bool ShaderVariantControl::IsDefined(ShaderDefine name) const
 	{
-		for (auto& define : defines)
-		{
-			if (define.name == name)
-			{
-				return true;
-			}
-		}
-
-		return false;
+		auto itr = FindEntry(defines, name.GetId());
+		return itr != defines.end() && GetNameId(*itr) == name.GetId();
 	}
 
 	bool ShaderVariantControl::IsEmpty() const
@@ -315,17 +411,13 @@ namespace Jwl
 		return defines.empty();
 	}
 
-	void ShaderVariantControl::Undefine(std::string_view name)
+	void ShaderVariantControl::Undefine(ShaderDefine name)
 	{
-		for (unsigned i = 0; i < defines.size(); ++i)
+		auto itr = FindEntry(defines, name.GetId());
+		if (itr != defines.end() && GetNameId(*itr) == name.GetId())
 		{
-			if (defines[i].name == name)
-			{
-				defines.erase(defines.begin() + i);
-				UpdateHash();
-
-				return;
-			}
+			defines.erase(itr);
+			UpdateHash();
 		}
 	}
 
@@ -337,47 +429,60 @@ namespace Jwl
 
 	std::string ShaderVariantControl::GetString() const
 	{
+		// IDs depend on the order that names were first seen, so we sort by name to keep the source text
+		// identical between runs. This keeps the program binary cache valid.
+		std::vector<std::pair<const std::string*, const std::string*>> sorted;
+		sorted.reserve(defines.size());
+		for (uint64_t entry : defines)
+		{
+			sorted.emplace_back(&ShaderDefine::GetString(GetNameId(entry)), &ShaderDefine::GetString(GetValueId(entry)));
+		}
+
+		std::sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) { return *a.first < *b.first; });
+
 		std::string result;
 
 		// Rough estimate of total length.
 		result.reserve(defines.size() * 12);
 
-		for (auto& define : defines)
+		for (auto& [name, value] : sorted)
 		{
-			result += "#define " + define.name + ' ' + define.value + '\n';
+			result += "#define " + *name + ' ' + *value + '\n';
 		}
 
 		return result;
 	}
 
-	unsigned ShaderVariantControl::GetHash() const
+	uint64_t ShaderVariantControl::GetHash() const
 	{
 		return hash;
 	}
 
 	bool ShaderVariantControl::operator==(const ShaderVariantControl& other) const
 	{
-		return hash == other.hash;
+		// The hash only allows us to exit early. Equal hashes still need to be confirmed.
+		return hash == other.hash && defines == other.defines;
 	}
 
 	bool ShaderVariantControl::operator!=(const ShaderVariantControl& other) const
 	{
-		return hash != other.hash;
+		return !(*this == other);
 	}
 
 	void ShaderVariantControl::UpdateHash()
 	{
-		std::hash<std::string> str_hash;
-		hash = 0x0;
+		hash = 0;
 
-		for (auto& define : defines)
+		for (uint64_t entry : defines)
 		{
-			hash += str_hash(define.name) + str_hash(define.value);
+			hash = HashCombine(hash, entry);
 		}
 	}
 
 	//-----------------------------------------------------------------------------------------------------
 
+	bool Shader::asyncCompilation = true;
+	std::string Shader::binaryCacheDirectory;
 	std::string Shader::commonHeader;
 
 	Shader::~Shader()
@@ -389,6 +494,25 @@ namespace Jwl
 	{
 		ASSERT(!IsLoaded(), "ShaderData already has a Shader loaded.");
 
+		StreamData data;
+		if (!Decode(filePath, data))
+		{
+			return false;
+		}
+
+		if (!LoadInternal(std::move(data.source)))
+		{
+			Error("Shader: ( %s )", filePath.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool Shader::Decode(std::string filePath, StreamData& out)
+	{
+		PROFILE_SCOPE("Shader::Decode");
+
 		auto ext = ExtractFileExtension(filePath);
 		if (ext.empty())
 		{
@@ -400,22 +524,67 @@ namespace Jwl
 			return false;
 		}
 
-		std::string source;
-		if (!LoadFileAsString(filePath, source))
+		if (!LoadFileAsString(filePath, out.source))
 		{
 			Error("Shader: ( %s )\nUnable to open file.", filePath.c_str());
 			return false;
 		}
 
-		if (!LoadInternal(source))
+		return true;
+	}
+
+	bool Shader::Reload(const StreamData& data)
+	{
+		ASSERT(IsLoaded(), "Must have a shader loaded to call this function.");
+
+		// Parse into a separate shader first so that a broken edit does not leave this one unusable.
+		Shader reloaded;
+		if (!reloaded.LoadInternal(data.source))
 		{
-			Error("Shader: ( %s )", filePath.c_str());
 			return false;
 		}
 
+		includes = std::move(reloaded.includes);
+
+		// Changes to whitespace and comments do not affect the compiled programs.
+		if (reloaded.sourceHash == sourceHash)
+		{
+			return true;
+		}
+
+		std::vector<ShaderVariantControl> inUse;
+		inUse.reserve(variants.Count());
+		variants.ForEach([&inUse](const ShaderVariantControl& definitions, ShaderVariant&) {
+			inUse.push_back(definitions);
+		});
+
+		sourceHash = reloaded.sourceHash;
+		attributes = std::move(reloaded.attributes);
+		samplers = std::move(reloaded.samplers);
+		uniformBuffers = std::move(reloaded.uniformBuffers);
+		vertexSource = std::move(reloaded.vertexSource);
+		geometrySource = std::move(reloaded.geometrySource);
+		fragmentSrouce = std::move(reloaded.fragmentSrouce);
+		textureBindings = std::move(reloaded.textureBindings);
+		bufferBindings = std::move(reloaded.bufferBindings);
+
+		// Static buffers are owned by the shader, so they are replaced to pick up new default values.
+		for (auto& slot : reloaded.buffers.GetAll())
+		{
+			buffers.Add(slot.buffer, slot.unit);
+		}
+
+		variants.Clear();
+		Warmup(inUse);
+
 		return true;
 	}
 
+	const std::vector<std::string>& Shader::GetIncludes() const
+	{
+		return includes;
+	}
+
 	bool Shader::LoadFromSource(std::string_view source)
 	{
 		ASSERT(!IsLoaded(), "ShaderData already has a Shader loaded.");
@@ -465,6 +634,16 @@ namespace Jwl
 			// Our minimum supported version is 3.3, where the format of the GLSL
 			// version identifier begins to be symmetrical with the GL version.
 			commonHeader = "#version " + std::to_string(major) + std::to_string(minor) + "0\n" + header;
+
+			driverIdentity  = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+			driverIdentity += reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+			driverIdentity += reinterpret_cast<const char*>(glGetString(GL_VERSION));
+
+			if (GLEW_ARB_parallel_shader_compile)
+			{
+				// Let the driver use as many background threads as it wants.
+				glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+			}
 		}
 
 		// Clean up the source to make parsing easier.
@@ -620,6 +799,16 @@ namespace Jwl
 			fragmentSrouce = passThroughFragment;
 		}
 
+		// Any change to the driver or the shared source code invalidates the cached binaries of every variant.
+		sourceHash = HashFNV(driverIdentity);
+		sourceHash = HashFNV(commonHeader, sourceHash);
+		sourceHash = HashFNV(uniformBuffers, sourceHash);
+		sourceHash = HashFNV(samplers, sourceHash);
+		sourceHash = HashFNV(attributes, sourceHash);
+		sourceHash = HashFNV(vertexSource, sourceHash);
+		sourceHash = HashFNV(geometrySource, sourceHash);
+		sourceHash = HashFNV(fragmentSrouce, sourceHash);
+
 		loaded = true;
 		return true;
 	}
@@ -689,22 +878,14 @@ namespace Jwl
 						*chr = '\0';
 					}
 
-					if (IsPathRelative(path))
-					{
-						if (!LoadFileAsString(RootAssetDirectory + path, *output))
-						{
-							Error("Shader include ( %s ) failed to load.", path);
-							return false;
-						}
-					}
-					else
+					std::string includePath = IsPathRelative(path) ? RootAssetDirectory + path : path;
+					if (!LoadFileAsString(includePath, *output))
 					{
-						if (!LoadFileAsString(path, *output))
-						{
-							Error("Shader include ( %s ) failed to load.", path);
-							return false;
-						}
+						Error("Shader include ( %s ) failed to load.", path);
+						return false;
 					}
+
+					includes.push_back(std::move(includePath));
 				}
 				else
 				{
@@ -1100,14 +1281,16 @@ namespace Jwl
 	void Shader::Unload()
 	{
 		loaded = false;
+		sourceHash = 0;
 
 		textures.Clear();
 		buffers.Clear();
 
-		variants.clear();
+		variants.Clear();
 
 		textureBindings.clear();
 		bufferBindings.clear();
+		includes.clear();
 
 		attributes.clear();
 		samplers.clear();
@@ -1124,73 +1307,30 @@ namespace Jwl
 
 	void Shader::Bind(const ShaderVariantControl& definitions)
 	{
+		PROFILE_SCOPE("Shader::Bind");
+
 		ASSERT(IsLoaded(), "Must have a shader loaded to call this function.");
 
-		auto itr = variants.find(definitions);
-		if (itr == variants.end())
+		ShaderVariant& variant = RequestVariant(definitions);
+		if (variant.pending && asyncCompilation && !definitions.IsEmpty() && variant.IsCompiling())
 		{
-			// This shader variant is new and needs to be created.
-			auto& variant = variants.emplace(definitions, ShaderVariant()).first->second;
-
-			const std::string defines = definitions.GetString();
-
-			if (!variant.Load(
-				commonHeader + uniformBuffers + samplers + defines,
-				attributes + vertexSource,
-				geometrySource,
-				fragmentSrouce))
-			{
-				if (!defines.empty())
-				{
-					Error("With variant definitions:\n%s", defines.c_str());
-				}
-
-				// Instead of doing nothing, we load a hard-coded pink shader on failure.
-				if (!variant.Load(
-					commonHeader,
-					"layout(location = 0) in vec4 a_vert;\n"
-					"void main()\n{\n"
-					"	gl_Position = Jwl_MVP * a_vert;\n"
-					"}\n",
-					"",
-					"out vec4 outColor;\n"
-					"void main()\n{\n"
-					"	outColor = vec4(1.0f, 0.5f, 0.7f, 1.0f);\n"
-					"}\n"))
-				{
-					ASSERT(false, "Fallback pink-shader failed to compile.");
-				}
-			}
-			else
+			// Rather than stalling the frame, we render with the base variant until this one is ready.
+			ShaderVariant& fallback = RequestVariant(ShaderVariantControl());
+			if (fallback.pending)
 			{
-				// Make sure the samplers are all set to the correct bindings.
-				for (auto& binding : textureBindings)
-				{
-					unsigned location = glGetUniformLocation(variant.program, binding.name.c_str());
-					// Not finding a location is not an error.
-					// It is most likely because a uniform has been optimized away.
-					if (location != GL_INVALID_INDEX)
-					{
-						glProgramUniform1i(variant.program, location, binding.unit);
-					}
-				}
-
-				// Make sure the UniformBuffers are all set to the correct bindings.
-				for (auto& binding : bufferBindings)
-				{
-					unsigned block = glGetUniformBlockIndex(variant.program, ("Jwl_User_" + binding.name).c_str());
-					if (block != GL_INVALID_INDEX)
-					{
-						glUniformBlockBinding(variant.program, block, binding.unit);
-					}
-				}
+				FinishVariant(fallback, ShaderVariantControl());
 			}
 
-			variant.Bind();
+			fallback.Bind();
 		}
 		else
 		{
-			itr->second.Bind();
+			if (variant.pending)
+			{
+				FinishVariant(variant, definitions);
+			}
+
+			variant.Bind();
 		}
 
 		/* Bind global shader resources */
@@ -1206,68 +1346,295 @@ namespace Jwl
 		buffers.UnBind();
 	}
 
+	void Shader::Warmup(const std::vector<ShaderVariantControl>& variantList)
+	{
+		ASSERT(IsLoaded(), "Must have a shader loaded to call this function.");
+
+		const bool background = asyncCompilation && GLEW_ARB_parallel_shader_compile;
+		for (auto& definitions : variantList)
+		{
+			ShaderVariant& variant = RequestVariant(definitions);
+
+			// If the driver cannot compile in the background, we finish the work now rather than at the first Bind().
+			if (variant.pending && !background)
+			{
+				FinishVariant(variant, definitions);
+			}
+		}
+	}
+
+	bool Shader::IsVariantReady(const ShaderVariantControl& definitions) const
+	{
+		const ShaderVariant* variant = variants.Find(definitions);
+		if (variant == nullptr)
+		{
+			return false;
+		}
+
+		return !variant->IsCompiling();
+	}
+
 	const std::vector<BufferBinding>& Shader::GetBufferBindings() const
 	{
 		return bufferBindings;
 	}
 
-	//-----------------------------------------------------------------------------------------------------
+	void Shader::SetAsyncCompilation(bool state)
+	{
+		asyncCompilation = state;
+	}
 
-	Shader::ShaderVariant::~ShaderVariant()
+	bool Shader::IsAsyncCompilationEnabled()
 	{
-		Unload();
+		return asyncCompilation;
 	}
 
-	bool Shader::ShaderVariant::Load(std::string_view _header, std::string_view vertSource, std::string_view geomSource, std::string_view fragSource)
+	void Shader::SetBinaryCacheDirectory(std::string directory)
 	{
-		program = glCreateProgram();
-		unsigned vertShader = GL_NONE;
-		unsigned geomShader = GL_NONE;
-		unsigned fragShader = GL_NONE;
+		if (!directory.empty())
+		{
+			if (directory.back() != '/' && directory.back() != '\\')
+			{
+				directory.push_back('/');
+			}
 
-		if (!vertSource.empty())
+			if (!DirectoryExists(directory) && !MakeDirectory(directory))
+			{
+				Error("Shader: ( %s )\nUnable to create the program binary cache directory.", directory.c_str());
+				return;
+			}
+		}
+
+		binaryCacheDirectory = std::move(directory);
+	}
+
+	const std::string& Shader::GetBinaryCacheDirectory()
+	{
+		return binaryCacheDirectory;
+	}
+
+	Shader::ShaderVariant& Shader::RequestVariant(const ShaderVariantControl& definitions)
+	{
+		auto [ptr, isNew] = variants.Insert(definitions);
+		ShaderVariant& variant = *ptr;
+		if (!isNew)
 		{
-			vertShader = CompileShader(program, GL_VERTEX_SHADER, _header, vertSource);
-			if (vertShader == GL_NONE)
+			return variant;
+		}
+
+		const std::string defines = definitions.GetString();
+		const bool useCache = !binaryCacheDirectory.empty() && GLEW_ARB_get_program_binary;
+
+		if (useCache)
+		{
+			variant.key = ShaderCacheKey::Create(sourceHash, defines);
+
+			ShaderBinary binary;
+			if (LoadShaderBinary(binaryCacheDirectory + variant.key.GetFileName(), variant.key, binary) &&
+				variant.LoadBinary(binary))
 			{
-				Error("Shader variant's vertex stage failed to compile.");
-				Unload();
-				return false;
+				return variant;
 			}
 		}
 
-		if (!geomSource.empty())
+		variant.Compile(
+			commonHeader + uniformBuffers + samplers + defines,
+			attributes + vertexSource,
+			geometrySource,
+			fragmentSrouce,
+			useCache);
+
+		return variant;
+	}
+
+	void Shader::FinishVariant(ShaderVariant& variant, const ShaderVariantControl& definitions)
+	{
+		if (!variant.Finish())
 		{
-			geomShader = CompileShader(program, GL_GEOMETRY_SHADER, _header, geomSource);
-			if (geomShader == GL_NONE)
+			const std::string defines = definitions.GetString();
+			if (!defines.empty())
 			{
-				Error("Shader variant's geometry stage failed to compile.");
-				Unload();
-				return false;
+				Error("With variant definitions:\n%s", defines.c_str());
+			}
+
+			// Instead of doing nothing, we load a hard-coded pink shader on failure.
+			if (!variant.Load(
+				commonHeader,
+				"layout(location = 0) in vec4 a_vert;\n"
+				"void main()\n{\n"
+				"	gl_Position = Jwl_MVP * a_vert;\n"
+				"}\n",
+				"",
+				"out vec4 outColor;\n"
+				"void main()\n{\n"
+				"	outColor = vec4(1.0f, 0.5f, 0.7f, 1.0f);\n"
+				"}\n"))
+			{
+				ASSERT(false, "Fallback pink-shader failed to compile.");
+			}
+
+			return;
+		}
+
+		// Make sure the samplers are all set to the correct bindings.
+		for (auto& binding : textureBindings)
+		{
+			unsigned location = glGetUniformLocation(variant.program, binding.name.c_str());
+			// Not finding a location is not an error.
+			// It is most likely because a uniform has been optimized away.
+			if (location != GL_INVALID_INDEX)
+			{
+				glProgramUniform1i(variant.program, location, binding.unit);
+			}
+		}
+
+		// Make sure the UniformBuffers are all set to the correct bindings.
+		for (auto& binding : bufferBindings)
+		{
+			unsigned block = glGetUniformBlockIndex(variant.program, ("Jwl_User_" + binding.name).c_str());
+			if (block != GL_INVALID_INDEX)
+			{
+				glUniformBlockBinding(variant.program, block, binding.unit);
+			}
+		}
+
+		// Save the newly compiled program so that the next run can skip compilation.
+		if (!variant.fromCache && !binaryCacheDirectory.empty() && GLEW_ARB_get_program_binary)
+		{
+			GLint length = 0;
+			glGetProgramiv(variant.program, GL_PROGRAM_BINARY_LENGTH, &length);
+			if (length > 0)
+			{
+				ShaderBinary binary;
+				binary.data.resize(length);
+				glGetProgramBinary(variant.program, length, nullptr, &binary.format, binary.data.data());
+
+				if (!SaveShaderBinary(binaryCacheDirectory + variant.key.GetFileName(), variant.key, binary))
+				{
+					Warning("Shader: Failed to save a program binary to the cache.");
+				}
 			}
 		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------
+
+	Shader::ShaderVariant::ShaderVariant(ShaderVariant&& other) noexcept
+	{
+		*this = std::move(other);
+	}
 
-		if (!fragSource.empty())
+	Shader::ShaderVariant& Shader::ShaderVariant::operator=(ShaderVariant&& other) noexcept
+	{
+		Unload();
+
+		program = other.program;
+		stages[0] = other.stages[0];
+		stages[1] = other.stages[1];
+		stages[2] = other.stages[2];
+		pending = other.pending;
+		fromCache = other.fromCache;
+		key = other.key;
+
+		// The GL objects now belong to this variant.
+		other.program = GL_NONE;
+		other.stages[0] = GL_NONE;
+		other.stages[1] = GL_NONE;
+		other.stages[2] = GL_NONE;
+		other.pending = false;
+
+		return *this;
+	}
+
+	Shader::ShaderVariant::~ShaderVariant()
+	{
+		Unload();
+	}
+
+	bool Shader::ShaderVariant::Load(std::string_view _header, std::string_view vertSource, std::string_view geomSource, std::string_view fragSource)
+	{
+		Compile(_header, vertSource, geomSource, fragSource, false);
+
+		return Finish();
+	}
+
+	void Shader::ShaderVariant::Compile(std::string_view _header, std::string_view vertSource, std::string_view geomSource, std::string_view fragSource, bool retrievable)
+	{
+		ASSERT(program == GL_NONE, "ShaderVariant is already loaded.");
+
+		program = glCreateProgram();
+		if (retrievable)
 		{
-			fragShader = CompileShader(program, GL_FRAGMENT_SHADER, _header, fragSource);
-			if (fragShader == GL_NONE)
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
+		if (!vertSource.empty()) stages[0] = CompileShader(program, GL_VERTEX_SHADER, _header, vertSource);
+		if (!geomSource.empty()) stages[1] = CompileShader(program, GL_GEOMETRY_SHADER, _header, geomSource);
+		if (!fragSource.empty()) stages[2] = CompileShader(program, GL_FRAGMENT_SHADER, _header, fragSource);
+
+		// With GL_ARB_parallel_shader_compile, this does not block. The results are checked in Finish().
+		glLinkProgram(program);
+		FrameStats.CountShaderVariantCompiled();
+
+		pending = true;
+		fromCache = false;
+	}
+
+	bool Shader::ShaderVariant::LoadBinary(const ShaderBinary& binary)
+	{
+		ASSERT(program == GL_NONE, "ShaderVariant is already loaded.");
+
+		program = glCreateProgram();
+		glProgramBinary(program, binary.format, binary.data.data(), static_cast<GLsizei>(binary.data.size()));
+
+		GLint success = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (success == GL_FALSE)
+		{
+			// Drivers may reject binaries after an update. This is expected, so we quietly recompile instead.
+			Unload();
+			return false;
+		}
+
+		pending = true;
+		fromCache = true;
+
+		return true;
+	}
+
+	bool Shader::ShaderVariant::Finish()
+	{
+		ASSERT(pending, "ShaderVariant has not been compiled.");
+
+		pending = false;
+
+		constexpr const char* stageNames[] = { "vertex", "geometry", "fragment" };
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			if (stages[i] != GL_NONE && !CheckShader(stages[i]))
 			{
-				Error("Shader variant's fragment stage failed to compile.");
+				Error("Shader variant's %s stage failed to compile.", stageNames[i]);
 				Unload();
 				return false;
 			}
 		}
 
-		if (!LinkProgram(program))
+		if (!CheckProgram(program))
 		{
 			Error("Shader variant failed to link.");
 			Unload();
 			return false;
 		}
 
-		if (vertShader != GL_NONE) glDetachShader(program, vertShader);
-		if (geomShader != GL_NONE) glDetachShader(program, geomShader);
-		if (fragShader != GL_NONE) glDetachShader(program, fragShader);
+		for (unsigned& stage : stages)
+		{
+			if (stage != GL_NONE)
+			{
+				glDetachShader(program, stage);
+				glDeleteShader(stage);
+				stage = GL_NONE;
+			}
+		}
 
 		/* Initialize built-in uniform blocks */
 		unsigned cameraBlock = glGetUniformBlockIndex(program, "Jwl_Camera_Uniforms");
@@ -1283,13 +1650,37 @@ namespace Jwl
 		return true;
 	}
 
+	bool Shader::ShaderVariant::IsCompiling() const
+	{
+		if (!pending || !GLEW_ARB_parallel_shader_compile)
+		{
+			return false;
+		}
+
+		GLint completed = GL_FALSE;
+		glGetProgramiv(program, GL_COMPLETION_STATUS_ARB, &completed);
+
+		return completed == GL_FALSE;
+	}
+
 	void Shader::ShaderVariant::Unload()
 	{
+		for (unsigned& stage : stages)
+		{
+			if (stage != GL_NONE)
+			{
+				glDeleteShader(stage);
+				stage = GL_NONE;
+			}
+		}
+
 		if (program != GL_NONE)
 		{
 			glDeleteProgram(program);
 			program = GL_NONE;
 		}
+
+		pending = false;
 	}
 
 	void Shader::ShaderVariant::Bind() const
@@ -1297,5 +1688,6 @@ namespace Jwl
 		ASSERT(program != GL_NONE, "ShaderVariant cannot be bound because it is not loaded.");
 
 		glUseProgram(program);
+		FrameStats.CountShaderBind();
 	}
 }
@@ -1,46 +1,68 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
 #include "Resource.h"
+#include "ShaderCache.h"
 #include "Shareable.h"
 #include "Texture.h"
 #include "UniformBuffer.h"
+#include "Jewel3D/Utilities/Container.h"
 
 #include <string_view>
-#include <unordered_map>
 #include <vector>
 
 namespace Jwl
 {
+	// The name of a shader define, interned to a small integer ID.
+	// Constructing one from a string requires a lookup, so frequently switched defines should be stored and reused.
+	class ShaderDefine
+	{
+	public:
+		ShaderDefine(std::string_view name);
+		ShaderDefine(const char* name) : ShaderDefine(std::string_view(name)) {}
+		ShaderDefine(const std::string& name) : ShaderDefine(std::string_view(name)) {}
+
+		unsigned GetId() const { return id; }
+		const std::string& GetName() const;
+
+		// Returns the ID of the string, interning it if it has not been seen before.
+		static unsigned Intern(std::string_view str);
+		// Returns the string that was interned with the ID.
+		static const std::string& GetString(unsigned id);
+
+	private:
+		unsigned id;
+	};
+
 	// Manages a set of defines used to control shaders.
 	class ShaderVariantControl
 	{
 	public:
 		// Adds a new define, or updates its value.
-		void Define(std::string_view name, std::string_view value = "");
+		void Define(ShaderDefine name, std::string_view value = "");
 
 		// Either Define()'s or Undefine()'s the property, based on state.
-		void Switch(std::string_view name, bool state);
+		void Switch(ShaderDefine name, bool state);
 
 		// Defines the property if it does not already exist. If it does, it is undefined.
-		void Toggle(std::string_view name);
+		void Toggle(ShaderDefine name);
 
 		// Returns true if 'name' is defined.
-		bool IsDefined(std::string_view name) const;
+		bool IsDefined(ShaderDefine name) const;
 
 		// Returns true if this object contains no defines.
 		bool IsEmpty() const;
 
 		// Removes a define.
-		void Undefine(std::string_view name);
+		void Undefine(ShaderDefine name);
 
 		// Clears all defined values.
 		void Reset();
 
-		// Returns the complete list of Defines.
+		// Returns the complete list of Defines, sorted by name.
 		std::string GetString() const;
 
 		// Returns a hash value generated from all internal defines.
-		unsigned GetHash() const;
+		uint64_t GetHash() const;
 
 		bool operator==(const ShaderVariantControl&) const;
 		bool operator!=(const ShaderVariantControl&) const;
@@ -48,14 +70,10 @@ namespace Jwl
 	private:
 		void UpdateHash();
 
-		struct Entry
-		{
-			std::string name;
-			std::string value;
-		};
-
-		std::vector<Entry> defines;
-		unsigned hash = 0;
+		// Each entry holds a define's ID in the upper 32 bits and the ID of its value in the lower 32 bits.
+		// Entries are kept sorted, so the same set of defines always has the same representation.
+		std::vector<uint64_t> defines;
+		uint64_t hash = 0;
 	};
 }
 
@@ -67,7 +85,7 @@ namespace std
 	{
 		size_t operator()(const Jwl::ShaderVariantControl& svc) const noexcept
 		{
-			return svc.GetHash();
+			return static_cast<size_t>(svc.GetHash());
 		}
 	};
 }
@@ -114,16 +132,49 @@ namespace Jwl
 		bool LoadPassThrough();
 		static Shader::Ptr MakeNewPassThrough();
 
+		// The contents of a *.shader file, ready to be parsed and compiled.
+		struct StreamData
+		{
+			std::string source;
+		};
+
+		// Reads the file from disk. Safe to call from any thread.
+		static bool Decode(std::string filePath, StreamData& out);
+		// Replaces the source code of a loaded shader. Must be called from the main thread.
+		// The variants that were in use are recompiled from the new source, while user-assigned textures and buffers are kept.
+		// If the new source fails to parse, the shader is left unchanged and false is returned.
+		bool Reload(const StreamData& data);
+
+		// Returns the files referenced by #include directives in the shader's source.
+		const std::vector<std::string>& GetIncludes() const;
+
 		// Unloads all GPU-side memory and cleans the object.
 		void Unload();
 
 		void Bind();
 		// Binds the shader compiled with the provided variant definitions.
+		// If the variant is still compiling asynchronously, the base variant is bound in its place.
 		void Bind(const ShaderVariantControl& definitions);
 		void UnBind();
 
+		// Begins compiling each of the variants ahead of time so that they are ready before their first use.
+		void Warmup(const std::vector<ShaderVariantControl>& variantList);
+
+		// Returns true if the variant has finished compiling and can be bound without a stall.
+		bool IsVariantReady(const ShaderVariantControl& definitions) const;
+
 		bool IsLoaded() const;
 
+		// Controls whether new variants are compiled in the background by the driver.
+		// Only takes effect if the driver supports GL_ARB_parallel_shader_compile.
+		static void SetAsyncCompilation(bool state);
+		static bool IsAsyncCompilationEnabled();
+
+		// Enables caching of compiled programs in the specified directory, skipping compilation on later runs.
+		// An empty string disables the cache. Only takes effect if the driver supports GL_ARB_get_program_binary.
+		static void SetBinaryCacheDirectory(std::string directory);
+		static const std::string& GetBinaryCacheDirectory();
+
 		// These textures will be bound whenever the shader is used in rendering.
 		TextureList textures;
 		// These buffers will be bound whenever the shader is used in rendering.
@@ -135,13 +186,29 @@ namespace Jwl
 		// Holds one compiled shader variation.
 		struct ShaderVariant
 		{
+			ShaderVariant() = default;
+			ShaderVariant(ShaderVariant&&) noexcept;
+			ShaderVariant& operator=(ShaderVariant&&) noexcept;
 			~ShaderVariant();
 
+			// Compiles and links the program, blocking until it is complete.
 			bool Load(std::string_view header, std::string_view vertSource, std::string_view geomSource, std::string_view fragSource);
+			// Issues the compile and link commands. Call Finish() once IsCompiling() returns false.
+			void Compile(std::string_view header, std::string_view vertSource, std::string_view geomSource, std::string_view fragSource, bool retrievable);
+			// Restores a previously linked program. Fails if the driver rejects the binary.
+			bool LoadBinary(const ShaderBinary& binary);
+			// Reports any compilation errors and prepares the program for use. Blocks if the program is still compiling.
+			bool Finish();
+			// Returns true while the driver is still compiling the program in the background.
+			bool IsCompiling() const;
 			void Unload();
 			void Bind() const;
 
 			unsigned program = 0;
+			unsigned stages[3] = { 0, 0, 0 };
+			bool pending = false;
+			bool fromCache = false;
+			ShaderCacheKey key;
 		};
 
 		// Used to identify the content of a Program block.
@@ -175,13 +242,33 @@ namespace Jwl
 		bool ParseUniformBlock(const Block& block, const char* name, unsigned Id, bool isInstance, bool isStatic);
 		bool ParseSamplers(const Block& block);
 
+		// Returns the variant, starting its compilation if it does not exist yet.
+		// The reference is only valid until the next call, which may move the variants in memory.
+		ShaderVariant& RequestVariant(const ShaderVariantControl& definitions);
+		// Completes a pending variant. A failed variant is replaced with a visible error shader.
+		void FinishVariant(ShaderVariant& variant, const ShaderVariantControl& definitions);
+
 		bool loaded = false;
+		// Hash of all source code shared by the variants. Used to identify cached program binaries.
+		uint64_t sourceHash = 0;
+
+		// Hashes the full 64 bits of the variant control, even on 32-bit platforms.
+		struct VariantHash
+		{
+			uint64_t operator()(const ShaderVariantControl& svc) const { return svc.GetHash(); }
+		};
 
-		std::unordered_map<ShaderVariantControl, ShaderVariant> variants;
+		FlatHashMap<ShaderVariantControl, ShaderVariant, VariantHash> variants;
 
 		std::vector<TextureBinding> textureBindings;
 		std::vector<BufferBinding> bufferBindings;
 
+		// The full paths of the included files.
+		std::vector<std::string> includes;
+
+		static bool asyncCompilation;
+		static std::string binaryCacheDirectory;
+
 		// Various shader source code snippets.
 		static std::string commonHeader;
 		std::string attributes;
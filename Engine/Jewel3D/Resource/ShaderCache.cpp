@@ -0,0 +1,127 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "ShaderCache.h"
+#include "Jewel3D/Application/FileSystem.h"
+#include "Jewel3D/Utilities/Hash.h"
+#include "Jewel3D/Utilities/ScopeGuard.h"
+#include "Jewel3D/Utilities/String.h"
+
+#define CACHE_VERSION 1
+
+namespace
+{
+	constexpr char cacheMagic[4] = { 'J', 'W', 'S', 'B' };
+
+	// Precedes the program binary in every cache file.
+	struct CacheHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t sourceHash;
+		uint64_t defineHash;
+		uint32_t format;
+		uint32_t size;
+		uint64_t checksum;
+	};
+}
+
+namespace Jwl
+{
+	ShaderCacheKey ShaderCacheKey::Create(std::string_view source, std::string_view defines)
+	{
+		return Create(HashFNV(source), defines);
+	}
+
+	ShaderCacheKey ShaderCacheKey::Create(uint64_t sourceHash, std::string_view defines)
+	{
+		ShaderCacheKey key;
+		key.sourceHash = sourceHash;
+		key.defineHash = HashFNV(defines);
+
+		return key;
+	}
+
+	std::string ShaderCacheKey::GetFileName() const
+	{
+		return FormatString("%016llx%016llx.shaderbin", sourceHash, defineHash);
+	}
+
+	bool ShaderCacheKey::operator==(const ShaderCacheKey& other) const
+	{
+		return sourceHash == other.sourceHash && defineHash == other.defineHash;
+	}
+
+	bool ShaderCacheKey::operator!=(const ShaderCacheKey& other) const
+	{
+		return !(*this == other);
+	}
+
+	bool SaveShaderBinary(std::string_view file, const ShaderCacheKey& key, const ShaderBinary& binary)
+	{
+		if (binary.data.empty())
+		{
+			return false;
+		}
+
+		FILE* binaryFile = fopen(file.data(), "wb");
+		if (binaryFile == nullptr)
+		{
+			return false;
+		}
+
+		CacheHeader header;
+		memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+		header.version    = CACHE_VERSION;
+		header.sourceHash = key.sourceHash;
+		header.defineHash = key.defineHash;
+		header.format     = binary.format;
+		header.size       = static_cast<uint32_t>(binary.data.size());
+		header.checksum   = HashFNV(binary.data.data(), binary.data.size());
+
+		bool success =
+			fwrite(&header, sizeof(CacheHeader), 1, binaryFile) == 1 &&
+			fwrite(binary.data.data(), binary.data.size(), 1, binaryFile) == 1;
+
+		success = (fclose(binaryFile) == 0) && success;
+		if (!success)
+		{
+			// Don't leave a partial file behind to be rejected on every run.
+			RemoveFile(file);
+		}
+
+		return success;
+	}
+
+	bool LoadShaderBinary(std::string_view file, const ShaderCacheKey& key, ShaderBinary& out)
+	{
+		FILE* binaryFile = fopen(file.data(), "rb");
+		if (binaryFile == nullptr)
+		{
+			return false;
+		}
+		defer { fclose(binaryFile); };
+
+		CacheHeader header;
+		if (fread(&header, sizeof(CacheHeader), 1, binaryFile) != 1 ||
+			memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+			header.version != CACHE_VERSION ||
+			header.sourceHash != key.sourceHash ||
+			header.defineHash != key.defineHash ||
+			header.size == 0)
+		{
+			return false;
+		}
+
+		std::vector<unsigned char> data(header.size);
+		if (fread(data.data(), header.size, 1, binaryFile) != 1 ||
+			HashFNV(data.data(), data.size()) != header.checksum)
+		{
+			return false;
+		}
+
+		out.format = header.format;
+		out.data = std::move(data);
+
+		return true;
+	}
+}
@@ -0,0 +1,41 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Jwl
+{
+	// Identifies one compiled shader variant in the on-disk program binary cache.
+	struct ShaderCacheKey
+	{
+		// 'source' should contain everything that affects compilation other than the variant's defines.
+		static ShaderCacheKey Create(std::string_view source, std::string_view defines);
+		// Creates a key from a source hash that was already computed with HashFNV().
+		static ShaderCacheKey Create(uint64_t sourceHash, std::string_view defines);
+
+		// Returns the name of the file that the program binary is cached in.
+		std::string GetFileName() const;
+
+		bool operator==(const ShaderCacheKey&) const;
+		bool operator!=(const ShaderCacheKey&) const;
+
+		uint64_t sourceHash = 0;
+		uint64_t defineHash = 0;
+	};
+
+	// A linked program as retrieved from the driver with glGetProgramBinary().
+	struct ShaderBinary
+	{
+		unsigned format = 0;
+		std::vector<unsigned char> data;
+	};
+
+	// Writes the program binary to the file, tagged with the key it was compiled from.
+	bool SaveShaderBinary(std::string_view file, const ShaderCacheKey& key, const ShaderBinary& binary);
+
+	// Reads a program binary from the file. Fails if the file is truncated,
+	// corrupt, from another cache version, or was not saved with the same key.
+	bool LoadShaderBinary(std::string_view file, const ShaderCacheKey& key, ShaderBinary& out);
+}
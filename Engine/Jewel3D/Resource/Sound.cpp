@@ -1,8 +1,10 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Jewel3D/Precompiled.h"
 #include "Sound.h"
+#include "Jewel3D/Application/FileSystem.h"
 #include "Jewel3D/Application/Logging.h"
-#include "Jewel3D/Utilities/ScopeGuard.h"
+#include "Jewel3D/Application/Profiler.h"
+#include "Jewel3D/Utilities/BinaryReader.h"
 #include "Jewel3D/Utilities/String.h"
 
 #include <OpenAL_Soft/al.h>
@@ -50,6 +52,14 @@ namespace Jwl
 
 	bool Sound::Load(std::string filePath)
 	{
+		StreamData data;
+		return Decode(std::move(filePath), data) && Upload(data);
+	}
+
+	bool Sound::Decode(std::string filePath, StreamData& out)
+	{
+		PROFILE_SCOPE("Sound::Decode");
+
 		auto ext = ExtractFileExtension(filePath);
 		if (ext.empty())
 		{
@@ -61,85 +71,85 @@ namespace Jwl
 			return false;
 		}
 
-		FILE* file = fopen(filePath.c_str(), "rb");
-		if (file == nullptr)
+		FileView file;
+		if (!file.Open(filePath))
 		{
 			Error("Sound: ( %s )\nUnable to open file.", filePath.c_str());
 			return false;
 		}
-		defer { fclose(file); };
+
+		BinaryReader reader(file.GetData(), file.GetSize());
 
 		// Variables to store info about the WAVE file.
 		char chunkID[5] = { '\0' };
 		unsigned chunkSize;
 		WaveHeader header;
-		unsigned char* soundData = nullptr;
-		defer{ free(soundData); };
 
-		// Check that the WAVE file is OK.
-		fread(chunkID, sizeof(char), 4, file);
-		if (strcmp(chunkID, "RIFF") != 0)
-		{
-			Error("Sound: ( %s )\nIncorrect file type.", filePath.c_str());
-			return false;
-		}
+		auto readChunkID = [&]() {
+			const unsigned char* id = reader.ReadBytes(4);
+			if (id == nullptr)
+			{
+				return false;
+			}
 
-		fread(&chunkSize, sizeof(unsigned), 1, file);
-		fread(chunkID, sizeof(char), 4, file);
-		if (strcmp(chunkID, "WAVE") != 0)
+			memcpy(chunkID, id, 4);
+			return true;
+		};
+
+		// Check that the WAVE file is OK.
+		if (!readChunkID() || strcmp(chunkID, "RIFF") != 0 ||
+			!reader.Read(chunkSize) ||
+			!readChunkID() || strcmp(chunkID, "WAVE") != 0 ||
+			!readChunkID() || strcmp(chunkID, "fmt ") != 0)
 		{
 			Error("Sound: ( %s )\nIncorrect file type.", filePath.c_str());
 			return false;
 		}
 
-		fread(chunkID, sizeof(char), 4, file);
-		if (strcmp(chunkID, "fmt ") != 0)
+		// Read sound format.
+		if (!reader.Read(chunkSize) ||
+			!reader.Read(header.FormatTag) ||
+			!reader.Read(header.Channels) ||
+			!reader.Read(header.SamplesPerSec) ||
+			!reader.Read(header.AvgBytesPerSec) ||
+			!reader.Read(header.BlockAlign) ||
+			!reader.Read(header.BitsPerSample))
 		{
 			Error("Sound: ( %s )\nIncorrect file type.", filePath.c_str());
 			return false;
 		}
 
-		// Read sound format.
-		fread(&chunkSize, sizeof(unsigned), 1, file);
-		fread(&header.FormatTag, sizeof(short), 1, file);
-		fread(&header.Channels, sizeof(short), 1, file);
-		fread(&header.SamplesPerSec, sizeof(unsigned), 1, file);
-		fread(&header.AvgBytesPerSec, sizeof(unsigned), 1, file);
-		fread(&header.BlockAlign, sizeof(short), 1, file);
-		fread(&header.BitsPerSample, sizeof(short), 1, file);
-
 		// Skip any extra header information.
 		if (header.FormatTag == WaveFormat::WAVE_FORMAT_EXTENSIBLE)
 		{
-			fseek(file, 24, SEEK_CUR);
+			reader.ReadBytes(24);
 		}
 		else if (header.FormatTag != WaveFormat::WAVE_FORMAT_PCM)
 		{
-			fseek(file, 2, SEEK_CUR);
+			reader.ReadBytes(2);
 		}
 
 		// Search for data chunk.
-		while (fread(&chunkID, sizeof(char), 4, file) != 0)
+		while (readChunkID() && reader.Read(chunkSize))
 		{
 			if (strcmp(chunkID, "data") == 0)
 			{
 				// Read data.
-				fread(&chunkSize, sizeof(unsigned), 1, file);
-				soundData = static_cast<unsigned char*>(malloc(chunkSize * sizeof(unsigned char)));
-				fread(soundData, sizeof(unsigned char), chunkSize, file);
+				if (const unsigned char* samples = reader.ReadBytes(chunkSize))
+				{
+					out.samples.assign(samples, samples + chunkSize);
+				}
 
 				break;
 			}
-			else
+			else if (reader.ReadBytes(chunkSize) == nullptr)
 			{
-				// Skip chunk.
-				int size;
-				fread(&size, sizeof(int), 1, file);
-				fseek(file, size, SEEK_CUR);
+				// Skipped past the end of the file.
+				break;
 			}
 		}
 
-		if (soundData == nullptr)
+		if (out.samples.empty())
 		{
 			// We didn't find any data to load.
 			Error("Sound: ( %s )\nNo data found in file.", filePath.c_str());
@@ -147,56 +157,69 @@ namespace Jwl
 		}
 
 		// Resolve the format of the WAVE file.
-		ALenum format = AL_NONE;
+		out.format = AL_NONE;
 		if (header.BitsPerSample == 8)
 		{
 			if (header.Channels == 1)
 			{
-				format = AL_FORMAT_MONO8;
+				out.format = AL_FORMAT_MONO8;
 			}
 			else if (header.Channels == 2)
 			{
-				format = AL_FORMAT_STEREO8;
+				out.format = AL_FORMAT_STEREO8;
 			}
 		}
 		else if (header.BitsPerSample == 16)
 		{
 			if (header.Channels == 1)
 			{
-				format = AL_FORMAT_MONO16;
+				out.format = AL_FORMAT_MONO16;
 			}
 			else if (header.Channels == 2)
 			{
-				format = AL_FORMAT_STEREO16;
+				out.format = AL_FORMAT_STEREO16;
 			}
 		}
 
-		if (format == AL_NONE)
+		if (out.format == AL_NONE)
 		{
 			Error("Sound: ( %s )\nUnsupported audio format.", filePath.c_str());
 			return false;
 		}
 
+		out.frequency = header.SamplesPerSec;
+
+		return true;
+	}
+
+	bool Sound::Upload(const StreamData& data)
+	{
+		PROFILE_SCOPE("Sound::Upload");
+
+		ASSERT(hBuffer == 0, "Sound already has a buffer loaded.");
+
 		// Create OpenAL buffer.
 		alGenBuffers(1, &hBuffer);
 		ALenum error = alGetError();
 		if (error != AL_NO_ERROR)
 		{
 			Unload();
-			Error("Sound: ( %s )\n%s", filePath.c_str(), alGetString(error));
+			Error("Sound: %s", alGetString(error));
 			return false;
 		}
 
 		// Send data to OpenAL.
-		alBufferData(hBuffer, format, soundData, chunkSize, header.SamplesPerSec);
+		alBufferData(hBuffer, data.format, data.samples.data(), static_cast<ALsizei>(data.samples.size()), data.frequency);
 		error = alGetError();
 		if (error != AL_NO_ERROR)
 		{
 			Unload();
-			Error("Sound: ( %s )\n%s", filePath.c_str(), alGetString(error));
+			Error("Sound: %s", alGetString(error));
 			return false;
 		}
 
+		bufferSize = data.samples.size();
+
 		return true;
 	}
 
@@ -207,6 +230,7 @@ namespace Jwl
 			alDeleteBuffers(1, &hBuffer);
 			AL_DEBUG_CHECK();
 			hBuffer = 0;
+			bufferSize = 0;
 		}
 	}
 
@@ -214,4 +238,12 @@ namespace Jwl
 	{
 		return hBuffer;
 	}
+
+	MemoryUsage Sound::GetMemoryUsage() const
+	{
+		MemoryUsage usage;
+		usage.cpuBytes = bufferSize;
+
+		return usage;
+	}
 }
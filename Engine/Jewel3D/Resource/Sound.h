@@ -3,6 +3,8 @@
 #include "Resource.h"
 #include "Shareable.h"
 
+#include <vector>
+
 namespace Jwl
 {
 	// An audio clip.
@@ -17,9 +19,27 @@ namespace Jwl
 		bool Load(std::string filePath);
 		void Unload();
 
+		// The decoded contents of a .wav file, ready to be uploaded.
+		struct StreamData
+		{
+			// The OpenAL format of the samples.
+			int format = 0;
+			int frequency = 0;
+			std::vector<unsigned char> samples;
+		};
+
+		// Reads the file from disk. Safe to call from any thread.
+		static bool Decode(std::string filePath, StreamData& out);
+		// Creates the audio buffer from decoded data. Must be called from the main thread.
+		bool Upload(const StreamData& data);
+
 		unsigned GetBufferHandle() const;
 
+		// The samples are held by the audio driver in system memory.
+		MemoryUsage GetMemoryUsage() const;
+
 	private:
 		unsigned hBuffer = 0;
+		size_t bufferSize = 0;
 	};
 }
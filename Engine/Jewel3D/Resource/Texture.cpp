@@ -1,14 +1,49 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Jewel3D/Precompiled.h"
 #include "Texture.h"
+#include "TextureStreamer.h"
+#include "Jewel3D/Application/Archive.h"
+#include "Jewel3D/Application/FrameStats.h"
 #include "Jewel3D/Application/Logging.h"
-#include "Jewel3D/Utilities/ScopeGuard.h"
+#include "Jewel3D/Application/Profiler.h"
+#include "Jewel3D/Math/Math.h"
+#include "Jewel3D/Utilities/BinaryReader.h"
 #include "Jewel3D/Utilities/String.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <GLEW/GL/glew.h>
 #include <SOIL/SOIL.h>
 
+namespace
+{
+	void UploadImage(unsigned target, unsigned level, unsigned width, unsigned height, Jwl::TextureFormat format, const unsigned char* pixels)
+	{
+		if (Jwl::IsCompressed(format))
+		{
+			glCompressedTexSubImage2D(target, level, 0, 0, width, height, Jwl::ResolveFormat(format), Jwl::CountBytes(format, width, height), pixels);
+		}
+		else
+		{
+			const unsigned dataFormat = Jwl::CountChannels(format) == 3 ? GL_RGB : GL_RGBA;
+			glTexSubImage2D(target, level, 0, 0, width, height, dataFormat, GL_UNSIGNED_BYTE, pixels);
+		}
+	}
+
+	// Like CountBytes(), but computed in 64 bits so that large dimensions cannot overflow.
+	uint64_t CountBytes64(Jwl::TextureFormat format, unsigned width, unsigned height)
+	{
+		if (Jwl::IsCompressed(format))
+		{
+			const uint64_t numBlocks = ((static_cast<uint64_t>(width) + 3) / 4) * ((static_cast<uint64_t>(height) + 3) / 4);
+			return numBlocks * Jwl::CountBytes(format, 4, 4);
+		}
+
+		return static_cast<uint64_t>(width) * height * Jwl::CountBytes(format, 1, 1);
+	}
+}
+
 namespace Jwl
 {
 	Texture::~Texture()
@@ -21,6 +56,7 @@ namespace Jwl
 		ASSERT(hTex == 0, "Texture already has a texture loaded.");
 		ASSERT(_anisotropicLevel >= 1.0f && _anisotropicLevel <= 16.0f, "'anisotropicLevel' must be in the range of [1, 16].");
 		ASSERT(_numSamples == 1 || _numSamples == 2 || _numSamples == 4 || _numSamples == 8 || _numSamples == 16, "'numSamples' must be a power of 2 between 1 and 16.");
+		ASSERT(!IsCompressed(_format), "'format' cannot be a block-compressed format.");
 
 		width = static_cast<int>(_width);
 		height = static_cast<int>(_height);
@@ -65,9 +101,13 @@ namespace Jwl
 
 	bool Texture::Load(std::string filePath)
 	{
-		ASSERT(hTex == 0, "Texture already has a texture loaded.");
+		StreamData data;
+		return Decode(std::move(filePath), data) && Upload(data);
+	}
 
-		unsigned numLevels = 0;
+	bool Texture::Decode(std::string filePath, StreamData& out)
+	{
+		PROFILE_SCOPE("Texture::Decode");
 
 		auto ext = ExtractFileExtension(filePath);
 		if (ext.empty() || CompareLowercase(ext, ".texture"))
@@ -77,73 +117,45 @@ namespace Jwl
 				filePath += ".texture";
 			}
 
-			FILE* fontFile = fopen(filePath.c_str(), "rb");
-			if (fontFile == nullptr)
+			FileView file;
+			if (!file.Open(filePath))
 			{
 				Error("Texture: ( %s )\nUnable to open file.", filePath.c_str());
 				return false;
 			}
-			defer { fclose(fontFile); };
-
-			// Read header.
-			bool isCubeMap = false;
-			fread(&isCubeMap, sizeof(bool), 1, fontFile);
-			fread(&width, sizeof(unsigned), 1, fontFile);
-			fread(&height, sizeof(unsigned), 1, fontFile);
-			fread(&format, sizeof(TextureFormat), 1, fontFile);
-			fread(&filter, sizeof(TextureFilter), 1, fontFile);
-			fread(&wraps.x, sizeof(TextureWrap), 1, fontFile);
-			fread(&wraps.y, sizeof(TextureWrap), 1, fontFile);
-			fread(&anisotropicLevel, sizeof(float), 1, fontFile);
-
-			numLevels = CountMipLevels(width, height, filter);
-			const unsigned textureSize = width * height * CountChannels(format);
-			const unsigned dataFormat = CountChannels(format) == 3 ? GL_RGB : GL_RGBA;
-			if (isCubeMap)
-			{
-				auto* image = static_cast<unsigned char*>(malloc(sizeof(unsigned char) * textureSize * 6));
-				defer{ free(image); };
-
-				fread(image, sizeof(unsigned char), textureSize * 6, fontFile);
 
-				glGenTextures(1, &hTex);
-				glBindTexture(GL_TEXTURE_CUBE_MAP, hTex);
-				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, ResolveFilterMag(filter));
-				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, ResolveFilterMin(filter));
-				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-				glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicLevel);
-
-				glTexStorage2D(GL_TEXTURE_CUBE_MAP, numLevels, ResolveFormat(format), width, height);
+			if (!Parse(std::move(file), out, filePath))
+			{
+				return false;
+			}
 
-				for (unsigned i = 0; i < 6; ++i)
+			// Streaming maps the levels straight from the file, so textures inside archives are always fully resident.
+			// The sizes are compared in case the file was replaced after it was opened.
+			const bool canStream = !out.isCubeMap && out.numLevels > 1 && CountMipLevels(out.width, out.height, out.filter) > 1;
+			if (canStream && TextureStreamer.IsEnabled() && !IsInArchive(filePath))
+			{
+				if (!out.mapping.Open(filePath) || out.mapping.GetSize() != out.file.GetSize())
 				{
-					glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, 0, 0, width, height, dataFormat, GL_UNSIGNED_BYTE, image + (textureSize * i));
+					out.mapping.Close();
 				}
-
-				target = GL_TEXTURE_CUBE_MAP;
 			}
-			else
-			{
-				auto* image = static_cast<unsigned char*>(malloc(sizeof(unsigned char) * textureSize));
-				defer{ free(image); };
-
-				fread(image, sizeof(unsigned char), textureSize, fontFile);
-
-				glGenTextures(1, &hTex);
-				glBindTexture(GL_TEXTURE_2D, hTex);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, ResolveFilterMag(filter));
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, ResolveFilterMin(filter));
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, ResolveWrap(wraps.x));
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, ResolveWrap(wraps.y));
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicLevel);
-
-				glTexStorage2D(GL_TEXTURE_2D, numLevels, ResolveFormat(format), width, height);
-				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, dataFormat, GL_UNSIGNED_BYTE, image);
 
-				target = GL_TEXTURE_2D;
+			// Load the pixels that Upload will read from disk now, so that the main thread does not stall on them.
+			// Streamed textures only create their smallest levels up front.
+			size_t offset = static_cast<size_t>(out.pixels - out.file.GetData());
+			size_t size = out.file.GetSize() - offset;
+			if (out.mapping.IsOpen())
+			{
+				const unsigned tailLevel = TextureStreamer.GetTailLevel(out.width, out.height, out.numLevels);
+				for (unsigned level = 0; level < tailLevel; ++level)
+				{
+					const size_t levelSize = CountBytes(out.format, Max(out.width >> level, 1u), Max(out.height >> level, 1u));
+					offset += levelSize;
+					size -= levelSize;
+				}
 			}
+
+			out.file.GetSubView(offset, size).Prefetch();
 		}
 		else
 		{
@@ -151,35 +163,224 @@ namespace Jwl
 			if (image.data == nullptr)
 				return false;
 
-			width = image.width;
-			height = image.height;
-			format = image.format;
-			numLevels = CountMipLevels(width, height, filter);
+			out.isCubeMap = false;
+			out.width = image.width;
+			out.height = image.height;
+			out.format = image.format;
+			out.decoded.assign(image.data, image.data + image.width * image.height * CountChannels(image.format));
+			out.pixels = out.decoded.data();
+		}
 
-			glGenTextures(1, &hTex);
-			glBindTexture(GL_TEXTURE_2D, hTex);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, ResolveFilterMag(filter));
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, ResolveFilterMin(filter));
+		return true;
+	}
+
+	bool Texture::Parse(FileView file, StreamData& out, std::string_view name)
+	{
+		out.file = std::move(file);
+
+		BinaryReader reader(out.file.GetData(), out.file.GetSize());
+		if (!reader.Read(out.isCubeMap) ||
+			!reader.Read(out.width) ||
+			!reader.Read(out.height) ||
+			!reader.Read(out.format) ||
+			!reader.Read(out.filter) ||
+			!reader.Read(out.wraps.x) ||
+			!reader.Read(out.wraps.y) ||
+			!reader.Read(out.anisotropicLevel) ||
+			!reader.Read(out.numLevels))
+		{
+			Error("Texture: ( %s )\nFile has an invalid header.", name.data());
+			return false;
+		}
+
+		// No GPU supports textures this large. The limit also keeps the size calculations below from overflowing.
+		// The actual limit of the GPU is checked once the texture is uploaded.
+		constexpr unsigned MAX_DIMENSION = 64 * 1024;
+		if (out.width == 0 || out.height == 0 ||
+			out.width > MAX_DIMENSION || out.height > MAX_DIMENSION ||
+			out.numLevels == 0 || out.numLevels > CountMipLevels(out.width, out.height, TextureFilter::Trilinear))
+		{
+			Error("Texture: ( %s )\nFile has an invalid header.", name.data());
+			return false;
+		}
+
+		// The sizes are computed in 64 bits so that a corrupt header cannot wrap them around to a small size.
+		uint64_t textureSize = 0;
+		for (unsigned level = 0; level < out.numLevels; ++level)
+		{
+			textureSize += CountBytes64(out.format, Max(out.width >> level, 1u), Max(out.height >> level, 1u));
+		}
+
+		if (out.isCubeMap)
+		{
+			textureSize *= 6;
+		}
+
+		// The pixels are used in place from the file.
+		out.pixels = textureSize <= reader.GetRemaining() ? reader.ReadBytes(static_cast<size_t>(textureSize)) : nullptr;
+		if (out.pixels == nullptr)
+		{
+			Error("Texture: ( %s )\nFile is missing image data.", name.data());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool Texture::Upload(const StreamData& data)
+	{
+		PROFILE_SCOPE("Texture::Upload");
+
+		ASSERT(hTex == 0, "Texture already has a texture loaded.");
+
+		GLint maxSize = 0;
+		glGetIntegerv(data.isCubeMap ? GL_MAX_CUBE_MAP_TEXTURE_SIZE : GL_MAX_TEXTURE_SIZE, &maxSize);
+		if (data.width > static_cast<unsigned>(maxSize) || data.height > static_cast<unsigned>(maxSize))
+		{
+			Error("Texture: Dimensions of %ux%u exceed the maximum texture size of %d.", data.width, data.height, maxSize);
+			return false;
+		}
+
+		width = static_cast<int>(data.width);
+		height = static_cast<int>(data.height);
+		format = data.format;
+		filter = data.filter;
+		wraps = data.wraps;
+		anisotropicLevel = data.anisotropicLevel;
+		numStoredLevels = data.numLevels;
+
+		// Cubemaps are always fully resident.
+		const bool canStream = !data.isCubeMap && data.mapping.IsOpen() && data.numLevels > 1 && CountMipLevels(width, height, filter) > 1;
+		if (!canStream || !TextureStreamer.IsEnabled())
+		{
+			CreateLevels(data.pixels, data.numLevels, 0, data.isCubeMap);
+			return true;
+		}
+
+		std::vector<size_t> levelSizes(data.numLevels);
+		for (unsigned level = 0; level < data.numLevels; ++level)
+		{
+			levelSizes[level] = CountBytes(format, Max(data.width >> level, 1u), Max(data.height >> level, 1u));
+		}
+
+		// Only the smallest levels are created now. The rest are streamed in once the texture is seen up close.
+		// The file was opened from disk rather than an archive, so the view starts at the beginning of the file.
+		streamFile = data.mapping;
+		streamOffset = static_cast<uint64_t>(data.pixels - data.file.GetData());
+		const unsigned tailLevel = TextureStreamer.GetTailLevel(data.width, data.height, data.numLevels);
+		streamHandle = TextureStreamer.Register(*this, levelSizes, tailLevel);
+
+		CreateLevels(data.pixels + GetLevelOffset(tailLevel), data.numLevels, tailLevel, false);
+
+		return true;
+	}
+
+	bool Texture::Reload(const StreamData& data)
+	{
+		Unload();
+		return Upload(data);
+	}
+
+	void Texture::CreateLevels(const unsigned char* pixels, unsigned _numStoredLevels, unsigned baseLevel, bool isCubeMap)
+	{
+		ASSERT(baseLevel < _numStoredLevels, "'baseLevel' must be one of the stored levels.");
+
+		const unsigned baseWidth = Max(static_cast<unsigned>(width) >> baseLevel, 1u);
+		const unsigned baseHeight = Max(static_cast<unsigned>(height) >> baseLevel, 1u);
+		const unsigned numFaces = isCubeMap ? 6 : 1;
+
+		// Compressed textures cannot generate their own mipmaps, so they are limited to the precomputed levels.
+		unsigned numLevels = CountMipLevels(baseWidth, baseHeight, filter);
+		if (IsCompressed(format))
+		{
+			numLevels = Min(numLevels, _numStoredLevels - baseLevel);
+		}
+
+		const unsigned numUploadedLevels = Min(numLevels, _numStoredLevels - baseLevel);
+
+		target = isCubeMap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+
+		unsigned handle = GL_NONE;
+		glGenTextures(1, &handle);
+		glBindTexture(target, handle);
+		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, ResolveFilterMag(filter));
+		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, ResolveFilterMin(filter));
+		if (isCubeMap)
+		{
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		}
+		else
+		{
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, ResolveWrap(wraps.x));
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, ResolveWrap(wraps.y));
-			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicLevel);
+		}
+		glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropicLevel);
 
-			const unsigned dataFormat = CountChannels(format) == 3 ? GL_RGB : GL_RGBA;
+		glTexStorage2D(target, numLevels, ResolveFormat(format), baseWidth, baseHeight);
 
-			glTexStorage2D(GL_TEXTURE_2D, numLevels, ResolveFormat(format), width, height);
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, dataFormat, GL_UNSIGNED_BYTE, image.data);
+		for (unsigned level = 0; level < numUploadedLevels; ++level)
+		{
+			const unsigned levelWidth = Max(baseWidth >> level, 1u);
+			const unsigned levelHeight = Max(baseHeight >> level, 1u);
 
-			target = GL_TEXTURE_2D;
+			for (unsigned face = 0; face < numFaces; ++face)
+			{
+				const unsigned faceTarget = isCubeMap ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+				UploadImage(faceTarget, level, levelWidth, levelHeight, format, pixels);
+
+				pixels += CountBytes(format, levelWidth, levelHeight);
+			}
 		}
 
-		if (numLevels > 1)
+		if (numUploadedLevels < numLevels)
 		{
 			glGenerateMipmap(target);
 		}
 
 		glBindTexture(target, GL_NONE);
 
-		return true;
+		// Swapping the handle keeps the texture valid for everyone sharing it.
+		if (hTex != GL_NONE)
+		{
+			glDeleteTextures(1, &hTex);
+		}
+
+		hTex = handle;
+		residentLevel = baseLevel;
+	}
+
+	void Texture::SetResidentLevel(unsigned level, const unsigned char* pixels)
+	{
+		ASSERT(streamHandle != 0, "Texture is not streamed.");
+
+		if (level != residentLevel)
+		{
+			CreateLevels(pixels, numStoredLevels, level, false);
+		}
+	}
+
+	void Texture::GetLevelRange(unsigned first, uint64_t& out_offset, size_t& out_size) const
+	{
+		ASSERT(streamHandle != 0, "Texture is not streamed.");
+		ASSERT(first < numStoredLevels, "Invalid level.");
+
+		const size_t offset = GetLevelOffset(first);
+		out_offset = streamOffset + offset;
+		out_size = GetLevelOffset(numStoredLevels) - offset;
+	}
+
+	size_t Texture::GetLevelOffset(unsigned level) const
+	{
+		// Only 2D textures are streamed or start above level 0, so there is a single face per level.
+		size_t offset = 0;
+		for (unsigned i = 0; i < level; ++i)
+		{
+			offset += CountBytes(format, Max(static_cast<unsigned>(width) >> i, 1u), Max(static_cast<unsigned>(height) >> i, 1u));
+		}
+
+		return offset;
 	}
 
 	void Texture::SetFilter(TextureFilter _filter)
@@ -221,14 +422,77 @@ namespace Jwl
 		anisotropicLevel = level;
 	}
 
+	void Texture::RequestResolution(float pixels)
+	{
+		if (streamHandle == 0)
+		{
+			return;
+		}
+
+		// Each level halves the resolution, so the level that matches the screen is log2 of the ratio.
+		const float size = static_cast<float>(Max(width, height));
+		unsigned level = 0;
+		if (pixels < size)
+		{
+			level = static_cast<unsigned>(std::log2(size / Max(pixels, 1.0f)));
+		}
+
+		TextureStreamer.Request(streamHandle, level);
+	}
+
+	bool Texture::IsStreamed() const
+	{
+		return streamHandle != 0;
+	}
+
+	unsigned Texture::GetResidentLevel() const
+	{
+		return residentLevel;
+	}
+
+	MemoryUsage Texture::GetMemoryUsage() const
+	{
+		MemoryUsage usage;
+		if (hTex == GL_NONE)
+		{
+			return usage;
+		}
+
+		const unsigned numFaces = target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+		unsigned numLevels = CountMipLevels(width, height, filter);
+		if (IsCompressed(format))
+		{
+			numLevels = Min(numLevels, numStoredLevels);
+		}
+
+		for (unsigned level = residentLevel; level < numLevels; ++level)
+		{
+			usage.gpuBytes += CountBytes(format, Max(static_cast<unsigned>(width) >> level, 1u), Max(static_cast<unsigned>(height) >> level, 1u));
+		}
+
+		usage.gpuBytes *= numFaces * numSamples;
+
+		return usage;
+	}
+
 	void Texture::Unload()
 	{
+		if (streamHandle != 0)
+		{
+			TextureStreamer.Unregister(streamHandle);
+			streamHandle = 0;
+			streamFile.Close();
+			streamOffset = 0;
+		}
+
 		if (hTex != GL_NONE)
 		{
 			glDeleteTextures(1, &hTex);
 			hTex = GL_NONE;
 			target = GL_NONE;
 		}
+
+		residentLevel = 0;
 	}
 
 	void Texture::Bind(unsigned slot)
@@ -237,6 +501,7 @@ namespace Jwl
 
 		glActiveTexture(GL_TEXTURE0 + slot);
 		glBindTexture(target, hTex);
+		FrameStats.CountTextureBind();
 	}
 
 	void Texture::UnBind(unsigned slot)
@@ -318,6 +583,7 @@ namespace Jwl
 	{
 		ASSERT(hTex != 0, "A texture must be loaded to call this function.");
 		ASSERT(numSamples == 1, "It is illegal to generate mipmaps on a multisampled texture.");
+		ASSERT(!IsCompressed(format), "It is illegal to generate mipmaps on a compressed texture.");
 
 		glBindTexture(target, hTex);
 		glGenerateMipmap(target);
@@ -423,7 +689,14 @@ namespace Jwl
 		int height = 0;
 		int numChannels = 0;
 
-		unsigned char* data = SOIL_load_image(file.data(), &width, &height, &numChannels, SOIL_LOAD_AUTO);
+		FileView view;
+		if (!view.Open(file))
+		{
+			Jwl::Error("Texture: ( %s )\nUnable to open file.", file.data());
+			return Image(0, 0, TextureFormat::RGB_8, nullptr);
+		}
+
+		unsigned char* data = SOIL_load_image_from_memory(view.GetData(), static_cast<int>(view.GetSize()), &width, &height, &numChannels, SOIL_LOAD_AUTO);
 		if (data == nullptr)
 		{
 			Jwl::Error("Texture: ( %s )\n%s", file.data(), SOIL_last_result());
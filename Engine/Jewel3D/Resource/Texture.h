@@ -12,6 +12,7 @@ namespace Jwl
 	// A 2D texture, renderTarget, or cubemap.
 	class Texture : public Resource<Texture>, public Shareable<Texture>
 	{
+		friend class TextureStreamerSingleton;
 	public:
 		Texture() = default;
 		~Texture();
@@ -29,6 +30,41 @@ namespace Jwl
 		bool Load(std::string filePath);
 		void Unload();
 
+		// The decoded contents of a texture file, ready to be uploaded.
+		struct StreamData
+		{
+			bool isCubeMap = false;
+			unsigned width = 0;
+			unsigned height = 0;
+			TextureFormat format = TextureFormat::RGB_8;
+			TextureFilter filter = TextureFilter::Point;
+			TextureWraps wraps = TextureWrap::Clamp;
+			float anisotropicLevel = 1.0f;
+			// The number of precomputed mip levels. Missing levels are generated after uploading, unless the format is compressed.
+			unsigned numLevels = 1;
+			// Each mip level in turn, from largest to smallest. Cubemaps store all six faces of a level back to back.
+			// Points into either 'file' or 'decoded'.
+			const unsigned char* pixels = nullptr;
+			// Keeps the pixels of a *.texture file alive until they are uploaded.
+			FileView file;
+			// Open if the texture can be streamed, so that its larger levels can be mapped in later.
+			FileMapping mapping;
+			// Holds the pixels of a decompressed image such as a *.png.
+			std::vector<unsigned char> decoded;
+		};
+
+		// Reads the file from disk. Safe to call from any thread.
+		// *.texture files are mapped into memory rather than copied.
+		static bool Decode(std::string filePath, StreamData& out);
+		// Reads the contents of a *.texture file that is already in memory, such as an entry in an archive.
+		// The view is kept in 'out' so that the data remains valid until it is uploaded.
+		static bool Parse(FileView file, StreamData& out, std::string_view name);
+		// Creates the texture from decoded data. Must be called from the main thread.
+		bool Upload(const StreamData& data);
+		// Replaces the contents of a loaded texture with newly decoded data.
+		// Used to apply changes to the texture's file while it is in use. Must be called from the main thread.
+		bool Reload(const StreamData& data);
+
 		void Bind(unsigned slot);
 		void UnBind(unsigned slot);
 
@@ -37,6 +73,17 @@ namespace Jwl
 		// Must be in the range of [1, 16].
 		void SetAnisotropicLevel(float level);
 
+		// Reports that the texture is being drawn roughly 'pixels' texels across on screen.
+		// Streamed textures use this to decide which mip levels should be resident. Other textures ignore it.
+		void RequestResolution(float pixels);
+		// Whether the mip levels of the texture are managed by the TextureStreamer.
+		bool IsStreamed() const;
+		// Returns the most detailed mip level that is resident. This is always 0 unless the texture is streamed.
+		unsigned GetResidentLevel() const;
+
+		// Returns the video memory used by the resident levels.
+		MemoryUsage GetMemoryUsage() const;
+
 		unsigned GetHandle() const;
 		unsigned GetNumSamples() const;
 		unsigned GetBindingTarget() const;
@@ -53,6 +100,16 @@ namespace Jwl
 		void RegenerateMipmaps();
 
 	private:
+		// Creates the texture object from precomputed levels, starting from 'baseLevel'. Replaces any previous texture object.
+		// The pixels start at 'baseLevel', followed by each of the smaller levels.
+		void CreateLevels(const unsigned char* pixels, unsigned numStoredLevels, unsigned baseLevel, bool isCubeMap);
+		// Recreates a streamed texture with a different set of resident levels, from pixels starting at 'level'.
+		void SetResidentLevel(unsigned level, const unsigned char* pixels);
+		// Returns the range of a streamed texture's file that holds level 'first' and the smaller ones after it.
+		void GetLevelRange(unsigned first, uint64_t& out_offset, size_t& out_size) const;
+		// Returns the offset of a level from the start of the pixels.
+		size_t GetLevelOffset(unsigned level) const;
+
 		unsigned hTex       = 0;
 		unsigned numSamples = 1;
 		unsigned target     = 0;
@@ -62,6 +119,16 @@ namespace Jwl
 		TextureFilter filter = TextureFilter::Point;
 		TextureWraps wraps = TextureWrap::Clamp;
 		float anisotropicLevel = 1.0f;
+
+		// The width and height always refer to level 0, even when it is not resident.
+		unsigned residentLevel = 0;
+		unsigned streamHandle = 0;
+		unsigned numStoredLevels = 1;
+		// Streamed textures keep their file open, but only map the levels they are loading.
+		// Keeping the whole file mapped would run out of address space long before video memory.
+		FileMapping streamFile;
+		// Where the pixels start in the file.
+		uint64_t streamOffset = 0;
 	};
 
 	// Used to associate a Texture with a particular binding point.
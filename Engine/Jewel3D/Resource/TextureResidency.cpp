@@ -0,0 +1,243 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "TextureResidency.h"
+#include "Jewel3D/Math/Math.h"
+
+#include <algorithm>
+
+namespace Jwl
+{
+	unsigned TextureResidency::Add(const std::vector<size_t>& levelSizes, unsigned tailLevel)
+	{
+		ASSERT(!levelSizes.empty(), "A texture must have at least one level.");
+		ASSERT(tailLevel < levelSizes.size(), "'tailLevel' must be one of the texture's levels.");
+
+		Entry entry;
+		entry.sizes.resize(levelSizes.size());
+		size_t total = 0;
+		for (size_t i = levelSizes.size(); i-- > 0;)
+		{
+			total += levelSizes[i];
+			entry.sizes[i] = total;
+		}
+
+		entry.tailLevel = tailLevel;
+		entry.level = tailLevel;
+		entry.previousLevel = tailLevel;
+		entry.requestedLevel = tailLevel;
+
+		committed += entry.sizes[tailLevel];
+
+		const unsigned handle = nextHandle++;
+		entries.emplace(handle, std::move(entry));
+
+		return handle;
+	}
+
+	void TextureResidency::Remove(unsigned handle)
+	{
+		auto itr = entries.find(handle);
+		if (itr == entries.end())
+		{
+			return;
+		}
+
+		committed -= itr->second.sizes[itr->second.level];
+		entries.erase(itr);
+	}
+
+	void TextureResidency::Request(unsigned handle, unsigned level, unsigned frame)
+	{
+		auto itr = entries.find(handle);
+		ASSERT(itr != entries.end(), "Texture is not being tracked.");
+
+		Entry& entry = itr->second;
+		level = Min(level, entry.tailLevel);
+
+		if (entry.lastUsedFrame == frame)
+		{
+			entry.requestedLevel = Min(entry.requestedLevel, level);
+		}
+		else
+		{
+			entry.requestedLevel = level;
+			entry.lastUsedFrame = frame;
+		}
+	}
+
+	std::vector<TextureResidency::Change> TextureResidency::Update(unsigned frame)
+	{
+		std::vector<Change> changes;
+
+		// The budget might have been lowered since the last update.
+		if (committed > budget)
+		{
+			MakeRoom(0, frame, changes);
+		}
+
+		std::vector<unsigned> loads;
+		for (auto& [handle, entry] : entries)
+		{
+			if (!entry.isPending && entry.lastUsedFrame == frame && entry.requestedLevel < entry.level)
+			{
+				loads.push_back(handle);
+			}
+		}
+
+		// The textures missing the most detail come first. Ties are broken by handle to keep the order stable.
+		std::sort(loads.begin(), loads.end(), [this](unsigned a, unsigned b) {
+			const Entry& entryA = entries.at(a);
+			const Entry& entryB = entries.at(b);
+			const unsigned missingA = entryA.level - entryA.requestedLevel;
+			const unsigned missingB = entryB.level - entryB.requestedLevel;
+
+			return missingA != missingB ? missingA > missingB : a < b;
+		});
+
+		for (unsigned handle : loads)
+		{
+			Entry& entry = entries.at(handle);
+			const size_t available = budget + CountEvictableBytes(frame);
+
+			// Settle for fewer levels if the whole request does not fit.
+			unsigned level = entry.requestedLevel;
+			while (level < entry.level && committed + (entry.sizes[level] - entry.sizes[entry.level]) > available)
+			{
+				++level;
+			}
+
+			if (level == entry.level)
+			{
+				continue;
+			}
+
+			const size_t bytes = entry.sizes[level] - entry.sizes[entry.level];
+			MakeRoom(bytes, frame, changes);
+
+			entry.previousLevel = entry.level;
+			entry.level = level;
+			entry.isPending = true;
+			committed += bytes;
+
+			changes.push_back({ handle, level, true });
+		}
+
+		return changes;
+	}
+
+	void TextureResidency::Complete(unsigned handle, bool success)
+	{
+		// The texture might have been removed while it was loading.
+		auto itr = entries.find(handle);
+		if (itr == entries.end())
+		{
+			return;
+		}
+
+		Entry& entry = itr->second;
+		ASSERT(entry.isPending, "Texture does not have a pending load.");
+
+		entry.isPending = false;
+		if (!success)
+		{
+			committed -= entry.sizes[entry.level] - entry.sizes[entry.previousLevel];
+			entry.level = entry.previousLevel;
+		}
+	}
+
+	void TextureResidency::SetBudget(size_t bytes)
+	{
+		budget = bytes;
+	}
+
+	size_t TextureResidency::GetBudget() const
+	{
+		return budget;
+	}
+
+	size_t TextureResidency::GetCommittedBytes() const
+	{
+		return committed;
+	}
+
+	unsigned TextureResidency::GetLevel(unsigned handle) const
+	{
+		auto itr = entries.find(handle);
+		ASSERT(itr != entries.end(), "Texture is not being tracked.");
+
+		return itr->second.level;
+	}
+
+	bool TextureResidency::IsPending(unsigned handle) const
+	{
+		auto itr = entries.find(handle);
+		ASSERT(itr != entries.end(), "Texture is not being tracked.");
+
+		return itr->second.isPending;
+	}
+
+	unsigned TextureResidency::GetCount() const
+	{
+		return static_cast<unsigned>(entries.size());
+	}
+
+	unsigned TextureResidency::GetEvictionLevel(const Entry& entry, unsigned frame)
+	{
+		return entry.lastUsedFrame == frame ? entry.requestedLevel : entry.tailLevel;
+	}
+
+	size_t TextureResidency::CountEvictableBytes(unsigned frame) const
+	{
+		size_t total = 0;
+		for (auto& [handle, entry] : entries)
+		{
+			const unsigned level = GetEvictionLevel(entry, frame);
+			if (!entry.isPending && level > entry.level)
+			{
+				total += entry.sizes[entry.level] - entry.sizes[level];
+			}
+		}
+
+		return total;
+	}
+
+	void TextureResidency::MakeRoom(size_t bytes, unsigned frame, std::vector<Change>& changes)
+	{
+		while (committed + bytes > budget)
+		{
+			// Find the least recently used texture with levels to spare. The largest is chosen among equals.
+			unsigned victim = 0;
+			const Entry* victimEntry = nullptr;
+			size_t victimBytes = 0;
+			for (auto& [handle, entry] : entries)
+			{
+				const unsigned level = GetEvictionLevel(entry, frame);
+				if (entry.isPending || level <= entry.level)
+				{
+					continue;
+				}
+
+				const size_t evictable = entry.sizes[entry.level] - entry.sizes[level];
+				if (!victimEntry ||
+					entry.lastUsedFrame < victimEntry->lastUsedFrame ||
+					(entry.lastUsedFrame == victimEntry->lastUsedFrame && (evictable > victimBytes || (evictable == victimBytes && handle < victim))))
+				{
+					victim = handle;
+					victimEntry = &entry;
+					victimBytes = evictable;
+				}
+			}
+
+			if (!victimEntry)
+			{
+				return;
+			}
+
+			Entry& entry = entries.at(victim);
+			entry.level = GetEvictionLevel(entry, frame);
+			committed -= victimBytes;
+
+			changes.push_back({ victim, entry.level, false });
+		}
+	}
+}
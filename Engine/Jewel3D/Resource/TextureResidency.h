@@ -0,0 +1,80 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <unordered_map>
+#include <vector>
+
+namespace Jwl
+{
+	// Decides which mip levels of streamed textures are kept in memory.
+	// Each texture has a tail of small levels that is always resident. The larger levels are loaded when rendering asks
+	// for them, and are evicted, least recently used first, when the memory budget is needed by another texture.
+	// Only the bookkeeping is done here, so that the decisions can be made and tested without a graphics context.
+	class TextureResidency
+	{
+	public:
+		// A change in the residency of a texture. Once applied, all levels from 'level' to the smallest are resident.
+		struct Change
+		{
+			unsigned handle = 0;
+			unsigned level = 0;
+			// Loads add detailed levels, evictions remove them.
+			bool isLoad = false;
+		};
+
+		// Begins tracking a texture. 'levelSizes' holds the size in bytes of each level, from largest to smallest.
+		// The levels from 'tailLevel' onwards are resident immediately and are never evicted.
+		// Returns a handle for the texture. Handles are never reused.
+		unsigned Add(const std::vector<size_t>& levelSizes, unsigned tailLevel);
+		// Stops tracking the texture and releases its memory from the budget.
+		void Remove(unsigned handle);
+
+		// Records that the texture was used during 'frame', and that it needs 'level' to be resident to look its best.
+		// If it is requested multiple times in a frame, the most detailed level is kept.
+		void Request(unsigned handle, unsigned level, unsigned frame);
+
+		// Returns the changes that bring the textures used during 'frame' to their requested levels within the budget.
+		// The most blurry textures are served first. If the full request does not fit, as many levels are loaded as will.
+		// Evictions are listed before the loads that need their memory, and are considered finished right away.
+		// Loads are charged to the budget immediately, but the texture is pending until Complete() is called.
+		std::vector<Change> Update(unsigned frame);
+
+		// Finishes a pending load. If it failed, the texture returns to its previous level and the memory is released.
+		void Complete(unsigned handle, bool success);
+
+		void SetBudget(size_t bytes);
+		size_t GetBudget() const;
+
+		// Returns the size of all resident and pending levels, including the tails.
+		size_t GetCommittedBytes() const;
+
+		// Returns the most detailed level that is resident, or is being loaded.
+		unsigned GetLevel(unsigned handle) const;
+		bool IsPending(unsigned handle) const;
+		unsigned GetCount() const;
+
+	private:
+		struct Entry
+		{
+			// The size of each level added to all of the smaller levels after it.
+			std::vector<size_t> sizes;
+			unsigned tailLevel = 0;
+			unsigned level = 0;
+			// The level to return to if a pending load fails.
+			unsigned previousLevel = 0;
+			unsigned requestedLevel = 0;
+			unsigned lastUsedFrame = 0;
+			bool isPending = false;
+		};
+
+		// Textures used this frame keep their requested levels. All others can be evicted down to their tails.
+		static unsigned GetEvictionLevel(const Entry& entry, unsigned frame);
+		size_t CountEvictableBytes(unsigned frame) const;
+		// Evicts the least recently used levels until 'bytes' more fit in the budget, or nothing more can be evicted.
+		void MakeRoom(size_t bytes, unsigned frame, std::vector<Change>& changes);
+
+		std::unordered_map<unsigned, Entry> entries;
+		unsigned nextHandle = 1;
+		size_t budget = 256 * 1024 * 1024;
+		size_t committed = 0;
+	};
+}
@@ -0,0 +1,178 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "TextureStreamer.h"
+#include "AssetStreamer.h"
+#include "Texture.h"
+#include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Math/Math.h"
+
+namespace Jwl
+{
+	class TextureStreamerSingleton::LevelRequest : public StreamRequest
+	{
+	public:
+		LevelRequest(unsigned _handle, unsigned _level, FileMapping _file, uint64_t _offset, size_t _size)
+			: handle(_handle), level(_level), file(std::move(_file)), offset(_offset), size(_size)
+		{
+		}
+
+	protected:
+		bool Read() override
+		{
+			levels = file.Map(offset, size);
+			if (!levels.IsOpen())
+			{
+				return false;
+			}
+
+			// Touching each page here means that the main thread does not stall on the disk when it uploads the levels.
+			levels.Prefetch();
+			return true;
+		}
+
+		bool Upload() override
+		{
+			const bool success = TextureStreamer.Upload(handle, level, levels.GetData());
+			levels.Close();
+
+			return success;
+		}
+
+		void Complete(bool success) override
+		{
+			levels.Close();
+			TextureStreamer.Complete(handle, success);
+		}
+
+	private:
+		unsigned handle;
+		unsigned level;
+		FileMapping file;
+		// The range of the file holding the new level and the smaller ones after it.
+		uint64_t offset;
+		size_t size;
+		// Only mapped from when it is read until it is uploaded.
+		FileView levels;
+	};
+
+	//-----------------------------------------------------------------------------------------------------
+
+	TextureStreamerSingleton TextureStreamer;
+
+	void TextureStreamerSingleton::SetEnabled(bool enabled)
+	{
+		isEnabled = enabled;
+	}
+
+	bool TextureStreamerSingleton::IsEnabled() const
+	{
+		return isEnabled;
+	}
+
+	void TextureStreamerSingleton::SetBudget(size_t bytes)
+	{
+		residency.SetBudget(bytes);
+	}
+
+	size_t TextureStreamerSingleton::GetBudget() const
+	{
+		return residency.GetBudget();
+	}
+
+	size_t TextureStreamerSingleton::GetUsage() const
+	{
+		return residency.GetCommittedBytes();
+	}
+
+	void TextureStreamerSingleton::SetTailSize(unsigned pixels)
+	{
+		ASSERT(pixels > 0, "Tail size must be at least one pixel.");
+
+		tailSize = pixels;
+	}
+
+	unsigned TextureStreamerSingleton::GetTailSize() const
+	{
+		return tailSize;
+	}
+
+	unsigned TextureStreamerSingleton::GetTailLevel(unsigned width, unsigned height, unsigned numLevels) const
+	{
+		unsigned level = 0;
+		while (level + 1 < numLevels && Max(width >> level, height >> level) > tailSize)
+		{
+			++level;
+		}
+
+		return level;
+	}
+
+	unsigned TextureStreamerSingleton::Register(Texture& texture, const std::vector<size_t>& levelSizes, unsigned tailLevel)
+	{
+		const unsigned handle = residency.Add(levelSizes, tailLevel);
+		textures.emplace(handle, &texture);
+
+		return handle;
+	}
+
+	void TextureStreamerSingleton::Unregister(unsigned handle)
+	{
+		residency.Remove(handle);
+		textures.erase(handle);
+	}
+
+	void TextureStreamerSingleton::Request(unsigned handle, unsigned level)
+	{
+		residency.Request(handle, level, frame);
+	}
+
+	bool TextureStreamerSingleton::Upload(unsigned handle, unsigned level, const unsigned char* pixels)
+	{
+		auto itr = textures.find(handle);
+		if (itr == textures.end())
+		{
+			return false;
+		}
+
+		itr->second->SetResidentLevel(level, pixels);
+		return true;
+	}
+
+	void TextureStreamerSingleton::Complete(unsigned handle, bool success)
+	{
+		residency.Complete(handle, success);
+	}
+
+	void TextureStreamerSingleton::Update()
+	{
+		for (auto& change : residency.Update(frame))
+		{
+			Texture& texture = *textures.at(change.handle);
+
+			uint64_t offset = 0;
+			size_t size = 0;
+			texture.GetLevelRange(change.level, offset, size);
+
+			if (change.isLoad)
+			{
+				AssetStreamer.Submit(std::make_shared<LevelRequest>(change.handle, change.level, texture.streamFile, offset, size));
+			}
+			else
+			{
+				// Evicting only recreates the texture from the smaller levels.
+				// They were read recently, so mapping them here rarely has to wait on the disk.
+				FileView levels = texture.streamFile.Map(offset, size);
+				if (levels.IsOpen())
+				{
+					texture.SetResidentLevel(change.level, levels.GetData());
+				}
+				else
+				{
+					Error("TextureStreamer: Unable to map the levels of a texture to evict it.");
+				}
+			}
+		}
+
+		++frame;
+	}
+}
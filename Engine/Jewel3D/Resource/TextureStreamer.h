@@ -0,0 +1,61 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include "TextureResidency.h"
+
+#include <unordered_map>
+
+namespace Jwl
+{
+	class Texture;
+
+	// Streams the detailed mip levels of textures in and out of GPU memory based on how large they appear on screen.
+	// While enabled, *.texture files with precomputed mip levels are created with only their smallest levels resident.
+	// Rendering reports the resolution that each texture is drawn at, and the missing levels are read on the
+	// AssetStreamer's I/O threads before being uploaded. The levels of textures that have not been drawn recently
+	// are evicted when their memory is needed to stay within the budget.
+	extern class TextureStreamerSingleton TextureStreamer;
+	class TextureStreamerSingleton
+	{
+		friend class ApplicationSingleton;
+		friend class Texture;
+	public:
+		// Only affects textures that are loaded afterwards.
+		void SetEnabled(bool enabled);
+		bool IsEnabled() const;
+
+		// Sets the number of bytes that streamed textures may occupy. The smallest levels of each texture are always kept.
+		void SetBudget(size_t bytes);
+		size_t GetBudget() const;
+		// Returns the number of bytes occupied by streamed textures, including levels that are still being loaded.
+		size_t GetUsage() const;
+
+		// Levels that are at most this many pixels across are loaded up front and are never evicted.
+		void SetTailSize(unsigned pixels);
+		unsigned GetTailSize() const;
+
+	private:
+		// Reads in the new levels of a streamed texture.
+		class LevelRequest;
+
+		// Returns the first level of a texture that is small enough to be part of its tail.
+		unsigned GetTailLevel(unsigned width, unsigned height, unsigned numLevels) const;
+
+		unsigned Register(Texture& texture, const std::vector<size_t>& levelSizes, unsigned tailLevel);
+		void Unregister(unsigned handle);
+		void Request(unsigned handle, unsigned level);
+
+		// Applies a finished load from pixels starting at 'level'. Returns false if the texture was unloaded in the meantime.
+		bool Upload(unsigned handle, unsigned level, const unsigned char* pixels);
+		void Complete(unsigned handle, bool success);
+
+		// Starts the loads and evictions for the frame that was just rendered.
+		void Update();
+
+		TextureResidency residency;
+		std::unordered_map<unsigned, Texture*> textures;
+		// Counts rendered frames, so that recently drawn textures can be told apart.
+		unsigned frame = 1;
+		unsigned tailSize = 128;
+		bool isEnabled = false;
+	};
+}
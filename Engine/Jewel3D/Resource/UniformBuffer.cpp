@@ -1,6 +1,7 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Jewel3D/Precompiled.h"
 #include "UniformBuffer.h"
+#include "Jewel3D/Application/FrameStats.h"
 #include "Jewel3D/Application/Logging.h"
 #include "Jewel3D/Math/Vector.h"
 
@@ -86,10 +87,12 @@ namespace Jwl
 	void UniformBuffer::Bind(unsigned slot) const
 	{
 		glBindBufferBase(GL_UNIFORM_BUFFER, slot, UBO);
+		FrameStats.CountUniformBufferBind();
 
 		if (dirty)
 		{
 			glBufferSubData(GL_UNIFORM_BUFFER, 0, bufferSize, buffer);
+			FrameStats.CountUpload(bufferSize);
 			dirty = false;
 		}
 	}
@@ -1,6 +1,7 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "Jewel3D/Precompiled.h"
 #include "VertexArray.h"
+#include "Jewel3D/Application/FrameStats.h"
 #include "Jewel3D/Application/Logging.h"
 
 #include <GLEW/GL/glew.h>
@@ -37,6 +38,7 @@ namespace Jwl
 
 		Bind();
 		glBufferSubData(GL_ARRAY_BUFFER, start, _size, data);
+		FrameStats.CountUpload(_size);
 		UnBind();
 	}
 
@@ -72,6 +74,71 @@ namespace Jwl
 		glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
 	}
 
+	// Index buffers are created and edited through GL_COPY_WRITE_BUFFER rather than GL_ELEMENT_ARRAY_BUFFER,
+	// because the element binding is part of the currently bound VertexArray's state.
+	IndexBuffer::IndexBuffer(unsigned _count, IndexFormat _format, VertexBufferUsage _usage)
+		: count(_count)
+		, format(_format)
+		, usage(_usage)
+	{
+		ASSERT(count, "An IndexBuffer must have a non-zero count.");
+
+		glGenBuffers(1, &IBO);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, IBO);
+		glBufferData(GL_COPY_WRITE_BUFFER, GetSize(), nullptr, ResolveVertexBufferUsage(usage));
+		glBindBuffer(GL_COPY_WRITE_BUFFER, GL_NONE);
+	}
+
+	IndexBuffer::~IndexBuffer()
+	{
+		glDeleteBuffers(1, &IBO);
+	}
+
+	void IndexBuffer::SetData(unsigned start, unsigned _count, const void* data)
+	{
+		ASSERT(start + _count <= count, "Out of bounds.");
+
+		const unsigned indexSize = CountBytes(format);
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, IBO);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, start * indexSize, _count * indexSize, data);
+		FrameStats.CountUpload(_count * indexSize);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, GL_NONE);
+	}
+
+	void* IndexBuffer::MapBuffer(VertexAccess accessMode)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, IBO);
+		return glMapBuffer(GL_COPY_WRITE_BUFFER, ResolveVertexAccess(accessMode));
+	}
+
+	void IndexBuffer::UnmapBuffer()
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, IBO);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, GL_NONE);
+	}
+
+	unsigned IndexBuffer::GetCount() const
+	{
+		return count;
+	}
+
+	unsigned IndexBuffer::GetSize() const
+	{
+		return count * CountBytes(format);
+	}
+
+	IndexFormat IndexBuffer::GetFormat() const
+	{
+		return format;
+	}
+
+	VertexBufferUsage IndexBuffer::GetBufferUsage() const
+	{
+		return usage;
+	}
+
 	VertexArray::VertexArray()
 	{
 		glGenVertexArrays(1, &VAO);
@@ -166,6 +233,15 @@ namespace Jwl
 			break;
 		}
 
+		case VertexFormat::HalfVec2:
+		case VertexFormat::uShortVec2:
+			glVertexAttribPointer(ptr.bindingUnit, 2, ResolveVertexFormat(ptr.format), ptr.normalized, ptr.stride, reinterpret_cast<void*>(ptr.startOffset));
+			break;
+		case VertexFormat::uShortVec4:
+		case VertexFormat::Int_2_10_10_10:
+			glVertexAttribPointer(ptr.bindingUnit, 4, ResolveVertexFormat(ptr.format), ptr.normalized, ptr.stride, reinterpret_cast<void*>(ptr.startOffset));
+			break;
+
 		case VertexFormat::Int:
 		case VertexFormat::uInt:
 		case VertexFormat::Short:
@@ -270,6 +346,59 @@ namespace Jwl
 		return *GetStream(bindingUnit).buffer;
 	}
 
+	void VertexArray::SetIndexBuffer(IndexBuffer::Ptr buffer)
+	{
+		ASSERT(buffer, "'buffer' cannot be nullptr.");
+
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer->IBO);
+		glBindVertexArray(GL_NONE);
+
+		indexBuffer = std::move(buffer);
+	}
+
+	void VertexArray::RemoveIndexBuffer()
+	{
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_NONE);
+		glBindVertexArray(GL_NONE);
+
+		indexBuffer.reset();
+	}
+
+	bool VertexArray::HasIndexBuffer() const
+	{
+		return indexBuffer != nullptr;
+	}
+
+	const IndexBuffer& VertexArray::GetIndexBuffer() const
+	{
+		ASSERT(indexBuffer, "VertexArray does not have an IndexBuffer.");
+		return *indexBuffer;
+	}
+
+	void VertexArray::SetPositionTransform(const mat4& transform)
+	{
+		positionTransform = transform;
+		hasPositionTransform = true;
+	}
+
+	void VertexArray::RemovePositionTransform()
+	{
+		positionTransform = mat4::Identity;
+		hasPositionTransform = false;
+	}
+
+	bool VertexArray::HasPositionTransform() const
+	{
+		return hasPositionTransform;
+	}
+
+	const mat4& VertexArray::GetPositionTransform() const
+	{
+		return positionTransform;
+	}
+
 	void VertexArray::Bind() const
 	{
 		glBindVertexArray(VAO);
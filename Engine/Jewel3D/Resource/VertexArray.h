@@ -1,5 +1,6 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include "Jewel3D/Math/Matrix.h"
 #include "Jewel3D/Rendering/Rendering.h"
 #include "Jewel3D/Resource/Shareable.h"
 
@@ -35,6 +36,35 @@ namespace Jwl
 		VertexBufferUsage usage;
 	};
 
+	// An OpenGL buffer of vertex indices. Attached to a VertexArray to render indexed triangles.
+	class IndexBuffer : public Shareable<IndexBuffer>
+	{
+		friend class VertexArray;
+	public:
+		IndexBuffer(unsigned count, IndexFormat format, VertexBufferUsage usage);
+		~IndexBuffer();
+
+		// 'start' and 'count' are measured in indices.
+		void SetData(unsigned start, unsigned count, const void* data);
+
+		// Must be followed by a call to UnmapBuffer() before rendering with the buffer.
+		void* MapBuffer(VertexAccess accessMode);
+		void UnmapBuffer();
+
+		// Returns the number of indices in the buffer.
+		unsigned GetCount() const;
+		// Returns the size of the buffer in bytes.
+		unsigned GetSize() const;
+		IndexFormat GetFormat() const;
+		VertexBufferUsage GetBufferUsage() const;
+
+	private:
+		unsigned IBO = 0;
+		unsigned count = 0;
+		IndexFormat format;
+		VertexBufferUsage usage;
+	};
+
 	// A single vertex attribute to be streamed to a vertex shader.
 	// Defines how to read the attribute from the given VertexBuffer.
 	struct VertexStream
@@ -75,9 +105,23 @@ namespace Jwl
 		template<typename Type>
 		detail::VertexRange<Type> GetStream(unsigned bindingUnit, VertexAccess access = VertexAccess::ReadWrite);
 
+		// When an IndexBuffer is set, the array is drawn with its indices rather than in vertex order.
+		void SetIndexBuffer(IndexBuffer::Ptr buffer);
+		void RemoveIndexBuffer();
+		bool HasIndexBuffer() const;
+		const IndexBuffer& GetIndexBuffer() const;
+
+		// Applied to positions before the model transform. Used to expand quantized positions back into local-space.
+		// Not supported when rendering with instancing.
+		void SetPositionTransform(const mat4& transform);
+		void RemovePositionTransform();
+		bool HasPositionTransform() const;
+		const mat4& GetPositionTransform() const;
+
 		void Bind() const;
 		void UnBind() const;
 
+		// The number of vertices in the streams. For indexed arrays, the number of elements drawn is the IndexBuffer's count.
 		void SetVertexCount(unsigned count);
 		unsigned GetVertexCount() const;
 		const auto& GetStreams() const { return streams; }
@@ -86,6 +130,11 @@ namespace Jwl
 		unsigned VAO = 0;
 		unsigned vertexCount = 0;
 
+		IndexBuffer::Ptr indexBuffer;
+
+		mat4 positionTransform;
+		bool hasPositionTransform = false;
+
 		std::vector<VertexStream> streams;
 	};
 }
@@ -0,0 +1,54 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <cstring>
+#include <type_traits>
+
+namespace Jwl
+{
+	// Reads binary values from a block of memory.
+	// Reads that would go past the end of the block fail and leave the output untouched.
+	class BinaryReader
+	{
+	public:
+		BinaryReader(const void* _data, size_t _size)
+			: data(static_cast<const unsigned char*>(_data)), size(_size) {}
+
+		// Copies the next value out of the block. The data does not need to be aligned.
+		template<typename T>
+		bool Read(T& out)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read.");
+
+			const unsigned char* bytes = ReadBytes(sizeof(T));
+			if (bytes == nullptr)
+			{
+				return false;
+			}
+
+			memcpy(&out, bytes, sizeof(T));
+			return true;
+		}
+
+		// Returns a pointer to the next 'count' bytes and moves past them, or nullptr if there are not enough.
+		const unsigned char* ReadBytes(size_t count)
+		{
+			if (count > GetRemaining())
+			{
+				return nullptr;
+			}
+
+			const unsigned char* result = data + position;
+			position += count;
+
+			return result;
+		}
+
+		size_t GetPosition() const { return position; }
+		size_t GetRemaining() const { return size - position; }
+
+	private:
+		const unsigned char* data;
+		size_t size;
+		size_t position = 0;
+	};
+}
@@ -0,0 +1,213 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "Compression.h"
+
+#include <algorithm>
+
+#define MIN_MATCH 4
+// The last match must start at least this many bytes before the end of the input.
+#define MATCH_START_LIMIT 12
+// The last this many bytes of the input are always encoded as literals.
+#define LAST_LITERALS 5
+#define MAX_OFFSET 0xFFFF
+#define HASH_BITS 12
+
+namespace
+{
+	uint32_t Read32(const unsigned char* ptr)
+	{
+		uint32_t value;
+		memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	uint32_t HashSequence(uint32_t sequence)
+	{
+		return (sequence * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	// Lengths that don't fit in a token's nibble continue in a run of bytes.
+	void WriteLength(std::vector<unsigned char>& out, size_t length)
+	{
+		while (length >= 255)
+		{
+			out.push_back(255);
+			length -= 255;
+		}
+
+		out.push_back(static_cast<unsigned char>(length));
+	}
+
+	bool ReadLength(const unsigned char* src, size_t srcSize, size_t& pos, size_t& length)
+	{
+		unsigned char byte;
+		do
+		{
+			if (pos >= srcSize)
+			{
+				return false;
+			}
+
+			byte = src[pos++];
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	void WriteSequence(std::vector<unsigned char>& out, const unsigned char* literals, size_t numLiterals, size_t offset, size_t matchLength)
+	{
+		const size_t matchCode = matchLength - MIN_MATCH;
+
+		unsigned char token = static_cast<unsigned char>(std::min<size_t>(numLiterals, 15) << 4);
+		if (offset != 0)
+		{
+			token |= static_cast<unsigned char>(std::min<size_t>(matchCode, 15));
+		}
+
+		out.push_back(token);
+		if (numLiterals >= 15)
+		{
+			WriteLength(out, numLiterals - 15);
+		}
+
+		out.insert(out.end(), literals, literals + numLiterals);
+
+		// The final sequence holds only literals.
+		if (offset == 0)
+		{
+			return;
+		}
+
+		out.push_back(static_cast<unsigned char>(offset & 0xFF));
+		out.push_back(static_cast<unsigned char>(offset >> 8));
+		if (matchCode >= 15)
+		{
+			WriteLength(out, matchCode - 15);
+		}
+	}
+}
+
+namespace Jwl
+{
+	void CompressLZ4(const void* data, size_t size, std::vector<unsigned char>& out)
+	{
+		auto* src = static_cast<const unsigned char*>(data);
+
+		out.clear();
+		out.reserve(size + size / 255 + 16);
+
+		size_t anchor = 0;
+		if (size > MATCH_START_LIMIT)
+		{
+			// Holds the last position + 1 at which each hashed sequence was seen. Zero means unused.
+			std::vector<uint32_t> table(1 << HASH_BITS, 0);
+
+			const size_t matchStartLimit = size - MATCH_START_LIMIT;
+			const size_t matchEndLimit = size - LAST_LITERALS;
+
+			size_t pos = 0;
+			while (pos < matchStartLimit)
+			{
+				const uint32_t sequence = Read32(src + pos);
+				uint32_t& entry = table[HashSequence(sequence)];
+				const size_t candidate = entry;
+				entry = static_cast<uint32_t>(pos + 1);
+
+				if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || Read32(src + candidate - 1) != sequence)
+				{
+					++pos;
+					continue;
+				}
+
+				const size_t match = candidate - 1;
+				size_t length = MIN_MATCH;
+				while (pos + length < matchEndLimit && src[match + length] == src[pos + length])
+				{
+					++length;
+				}
+
+				WriteSequence(out, src + anchor, pos - anchor, pos - match, length);
+
+				pos += length;
+				anchor = pos;
+			}
+		}
+
+		WriteSequence(out, src + anchor, size - anchor, 0, 0);
+	}
+
+	bool DecompressLZ4(const void* data, size_t size, void* out, size_t decompressedSize)
+	{
+		auto* src = static_cast<const unsigned char*>(data);
+		auto* dst = static_cast<unsigned char*>(out);
+
+		size_t srcPos = 0;
+		size_t dstPos = 0;
+		while (srcPos < size)
+		{
+			const unsigned char token = src[srcPos++];
+
+			size_t numLiterals = token >> 4;
+			if (numLiterals == 15 && !ReadLength(src, size, srcPos, numLiterals))
+			{
+				return false;
+			}
+
+			if (numLiterals > size - srcPos || numLiterals > decompressedSize - dstPos)
+			{
+				return false;
+			}
+
+			// The destination can be null when decompressing an empty buffer, which memcpy does not allow even for 0 bytes.
+			if (numLiterals > 0)
+			{
+				memcpy(dst + dstPos, src + srcPos, numLiterals);
+			}
+
+			srcPos += numLiterals;
+			dstPos += numLiterals;
+
+			// The final sequence has no match.
+			if (srcPos == size)
+			{
+				break;
+			}
+
+			if (size - srcPos < 2)
+			{
+				return false;
+			}
+
+			const size_t offset = src[srcPos] | (src[srcPos + 1] << 8);
+			srcPos += 2;
+			if (offset == 0 || offset > dstPos)
+			{
+				return false;
+			}
+
+			size_t matchLength = token & 0xF;
+			if (matchLength == 15 && !ReadLength(src, size, srcPos, matchLength))
+			{
+				return false;
+			}
+
+			matchLength += MIN_MATCH;
+			if (matchLength > decompressedSize - dstPos)
+			{
+				return false;
+			}
+
+			// The match may overlap the bytes it is producing, so it must be copied forwards one byte at a time.
+			const unsigned char* match = dst + dstPos - offset;
+			for (size_t i = 0; i < matchLength; ++i)
+			{
+				dst[dstPos + i] = match[i];
+			}
+
+			dstPos += matchLength;
+		}
+
+		return dstPos == decompressedSize;
+	}
+}
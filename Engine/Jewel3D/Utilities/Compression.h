@@ -0,0 +1,16 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <vector>
+
+// Lossless compression using the LZ4 block format.
+// LZ4 favours decompression speed over compression ratio, which suits data that is compressed once
+// by a tool and then decompressed every time it is loaded.
+namespace Jwl
+{
+	// Compresses the data, replacing the contents of 'out'.
+	void CompressLZ4(const void* data, size_t size, std::vector<unsigned char>& out);
+
+	// Decompresses data produced by CompressLZ4() into a buffer of exactly 'decompressedSize' bytes.
+	// Returns false if the data is malformed or would not exactly fill the buffer.
+	bool DecompressLZ4(const void* data, size_t size, void* out, size_t decompressedSize);
+}
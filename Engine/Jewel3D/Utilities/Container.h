@@ -1,7 +1,11 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include "Jewel3D/Utilities/Hash.h"
+
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace Jwl
 {
@@ -17,4 +21,125 @@ namespace Jwl
 		size_t operator()(const std::string& text) const { return hash_type{}(text); }
 		size_t operator()(const char* text) const { return hash_type{}(text); }
 	};
+
+	// An insert-only hash map which stores its elements in a single array and resolves collisions with linear probing.
+	// Lookups touch contiguous memory instead of chasing per-node allocations like std::unordered_map.
+	// Key and Value must be default constructible and movable. Inserting may move existing elements,
+	// so pointers returned by Find() or Insert() are only valid until the next call to Insert().
+	template<typename Key, typename Value, typename Hasher = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class FlatHashMap
+	{
+	public:
+		// Returns the value associated with the key, or nullptr if there is none.
+		Value* Find(const Key& key)
+		{
+			if (count == 0)
+			{
+				return nullptr;
+			}
+
+			Slot& slot = slots[FindSlot(key, HashKey(key))];
+			return slot.hash != 0 ? &slot.value : nullptr;
+		}
+
+		const Value* Find(const Key& key) const
+		{
+			return const_cast<FlatHashMap*>(this)->Find(key);
+		}
+
+		// Returns the value associated with the key, default constructing it if it does not exist yet.
+		// The second element of the result is true if the value was newly created.
+		std::pair<Value*, bool> Insert(const Key& key)
+		{
+			// Keep the load factor at or below 50% so that probe sequences stay short.
+			if ((count + 1) * 2 > slots.size())
+			{
+				Grow();
+			}
+
+			const uint64_t hash = HashKey(key);
+			Slot& slot = slots[FindSlot(key, hash)];
+			if (slot.hash != 0)
+			{
+				return { &slot.value, false };
+			}
+
+			slot.hash = hash;
+			slot.key = key;
+			++count;
+
+			return { &slot.value, true };
+		}
+
+		// Destroys all elements.
+		void Clear()
+		{
+			slots.clear();
+			count = 0;
+		}
+
+		unsigned Count() const { return static_cast<unsigned>(count); }
+		bool IsEmpty() const { return count == 0; }
+
+		// Calls 'func' with the key and value of each element, in no particular order.
+		// Elements must not be inserted until the iteration is complete.
+		template<typename Func>
+		void ForEach(Func&& func)
+		{
+			for (Slot& slot : slots)
+			{
+				if (slot.hash != 0)
+				{
+					func(std::as_const(slot.key), slot.value);
+				}
+			}
+		}
+
+	private:
+		struct Slot
+		{
+			// Zero marks an empty slot.
+			uint64_t hash = 0;
+			Key key;
+			Value value;
+		};
+
+		static uint64_t HashKey(const Key& key)
+		{
+			const uint64_t hash = HashMix(static_cast<uint64_t>(Hasher{}(key)));
+			return hash != 0 ? hash : 1;
+		}
+
+		// Returns the index of the slot holding the key, or of the empty slot where it belongs.
+		size_t FindSlot(const Key& key, uint64_t hash) const
+		{
+			const size_t mask = slots.size() - 1;
+			for (size_t i = static_cast<size_t>(hash) & mask;; i = (i + 1) & mask)
+			{
+				const Slot& slot = slots[i];
+				if (slot.hash == 0 || (slot.hash == hash && KeyEqual{}(slot.key, key)))
+				{
+					return i;
+				}
+			}
+		}
+
+		void Grow()
+		{
+			std::vector<Slot> oldSlots(slots.empty() ? 16 : slots.size() * 2);
+			oldSlots.swap(slots);
+
+			for (Slot& oldSlot : oldSlots)
+			{
+				if (oldSlot.hash != 0)
+				{
+					slots[FindSlot(oldSlot.key, oldSlot.hash)] = std::move(oldSlot);
+				}
+			}
+		}
+
+		// The size is always zero or a power of two.
+		std::vector<Slot> slots;
+		size_t count = 0;
+	};
 }
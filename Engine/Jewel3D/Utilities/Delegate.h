@@ -0,0 +1,221 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Jwl
+{
+	template<typename Signature>
+	class Delegate;
+
+	// A callable wrapper like std::function, which stores small callables inside of itself instead of on the heap.
+	// Function pointers, and lambdas capturing up to three pointers, are stored inline and copied without any allocation.
+	// Larger callables are still supported, but are heap allocated.
+	template<typename Return, typename... Args>
+	class Delegate<Return(Args...)>
+	{
+	public:
+		Delegate() = default;
+		Delegate(std::nullptr_t) {}
+
+		template<typename Functor, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Functor>, Delegate>>>
+		Delegate(Functor&& functor)
+		{
+			Assign(std::forward<Functor>(functor));
+		}
+
+		Delegate(const Delegate& other)
+		{
+			CopyFrom(other);
+		}
+
+		Delegate(Delegate&& other) noexcept
+		{
+			MoveFrom(other);
+		}
+
+		~Delegate()
+		{
+			Reset();
+		}
+
+		Delegate& operator=(const Delegate& other)
+		{
+			if (this != &other)
+			{
+				Reset();
+				CopyFrom(other);
+			}
+
+			return *this;
+		}
+
+		Delegate& operator=(Delegate&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Reset();
+				MoveFrom(other);
+			}
+
+			return *this;
+		}
+
+		Delegate& operator=(std::nullptr_t)
+		{
+			Reset();
+			return *this;
+		}
+
+		template<typename Functor, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Functor>, Delegate>>>
+		Delegate& operator=(Functor&& functor)
+		{
+			Reset();
+			Assign(std::forward<Functor>(functor));
+			return *this;
+		}
+
+		// Calls the stored function. The delegate must not be empty.
+		Return operator()(Args... args) const
+		{
+			return invoke(const_cast<std::byte*>(storage), std::forward<Args>(args)...);
+		}
+
+		explicit operator bool() const
+		{
+			return invoke != nullptr;
+		}
+
+	private:
+		static constexpr size_t STORAGE_SIZE = sizeof(void*) * 3;
+
+		template<typename Functor>
+		static constexpr bool IsInline = sizeof(Functor) <= STORAGE_SIZE && alignof(Functor) <= alignof(void*) && std::is_nothrow_move_constructible_v<Functor>;
+
+		enum class Operation
+		{
+			Copy,
+			Move,
+			Destroy
+		};
+
+		using InvokeFunc = Return(*)(void* storage, Args&&... args);
+		// Copies, moves, or destroys the stored callable. Null for inline callables that can be copied bytewise.
+		using ManageFunc = void(*)(Operation operation, void* destination, void* source);
+
+		template<typename Functor>
+		void Assign(Functor&& functor)
+		{
+			using Stored = std::decay_t<Functor>;
+
+			// Null function pointers and empty std::functions leave the delegate empty.
+			if constexpr (std::is_constructible_v<bool, const Stored&>)
+			{
+				if (!static_cast<bool>(functor))
+				{
+					return;
+				}
+			}
+
+			if constexpr (IsInline<Stored>)
+			{
+				new (storage) Stored(std::forward<Functor>(functor));
+				invoke = [](void* data, Args&&... args) -> Return {
+					return (*static_cast<Stored*>(data))(std::forward<Args>(args)...);
+				};
+
+				if constexpr (!std::is_trivially_copyable_v<Stored>)
+				{
+					manage = [](Operation operation, void* destination, void* source) {
+						switch (operation)
+						{
+						case Operation::Copy:
+							new (destination) Stored(*static_cast<const Stored*>(source));
+							break;
+						case Operation::Move:
+							new (destination) Stored(std::move(*static_cast<Stored*>(source)));
+							static_cast<Stored*>(source)->~Stored();
+							break;
+						case Operation::Destroy:
+							static_cast<Stored*>(destination)->~Stored();
+							break;
+						}
+					};
+				}
+			}
+			else
+			{
+				// Only a pointer to the callable is stored.
+				*reinterpret_cast<Stored**>(storage) = new Stored(std::forward<Functor>(functor));
+				invoke = [](void* data, Args&&... args) -> Return {
+					return (**static_cast<Stored**>(data))(std::forward<Args>(args)...);
+				};
+
+				manage = [](Operation operation, void* destination, void* source) {
+					switch (operation)
+					{
+					case Operation::Copy:
+						*static_cast<Stored**>(destination) = new Stored(**static_cast<Stored**>(source));
+						break;
+					case Operation::Move:
+						*static_cast<Stored**>(destination) = *static_cast<Stored**>(source);
+						break;
+					case Operation::Destroy:
+						delete *static_cast<Stored**>(destination);
+						break;
+					}
+				};
+			}
+		}
+
+		void CopyFrom(const Delegate& other)
+		{
+			if (other.manage)
+			{
+				other.manage(Operation::Copy, storage, const_cast<std::byte*>(other.storage));
+			}
+			else
+			{
+				std::memcpy(storage, other.storage, STORAGE_SIZE);
+			}
+
+			invoke = other.invoke;
+			manage = other.manage;
+		}
+
+		void MoveFrom(Delegate& other)
+		{
+			if (other.manage)
+			{
+				other.manage(Operation::Move, storage, other.storage);
+			}
+			else
+			{
+				std::memcpy(storage, other.storage, STORAGE_SIZE);
+			}
+
+			invoke = other.invoke;
+			manage = other.manage;
+			other.invoke = nullptr;
+			other.manage = nullptr;
+		}
+
+		void Reset()
+		{
+			if (manage)
+			{
+				manage(Operation::Destroy, storage, nullptr);
+			}
+
+			invoke = nullptr;
+			manage = nullptr;
+		}
+
+		alignas(void*) std::byte storage[STORAGE_SIZE];
+		InvokeFunc invoke = nullptr;
+		ManageFunc manage = nullptr;
+	};
+}
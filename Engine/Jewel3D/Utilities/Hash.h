@@ -0,0 +1,56 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// Contains hashing functions whose results are stable between runs and platforms.
+// Unlike std::hash, these are safe to use for keys that are saved to disk.
+namespace Jwl
+{
+	constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+	constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+	// 64-bit FNV-1a hash of the string. Pass a previous result as 'hash' to continue hashing.
+	constexpr uint64_t HashFNV(std::string_view str, uint64_t hash = FNV_OFFSET_BASIS)
+	{
+		for (char c : str)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= FNV_PRIME;
+		}
+
+		return hash;
+	}
+
+	// 64-bit FNV-1a hash of a block of memory. Pass a previous result as 'hash' to continue hashing.
+	inline uint64_t HashFNV(const void* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS)
+	{
+		auto* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= FNV_PRIME;
+		}
+
+		return hash;
+	}
+
+	// Scrambles the bits of the value so that every input bit affects every output bit.
+	// This is the finalizer from MurmurHash3.
+	constexpr uint64_t HashMix(uint64_t value)
+	{
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccdull;
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53ull;
+		value ^= value >> 33;
+
+		return value;
+	}
+
+	// Combines two hashes. The result depends on the order of the arguments.
+	constexpr uint64_t HashCombine(uint64_t seed, uint64_t value)
+	{
+		return HashMix(seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)));
+	}
+}
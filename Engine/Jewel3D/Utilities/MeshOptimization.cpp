@@ -0,0 +1,520 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "MeshOptimization.h"
+#include "Jewel3D/Application/Logging.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+	constexpr unsigned INVALID_INDEX = ~0u;
+
+	// The triangles that use each vertex, stored contiguously.
+	struct Adjacency
+	{
+		Adjacency(const std::vector<unsigned>& indices, unsigned numVertices)
+			: offsets(numVertices + 1, 0)
+			, triangles(indices.size())
+		{
+			for (unsigned index : indices)
+			{
+				offsets[index + 1]++;
+			}
+
+			for (unsigned i = 0; i < numVertices; ++i)
+			{
+				offsets[i + 1] += offsets[i];
+			}
+
+			std::vector<unsigned> cursor(offsets.begin(), offsets.end() - 1);
+			for (unsigned i = 0; i < indices.size(); ++i)
+			{
+				triangles[cursor[indices[i]]++] = i / 3;
+			}
+		}
+
+		std::vector<unsigned> offsets;
+		std::vector<unsigned> triangles;
+	};
+
+	// The sum of squared distances to a set of planes, weighted by the area of the triangle each plane came from.
+	struct Quadric
+	{
+		// Builds the quadric of the triangle's plane.
+		Quadric(const Jwl::vec3& p0, const Jwl::vec3& p1, const Jwl::vec3& p2)
+		{
+			const Jwl::vec3 normal = Jwl::Cross(p1 - p0, p2 - p0);
+			const double length = Jwl::Length(normal);
+			if (length == 0.0)
+			{
+				return;
+			}
+
+			const double x = normal.x / length;
+			const double y = normal.y / length;
+			const double z = normal.z / length;
+			const double w = -(x * p0.x + y * p0.y + z * p0.z);
+			weight = length * 0.5;
+
+			xx = x * x * weight; xy = x * y * weight; xz = x * z * weight; xw = x * w * weight;
+			yy = y * y * weight; yz = y * z * weight; yw = y * w * weight;
+			zz = z * z * weight; zw = z * w * weight;
+			ww = w * w * weight;
+		}
+
+		Quadric() = default;
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			xx += other.xx; xy += other.xy; xz += other.xz; xw += other.xw;
+			yy += other.yy; yz += other.yz; yw += other.yw;
+			zz += other.zz; zw += other.zw;
+			ww += other.ww;
+			weight += other.weight;
+
+			return *this;
+		}
+
+		// Returns the mean squared distance from the point to the planes.
+		double GetError(const Jwl::vec3& p) const
+		{
+			if (weight == 0.0)
+			{
+				return 0.0;
+			}
+
+			const double error =
+				xx * p.x * p.x + yy * p.y * p.y + zz * p.z * p.z +
+				2.0 * (xy * p.x * p.y + xz * p.x * p.z + yz * p.y * p.z) +
+				2.0 * (xw * p.x + yw * p.y + zw * p.z) +
+				ww;
+
+			return std::max(error, 0.0) / weight;
+		}
+
+		double xx = 0.0, xy = 0.0, xz = 0.0, xw = 0.0;
+		double yy = 0.0, yz = 0.0, yw = 0.0;
+		double zz = 0.0, zw = 0.0;
+		double ww = 0.0;
+		double weight = 0.0;
+	};
+
+	// A candidate for moving vertex 'from' onto vertex 'to'.
+	struct Collapse
+	{
+		unsigned from;
+		unsigned to;
+		double error;
+	};
+
+	// Finds the vertices that must not be moved because doing so would open a crack in the surface.
+	std::vector<bool> FindLockedVertices(const std::vector<unsigned>& indices, const std::vector<Jwl::vec3>& positions)
+	{
+		const unsigned numVertices = static_cast<unsigned>(positions.size());
+
+		// Vertices split along a seam have identical positions but different attributes.
+		std::unordered_map<std::string_view, unsigned> lookup;
+		lookup.reserve(numVertices);
+
+		std::vector<unsigned> canonical(numVertices);
+		std::vector<unsigned> sharedCount(numVertices, 0);
+		for (unsigned i = 0; i < numVertices; ++i)
+		{
+			const std::string_view key(reinterpret_cast<const char*>(&positions[i]), sizeof(Jwl::vec3));
+			canonical[i] = lookup.emplace(key, i).first->second;
+			sharedCount[canonical[i]]++;
+		}
+
+		std::vector<bool> locked(numVertices, false);
+		for (unsigned i = 0; i < numVertices; ++i)
+		{
+			locked[i] = sharedCount[canonical[i]] > 1;
+		}
+
+		// A border edge has no matching edge running the opposite direction on a neighbouring triangle.
+		auto edgeKey = [](unsigned a, unsigned b) {
+			return (static_cast<unsigned long long>(a) << 32) | b;
+		};
+
+		std::unordered_set<unsigned long long> edges;
+		edges.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (unsigned e = 0; e < 3; ++e)
+			{
+				edges.insert(edgeKey(canonical[indices[i + e]], canonical[indices[i + (e + 1) % 3]]));
+			}
+		}
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (unsigned e = 0; e < 3; ++e)
+			{
+				const unsigned a = indices[i + e];
+				const unsigned b = indices[i + (e + 1) % 3];
+				if (edges.find(edgeKey(canonical[b], canonical[a])) == edges.end())
+				{
+					locked[a] = true;
+					locked[b] = true;
+				}
+			}
+		}
+
+		return locked;
+	}
+
+	// Returns true if moving 'from' onto 'to' would turn any of the surrounding triangles inside out.
+	bool CollapseFlipsTriangle(const Adjacency& adjacency, const std::vector<unsigned>& indices, const std::vector<Jwl::vec3>& positions, unsigned from, unsigned to)
+	{
+		for (unsigned i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; ++i)
+		{
+			const unsigned* triangle = &indices[adjacency.triangles[i] * 3];
+			if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+			{
+				// This triangle is removed by the collapse.
+				continue;
+			}
+
+			const Jwl::vec3& p0 = positions[triangle[0]];
+			const Jwl::vec3& p1 = positions[triangle[1]];
+			const Jwl::vec3& p2 = positions[triangle[2]];
+			const Jwl::vec3 before = Jwl::Cross(p1 - p0, p2 - p0);
+
+			const Jwl::vec3& q0 = triangle[0] == from ? positions[to] : p0;
+			const Jwl::vec3& q1 = triangle[1] == from ? positions[to] : p1;
+			const Jwl::vec3& q2 = triangle[2] == from ? positions[to] : p2;
+			const Jwl::vec3 after = Jwl::Cross(q1 - q0, q2 - q0);
+
+			if (Jwl::Dot(before, after) <= 0.0f)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+namespace Jwl
+{
+	void WeldVertices(std::vector<unsigned char>& vertices, unsigned vertexSize, std::vector<unsigned>& outIndices)
+	{
+		ASSERT(vertexSize > 0, "'vertexSize' must be greater than zero.");
+		ASSERT(vertices.size() % vertexSize == 0, "'vertices' must contain a whole number of vertices.");
+
+		const unsigned numVertices = static_cast<unsigned>(vertices.size() / vertexSize);
+		outIndices.resize(numVertices);
+
+		// Keys point into the original buffer, so unique vertices are compacted into a separate one.
+		std::vector<unsigned char> unique;
+		unique.reserve(vertices.size());
+
+		std::unordered_map<std::string_view, unsigned> lookup;
+		lookup.reserve(numVertices);
+
+		for (unsigned i = 0; i < numVertices; ++i)
+		{
+			const std::string_view key(reinterpret_cast<const char*>(vertices.data()) + i * vertexSize, vertexSize);
+			const unsigned nextIndex = static_cast<unsigned>(unique.size() / vertexSize);
+
+			auto [itr, inserted] = lookup.emplace(key, nextIndex);
+			if (inserted)
+			{
+				unique.insert(unique.end(), key.begin(), key.end());
+			}
+
+			outIndices[i] = itr->second;
+		}
+
+		vertices = std::move(unique);
+	}
+
+	void OptimizeVertexCache(std::vector<unsigned>& indices, unsigned numVertices, unsigned cacheSize)
+	{
+		ASSERT(indices.size() % 3 == 0, "'indices' must describe a list of triangles.");
+
+		const unsigned numTriangles = static_cast<unsigned>(indices.size() / 3);
+		if (numTriangles == 0)
+		{
+			return;
+		}
+
+		const Adjacency adjacency(indices, numVertices);
+
+		// The number of triangles that still need to be emitted for each vertex.
+		std::vector<unsigned> liveTriangles(numVertices);
+		for (unsigned i = 0; i < numVertices; ++i)
+		{
+			liveTriangles[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+		}
+
+		// The time that each vertex last entered the simulated cache.
+		std::vector<unsigned> cacheTime(numVertices, 0);
+		std::vector<bool> emitted(numTriangles, false);
+
+		// Recently used vertices, for recovering when we reach a vertex with no remaining triangles.
+		std::vector<unsigned> deadEnds;
+		std::vector<unsigned> candidates;
+
+		std::vector<unsigned> result;
+		result.reserve(indices.size());
+
+		unsigned time = cacheSize + 1;
+		unsigned cursor = 0;
+		unsigned fanningVertex = 0;
+
+		while (fanningVertex != INVALID_INDEX)
+		{
+			candidates.clear();
+
+			// Emit all remaining triangles around the vertex.
+			for (unsigned i = adjacency.offsets[fanningVertex]; i < adjacency.offsets[fanningVertex + 1]; ++i)
+			{
+				const unsigned triangle = adjacency.triangles[i];
+				if (emitted[triangle])
+				{
+					continue;
+				}
+
+				for (unsigned j = 0; j < 3; ++j)
+				{
+					const unsigned vertex = indices[triangle * 3 + j];
+					result.push_back(vertex);
+					deadEnds.push_back(vertex);
+					candidates.push_back(vertex);
+					liveTriangles[vertex]--;
+
+					if (time - cacheTime[vertex] > cacheSize)
+					{
+						cacheTime[vertex] = time;
+						time++;
+					}
+				}
+
+				emitted[triangle] = true;
+			}
+
+			// Pick the next vertex to fan around: the one that will still be in the cache
+			// after its remaining triangles are emitted, and has been in the cache the longest.
+			fanningVertex = INVALID_INDEX;
+			int bestPriority = -1;
+			for (unsigned vertex : candidates)
+			{
+				if (liveTriangles[vertex] == 0)
+				{
+					continue;
+				}
+
+				int priority = 0;
+				if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+				{
+					priority = static_cast<int>(time - cacheTime[vertex]);
+				}
+
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					fanningVertex = vertex;
+				}
+			}
+
+			if (fanningVertex == INVALID_INDEX)
+			{
+				// Fall back to a recently used vertex, then to any vertex with triangles remaining.
+				while (!deadEnds.empty())
+				{
+					const unsigned vertex = deadEnds.back();
+					deadEnds.pop_back();
+
+					if (liveTriangles[vertex] > 0)
+					{
+						fanningVertex = vertex;
+						break;
+					}
+				}
+
+				while (fanningVertex == INVALID_INDEX && cursor < numVertices)
+				{
+					if (liveTriangles[cursor] > 0)
+					{
+						fanningVertex = cursor;
+					}
+
+					cursor++;
+				}
+			}
+		}
+
+		ASSERT(result.size() == indices.size(), "Not all triangles were emitted.");
+		indices = std::move(result);
+	}
+
+	void OptimizeVertexFetch(std::vector<unsigned char>& vertices, unsigned vertexSize, std::vector<unsigned>& indices)
+	{
+		ASSERT(vertexSize > 0, "'vertexSize' must be greater than zero.");
+
+		const unsigned numVertices = static_cast<unsigned>(vertices.size() / vertexSize);
+		std::vector<unsigned> remap(numVertices, INVALID_INDEX);
+		std::vector<unsigned char> result;
+		result.reserve(vertices.size());
+
+		unsigned nextIndex = 0;
+		for (unsigned& index : indices)
+		{
+			if (remap[index] == INVALID_INDEX)
+			{
+				remap[index] = nextIndex++;
+
+				auto* vertex = vertices.data() + static_cast<size_t>(index) * vertexSize;
+				result.insert(result.end(), vertex, vertex + vertexSize);
+			}
+
+			index = remap[index];
+		}
+
+		vertices = std::move(result);
+	}
+
+	float SimplifyMesh(const std::vector<unsigned>& indices, const std::vector<vec3>& positions, unsigned targetIndexCount, std::vector<unsigned>& outIndices)
+	{
+		ASSERT(indices.size() % 3 == 0, "'indices' must describe a list of triangles.");
+
+		const unsigned numVertices = static_cast<unsigned>(positions.size());
+		const std::vector<bool> locked = FindLockedVertices(indices, positions);
+
+		std::vector<Quadric> quadrics(numVertices);
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const Quadric plane(positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]]);
+			quadrics[indices[i]] += plane;
+			quadrics[indices[i + 1]] += plane;
+			quadrics[indices[i + 2]] += plane;
+		}
+
+		outIndices = indices;
+		double maxError = 0.0;
+
+		std::vector<Collapse> collapses;
+		std::vector<unsigned> remap(numVertices);
+		std::vector<bool> touched(numVertices);
+
+		// Each pass collapses as many independent edges as it can, cheapest first.
+		// Collapses only invalidate the costs around them, so the neighbourhood of each one is left alone until the next pass.
+		while (outIndices.size() > targetIndexCount)
+		{
+			const Adjacency adjacency(outIndices, numVertices);
+
+			collapses.clear();
+			for (size_t i = 0; i < outIndices.size(); i += 3)
+			{
+				for (unsigned e = 0; e < 3; ++e)
+				{
+					const unsigned a = outIndices[i + e];
+					const unsigned b = outIndices[i + (e + 1) % 3];
+
+					if (!locked[a]) collapses.push_back({ a, b, quadrics[a].GetError(positions[b]) });
+					if (!locked[b]) collapses.push_back({ b, a, quadrics[b].GetError(positions[a]) });
+				}
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+				return a.error < b.error;
+			});
+
+			for (unsigned i = 0; i < numVertices; ++i)
+			{
+				remap[i] = i;
+			}
+			std::fill(touched.begin(), touched.end(), false);
+
+			const size_t trianglesToRemove = (outIndices.size() - targetIndexCount + 2) / 3;
+			size_t removedTriangles = 0;
+
+			for (const Collapse& collapse : collapses)
+			{
+				if (removedTriangles >= trianglesToRemove)
+				{
+					break;
+				}
+
+				if (touched[collapse.from] || touched[collapse.to] ||
+					CollapseFlipsTriangle(adjacency, outIndices, positions, collapse.from, collapse.to))
+				{
+					continue;
+				}
+
+				remap[collapse.from] = collapse.to;
+				quadrics[collapse.to] += quadrics[collapse.from];
+				maxError = std::max(maxError, collapse.error);
+
+				// Every triangle around the collapsed vertex changes shape, so none of its neighbours can be moved this pass.
+				for (unsigned j = adjacency.offsets[collapse.from]; j < adjacency.offsets[collapse.from + 1]; ++j)
+				{
+					const unsigned* triangle = &outIndices[adjacency.triangles[j] * 3];
+					touched[triangle[0]] = true;
+					touched[triangle[1]] = true;
+					touched[triangle[2]] = true;
+
+					if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+					{
+						removedTriangles++;
+					}
+				}
+			}
+
+			if (removedTriangles == 0)
+			{
+				// Every remaining edge is locked or would flip a triangle.
+				break;
+			}
+
+			// Apply the collapses and discard the triangles that became degenerate.
+			size_t write = 0;
+			for (size_t i = 0; i < outIndices.size(); i += 3)
+			{
+				const unsigned a = remap[outIndices[i]];
+				const unsigned b = remap[outIndices[i + 1]];
+				const unsigned c = remap[outIndices[i + 2]];
+
+				if (a != b && b != c && a != c)
+				{
+					outIndices[write++] = a;
+					outIndices[write++] = b;
+					outIndices[write++] = c;
+				}
+			}
+
+			outIndices.resize(write);
+		}
+
+		return static_cast<float>(std::sqrt(maxError));
+	}
+
+	float ComputeACMR(const std::vector<unsigned>& indices, unsigned numVertices, unsigned cacheSize)
+	{
+		const unsigned numTriangles = static_cast<unsigned>(indices.size() / 3);
+		if (numTriangles == 0)
+		{
+			return 0.0f;
+		}
+
+		// A vertex is in the cache if it was added within the last 'cacheSize' misses.
+		std::vector<unsigned> cacheTime(numVertices, 0);
+		unsigned misses = 0;
+
+		for (unsigned index : indices)
+		{
+			if (cacheTime[index] == 0 || misses + 1 - cacheTime[index] > cacheSize)
+			{
+				misses++;
+				cacheTime[index] = misses;
+			}
+		}
+
+		return static_cast<float>(misses) / static_cast<float>(numTriangles);
+	}
+}
@@ -0,0 +1,33 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include "Jewel3D/Math/Vector.h"
+
+#include <vector>
+
+// Offline processing for indexed triangle lists.
+// Vertices are treated as opaque blocks of 'vertexSize' bytes so that any interleaved layout can be processed.
+namespace Jwl
+{
+	// Merges byte-identical vertices.
+	// 'vertices' is replaced with the unique vertices, and 'outIndices' receives one index per original vertex.
+	void WeldVertices(std::vector<unsigned char>& vertices, unsigned vertexSize, std::vector<unsigned>& outIndices);
+
+	// Reorders triangles to improve the hit rate of the GPU's post-transform vertex cache.
+	// Based on "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (Sander, Nehab, Barczak 2007).
+	void OptimizeVertexCache(std::vector<unsigned>& indices, unsigned numVertices, unsigned cacheSize = 16);
+
+	// Reorders vertices into the order they are first referenced, so that vertex fetches move linearly through memory.
+	// Vertices that are never referenced are removed.
+	void OptimizeVertexFetch(std::vector<unsigned char>& vertices, unsigned vertexSize, std::vector<unsigned>& indices);
+
+	// Reduces the triangle count towards 'targetIndexCount' by collapsing the edges that add the least Quadric Error first.
+	// Based on "Surface Simplification Using Quadric Error Metrics" (Garland, Heckbert 1997).
+	// Vertices are only ever collapsed onto one another, so 'outIndices' refers to the same vertices as 'indices'.
+	// Vertices on open borders or attribute seams (those sharing a position with another vertex) are never moved, to avoid cracks.
+	// Returns the approximate distance that the surface moved, in the same units as 'positions'.
+	float SimplifyMesh(const std::vector<unsigned>& indices, const std::vector<vec3>& positions, unsigned targetIndexCount, std::vector<unsigned>& outIndices);
+
+	// Returns the Average Cache Miss Ratio: the number of vertices transformed per triangle with a FIFO cache.
+	// 3.0 is the worst case, where no vertices are reused. Well-ordered meshes approach 0.5 - 0.7.
+	float ComputeACMR(const std::vector<unsigned>& indices, unsigned numVertices, unsigned cacheSize = 16);
+}
@@ -1,5 +1,6 @@
 // Copyright (c) 2017 Emilian Cioca
 #pragma once
+#include <string_view>
 #include <type_traits>
 
 // Contains various helpers and utilities for compile-time metaprogramming.
@@ -94,6 +95,35 @@ namespace Jwl::Meta
 		return detail::HashCRC(str, detail::StrLen(str));
 	}
 
+	// Returns the name of the type as written in the source, such as "Jwl::Mesh".
+	// The name is taken from the function's signature, so unlike typeid() it does not require RTTI or a complete type.
+	template<typename T>
+	constexpr std::string_view TypeName()
+	{
+	#ifdef _MSC_VER
+		// "... Jwl::Meta::TypeName<class Jwl::Mesh>(void)"
+		std::string_view name = __FUNCSIG__;
+		name.remove_prefix(name.find("TypeName<") + 9);
+		name = name.substr(0, name.rfind(">(void)"));
+
+		for (std::string_view keyword : { "class ", "struct ", "enum " })
+		{
+			if (name.starts_with(keyword))
+			{
+				name.remove_prefix(keyword.size());
+				break;
+			}
+		}
+	#else
+		// "... Jwl::Meta::TypeName() [with T = Jwl::Mesh; ...]"
+		std::string_view name = __PRETTY_FUNCTION__;
+		name.remove_prefix(name.find("T = ") + 4);
+		name = name.substr(0, name.find_first_of(";]"));
+	#endif
+
+		return name;
+	}
+
 	// Used for compile-time in-place strings for use as template parameters.
 	// STRING("...") will generate a strongly typed and constexpr string up to 64 max length.
 	// Sized macros are available to select more specific lengths, up to 128.
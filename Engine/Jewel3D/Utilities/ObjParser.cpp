@@ -0,0 +1,593 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "ObjParser.h"
+#include "Jewel3D/Application/FileSystem.h"
+#include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Application/ThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+
+namespace
+{
+	using namespace Jwl;
+
+	// Chunks smaller than this are not worth the cost of handing to another thread.
+	constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+	// Powers of ten that are exactly representable as doubles.
+	constexpr double POWERS_OF_TEN[] = {
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	constexpr int MAX_EXACT_POWER = 22;
+
+	// A range of whole lines, along with everything parsed from it.
+	struct Chunk
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+
+		std::vector<vec3> positions;
+		std::vector<vec2> uvs;
+		std::vector<vec3> normals;
+		std::vector<ObjCorner> corners;
+
+		// Negative indices are relative to the end of the attribute list, which depends on preceding chunks.
+		// These are stored as (corner * 3 + attribute) so they can be offset once every chunk has been parsed.
+		std::vector<unsigned> relativeIndices;
+
+		// Set when parsing fails. The line is not known for errors found after parsing.
+		const char* errorMessage = nullptr;
+		const char* errorLine = nullptr;
+
+		// Where this chunk's data starts in the final arrays.
+		size_t positionOffset = 0;
+		size_t uvOffset = 0;
+		size_t normalOffset = 0;
+		size_t cornerOffset = 0;
+	};
+
+	bool IsDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	bool IsLineEnd(char c)
+	{
+		return c == '\n' || c == '\r';
+	}
+
+	void SkipSpaces(const char*& cursor, const char* end)
+	{
+		while (cursor < end && (*cursor == ' ' || *cursor == '\t'))
+		{
+			++cursor;
+		}
+	}
+
+	void SkipLine(const char*& cursor, const char* end)
+	{
+		const char* newline = static_cast<const char*>(memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+		cursor = newline ? newline + 1 : end;
+	}
+
+	// Parses a decimal floating point number such as "-1.25e-3".
+	// The significant digits are accumulated as an integer and scaled once, which is exact for typical inputs.
+	bool ParseFloat(const char*& cursor, const char* end, float& out)
+	{
+		SkipSpaces(cursor, end);
+
+		const char* p = cursor;
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			negative = *p == '-';
+			++p;
+		}
+
+		uint64_t mantissa = 0;
+		int exponent = 0;
+		bool hasDigits = false;
+
+		// Digits beyond what a 64-bit integer can hold only affect the exponent.
+		constexpr uint64_t MANTISSA_LIMIT = 100000000000000000ull;
+
+		while (p < end && IsDigit(*p))
+		{
+			if (mantissa < MANTISSA_LIMIT)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+			}
+			else
+			{
+				++exponent;
+			}
+
+			hasDigits = true;
+			++p;
+		}
+
+		if (p < end && *p == '.')
+		{
+			++p;
+			while (p < end && IsDigit(*p))
+			{
+				if (mantissa < MANTISSA_LIMIT)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					--exponent;
+				}
+
+				hasDigits = true;
+				++p;
+			}
+		}
+
+		if (!hasDigits)
+		{
+			return false;
+		}
+
+		if (p < end && (*p == 'e' || *p == 'E'))
+		{
+			++p;
+			bool negativeExponent = false;
+			if (p < end && (*p == '-' || *p == '+'))
+			{
+				negativeExponent = *p == '-';
+				++p;
+			}
+
+			if (p == end || !IsDigit(*p))
+			{
+				return false;
+			}
+
+			int value = 0;
+			while (p < end && IsDigit(*p))
+			{
+				// Clamped well beyond the range of a float so that it cannot overflow.
+				value = std::min(value * 10 + (*p - '0'), 1000);
+				++p;
+			}
+
+			exponent += negativeExponent ? -value : value;
+		}
+
+		double result = static_cast<double>(mantissa);
+		if (mantissa != 0)
+		{
+			while (exponent > MAX_EXACT_POWER)
+			{
+				result *= POWERS_OF_TEN[MAX_EXACT_POWER];
+				exponent -= MAX_EXACT_POWER;
+			}
+
+			while (exponent < -MAX_EXACT_POWER)
+			{
+				result /= POWERS_OF_TEN[MAX_EXACT_POWER];
+				exponent += MAX_EXACT_POWER;
+			}
+
+			result = exponent < 0 ? result / POWERS_OF_TEN[-exponent] : result * POWERS_OF_TEN[exponent];
+		}
+
+		out = static_cast<float>(negative ? -result : result);
+		cursor = p;
+		return true;
+	}
+
+	bool ParseInt(const char*& cursor, const char* end, int& out)
+	{
+		const char* p = cursor;
+		bool negative = false;
+		if (p < end && *p == '-')
+		{
+			negative = true;
+			++p;
+		}
+
+		if (p == end || !IsDigit(*p))
+		{
+			return false;
+		}
+
+		int64_t value = 0;
+		while (p < end && IsDigit(*p))
+		{
+			value = value * 10 + (*p - '0');
+			if (value > INT32_MAX)
+			{
+				return false;
+			}
+
+			++p;
+		}
+
+		out = static_cast<int>(negative ? -value : value);
+		cursor = p;
+		return true;
+	}
+
+	// Reads the floats on a line. Values beyond 'required' are optional and default to zero.
+	template<unsigned count>
+	bool ParseVector(const char*& cursor, const char* end, unsigned required, float (&values)[count])
+	{
+		for (unsigned i = 0; i < count; ++i)
+		{
+			values[i] = 0.0f;
+			if (!ParseFloat(cursor, end, values[i]) && i < required)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// A face corner before it is written to a chunk.
+	struct ParsedCorner
+	{
+		ObjCorner corner;
+		// One bit per attribute that was specified with a negative index.
+		unsigned relativeMask = 0;
+	};
+
+	// Converts a one-based .obj index into a zero-based one.
+	// Negative indices count backwards from the most recently declared attribute.
+	bool ResolveIndex(int index, size_t localCount, unsigned attribute, int& out, unsigned& relativeMask)
+	{
+		if (index > 0)
+		{
+			out = index - 1;
+		}
+		else if (index < 0)
+		{
+			out = static_cast<int>(localCount) + index;
+			relativeMask |= 1u << attribute;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	// Parses a face corner in any of the forms "v", "v/vt", "v//vn", or "v/vt/vn".
+	bool ParseCorner(const char*& cursor, const char* end, const Chunk& chunk, ParsedCorner& out)
+	{
+		int index;
+		if (!ParseInt(cursor, end, index) ||
+			!ResolveIndex(index, chunk.positions.size(), 0, out.corner.position, out.relativeMask))
+		{
+			return false;
+		}
+
+		if (cursor == end || *cursor != '/')
+		{
+			return true;
+		}
+
+		++cursor;
+		if (cursor < end && *cursor != '/')
+		{
+			if (!ParseInt(cursor, end, index) ||
+				!ResolveIndex(index, chunk.uvs.size(), 1, out.corner.uv, out.relativeMask))
+			{
+				return false;
+			}
+		}
+
+		if (cursor == end || *cursor != '/')
+		{
+			return true;
+		}
+
+		++cursor;
+		return ParseInt(cursor, end, index) &&
+			ResolveIndex(index, chunk.normals.size(), 2, out.corner.normal, out.relativeMask);
+	}
+
+	void EmitCorner(Chunk& chunk, const ParsedCorner& corner)
+	{
+		for (unsigned attribute = 0; attribute < 3; ++attribute)
+		{
+			if (corner.relativeMask & (1u << attribute))
+			{
+				chunk.relativeIndices.push_back(static_cast<unsigned>(chunk.corners.size() * 3 + attribute));
+			}
+		}
+
+		chunk.corners.push_back(corner.corner);
+	}
+
+	// Parses a polygon of any size, emitting it as a triangle fan around the first corner.
+	bool ParseFace(const char*& cursor, const char* end, Chunk& chunk)
+	{
+		unsigned numCorners = 0;
+		ParsedCorner first;
+		ParsedCorner previous;
+
+		while (true)
+		{
+			SkipSpaces(cursor, end);
+			if (cursor == end || IsLineEnd(*cursor) || *cursor == '#')
+			{
+				break;
+			}
+
+			ParsedCorner corner;
+			if (!ParseCorner(cursor, end, chunk, corner))
+			{
+				return false;
+			}
+
+			if (numCorners == 0)
+			{
+				first = corner;
+			}
+			else if (numCorners >= 2)
+			{
+				EmitCorner(chunk, first);
+				EmitCorner(chunk, previous);
+				EmitCorner(chunk, corner);
+			}
+
+			previous = corner;
+			++numCorners;
+		}
+
+		return numCorners >= 3;
+	}
+
+	void ParseChunk(Chunk& chunk)
+	{
+		const char* cursor = chunk.begin;
+		const char* end = chunk.end;
+
+		while (cursor < end)
+		{
+			const char* line = cursor;
+			SkipSpaces(cursor, end);
+
+			if (cursor + 1 < end && cursor[0] == 'v')
+			{
+				const char type = cursor[1];
+				if (type == ' ' || type == '\t')
+				{
+					cursor += 1;
+					float values[3];
+					if (!ParseVector(cursor, end, 3, values))
+					{
+						chunk.errorLine = line;
+						chunk.errorMessage = "Invalid vertex position.";
+						return;
+					}
+
+					chunk.positions.emplace_back(values[0], values[1], values[2]);
+				}
+				else if (type == 't')
+				{
+					cursor += 2;
+					float values[2];
+					if (!ParseVector(cursor, end, 1, values))
+					{
+						chunk.errorLine = line;
+						chunk.errorMessage = "Invalid texture coordinate.";
+						return;
+					}
+
+					chunk.uvs.emplace_back(values[0], values[1]);
+				}
+				else if (type == 'n')
+				{
+					cursor += 2;
+					float values[3];
+					if (!ParseVector(cursor, end, 3, values))
+					{
+						chunk.errorLine = line;
+						chunk.errorMessage = "Invalid vertex normal.";
+						return;
+					}
+
+					chunk.normals.emplace_back(values[0], values[1], values[2]);
+				}
+			}
+			else if (cursor + 1 < end && cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t'))
+			{
+				cursor += 1;
+				if (!ParseFace(cursor, end, chunk))
+				{
+					chunk.errorLine = line;
+					chunk.errorMessage = "Invalid face. Faces require at least three valid corners.";
+					return;
+				}
+			}
+
+			SkipLine(cursor, end);
+		}
+	}
+
+	// Copies the chunk into its place in the final mesh, resolving relative indices and validating all of them.
+	void MergeChunk(Chunk& chunk, ObjMesh& out)
+	{
+		std::copy(chunk.positions.begin(), chunk.positions.end(), out.positions.begin() + chunk.positionOffset);
+		std::copy(chunk.uvs.begin(), chunk.uvs.end(), out.uvs.begin() + chunk.uvOffset);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), out.normals.begin() + chunk.normalOffset);
+
+		for (unsigned relative : chunk.relativeIndices)
+		{
+			ObjCorner& corner = chunk.corners[relative / 3];
+			switch (relative % 3)
+			{
+			case 0: corner.position += static_cast<int>(chunk.positionOffset); break;
+			case 1: corner.uv += static_cast<int>(chunk.uvOffset); break;
+			case 2: corner.normal += static_cast<int>(chunk.normalOffset); break;
+			}
+		}
+
+		auto isValid = [](int index, size_t count) {
+			return index == -1 || (index >= 0 && static_cast<size_t>(index) < count);
+		};
+
+		for (const ObjCorner& corner : chunk.corners)
+		{
+			if (corner.position == -1 ||
+				!isValid(corner.position, out.positions.size()) ||
+				!isValid(corner.uv, out.uvs.size()) ||
+				!isValid(corner.normal, out.normals.size()))
+			{
+				chunk.errorMessage = "A face references an attribute that does not exist.";
+				return;
+			}
+		}
+
+		std::copy(chunk.corners.begin(), chunk.corners.end(), out.corners.begin() + chunk.cornerOffset);
+	}
+
+	// Returns the line number of the given position, for error reporting.
+	unsigned GetLineNumber(std::string_view text, const char* position)
+	{
+		return static_cast<unsigned>(std::count(text.data(), position, '\n')) + 1;
+	}
+}
+
+namespace Jwl
+{
+	bool ParseObj(std::string_view text, ObjMesh& out, unsigned numThreads)
+	{
+		if (numThreads == 0)
+		{
+			numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+
+		// A few chunks per thread keeps every thread busy even when some chunks are denser than others.
+		const size_t maxChunks = static_cast<size_t>(numThreads) * 4;
+		const size_t numChunks = std::clamp<size_t>(text.size() / MIN_CHUNK_SIZE, 1, maxChunks);
+
+		// Split the text into roughly even ranges, moving each boundary forward to the start of the next line.
+		std::vector<Chunk> chunks(numChunks);
+		const size_t chunkSize = text.size() / numChunks;
+		const char* const textEnd = text.data() + text.size();
+		const char* boundary = text.data();
+		for (size_t i = 0; i < numChunks; ++i)
+		{
+			chunks[i].begin = boundary;
+
+			if (i + 1 == numChunks)
+			{
+				boundary = textEnd;
+			}
+			else
+			{
+				boundary = std::max(boundary, text.data() + chunkSize * (i + 1));
+				SkipLine(boundary, textEnd);
+			}
+
+			chunks[i].end = boundary;
+		}
+
+		// Worker threads are only started when there is more than one chunk of work.
+		std::unique_ptr<ThreadPool> pool;
+		if (numChunks > 1 && numThreads > 1)
+		{
+			pool = std::make_unique<ThreadPool>(static_cast<unsigned>(std::min<size_t>(numThreads, numChunks)));
+		}
+
+		auto forEachChunk = [&](auto func) {
+			if (pool)
+			{
+				for (Chunk& chunk : chunks)
+				{
+					pool->Submit([&chunk, func] { func(chunk); });
+				}
+
+				pool->Wait();
+			}
+			else
+			{
+				for (Chunk& chunk : chunks)
+				{
+					func(chunk);
+				}
+			}
+		};
+
+		auto reportErrors = [&]() {
+			for (const Chunk& chunk : chunks)
+			{
+				if (chunk.errorLine)
+				{
+					Error("ObjParser: Line %u\n%s", GetLineNumber(text, chunk.errorLine), chunk.errorMessage);
+					return true;
+				}
+				else if (chunk.errorMessage)
+				{
+					Error("ObjParser: %s", chunk.errorMessage);
+					return true;
+				}
+			}
+
+			return false;
+		};
+
+		forEachChunk(ParseChunk);
+		if (reportErrors())
+		{
+			return false;
+		}
+
+		// Each chunk's data is placed after the data of all preceding chunks.
+		size_t numPositions = 0;
+		size_t numUvs = 0;
+		size_t numNormals = 0;
+		size_t numCorners = 0;
+		for (Chunk& chunk : chunks)
+		{
+			chunk.positionOffset = numPositions;
+			chunk.uvOffset = numUvs;
+			chunk.normalOffset = numNormals;
+			chunk.cornerOffset = numCorners;
+
+			numPositions += chunk.positions.size();
+			numUvs += chunk.uvs.size();
+			numNormals += chunk.normals.size();
+			numCorners += chunk.corners.size();
+		}
+
+		if (numPositions > INT32_MAX || numUvs > INT32_MAX || numNormals > INT32_MAX)
+		{
+			Error("ObjParser: The mesh has too many vertices.");
+			return false;
+		}
+
+		out.positions.resize(numPositions);
+		out.uvs.resize(numUvs);
+		out.normals.resize(numNormals);
+		out.corners.resize(numCorners);
+
+		forEachChunk([&out](Chunk& chunk) { MergeChunk(chunk, out); });
+		if (reportErrors())
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	bool LoadObj(std::string_view filePath, ObjMesh& out, unsigned numThreads)
+	{
+		FileView file;
+		if (!file.Open(filePath))
+		{
+			Error("ObjParser: ( %s )\nUnable to open file.", filePath.data());
+			return false;
+		}
+
+		const std::string_view text(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+		return ParseObj(text, out, numThreads);
+	}
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include "Jewel3D/Math/Vector.h"
+
+#include <string_view>
+#include <vector>
+
+namespace Jwl
+{
+	// The attributes used by one corner of a triangle, as zero-based indices into an ObjMesh's arrays.
+	// An index of -1 means that the face did not specify the attribute.
+	struct ObjCorner
+	{
+		bool operator==(const ObjCorner& other) const
+		{
+			return position == other.position && uv == other.uv && normal == other.normal;
+		}
+
+		int position = -1;
+		int uv = -1;
+		int normal = -1;
+	};
+
+	// The geometry of a Wavefront .obj file.
+	struct ObjMesh
+	{
+		std::vector<vec3> positions;
+		std::vector<vec2> uvs;
+		std::vector<vec3> normals;
+
+		// Three corners per triangle. Polygons with more than three sides are fan-triangulated.
+		std::vector<ObjCorner> corners;
+	};
+
+	// Parses the geometry of an .obj file. Materials, groups, and other statements are ignored.
+	// The text is split into chunks at line boundaries which are parsed in parallel.
+	// A thread count of 0 uses one thread per hardware core.
+	bool ParseObj(std::string_view text, ObjMesh& out, unsigned numThreads = 0);
+
+	// Maps the file into memory and parses it with ParseObj().
+	bool LoadObj(std::string_view filePath, ObjMesh& out, unsigned numThreads = 0);
+}
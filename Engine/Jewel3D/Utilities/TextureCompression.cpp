@@ -0,0 +1,902 @@
+// Copyright (c) 2020 Emilian Cioca
+#include "Jewel3D/Precompiled.h"
+#include "TextureCompression.h"
+#include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Application/ThreadPool.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// A 4x4 block of RGBA pixels, in rows from top to bottom.
+	using Block = unsigned char[16][4];
+	using Points = float[16][4];
+
+	// The interpolation weights of BC7's 4 bit indices, out of 64.
+	constexpr unsigned char bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Strips are sized so that each job has enough work to outweigh the cost of scheduling it.
+	constexpr unsigned DOWNSAMPLE_ROWS_PER_STRIP = 64;
+	constexpr unsigned BLOCK_ROWS_PER_STRIP = 8;
+
+	// Invokes 'func(firstRow, endRow)' over strips of rows, in parallel if a pool is provided.
+	template<typename Func>
+	void ForEachStrip(unsigned numRows, unsigned rowsPerStrip, Jwl::ThreadPool* pool, const Func& func)
+	{
+		if (pool == nullptr || numRows <= rowsPerStrip)
+		{
+			func(0u, numRows);
+			return;
+		}
+
+		for (unsigned firstRow = 0; firstRow < numRows; firstRow += rowsPerStrip)
+		{
+			const unsigned endRow = std::min(firstRow + rowsPerStrip, numRows);
+			pool->Submit([&func, firstRow, endRow] { func(firstRow, endRow); });
+		}
+
+		pool->Wait();
+	}
+
+	struct LinearTable
+	{
+		LinearTable()
+		{
+			for (unsigned i = 0; i < 256; ++i)
+			{
+				const float value = i / 255.0f;
+				values[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+			}
+		}
+
+		float values[256];
+	};
+
+	float SRGBToLinear(unsigned char value)
+	{
+		static const LinearTable table;
+		return table.values[value];
+	}
+
+	unsigned char LinearToSRGB(float value)
+	{
+		value = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+		return static_cast<unsigned char>(std::clamp(value * 255.0f + 0.5f, 0.0f, 255.0f));
+	}
+
+	unsigned SquaredDistance(const unsigned char* a, const unsigned char* b, unsigned numChannels)
+	{
+		unsigned result = 0;
+		for (unsigned c = 0; c < numChannels; ++c)
+		{
+			const int delta = static_cast<int>(a[c]) - static_cast<int>(b[c]);
+			result += static_cast<unsigned>(delta * delta);
+		}
+
+		return result;
+	}
+
+	void FetchBlock(const unsigned char* pixels, unsigned width, unsigned height, unsigned numChannels, unsigned blockX, unsigned blockY, Block& out)
+	{
+		for (unsigned y = 0; y < 4; ++y)
+		{
+			const unsigned sourceY = std::min(blockY * 4 + y, height - 1);
+			for (unsigned x = 0; x < 4; ++x)
+			{
+				const unsigned sourceX = std::min(blockX * 4 + x, width - 1);
+				const unsigned char* source = pixels + (size_t(sourceY) * width + sourceX) * numChannels;
+
+				for (unsigned c = 0; c < 4; ++c)
+				{
+					out[y * 4 + x][c] = c < numChannels ? source[c] : (c == 3 ? 255 : 0);
+				}
+			}
+		}
+	}
+
+	void StoreBlock(const Block& block, unsigned width, unsigned height, unsigned blockX, unsigned blockY, unsigned char* pixels)
+	{
+		for (unsigned y = 0; y < 4 && blockY * 4 + y < height; ++y)
+		{
+			for (unsigned x = 0; x < 4 && blockX * 4 + x < width; ++x)
+			{
+				memcpy(pixels + ((size_t(blockY) * 4 + y) * width + blockX * 4 + x) * 4, block[y * 4 + x], 4);
+			}
+		}
+	}
+
+	// Finds the line through the points with the greatest variance, using power iteration on their covariance matrix.
+	// 'start' and 'end' receive the extents of the points projected onto the line.
+	void FitLine(const Points& points, unsigned numDims, float (&start)[4], float (&end)[4])
+	{
+		float mean[4] = { 0.0f };
+		float min[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+		float max[4] = { 0.0f };
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			for (unsigned d = 0; d < numDims; ++d)
+			{
+				mean[d] += points[i][d] / 16.0f;
+				min[d] = std::min(min[d], points[i][d]);
+				max[d] = std::max(max[d], points[i][d]);
+			}
+		}
+
+		float covariance[4][4] = { { 0.0f } };
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			for (unsigned a = 0; a < numDims; ++a)
+			{
+				for (unsigned b = 0; b < numDims; ++b)
+				{
+					covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+				}
+			}
+		}
+
+		// The diagonal of the bounding box is a good first guess.
+		float axis[4] = { 0.0f };
+		for (unsigned d = 0; d < numDims; ++d)
+		{
+			axis[d] = max[d] - min[d];
+		}
+
+		for (unsigned iteration = 0; iteration < 8; ++iteration)
+		{
+			float next[4] = { 0.0f };
+			float largest = 0.0f;
+			for (unsigned a = 0; a < numDims; ++a)
+			{
+				for (unsigned b = 0; b < numDims; ++b)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+
+				largest = std::max(largest, std::abs(next[a]));
+			}
+
+			if (largest == 0.0f)
+				break;
+
+			for (unsigned d = 0; d < numDims; ++d)
+			{
+				axis[d] = next[d] / largest;
+			}
+		}
+
+		float length = 0.0f;
+		for (unsigned d = 0; d < numDims; ++d)
+		{
+			length += axis[d] * axis[d];
+		}
+
+		float minT = 0.0f;
+		float maxT = 0.0f;
+		if (length > 0.0f)
+		{
+			length = std::sqrt(length);
+			for (unsigned d = 0; d < numDims; ++d)
+			{
+				axis[d] /= length;
+			}
+
+			minT = std::numeric_limits<float>::max();
+			maxT = -std::numeric_limits<float>::max();
+			for (unsigned i = 0; i < 16; ++i)
+			{
+				float t = 0.0f;
+				for (unsigned d = 0; d < numDims; ++d)
+				{
+					t += (points[i][d] - mean[d]) * axis[d];
+				}
+
+				minT = std::min(minT, t);
+				maxT = std::max(maxT, t);
+			}
+		}
+
+		for (unsigned d = 0; d < numDims; ++d)
+		{
+			start[d] = std::clamp(mean[d] + axis[d] * minT, 0.0f, 255.0f);
+			end[d] = std::clamp(mean[d] + axis[d] * maxT, 0.0f, 255.0f);
+		}
+	}
+
+	// Solves for the endpoints with the least squared error, given how far along the line each point was placed.
+	// Returns false if the points all share the same weight, in which case there is no unique solution.
+	bool RefineLine(const Points& points, unsigned numDims, const float (&weights)[16], float (&start)[4], float (&end)[4])
+	{
+		float aa = 0.0f;
+		float ab = 0.0f;
+		float bb = 0.0f;
+		float ax[4] = { 0.0f };
+		float bx[4] = { 0.0f };
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			const float a = 1.0f - weights[i];
+			const float b = weights[i];
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+
+			for (unsigned d = 0; d < numDims; ++d)
+			{
+				ax[d] += a * points[i][d];
+				bx[d] += b * points[i][d];
+			}
+		}
+
+		const float determinant = aa * bb - ab * ab;
+		if (std::abs(determinant) < 1e-6f)
+			return false;
+
+		for (unsigned d = 0; d < numDims; ++d)
+		{
+			start[d] = std::clamp((ax[d] * bb - bx[d] * ab) / determinant, 0.0f, 255.0f);
+			end[d] = std::clamp((bx[d] * aa - ax[d] * ab) / determinant, 0.0f, 255.0f);
+		}
+
+		return true;
+	}
+
+	void ToPoints(const Block& block, Points& out)
+	{
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			for (unsigned c = 0; c < 4; ++c)
+			{
+				out[i][c] = block[i][c];
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------
+	// BC1 color blocks: two 5:6:5 endpoints and a 2 bit index per pixel.
+
+	unsigned short Pack565(const float (&color)[4])
+	{
+		const unsigned r = static_cast<unsigned>(color[0] * (31.0f / 255.0f) + 0.5f);
+		const unsigned g = static_cast<unsigned>(color[1] * (63.0f / 255.0f) + 0.5f);
+		const unsigned b = static_cast<unsigned>(color[2] * (31.0f / 255.0f) + 0.5f);
+
+		return static_cast<unsigned short>((r << 11) | (g << 5) | b);
+	}
+
+	void Unpack565(unsigned short color, unsigned char (&out)[4])
+	{
+		const unsigned r = color >> 11;
+		const unsigned g = (color >> 5) & 0x3F;
+		const unsigned b = color & 0x1F;
+
+		out[0] = static_cast<unsigned char>((r << 3) | (r >> 2));
+		out[1] = static_cast<unsigned char>((g << 2) | (g >> 4));
+		out[2] = static_cast<unsigned char>((b << 3) | (b >> 2));
+		out[3] = 255;
+	}
+
+	// When color0 <= color1 a BC1 block is in three-color mode, where the last entry is transparent black.
+	// The color blocks of BC3 are always in four-color mode.
+	void BuildColorPalette(unsigned short color0, unsigned short color1, bool allowThreeColor, unsigned char (&palette)[4][4])
+	{
+		Unpack565(color0, palette[0]);
+		Unpack565(color1, palette[1]);
+
+		if (color0 > color1 || !allowThreeColor)
+		{
+			for (unsigned c = 0; c < 3; ++c)
+			{
+				palette[2][c] = static_cast<unsigned char>((2 * palette[0][c] + palette[1][c] + 1) / 3);
+				palette[3][c] = static_cast<unsigned char>((palette[0][c] + 2 * palette[1][c] + 1) / 3);
+			}
+
+			palette[2][3] = 255;
+			palette[3][3] = 255;
+		}
+		else
+		{
+			for (unsigned c = 0; c < 3; ++c)
+			{
+				palette[2][c] = static_cast<unsigned char>((palette[0][c] + palette[1][c] + 1) / 2);
+				palette[3][c] = 0;
+			}
+
+			palette[2][3] = 255;
+			palette[3][3] = 0;
+		}
+	}
+
+	// Encodes the block in four-color mode and returns the squared error.
+	// 'weights' receives how far each pixel was placed along the line from 'start' to 'end'.
+	unsigned EncodeColors(const Block& block, const float (&start)[4], const float (&end)[4], unsigned char* out, float (&weights)[16])
+	{
+		unsigned short color0 = Pack565(end);
+		unsigned short color1 = Pack565(start);
+		const bool swapped = color0 < color1;
+		if (swapped)
+		{
+			std::swap(color0, color1);
+		}
+
+		unsigned char palette[4][4];
+		BuildColorPalette(color0, color1, false, palette);
+
+		// Weights of each palette entry towards color0.
+		constexpr float paletteWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+		unsigned indices = 0;
+		unsigned error = 0;
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			// Equal endpoints would be read as three-color mode, so only the first entry can be used.
+			unsigned bestIndex = 0;
+			unsigned bestError = SquaredDistance(block[i], palette[0], 3);
+			for (unsigned p = 1; p < 4 && color0 != color1; ++p)
+			{
+				const unsigned distance = SquaredDistance(block[i], palette[p], 3);
+				if (distance < bestError)
+				{
+					bestError = distance;
+					bestIndex = p;
+				}
+			}
+
+			indices |= bestIndex << (i * 2);
+			error += bestError;
+			weights[i] = swapped ? 1.0f - paletteWeights[bestIndex] : paletteWeights[bestIndex];
+		}
+
+		out[0] = static_cast<unsigned char>(color0);
+		out[1] = static_cast<unsigned char>(color0 >> 8);
+		out[2] = static_cast<unsigned char>(color1);
+		out[3] = static_cast<unsigned char>(color1 >> 8);
+		out[4] = static_cast<unsigned char>(indices);
+		out[5] = static_cast<unsigned char>(indices >> 8);
+		out[6] = static_cast<unsigned char>(indices >> 16);
+		out[7] = static_cast<unsigned char>(indices >> 24);
+
+		return error;
+	}
+
+	void EncodeColorBlock(const Block& block, unsigned char* out)
+	{
+		Points points;
+		ToPoints(block, points);
+
+		float start[4];
+		float end[4];
+		FitLine(points, 3, start, end);
+
+		float weights[16];
+		unsigned bestError = EncodeColors(block, start, end, out, weights);
+
+		for (unsigned iteration = 0; iteration < 2 && bestError > 0; ++iteration)
+		{
+			if (!RefineLine(points, 3, weights, start, end))
+				break;
+
+			unsigned char candidate[8];
+			float candidateWeights[16];
+			const unsigned error = EncodeColors(block, start, end, candidate, candidateWeights);
+			if (error >= bestError)
+				break;
+
+			bestError = error;
+			memcpy(out, candidate, sizeof(candidate));
+			memcpy(weights, candidateWeights, sizeof(weights));
+		}
+	}
+
+	void DecodeColorBlock(const unsigned char* in, bool allowThreeColor, Block& out)
+	{
+		const unsigned short color0 = static_cast<unsigned short>(in[0] | (in[1] << 8));
+		const unsigned short color1 = static_cast<unsigned short>(in[2] | (in[3] << 8));
+		const unsigned indices = in[4] | (in[5] << 8) | (in[6] << 16) | (unsigned(in[7]) << 24);
+
+		unsigned char palette[4][4];
+		BuildColorPalette(color0, color1, allowThreeColor, palette);
+
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			const unsigned char* color = palette[(indices >> (i * 2)) & 0x3];
+			out[i][0] = color[0];
+			out[i][1] = color[1];
+			out[i][2] = color[2];
+			if (allowThreeColor)
+			{
+				out[i][3] = color[3];
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------
+	// BC4 channel blocks, used for the alpha of BC3 and both channels of BC5: two 8 bit endpoints and a 3 bit index per pixel.
+
+	void BuildChannelPalette(unsigned char value0, unsigned char value1, unsigned char (&palette)[8])
+	{
+		palette[0] = value0;
+		palette[1] = value1;
+
+		if (value0 > value1)
+		{
+			for (unsigned i = 1; i < 7; ++i)
+			{
+				palette[i + 1] = static_cast<unsigned char>(((7 - i) * value0 + i * value1 + 3) / 7);
+			}
+		}
+		else
+		{
+			for (unsigned i = 1; i < 5; ++i)
+			{
+				palette[i + 1] = static_cast<unsigned char>(((5 - i) * value0 + i * value1 + 2) / 5);
+			}
+
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	void EncodeChannelBlock(const Block& block, unsigned channel, unsigned char* out)
+	{
+		unsigned char min = 255;
+		unsigned char max = 0;
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			min = std::min(min, block[i][channel]);
+			max = std::max(max, block[i][channel]);
+		}
+
+		// The eight value mode spans the full range of the block.
+		unsigned char palette[8];
+		BuildChannelPalette(max, min, palette);
+
+		unsigned long long indices = 0;
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			unsigned bestIndex = 0;
+			int bestError = INT_MAX;
+			for (unsigned p = 0; p < 8 && max != min; ++p)
+			{
+				const int error = std::abs(static_cast<int>(block[i][channel]) - static_cast<int>(palette[p]));
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+
+			indices |= static_cast<unsigned long long>(bestIndex) << (i * 3);
+		}
+
+		out[0] = max;
+		out[1] = min;
+		for (unsigned i = 0; i < 6; ++i)
+		{
+			out[2 + i] = static_cast<unsigned char>(indices >> (i * 8));
+		}
+	}
+
+	void DecodeChannelBlock(const unsigned char* in, unsigned channel, Block& out)
+	{
+		unsigned char palette[8];
+		BuildChannelPalette(in[0], in[1], palette);
+
+		unsigned long long indices = 0;
+		for (unsigned i = 0; i < 6; ++i)
+		{
+			indices |= static_cast<unsigned long long>(in[2 + i]) << (i * 8);
+		}
+
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			out[i][channel] = palette[(indices >> (i * 3)) & 0x7];
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------
+	// BC7 mode 6 blocks: two 7.7.7.7 RGBA endpoints, each with a shared low bit, and a 4 bit index per pixel.
+
+	// Reads and writes fields of a 128 bit block, least significant bit first.
+	class BlockBits
+	{
+	public:
+		BlockBits(unsigned char* _data)
+			: data(_data)
+		{
+		}
+
+		void Write(unsigned value, unsigned numBits)
+		{
+			for (unsigned i = 0; i < numBits; ++i, ++position)
+			{
+				if ((value >> i) & 1)
+				{
+					data[position / 8] |= static_cast<unsigned char>(1 << (position % 8));
+				}
+			}
+		}
+
+		unsigned Read(unsigned numBits)
+		{
+			unsigned value = 0;
+			for (unsigned i = 0; i < numBits; ++i, ++position)
+			{
+				value |= ((data[position / 8] >> (position % 8)) & 1u) << i;
+			}
+
+			return value;
+		}
+
+	private:
+		unsigned char* data;
+		unsigned position = 0;
+	};
+
+	struct Mode6Block
+	{
+		// 7 bit values.
+		unsigned char endpoints[2][4];
+		unsigned char pBits[2];
+		unsigned char indices[16];
+	};
+
+	void BuildMode6Palette(const Mode6Block& block, unsigned char (&palette)[16][4])
+	{
+		unsigned char endpoints[2][4];
+		for (unsigned e = 0; e < 2; ++e)
+		{
+			for (unsigned c = 0; c < 4; ++c)
+			{
+				endpoints[e][c] = static_cast<unsigned char>((block.endpoints[e][c] << 1) | block.pBits[e]);
+			}
+		}
+
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			for (unsigned c = 0; c < 4; ++c)
+			{
+				palette[i][c] = static_cast<unsigned char>(((64 - bc7Weights[i]) * endpoints[0][c] + bc7Weights[i] * endpoints[1][c] + 32) >> 6);
+			}
+		}
+	}
+
+	// Quantizes the endpoints with the best choice of low bits. 'out' is only replaced if the result has less error than 'bestError'.
+	void QuantizeMode6(const Block& block, const float (&start)[4], const float (&end)[4], Mode6Block& out, unsigned& bestError)
+	{
+		for (unsigned p = 0; p < 4; ++p)
+		{
+			Mode6Block candidate;
+			candidate.pBits[0] = static_cast<unsigned char>(p & 1);
+			candidate.pBits[1] = static_cast<unsigned char>(p >> 1);
+
+			for (unsigned c = 0; c < 4; ++c)
+			{
+				candidate.endpoints[0][c] = static_cast<unsigned char>(std::clamp((start[c] - candidate.pBits[0]) * 0.5f + 0.5f, 0.0f, 127.0f));
+				candidate.endpoints[1][c] = static_cast<unsigned char>(std::clamp((end[c] - candidate.pBits[1]) * 0.5f + 0.5f, 0.0f, 127.0f));
+			}
+
+			unsigned char palette[16][4];
+			BuildMode6Palette(candidate, palette);
+
+			unsigned error = 0;
+			for (unsigned i = 0; i < 16 && error < bestError; ++i)
+			{
+				unsigned pixelError = UINT_MAX;
+				for (unsigned char index = 0; index < 16; ++index)
+				{
+					const unsigned distance = SquaredDistance(block[i], palette[index], 4);
+					if (distance < pixelError)
+					{
+						pixelError = distance;
+						candidate.indices[i] = index;
+					}
+				}
+
+				error += pixelError;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				out = candidate;
+			}
+		}
+	}
+
+	void EncodeMode6Block(const Block& block, unsigned char* out)
+	{
+		Points points;
+		ToPoints(block, points);
+
+		float start[4];
+		float end[4];
+		FitLine(points, 4, start, end);
+
+		Mode6Block result;
+		unsigned bestError = UINT_MAX;
+		QuantizeMode6(block, start, end, result, bestError);
+
+		for (unsigned iteration = 0; iteration < 2 && bestError > 0; ++iteration)
+		{
+			float weights[16];
+			for (unsigned i = 0; i < 16; ++i)
+			{
+				weights[i] = bc7Weights[result.indices[i]] / 64.0f;
+			}
+
+			if (!RefineLine(points, 4, weights, start, end))
+				break;
+
+			const unsigned previousError = bestError;
+			QuantizeMode6(block, start, end, result, bestError);
+			if (bestError == previousError)
+				break;
+		}
+
+		// The most significant bit of the first index is implied to be zero, so the endpoints are swapped if needed.
+		if (result.indices[0] & 0x8)
+		{
+			std::swap(result.endpoints[0], result.endpoints[1]);
+			std::swap(result.pBits[0], result.pBits[1]);
+			for (unsigned i = 0; i < 16; ++i)
+			{
+				result.indices[i] = static_cast<unsigned char>(15 - result.indices[i]);
+			}
+		}
+
+		memset(out, 0, 16);
+		BlockBits bits(out);
+		bits.Write(1 << 6, 7);
+		for (unsigned c = 0; c < 4; ++c)
+		{
+			bits.Write(result.endpoints[0][c], 7);
+			bits.Write(result.endpoints[1][c], 7);
+		}
+
+		bits.Write(result.pBits[0], 1);
+		bits.Write(result.pBits[1], 1);
+		bits.Write(result.indices[0], 3);
+		for (unsigned i = 1; i < 16; ++i)
+		{
+			bits.Write(result.indices[i], 4);
+		}
+	}
+
+	bool DecodeMode6Block(const unsigned char* in, Block& out)
+	{
+		if ((in[0] & 0x7F) != (1 << 6))
+			return false;
+
+		unsigned char data[16];
+		memcpy(data, in, sizeof(data));
+		BlockBits bits(data);
+		bits.Read(7);
+
+		Mode6Block block;
+		for (unsigned c = 0; c < 4; ++c)
+		{
+			block.endpoints[0][c] = static_cast<unsigned char>(bits.Read(7));
+			block.endpoints[1][c] = static_cast<unsigned char>(bits.Read(7));
+		}
+
+		block.pBits[0] = static_cast<unsigned char>(bits.Read(1));
+		block.pBits[1] = static_cast<unsigned char>(bits.Read(1));
+		block.indices[0] = static_cast<unsigned char>(bits.Read(3));
+		for (unsigned i = 1; i < 16; ++i)
+		{
+			block.indices[i] = static_cast<unsigned char>(bits.Read(4));
+		}
+
+		unsigned char palette[16][4];
+		BuildMode6Palette(block, palette);
+
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			memcpy(out[i], palette[block.indices[i]], 4);
+		}
+
+		return true;
+	}
+}
+
+namespace Jwl
+{
+	void DownsampleImage(const unsigned char* pixels, unsigned width, unsigned height, unsigned numChannels, bool isSRGB, std::vector<unsigned char>& out, ThreadPool* pool)
+	{
+		ASSERT(pixels, "'pixels' cannot be null.");
+		ASSERT(width > 0 && height > 0, "Image cannot be empty.");
+		ASSERT(numChannels > 0 && numChannels <= 4, "'numChannels' must be in the range of [1, 4].");
+
+		const unsigned outWidth = std::max(width / 2, 1u);
+		const unsigned outHeight = std::max(height / 2, 1u);
+		out.resize(size_t(outWidth) * outHeight * numChannels);
+
+		unsigned char* outPixels = out.data();
+		ForEachStrip(outHeight, DOWNSAMPLE_ROWS_PER_STRIP, pool, [=](unsigned firstRow, unsigned endRow) {
+			for (unsigned y = firstRow; y < endRow; ++y)
+			{
+				const unsigned y0 = std::min(y * 2, height - 1);
+				const unsigned y1 = std::min(y * 2 + 1, height - 1);
+
+				for (unsigned x = 0; x < outWidth; ++x)
+				{
+					const unsigned x0 = std::min(x * 2, width - 1);
+					const unsigned x1 = std::min(x * 2 + 1, width - 1);
+
+					const unsigned char* samples[4] = {
+						pixels + (size_t(y0) * width + x0) * numChannels,
+						pixels + (size_t(y0) * width + x1) * numChannels,
+						pixels + (size_t(y1) * width + x0) * numChannels,
+						pixels + (size_t(y1) * width + x1) * numChannels
+					};
+
+					unsigned char* dest = outPixels + (size_t(y) * outWidth + x) * numChannels;
+					for (unsigned c = 0; c < numChannels; ++c)
+					{
+						if (isSRGB && c < 3)
+						{
+							float sum = 0.0f;
+							for (const unsigned char* sample : samples)
+							{
+								sum += SRGBToLinear(sample[c]);
+							}
+
+							dest[c] = LinearToSRGB(sum * 0.25f);
+						}
+						else
+						{
+							unsigned sum = 0;
+							for (const unsigned char* sample : samples)
+							{
+								sum += sample[c];
+							}
+
+							dest[c] = static_cast<unsigned char>((sum + 2) / 4);
+						}
+					}
+				}
+			}
+		});
+	}
+
+	void CompressImage(const unsigned char* pixels, unsigned width, unsigned height, unsigned numChannels, TextureFormat format, std::vector<unsigned char>& out, ThreadPool* pool)
+	{
+		ASSERT(pixels, "'pixels' cannot be null.");
+		ASSERT(width > 0 && height > 0, "Image cannot be empty.");
+		ASSERT(numChannels > 0 && numChannels <= 4, "'numChannels' must be in the range of [1, 4].");
+		ASSERT(IsCompressed(format), "'format' must be a block-compressed format.");
+
+		const unsigned blocksX = (width + 3) / 4;
+		const unsigned blocksY = (height + 3) / 4;
+		const unsigned blockSize = CountBytes(format, 4, 4);
+		out.resize(CountBytes(format, width, height));
+
+		unsigned char* blocks = out.data();
+		ForEachStrip(blocksY, BLOCK_ROWS_PER_STRIP, pool, [=](unsigned firstRow, unsigned endRow) {
+			unsigned char* dest = blocks + size_t(firstRow) * blocksX * blockSize;
+			for (unsigned blockY = firstRow; blockY < endRow; ++blockY)
+			{
+				for (unsigned blockX = 0; blockX < blocksX; ++blockX)
+				{
+					Block block;
+					FetchBlock(pixels, width, height, numChannels, blockX, blockY, block);
+
+					switch (format)
+					{
+					case TextureFormat::RGB_BC1:
+					case TextureFormat::sRGB_BC1:
+						EncodeColorBlock(block, dest);
+						break;
+
+					case TextureFormat::RGBA_BC3:
+					case TextureFormat::sRGBA_BC3:
+						EncodeChannelBlock(block, 3, dest);
+						EncodeColorBlock(block, dest + 8);
+						break;
+
+					case TextureFormat::RG_BC5:
+						EncodeChannelBlock(block, 0, dest);
+						EncodeChannelBlock(block, 1, dest + 8);
+						break;
+
+					case TextureFormat::RGBA_BC7:
+					case TextureFormat::sRGBA_BC7:
+						EncodeMode6Block(block, dest);
+						break;
+
+					default:
+						break;
+					}
+
+					dest += blockSize;
+				}
+			}
+		});
+	}
+
+	bool DecompressImage(const unsigned char* blocks, unsigned width, unsigned height, TextureFormat format, std::vector<unsigned char>& out)
+	{
+		ASSERT(blocks, "'blocks' cannot be null.");
+
+		if (!IsCompressed(format))
+		{
+			Error("Texture format is not block-compressed.");
+			return false;
+		}
+
+		const unsigned blocksX = (width + 3) / 4;
+		const unsigned blocksY = (height + 3) / 4;
+		const unsigned blockSize = CountBytes(format, 4, 4);
+		out.resize(size_t(width) * height * 4);
+
+		const unsigned char* source = blocks;
+		for (unsigned blockY = 0; blockY < blocksY; ++blockY)
+		{
+			for (unsigned blockX = 0; blockX < blocksX; ++blockX)
+			{
+				Block block;
+				for (auto& pixel : block)
+				{
+					pixel[0] = pixel[1] = pixel[2] = 0;
+					pixel[3] = 255;
+				}
+
+				switch (format)
+				{
+				case TextureFormat::RGB_BC1:
+				case TextureFormat::sRGB_BC1:
+					DecodeColorBlock(source, true, block);
+					break;
+
+				case TextureFormat::RGBA_BC3:
+				case TextureFormat::sRGBA_BC3:
+					DecodeChannelBlock(source, 3, block);
+					DecodeColorBlock(source + 8, false, block);
+					break;
+
+				case TextureFormat::RG_BC5:
+					DecodeChannelBlock(source, 0, block);
+					DecodeChannelBlock(source + 8, 1, block);
+					break;
+
+				case TextureFormat::RGBA_BC7:
+				case TextureFormat::sRGBA_BC7:
+					if (!DecodeMode6Block(source, block))
+					{
+						Error("Only mode 6 BC7 blocks can be decoded.");
+						return false;
+					}
+					break;
+
+				default:
+					break;
+				}
+
+				StoreBlock(block, width, height, blockX, blockY, out.data());
+				source += blockSize;
+			}
+		}
+
+		return true;
+	}
+
+	float ComputePSNR(const unsigned char* a, const unsigned char* b, size_t size)
+	{
+		ASSERT(size > 0, "Buffers cannot be empty.");
+
+		double sum = 0.0;
+		for (size_t i = 0; i < size; ++i)
+		{
+			const double delta = static_cast<double>(a[i]) - static_cast<double>(b[i]);
+			sum += delta * delta;
+		}
+
+		if (sum == 0.0)
+			return std::numeric_limits<float>::infinity();
+
+		const double meanSquaredError = sum / static_cast<double>(size);
+		return static_cast<float>(10.0 * std::log10((255.0 * 255.0) / meanSquaredError));
+	}
+}
@@ -0,0 +1,33 @@
+// Copyright (c) 2020 Emilian Cioca
+#pragma once
+#include "Jewel3D/Rendering/Rendering.h"
+
+#include <vector>
+
+// Offline processing for texture data, such as building mip chains and block compression.
+// Images are tightly packed rows of 8 bit channels, with the same layout as a Jwl::Image.
+namespace Jwl
+{
+	class ThreadPool;
+
+	// Halves the size of the image, rounding down, with a 2x2 box filter.
+	// When 'isSRGB' is set, the color channels are averaged in linear space so that the mips keep the brightness of the original.
+	// The fourth channel is treated as linear alpha.
+	// When a pool is provided the image is split into strips of rows that are processed in parallel. The call waits for the whole pool to finish.
+	void DownsampleImage(const unsigned char* pixels, unsigned width, unsigned height, unsigned numChannels, bool isSRGB, std::vector<unsigned char>& out, ThreadPool* pool = nullptr);
+
+	// Encodes the image into the 4x4 blocks of a compressed 'format', replacing the contents of 'out'.
+	// Missing channels are read as 0, or 255 for alpha. Partial blocks along the edges repeat the last row and column.
+	// BC7 blocks are always encoded with mode 6, which has a single subset with 7.7.7.7.1 endpoints and 4 bit indices.
+	// When a pool is provided the image is split into strips of blocks that are encoded in parallel. The call waits for the whole pool to finish.
+	void CompressImage(const unsigned char* pixels, unsigned width, unsigned height, unsigned numChannels, TextureFormat format, std::vector<unsigned char>& out, ThreadPool* pool = nullptr);
+
+	// Decodes compressed blocks into an RGBA image, replacing the contents of 'out'.
+	// BC5 decodes to red and green, with blue set to 0 and alpha to 255.
+	// Returns false if 'format' is not compressed, or if a BC7 block uses a mode other than 6.
+	bool DecompressImage(const unsigned char* blocks, unsigned width, unsigned height, TextureFormat format, std::vector<unsigned char>& out);
+
+	// Returns the Peak Signal-to-Noise Ratio between two buffers of 8 bit values, in decibels.
+	// Identical buffers return infinity. Lossy compression of photographic content is typically in the range of 30 - 50.
+	float ComputePSNR(const unsigned char* a, const unsigned char* b, size_t size);
+}
@@ -0,0 +1,162 @@
+#include <catch.hpp>
+#include <Jewel3D/Application/Archive.h>
+#include <Jewel3D/Application/FileSystem.h>
+
+using namespace Jwl;
+
+namespace
+{
+	std::vector<unsigned char> ToBytes(std::string_view str)
+	{
+		return std::vector<unsigned char>(str.begin(), str.end());
+	}
+
+	bool Matches(const FileView& view, std::string_view expected)
+	{
+		return std::string_view(reinterpret_cast<const char*>(view.GetData()), view.GetSize()) == expected;
+	}
+}
+
+TEST_CASE("Archive")
+{
+	const char* file = "ArchiveTest.pack";
+	const std::string repetitive(10000, 'z');
+
+	ArchiveWriter writer;
+	writer.Add("Models/Tree.model", ToBytes("tree"), false);
+	writer.Add("Textures\\Bark.texture", ToBytes(repetitive), true);
+	writer.Add("Empty.txt", {}, true);
+	writer.Add("Sounds/Wind.wav", ToBytes("wind"), true);
+	REQUIRE(writer.GetEntryCount() == 4);
+	REQUIRE(writer.Save(file));
+
+	SECTION("Lookup")
+	{
+		Archive archive;
+		REQUIRE(archive.Open(file));
+		CHECK(archive.GetEntries().size() == 4);
+
+		FileView view;
+		REQUIRE(archive.OpenEntry("Models/Tree.model", view));
+		CHECK(Matches(view, "tree"));
+
+		// Names are not case or slash sensitive.
+		REQUIRE(archive.OpenEntry("./models\\TREE.model", view));
+		CHECK(Matches(view, "tree"));
+
+		REQUIRE(archive.OpenEntry("Empty.txt", view));
+		CHECK(view.GetSize() == 0);
+
+		CHECK_FALSE(archive.Contains("Models/Rock.model"));
+		CHECK_FALSE(archive.OpenEntry("Models", view));
+	}
+
+	SECTION("Compression")
+	{
+		Archive archive;
+		REQUIRE(archive.Open(file));
+
+		FileView view;
+		REQUIRE(archive.OpenEntry("Textures/Bark.texture", view));
+		CHECK(Matches(view, repetitive));
+
+		// Entries that don't benefit from compression are stored as-is.
+		REQUIRE(archive.OpenEntry("Sounds/Wind.wav", view));
+		CHECK(Matches(view, "wind"));
+
+		for (auto& entry : archive.GetEntries())
+		{
+			if (archive.GetName(entry) == "textures/bark.texture")
+			{
+				CHECK(entry.compression == static_cast<uint32_t>(ArchiveCompression::LZ4));
+				CHECK(entry.storedSize < entry.size);
+			}
+			else
+			{
+				CHECK(entry.compression == static_cast<uint32_t>(ArchiveCompression::None));
+			}
+		}
+	}
+
+	SECTION("Layout")
+	{
+		Archive archive;
+		REQUIRE(archive.Open(file));
+
+		uint64_t previousHash = 0;
+		for (auto& entry : archive.GetEntries())
+		{
+			CHECK(entry.offset % ARCHIVE_ALIGNMENT == 0);
+			CHECK(entry.nameHash >= previousHash);
+			previousHash = entry.nameHash;
+		}
+	}
+
+	SECTION("Mounting")
+	{
+		FileView view;
+		CHECK_FALSE(view.Open("./PackedAssets/Models/Tree.model"));
+		CHECK_FALSE(IsInArchive("./PackedAssets/Models/Tree.model"));
+
+		REQUIRE(MountArchive(file, "./PackedAssets/"));
+
+		REQUIRE(view.Open("./PackedAssets/Models/Tree.model"));
+		CHECK(Matches(view, "tree"));
+		CHECK(IsInArchive("./PackedAssets/Models/Tree.model"));
+		CHECK_FALSE(IsInArchive("./PackedAssets/Models/Rock.model"));
+		CHECK_FALSE(IsInArchive("./Models/Tree.model"));
+
+		std::string text;
+		REQUIRE(LoadFileAsString("./PackedAssets/Textures/Bark.texture", text));
+		CHECK(text == repetitive);
+
+		// Later mounts take priority.
+		const char* patch = "ArchivePatch.pack";
+		ArchiveWriter patchWriter;
+		patchWriter.Add("Models/Tree.model", ToBytes("patched"), false);
+		REQUIRE(patchWriter.Save(patch));
+		REQUIRE(MountArchive(patch, "./PackedAssets/"));
+
+		REQUIRE(view.Open("./PackedAssets/Models/Tree.model"));
+		CHECK(Matches(view, "patched"));
+
+		UnmountArchive(patch);
+		REQUIRE(view.Open("./PackedAssets/Models/Tree.model"));
+		CHECK(Matches(view, "tree"));
+
+		UnmountAllArchives();
+		CHECK_FALSE(view.Open("./PackedAssets/Models/Tree.model"));
+		CHECK_FALSE(IsInArchive("./PackedAssets/Models/Tree.model"));
+
+		RemoveFile(patch);
+	}
+
+	SECTION("Invalid Archives")
+	{
+		const char* invalid = "ArchiveInvalid.pack";
+		FILE* output = fopen(invalid, "wb");
+		REQUIRE(output != nullptr);
+		fputs("not an archive", output);
+		fclose(output);
+
+		Archive archive;
+		CHECK_FALSE(archive.Open(invalid));
+		CHECK_FALSE(archive.Open("ArchiveMissing.pack"));
+		CHECK_FALSE(archive.IsOpen());
+
+		// A header claiming more entries than the file could hold.
+		output = fopen(invalid, "wb");
+		REQUIRE(output != nullptr);
+		const uint32_t header[] = { 1, 0xFFFFFFFF, 0 };
+		fwrite("JWPK", 1, 4, output);
+		fwrite(header, sizeof(header), 1, output);
+		fclose(output);
+
+		CHECK_FALSE(archive.Open(invalid));
+		CHECK_FALSE(archive.IsOpen());
+
+		RemoveFile(invalid);
+	}
+
+	RemoveFile(file);
+}
@@ -0,0 +1,122 @@
+#include <catch.hpp>
+#include <Jewel3D/Resource/Resource.h>
+
+#include <atomic>
+
+using namespace Jwl;
+
+namespace
+{
+	std::atomic<unsigned> decodeCount = 0;
+
+	// Streams without touching the disk or the GPU.
+	// Files named "missing" fail to decode, and files named "corrupt" fail to upload.
+	class FakeAsset : public Resource<FakeAsset>
+	{
+	public:
+		struct StreamData
+		{
+			std::string contents;
+		};
+
+		static bool Decode(std::string filePath, StreamData& out)
+		{
+			++decodeCount;
+			if (filePath.find("missing") != std::string::npos)
+			{
+				return false;
+			}
+
+			out.contents = std::move(filePath);
+			return true;
+		}
+
+		bool Upload(const StreamData& data)
+		{
+			contents = data.contents;
+			return contents.find("corrupt") == std::string::npos;
+		}
+
+		bool Load(std::string filePath)
+		{
+			StreamData data;
+			return Decode(std::move(filePath), data) && Upload(data);
+		}
+
+		std::string contents;
+	};
+}
+
+TEST_CASE("AssetStreamer")
+{
+	decodeCount = 0;
+
+	SECTION("LoadAsync")
+	{
+		auto handle = LoadAsync<FakeAsset>("a.fake");
+		CHECK(handle.Wait() != nullptr);
+		CHECK(handle.IsReady());
+		CHECK(handle.IsFinished());
+		CHECK_FALSE(handle.IsFailed());
+		CHECK(handle.Get()->contents == RootAssetDirectory + "a.fake");
+
+		// Once loaded, the asset comes from the cache.
+		CHECK(FakeAsset::Find(RootAssetDirectory + "a.fake") == handle.Get());
+		CHECK(LoadAsync<FakeAsset>("a.fake").Get() == handle.Get());
+		CHECK(Load<FakeAsset>("a.fake") == handle.Get());
+		CHECK(decodeCount == 1);
+	}
+
+	SECTION("Deduplication")
+	{
+		auto first = LoadAsync<FakeAsset>("b.fake");
+		auto second = LoadAsync<FakeAsset>("b.fake");
+
+		// A synchronous load completes the in-flight request rather than starting another.
+		auto asset = Load<FakeAsset>("b.fake");
+		REQUIRE(asset != nullptr);
+		CHECK(first.Get() == asset);
+		CHECK(second.Wait() == asset);
+		CHECK(decodeCount == 1);
+	}
+
+	SECTION("Failure")
+	{
+		auto missing = LoadAsync<FakeAsset>("missing.fake");
+		auto corrupt = LoadAsync<FakeAsset>("corrupt.fake");
+		AssetStreamer.FinishAll();
+
+		CHECK(missing.IsFailed());
+		CHECK(corrupt.IsFailed());
+		CHECK(missing.Get() == nullptr);
+		CHECK(corrupt.Wait() == nullptr);
+		CHECK(FakeAsset::Find(RootAssetDirectory + "corrupt.fake") == nullptr);
+
+		// A failed request can be made again.
+		CHECK(LoadAsync<FakeAsset>("missing.fake").Wait() == nullptr);
+		CHECK(decodeCount == 3);
+	}
+
+	SECTION("Many Requests")
+	{
+		std::vector<AsyncLoad<FakeAsset>> handles;
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			handles.push_back(LoadAsync<FakeAsset>("many" + std::to_string(i) + ".fake"));
+		}
+
+		AssetStreamer.FinishAll();
+		CHECK(AssetStreamer.GetPendingCount() == 0);
+
+		bool allReady = true;
+		for (auto& handle : handles)
+		{
+			allReady = allReady && handle.IsReady();
+		}
+
+		CHECK(allReady);
+		CHECK(decodeCount == 100);
+	}
+
+	UnloadAll<FakeAsset>();
+}
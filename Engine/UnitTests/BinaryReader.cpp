@@ -0,0 +1,42 @@
+#include <catch.hpp>
+#include <Jewel3D/Utilities/BinaryReader.h>
+
+using namespace Jwl;
+
+TEST_CASE("BinaryReader")
+{
+	// An int that is not aligned, followed by three bytes.
+	const unsigned char data[] = { 0xFF, 0x01, 0x00, 0x00, 0x00, 'a', 'b', 'c' };
+
+	BinaryReader reader(data + 1, sizeof(data) - 1);
+	CHECK(reader.GetRemaining() == 7);
+
+	int value = 0;
+	REQUIRE(reader.Read(value));
+	CHECK(value == 1);
+	CHECK(reader.GetPosition() == 4);
+
+	SECTION("Bytes")
+	{
+		const unsigned char* bytes = reader.ReadBytes(3);
+		REQUIRE(bytes != nullptr);
+		CHECK(bytes == data + 5);
+		CHECK(reader.GetRemaining() == 0);
+
+		CHECK(reader.ReadBytes(0) != nullptr);
+		CHECK(reader.ReadBytes(1) == nullptr);
+	}
+
+	SECTION("Out of Bounds")
+	{
+		// A failed read must not consume anything or modify the output.
+		value = 42;
+		CHECK_FALSE(reader.Read(value));
+		CHECK(value == 42);
+		CHECK(reader.GetRemaining() == 3);
+
+		CHECK(reader.ReadBytes(4) == nullptr);
+		CHECK(reader.ReadBytes(size_t(-1)) == nullptr);
+		CHECK(reader.GetRemaining() == 3);
+	}
+}
@@ -0,0 +1,164 @@
+#include <catch.hpp>
+#include <Jewel3D/Math/Math.h>
+#include <Jewel3D/Math/Quaternion.h>
+#include <Jewel3D/Math/Vector.h>
+#include <Jewel3D/Network/BitStream.h>
+
+using namespace Jwl;
+
+TEST_CASE("BitStream")
+{
+	SECTION("Bits")
+	{
+		BitWriter writer;
+		writer.Write(5, 3);
+		writer.WriteBool(true);
+		writer.Write(0xABCDEF12, 32);
+		writer.Write(0xFFFF, 4);
+		writer.Write(0, 0);
+
+		CHECK(writer.GetBitCount() == 40);
+		CHECK(writer.GetByteCount() == 5);
+
+		BitReader reader(writer.GetData());
+		uint32_t value = 0;
+		bool flag = false;
+
+		REQUIRE(reader.Read(3, value));
+		CHECK(value == 5);
+		REQUIRE(reader.ReadBool(flag));
+		CHECK(flag);
+		REQUIRE(reader.Read(32, value));
+		CHECK(value == 0xABCDEF12);
+		REQUIRE(reader.Read(4, value));
+		CHECK(value == 0xF);
+		CHECK(reader.GetRemaining() == 0);
+
+		// A failed read must not consume anything or modify the output.
+		value = 42;
+		CHECK_FALSE(reader.Read(1, value));
+		CHECK(value == 42);
+	}
+
+	SECTION("Integers")
+	{
+		BitWriter writer;
+		writer.WriteInt(-3, -10, 10);
+		writer.WriteInt(7, 7, 7);
+		writer.WriteVarUint(0);
+		writer.WriteVarUint(15);
+		writer.WriteVarUint(16);
+		writer.WriteVarUint(0xFFFFFFFF);
+
+		// 5 bits for the range, nothing for a single value, and 5 bits per group of 4.
+		CHECK(writer.GetBitCount() == 5 + 0 + 5 + 5 + 10 + 40);
+
+		BitReader reader(writer.GetData());
+		int value = 0;
+		uint32_t var = 0;
+
+		REQUIRE(reader.ReadInt(-10, 10, value));
+		CHECK(value == -3);
+		REQUIRE(reader.ReadInt(7, 7, value));
+		CHECK(value == 7);
+		REQUIRE(reader.ReadVarUint(var));
+		CHECK(var == 0);
+		REQUIRE(reader.ReadVarUint(var));
+		CHECK(var == 15);
+		REQUIRE(reader.ReadVarUint(var));
+		CHECK(var == 16);
+		REQUIRE(reader.ReadVarUint(var));
+		CHECK(var == 0xFFFFFFFF);
+	}
+
+	SECTION("Quantization")
+	{
+		CHECK(GetBitsRequired(0) == 0);
+		CHECK(GetBitsRequired(1) == 1);
+		CHECK(GetBitsRequired(255) == 8);
+		CHECK(GetBitsRequired(256) == 9);
+		CHECK(GetQuantizedBits(-1.0f, 1.0f, 0.01f) == 8);
+
+		BitWriter writer;
+		writer.WriteFloat(0.337f, -1.0f, 1.0f, 0.01f);
+		writer.WriteFloat(5.0f, -1.0f, 1.0f, 0.01f);
+		writer.WriteVec3(vec3(-100.5f, 0.0f, 2000.25f), -4096.0f, 4096.0f, 0.01f);
+		CHECK(writer.GetBitCount() == 8 + 8 + 20 * 3);
+
+		BitReader reader(writer.GetData());
+		float value = 0.0f;
+		vec3 vector;
+
+		REQUIRE(reader.ReadFloat(-1.0f, 1.0f, 0.01f, value));
+		CHECK(Abs(value - 0.337f) <= 0.005f);
+		// Values outside of the range are clamped.
+		REQUIRE(reader.ReadFloat(-1.0f, 1.0f, 0.01f, value));
+		CHECK(value == 1.0f);
+		REQUIRE(reader.ReadVec3(-4096.0f, 4096.0f, 0.01f, vector));
+		CHECK(Abs(vector.x + 100.5f) <= 0.005f);
+		CHECK(Abs(vector.y) <= 0.005f);
+		CHECK(Abs(vector.z - 2000.25f) <= 0.005f);
+	}
+
+	SECTION("Quaternions")
+	{
+		quat rotations[4];
+		rotations[1].Rotate(Normalize(vec3(1.0f, 2.0f, 3.0f)), 75.0f);
+		rotations[2].Rotate(vec3::Up, 180.0f);
+		rotations[3] = quat(-0.5f, 0.5f, -0.5f, -0.5f);
+
+		BitWriter writer;
+		for (const quat& rotation : rotations)
+		{
+			writer.WriteQuat(rotation, 10);
+		}
+		CHECK(writer.GetBitCount() == 32 * 4);
+
+		BitReader reader(writer.GetData());
+		for (const quat& rotation : rotations)
+		{
+			quat result;
+			REQUIRE(reader.ReadQuat(10, result));
+
+			// The sign can be flipped, since that represents the same rotation.
+			CHECK(Abs(Dot(result, rotation)) > 0.9999f);
+		}
+	}
+
+	SECTION("Bytes")
+	{
+		BitWriter writer;
+		writer.WriteBool(true);
+		writer.WriteBytes("Hello");
+		writer.AlignToByte();
+		writer.WriteBytes(std::string_view("\0World", 6));
+		CHECK(writer.GetByteCount() == 12);
+
+		BitWriter copy;
+		copy.Write(3, 2);
+		copy.WriteBits(writer.GetData(), writer.GetBitCount());
+		CHECK(copy.GetBitCount() == writer.GetBitCount() + 2);
+
+		BitReader reader(copy.GetData());
+		uint32_t prefix;
+		bool flag;
+		std::string text;
+
+		REQUIRE(reader.Read(2, prefix));
+		CHECK(prefix == 3);
+		REQUIRE(reader.ReadBool(flag));
+		REQUIRE(reader.ReadBytes(5, text));
+		CHECK(text == "Hello");
+
+		// The padding from AlignToByte().
+		std::string bits;
+		REQUIRE(reader.ReadBits(7, bits));
+		CHECK(bits == std::string(1, '\0'));
+
+		REQUIRE(reader.ReadBytes(6, text));
+		CHECK(text == std::string("\0World", 6));
+
+		CHECK_FALSE(reader.ReadBytes(1, text));
+		CHECK(text == std::string("\0World", 6));
+	}
+}
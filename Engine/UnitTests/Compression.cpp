@@ -0,0 +1,83 @@
+#include <catch.hpp>
+#include <Jewel3D/Utilities/Compression.h>
+
+#include <random>
+
+using namespace Jwl;
+
+namespace
+{
+	bool RoundTrip(const std::vector<unsigned char>& data)
+	{
+		std::vector<unsigned char> compressed;
+		CompressLZ4(data.data(), data.size(), compressed);
+
+		std::vector<unsigned char> decompressed(data.size());
+		return DecompressLZ4(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()) &&
+			decompressed == data;
+	}
+}
+
+TEST_CASE("Compression")
+{
+	SECTION("Empty")
+	{
+		CHECK(RoundTrip({}));
+	}
+
+	SECTION("Small")
+	{
+		CHECK(RoundTrip({ 'a' }));
+		CHECK(RoundTrip({ 'a', 'b', 'c', 'd', 'e', 'f', 'g' }));
+	}
+
+	SECTION("Repetitive")
+	{
+		std::vector<unsigned char> data;
+		for (unsigned i = 0; i < 100000; ++i)
+		{
+			data.push_back(static_cast<unsigned char>(i % 7));
+		}
+
+		std::vector<unsigned char> compressed;
+		CompressLZ4(data.data(), data.size(), compressed);
+		CHECK(compressed.size() < data.size() / 10);
+
+		CHECK(RoundTrip(data));
+	}
+
+	SECTION("Random")
+	{
+		std::mt19937 generator(1234);
+		std::vector<unsigned char> data(200000);
+		for (auto& byte : data)
+		{
+			byte = static_cast<unsigned char>(generator());
+		}
+
+		CHECK(RoundTrip(data));
+
+		// Long matches far apart.
+		data.insert(data.end(), data.begin(), data.begin() + 50000);
+		CHECK(RoundTrip(data));
+	}
+
+	SECTION("Corrupt Data")
+	{
+		std::vector<unsigned char> data(1000, 'x');
+		std::vector<unsigned char> compressed;
+		CompressLZ4(data.data(), data.size(), compressed);
+
+		std::vector<unsigned char> decompressed(data.size());
+
+		// Wrong decompressed size.
+		CHECK_FALSE(DecompressLZ4(compressed.data(), compressed.size(), decompressed.data(), decompressed.size() - 1));
+
+		// Truncated input.
+		CHECK_FALSE(DecompressLZ4(compressed.data(), compressed.size() - 1, decompressed.data(), decompressed.size()));
+
+		// Offset pointing before the start of the output.
+		std::vector<unsigned char> invalid = { 0x10, 'x', 0xFF, 0x00 };
+		CHECK_FALSE(DecompressLZ4(invalid.data(), invalid.size(), decompressed.data(), decompressed.size()));
+	}
+}
@@ -0,0 +1,86 @@
+#include <catch.hpp>
+#include <Jewel3D/Utilities/Delegate.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+using namespace Jwl;
+
+namespace
+{
+	int Twice(int value)
+	{
+		return value * 2;
+	}
+}
+
+TEST_CASE("Delegate")
+{
+	SECTION("Empty")
+	{
+		Delegate<int(int)> empty;
+		CHECK_FALSE(empty);
+
+		Delegate<int(int)> fromNull = static_cast<int(*)(int)>(nullptr);
+		CHECK_FALSE(fromNull);
+
+		Delegate<int(int)> fromEmpty = std::function<int(int)>();
+		CHECK_FALSE(fromEmpty);
+	}
+
+	SECTION("Functions")
+	{
+		Delegate<int(int)> function = &Twice;
+		REQUIRE(function);
+		CHECK(function(21) == 42);
+
+		int offset = 5;
+		Delegate<int(int)> lambda = [&offset](int value) { return value + offset; };
+		offset = 10;
+		CHECK(lambda(1) == 11);
+
+		lambda = nullptr;
+		CHECK_FALSE(lambda);
+	}
+
+	SECTION("Copies")
+	{
+		// Small captures are stored inline, larger ones on the heap. Both copy and move correctly.
+		auto shared = std::make_shared<int>(3);
+		std::string text = "A string too long for the small string optimization";
+		char large[64] = "Large";
+
+		Delegate<size_t()> inlined = [shared] { return static_cast<size_t>(*shared); };
+		Delegate<size_t()> heap = [text, large] { return text.size() + std::char_traits<char>::length(large); };
+
+		Delegate<size_t()> inlinedCopy = inlined;
+		Delegate<size_t()> heapCopy = heap;
+		CHECK(shared.use_count() == 3);
+
+		Delegate<size_t()> inlinedMoved = std::move(inlined);
+		Delegate<size_t()> heapMoved = std::move(heap);
+		CHECK_FALSE(inlined);
+		CHECK_FALSE(heap);
+		CHECK(shared.use_count() == 3);
+
+		CHECK(inlinedCopy() == 3);
+		CHECK(inlinedMoved() == 3);
+		CHECK(heapCopy() == text.size() + 5);
+		CHECK(heapMoved() == text.size() + 5);
+
+		inlinedCopy = heapCopy;
+		CHECK(shared.use_count() == 2);
+		CHECK(inlinedCopy() == text.size() + 5);
+
+		inlinedMoved = nullptr;
+		CHECK(shared.use_count() == 1);
+	}
+
+	SECTION("Mutable")
+	{
+		Delegate<int()> counter = [count = 0]() mutable { return ++count; };
+		counter();
+		CHECK(counter() == 2);
+	}
+}
@@ -0,0 +1,270 @@
+#include <catch.hpp>
+#include <Jewel3D/Application/Event.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Jwl;
+
+namespace
+{
+	struct Numbered : public Event<Numbered>
+	{
+		Numbered(unsigned _thread, unsigned _index)
+			: thread(_thread), index(_index)
+		{
+		}
+
+		unsigned thread;
+		unsigned index;
+	};
+
+	struct Named : public Event<Named>
+	{
+		Named(std::string _name, unsigned* _destroyed)
+			: name(std::move(_name)), destroyed(_destroyed)
+		{
+		}
+
+		~Named()
+		{
+			++*destroyed;
+		}
+
+		std::string name;
+		unsigned* destroyed;
+	};
+
+	struct Large : public Event<Large>
+	{
+		char data[100 * 1024];
+	};
+
+	struct Latest : public Event<Latest>
+	{
+		static constexpr bool IsCoalesced = true;
+
+		Latest(int _value)
+			: value(_value)
+		{
+		}
+
+		int value;
+	};
+
+	struct Early : public Event<Early> {};
+	struct Late : public Event<Late> {};
+}
+
+TEST_CASE("EventQueue")
+{
+	SECTION("Order")
+	{
+		std::vector<unsigned> received;
+		Listener<Numbered> listener([&](const Numbered& e) { received.push_back(e.index); });
+
+		for (unsigned i = 0; i < 5; ++i)
+		{
+			EventQueue.Push<Numbered>(0u, i);
+		}
+
+		CHECK(received.empty());
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<unsigned>{ 0, 1, 2, 3, 4 });
+
+		// Nothing is left over.
+		EventQueue.Dispatch();
+		CHECK(received.size() == 5);
+	}
+
+	SECTION("Type Order")
+	{
+		std::string received;
+		Listener<Early> earlyListener([&](const Early&) { received += 'E'; });
+		Listener<Late> lateListener([&](const Late&) { received += 'L'; });
+
+		EventQueue.Push<Early>();
+		EventQueue.Push<Late>();
+		EventQueue.Dispatch();
+		CHECK(received == "EL");
+
+		// Types are distributed in the order they were first pushed.
+		received.clear();
+		EventQueue.Push<Late>();
+		EventQueue.Push<Early>();
+		EventQueue.Dispatch();
+		CHECK(received == "EL");
+	}
+
+	SECTION("Destruction")
+	{
+		unsigned destroyed = 0;
+		std::string names;
+		Listener<Named> listener([&](const Named& e) { names += e.name; });
+
+		EventQueue.Push<Named>("Hello, ", &destroyed);
+		EventQueue.Push<Named>("a string too long for the small string optimization.", &destroyed);
+		EventQueue.Dispatch();
+
+		CHECK(names == "Hello, a string too long for the small string optimization.");
+		CHECK(destroyed == 2);
+	}
+
+	SECTION("Push During Dispatch")
+	{
+		std::vector<unsigned> received;
+		Listener<Numbered> listener([&](const Numbered& e) {
+			received.push_back(e.index);
+			if (e.index < 3)
+			{
+				EventQueue.Push<Numbered>(0u, e.index + 1);
+			}
+		});
+
+		// Each event queues the next one, which waits for the following call.
+		EventQueue.Push<Numbered>(0u, 0u);
+		for (unsigned i = 1; i <= 4; ++i)
+		{
+			EventQueue.Dispatch();
+			CHECK(received.size() == i);
+		}
+
+		CHECK(received == std::vector<unsigned>{ 0, 1, 2, 3 });
+	}
+
+	SECTION("Growth")
+	{
+		// Events larger than a block, and frames larger than the arena, are still stored.
+		unsigned count = 0;
+		Listener<Large> listener([&](const Large&) { ++count; });
+
+		for (unsigned frame = 0; frame < 3; ++frame)
+		{
+			for (unsigned i = 0; i < 20; ++i)
+			{
+				EventQueue.Push<Large>();
+			}
+
+			EventQueue.Dispatch();
+		}
+
+		CHECK(count == 60);
+	}
+
+	SECTION("Coalescing")
+	{
+		std::vector<int> received;
+		Listener<Latest> listener([&](const Latest& e) { received.push_back(e.value); });
+
+		for (int i = 0; i < 10; ++i)
+		{
+			EventQueue.Push<Latest>(i);
+		}
+
+		EventQueue.Dispatch();
+		CHECK(received == std::vector<int>{ 9 });
+
+		EventQueue.Dispatch();
+		CHECK(received.size() == 1);
+	}
+
+	SECTION("Listeners")
+	{
+		// Each listener receives all of the events before the next listener.
+		std::string order;
+		Listener<Numbered> first([&](const Numbered& e) { order += 'a' + static_cast<char>(e.index); });
+		Listener<Numbered> second([&](const Numbered& e) { order += 'A' + static_cast<char>(e.index); });
+		Listener<Numbered> empty;
+
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			EventQueue.Push<Numbered>(0u, i);
+		}
+
+		EventQueue.Dispatch();
+		CHECK(order == "abcABC");
+
+		// Events can still be distributed immediately.
+		order.clear();
+		EventQueue.Dispatch(Numbered(0, 25));
+		CHECK(order == "zZ");
+	}
+
+	SECTION("Stress")
+	{
+		constexpr unsigned NUM_THREADS = 8;
+		constexpr unsigned NUM_EVENTS = 50000;
+
+		// Events from each thread must arrive in the order that thread pushed them.
+		std::vector<unsigned> nextIndex(NUM_THREADS, 0);
+		unsigned numOutOfOrder = 0;
+		unsigned numReceived = 0;
+		Listener<Numbered> listener([&](const Numbered& e) {
+			if (e.index != nextIndex[e.thread])
+			{
+				++numOutOfOrder;
+			}
+
+			nextIndex[e.thread] = e.index + 1;
+			++numReceived;
+		});
+
+		std::atomic<unsigned> numFinished = 0;
+		std::vector<std::thread> threads;
+		for (unsigned t = 0; t < NUM_THREADS; ++t)
+		{
+			threads.emplace_back([t, &numFinished] {
+				for (unsigned i = 0; i < NUM_EVENTS; ++i)
+				{
+					EventQueue.Push<Numbered>(t, i);
+				}
+
+				++numFinished;
+			});
+		}
+
+		// The main thread dispatches while the others are still pushing.
+		while (numFinished < NUM_THREADS)
+		{
+			EventQueue.Dispatch();
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		EventQueue.Dispatch();
+
+		CHECK(numReceived == NUM_THREADS * NUM_EVENTS);
+		CHECK(numOutOfOrder == 0);
+	}
+}
+
+TEST_CASE("EventQueue Benchmark", "[!benchmark]")
+{
+	unsigned count = 0;
+	Listener<Numbered> listener([&](const Numbered&) { ++count; });
+
+	BENCHMARK("Push and Dispatch 10000 Events")
+	{
+		for (unsigned i = 0; i < 10000; ++i)
+		{
+			EventQueue.Push<Numbered>(0u, i);
+		}
+
+		EventQueue.Dispatch();
+	}
+
+	BENCHMARK("Push and Dispatch 10000 Coalesced Events")
+	{
+		for (int i = 0; i < 10000; ++i)
+		{
+			EventQueue.Push<Latest>(i);
+		}
+
+		EventQueue.Dispatch();
+	}
+}
@@ -31,4 +31,83 @@ TEST_CASE("FileSystem")
 
 		CHECK(ExtractFileExtension("C:/user/test5.txt.zip") == ".zip");
 	}
+	SECTION("FileView")
+	{
+		const char* file = "FileViewTest.bin";
+		const char contents[] = "0123456789";
+
+		FILE* output = fopen(file, "wb");
+		REQUIRE(output != nullptr);
+		fwrite(contents, 1, 10, output);
+		fclose(output);
+
+		FileView view;
+		CHECK_FALSE(view.IsOpen());
+		CHECK_FALSE(view.Open("FileViewTest.missing"));
+
+		REQUIRE(view.Open(file));
+		CHECK(view.IsOpen());
+		REQUIRE(view.GetSize() == 10);
+		CHECK(memcmp(view.GetData(), contents, 10) == 0);
+
+		// Sub-views keep the mapping alive after the original is closed.
+		FileView subView = view.GetSubView(2, 3);
+		view.Close();
+		CHECK_FALSE(view.IsOpen());
+		REQUIRE(subView.IsOpen());
+		CHECK(subView.GetSize() == 3);
+		CHECK(memcmp(subView.GetData(), "234", 3) == 0);
+
+		CHECK(subView.GetSubView(0, 3).IsOpen());
+		CHECK_FALSE(subView.GetSubView(1, 3).IsOpen());
+		CHECK_FALSE(subView.GetSubView(4, 0).IsOpen());
+
+		subView.Close();
+		CHECK(RemoveFile(file));
+	}
+	SECTION("Overwriting Mapped Files")
+	{
+		const auto writeFile = [](const char* file, const char* contents) {
+			FILE* output = fopen(file, "wb");
+			REQUIRE(output != nullptr);
+			fwrite(contents, 1, 10, output);
+			fclose(output);
+		};
+
+		// Mirrors a streamed texture, which keeps its levels mapped while the encoder replaces the file.
+		const char* file = "OverwriteTest.texture";
+		writeFile(file, "0123456789");
+
+		FileView view;
+		REQUIRE(view.Open(file));
+		FileView levels = view.GetSubView(4, 6);
+		view.Close();
+
+		writeFile("OverwriteTest.tmp", "abcdefghij");
+		REQUIRE(OverwriteFile(file, "OverwriteTest.tmp"));
+		CHECK_FALSE(FileExists("OverwriteTest.tmp"));
+
+		// The old contents remain readable until the view is released.
+		REQUIRE(levels.GetSize() == 6);
+		CHECK(memcmp(levels.GetData(), "456789", 6) == 0);
+
+		FileView newView;
+		REQUIRE(newView.Open(file));
+		REQUIRE(newView.GetSize() == 10);
+		CHECK(memcmp(newView.GetData(), "abcdefghij", 10) == 0);
+		newView.Close();
+
+		// Once released, the old file is cleaned up by the next overwrite.
+		levels.Close();
+		writeFile("OverwriteTest.tmp", "ABCDEFGHIJ");
+		REQUIRE(OverwriteFile(file, "OverwriteTest.tmp"));
+		CHECK_FALSE(FileExists("OverwriteTest.texture.old0"));
+		CHECK_FALSE(FileExists("OverwriteTest.texture.old1"));
+
+		REQUIRE(newView.Open(file));
+		CHECK(memcmp(newView.GetData(), "ABCDEFGHIJ", 10) == 0);
+		newView.Close();
+
+		CHECK(RemoveFile(file));
+	}
 }
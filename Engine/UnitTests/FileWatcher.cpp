@@ -0,0 +1,64 @@
+#include <catch.hpp>
+#include <Jewel3D/Application/FileWatcher.h>
+
+using namespace Jwl;
+
+TEST_CASE("ChangeCoalescer")
+{
+	ChangeCoalescer changes;
+	std::vector<std::string> files;
+
+	SECTION("Waits For Files To Settle")
+	{
+		changes.Add("a.texture", 0.0);
+
+		changes.Collect(50.0, 100.0, files);
+		CHECK(files.empty());
+		CHECK(!changes.IsEmpty());
+
+		changes.Collect(100.0, 100.0, files);
+		REQUIRE(files.size() == 1);
+		CHECK(files[0] == "a.texture");
+		CHECK(changes.IsEmpty());
+	}
+
+	SECTION("Bursts Are Merged")
+	{
+		// An editor saving the file in several steps.
+		changes.Add("a.shader", 0.0);
+		changes.Add("a.shader", 20.0);
+		changes.Add("a.shader", 90.0);
+
+		// The quiet period restarts with each change.
+		changes.Collect(150.0, 100.0, files);
+		CHECK(files.empty());
+
+		changes.Collect(190.0, 100.0, files);
+		REQUIRE(files.size() == 1);
+		CHECK(files[0] == "a.shader");
+
+		// Once reported, a new change is tracked again.
+		changes.Add("a.shader", 200.0);
+		changes.Collect(300.0, 100.0, files);
+		CHECK(files.size() == 2);
+	}
+
+	SECTION("Reported In Order")
+	{
+		changes.Add("a", 0.0);
+		changes.Add("b", 10.0);
+		changes.Add("c", 20.0);
+		changes.Add("a", 30.0);
+
+		// 'b' and 'c' have settled, but 'a' changed again.
+		changes.Collect(125.0, 100.0, files);
+		REQUIRE(files.size() == 2);
+		CHECK(files[0] == "b");
+		CHECK(files[1] == "c");
+
+		changes.Collect(130.0, 100.0, files);
+		REQUIRE(files.size() == 3);
+		CHECK(files[2] == "a");
+		CHECK(changes.IsEmpty());
+	}
+}
@@ -0,0 +1,98 @@
+#include <catch.hpp>
+#include <Jewel3D/Utilities/Container.h>
+
+using namespace Jwl;
+
+namespace
+{
+	// Forces every key into the same probe sequence.
+	struct CollidingHash
+	{
+		size_t operator()(int) const { return 7; }
+	};
+}
+
+TEST_CASE("FlatHashMap")
+{
+	SECTION("Insert and Find")
+	{
+		FlatHashMap<std::string, int> map;
+		CHECK(map.IsEmpty());
+		CHECK(map.Find("missing") == nullptr);
+
+		auto [value, isNew] = map.Insert("one");
+		REQUIRE(value != nullptr);
+		CHECK(isNew);
+		CHECK(*value == 0);
+		*value = 1;
+
+		auto [existing, isNewAgain] = map.Insert("one");
+		CHECK_FALSE(isNewAgain);
+		CHECK(*existing == 1);
+		CHECK(map.Count() == 1);
+
+		map.Clear();
+		CHECK(map.IsEmpty());
+		CHECK(map.Find("one") == nullptr);
+	}
+
+	SECTION("Growth")
+	{
+		FlatHashMap<int, int> map;
+		for (int i = 0; i < 1000; ++i)
+		{
+			*map.Insert(i).first = i * 2;
+		}
+
+		CHECK(map.Count() == 1000);
+
+		bool allFound = true;
+		for (int i = 0; i < 1000; ++i)
+		{
+			const int* value = map.Find(i);
+			allFound = allFound && value != nullptr && *value == i * 2;
+		}
+
+		CHECK(allFound);
+		CHECK(map.Find(1000) == nullptr);
+	}
+
+	SECTION("Collisions")
+	{
+		FlatHashMap<int, int, CollidingHash> map;
+		for (int i = 0; i < 20; ++i)
+		{
+			*map.Insert(i).first = i;
+		}
+
+		CHECK(map.Count() == 20);
+		for (int i = 0; i < 20; ++i)
+		{
+			REQUIRE(map.Find(i) != nullptr);
+			CHECK(*map.Find(i) == i);
+		}
+
+		CHECK(map.Find(20) == nullptr);
+	}
+
+	SECTION("ForEach")
+	{
+		FlatHashMap<int, int> map;
+		for (int i = 0; i < 50; ++i)
+		{
+			*map.Insert(i).first = i * 2;
+		}
+
+		int visited = 0;
+		bool allMatch = true;
+		map.ForEach([&](int key, int& value) {
+			allMatch = allMatch && value == key * 2;
+			value = key;
+			++visited;
+		});
+
+		CHECK(visited == 50);
+		CHECK(allMatch);
+		CHECK(*map.Find(7) == 7);
+	}
+}
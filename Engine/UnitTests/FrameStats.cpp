@@ -0,0 +1,149 @@
+#include <catch.hpp>
+#include <Jewel3D/Application/FrameStats.h>
+#include <Jewel3D/Entity/Entity.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Jwl;
+
+namespace
+{
+	class Counted : public Component<Counted>
+	{
+	public:
+		Counted(Entity& owner) : Component(owner) {}
+	};
+
+	class CountedTag : public Tag<CountedTag> {};
+}
+
+TEST_CASE("FrameStats")
+{
+	// Start from an empty frame.
+	FrameStats.EndFrame();
+
+	SECTION("Counters")
+	{
+		FrameStats.CountDrawCall(12);
+		FrameStats.CountDrawCall(2);
+		FrameStats.CountShaderBind();
+		FrameStats.CountTextureBind();
+		FrameStats.CountTextureBind();
+		FrameStats.CountUniformBufferBind();
+		FrameStats.CountUpload(64);
+		FrameStats.CountUpload(16);
+		FrameStats.CountShaderVariantCompiled();
+
+		CHECK(FrameStats.GetCurrentCounters().drawCalls == 2);
+
+		const uint64_t frame = FrameStats.GetLastFrame().frame;
+		FrameStats.EndFrame();
+
+		const FrameReport& report = FrameStats.GetLastFrame();
+		CHECK(report.frame == frame + 1);
+		CHECK(report.counters.drawCalls == 2);
+		CHECK(report.counters.primitives == 14);
+		CHECK(report.counters.shaderBinds == 1);
+		CHECK(report.counters.textureBinds == 2);
+		CHECK(report.counters.uniformBufferBinds == 1);
+		CHECK(report.counters.bytesUploaded == 80);
+		CHECK(report.counters.shaderVariantsCompiled == 1);
+
+		// The counters start over for the next frame.
+		CHECK(FrameStats.GetCurrentCounters().drawCalls == 0);
+		FrameStats.EndFrame();
+		CHECK(FrameStats.GetLastFrame().counters.drawCalls == 0);
+		CHECK(FrameStats.GetLastFrame().counters.bytesUploaded == 0);
+	}
+
+	SECTION("Index Tables")
+	{
+		auto first = Entity::MakeNew();
+		auto second = Entity::MakeNew();
+		first->Add<Counted>();
+		second->Add<Counted>();
+		second->Tag<CountedTag>();
+
+		FrameStats.EndFrame();
+
+		const auto& tables = FrameStats.GetLastFrame().indexTables;
+		REQUIRE(tables.size() == ComponentBase::GetNumIDs() + 1);
+
+		const IndexTableStats& counted = tables[Counted::GetComponentId()];
+		CHECK(counted.componentId == Counted::GetComponentId());
+		CHECK(counted.typeName.ends_with("::Counted"));
+		CHECK(counted.typeName == ComponentBase::GetTypeName(Counted::GetComponentId()));
+		CHECK(counted.entities == 2);
+		CHECK(counted.components == 2);
+
+		const IndexTableStats& tag = tables[CountedTag::GetComponentId()];
+		CHECK(tag.entities == 1);
+		CHECK(tag.components == 0);
+
+		// Disabled components are not indexed.
+		first->Disable<Counted>();
+		FrameStats.EndFrame();
+		CHECK(FrameStats.GetLastFrame().indexTables[Counted::GetComponentId()].entities == 1);
+	}
+
+	SECTION("Caches")
+	{
+		const auto& caches = FrameStats.GetLastFrame().caches;
+		REQUIRE(caches.size() == 6);
+		CHECK(caches[0].type == "Model");
+		CHECK(caches[1].type == "Texture");
+	}
+
+	SECTION("CSV")
+	{
+		REQUIRE(FrameStats.OpenCSV("FrameStatsTest.csv"));
+		CHECK(FrameStats.IsWritingCSV());
+
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			FrameStats.CountDrawCall(i);
+			FrameStats.EndFrame();
+		}
+
+		FrameStats.CloseCSV();
+		CHECK(!FrameStats.IsWritingCSV());
+
+		// Frames are not written once the file is closed.
+		FrameStats.EndFrame();
+
+		std::ifstream file("FrameStatsTest.csv");
+		REQUIRE(file);
+
+		std::vector<std::string> lines;
+		for (std::string line; std::getline(file, line);)
+		{
+			lines.push_back(line);
+		}
+
+		file.close();
+		std::remove("FrameStatsTest.csv");
+
+		REQUIRE(lines.size() == 4);
+		CHECK(lines[0].find("Frame,Frame MS,Draw Calls,Primitives,") == 0);
+		CHECK(lines[0].find(",Model Count,Model CPU Bytes,Model GPU Bytes,") != std::string::npos);
+
+		// Index tables are named after their type rather than their Id, which can change between builds.
+		const std::string countedName(ComponentBase::GetTypeName(Counted::GetComponentId()));
+		CHECK(lines[0].find(",\"Entities " + countedName + "\",\"Components " + countedName + '"') != std::string::npos);
+
+		// Every row has a value for each column.
+		const auto numColumns = std::count(lines[0].begin(), lines[0].end(), ',');
+		for (unsigned i = 1; i < lines.size(); ++i)
+		{
+			CHECK(std::count(lines[i].begin(), lines[i].end(), ',') == numColumns);
+		}
+
+		// The draw call count is the third column.
+		const std::string lastRow = lines[3].substr(lines[3].find(',', lines[3].find(',') + 1) + 1);
+		CHECK(lastRow.find("1,2,") == 0);
+	}
+}
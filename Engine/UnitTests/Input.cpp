@@ -0,0 +1,57 @@
+#include <catch.hpp>
+#include <Jewel3D/Input/Input.h>
+
+#include <Windows.h>
+#include <vector>
+
+using namespace Jwl;
+
+namespace
+{
+	MSG MouseMessage(int x, int y)
+	{
+		MSG msg = {};
+		msg.message = WM_MOUSEMOVE;
+		msg.lParam = MAKELPARAM(x, y);
+
+		return msg;
+	}
+}
+
+TEST_CASE("Input")
+{
+	// Start with nothing queued.
+	Input.BeginDispatch();
+	EventQueue.Dispatch();
+
+	SECTION("Mouse Movement Between Dispatches")
+	{
+		std::vector<vec2> deltas;
+		Listener<MouseMoved> listener([&](const MouseMoved& e) { deltas.push_back(e.delta); });
+
+		const vec2 start = Input.GetMousePos();
+
+		// Messages are usually pumped several times before each dispatch, since dispatches only happen on fixed update steps.
+		// First pump.
+		Input.Update(MouseMessage(10, 20));
+		// Second pump.
+		Input.Update(MouseMessage(15, 25));
+		Input.Update(MouseMessage(40, 30));
+		const vec2 end = Input.GetMousePos();
+
+		Input.BeginDispatch();
+		EventQueue.Dispatch();
+
+		// Only the last movement is distributed, but its delta covers all of them.
+		REQUIRE(deltas.size() == 1);
+		CHECK(deltas[0] == end - start);
+
+		// The next delta starts from where the last dispatch left off.
+		Input.Update(MouseMessage(45, 20));
+		Input.BeginDispatch();
+		EventQueue.Dispatch();
+
+		REQUIRE(deltas.size() == 2);
+		CHECK(deltas[1] == Input.GetMousePos() - end);
+	}
+}
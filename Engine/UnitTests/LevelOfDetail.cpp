@@ -0,0 +1,50 @@
+#include <catch.hpp>
+#include <Jewel3D/Rendering/Mesh.h>
+
+using namespace Jwl;
+
+TEST_CASE("Level of Detail")
+{
+	std::vector<Model::Lod> lods(4);
+	lods[1].error = 0.01f;
+	lods[2].error = 0.04f;
+	lods[3].error = 0.2f;
+
+	const float threshold = 0.002f;
+	const float hysteresis = 0.25f;
+
+	SECTION("No Levels")
+	{
+		CHECK(SelectLod({}, 0.5f, 1.0f, 0, threshold, hysteresis) == 0);
+	}
+
+	SECTION("Selection")
+	{
+		// Up close, only the full-detail model is accurate enough.
+		CHECK(SelectLod(lods, 2.0f, 1.0f, 0, threshold, hysteresis) == 0);
+
+		// Far away, even the coarsest level is accurate enough.
+		CHECK(SelectLod(lods, 0.001f, 1.0f, 0, threshold, hysteresis) == 3);
+
+		// Large bounds make the same error less significant.
+		CHECK(SelectLod(lods, 0.1f, 1.0f, 0, threshold, hysteresis) == 1);
+		CHECK(SelectLod(lods, 0.1f, 4.0f, 0, threshold, hysteresis) == 2);
+
+		// Out of range levels are clamped.
+		CHECK(SelectLod(lods, 2.0f, 1.0f, 10, threshold, hysteresis) == 0);
+		CHECK(SelectLod(lods, 0.001f, 1.0f, 10, threshold, hysteresis) == 3);
+	}
+
+	SECTION("Hysteresis")
+	{
+		// Level 1 is exactly at the threshold when covering 20% of the screen.
+		// Switching to it requires a margin, but switching back only happens once it exceeds the threshold.
+		CHECK(SelectLod(lods, 0.19f, 1.0f, 0, threshold, hysteresis) == 0);
+		CHECK(SelectLod(lods, 0.14f, 1.0f, 0, threshold, hysteresis) == 1);
+		CHECK(SelectLod(lods, 0.19f, 1.0f, 1, threshold, hysteresis) == 1);
+		CHECK(SelectLod(lods, 0.21f, 1.0f, 1, threshold, hysteresis) == 0);
+
+		// Without hysteresis, the switch happens at the same point in both directions.
+		CHECK(SelectLod(lods, 0.19f, 1.0f, 0, threshold, 0.0f) == 1);
+	}
+}
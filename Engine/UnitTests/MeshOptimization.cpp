@@ -0,0 +1,180 @@
+#include <catch.hpp>
+#include <Jewel3D/Utilities/MeshOptimization.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace Jwl;
+
+namespace
+{
+	struct Vertex
+	{
+		float x, y, z;
+	};
+
+	// A triangle soup of a grid of quads, with the triangles in a random order.
+	std::vector<unsigned char> MakeShuffledGrid(unsigned size)
+	{
+		std::vector<Vertex> triangles;
+		for (unsigned y = 0; y < size; ++y)
+		{
+			for (unsigned x = 0; x < size; ++x)
+			{
+				const Vertex v0 = { float(x),     float(y),     0.0f };
+				const Vertex v1 = { float(x + 1), float(y),     0.0f };
+				const Vertex v2 = { float(x),     float(y + 1), 0.0f };
+				const Vertex v3 = { float(x + 1), float(y + 1), 0.0f };
+
+				triangles.insert(triangles.end(), { v0, v1, v2 });
+				triangles.insert(triangles.end(), { v2, v1, v3 });
+			}
+		}
+
+		std::vector<std::array<Vertex, 3>> shuffled(triangles.size() / 3);
+		memcpy(shuffled.data(), triangles.data(), triangles.size() * sizeof(Vertex));
+		std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+		std::vector<unsigned char> bytes(triangles.size() * sizeof(Vertex));
+		memcpy(bytes.data(), shuffled.data(), bytes.size());
+
+		return bytes;
+	}
+
+	bool SameTriangles(std::vector<unsigned char> verticesA, std::vector<unsigned> indicesA, std::vector<unsigned char> verticesB, std::vector<unsigned> indicesB)
+	{
+		auto expand = [](const std::vector<unsigned char>& vertices, const std::vector<unsigned>& indices) {
+			std::vector<std::array<float, 9>> triangles(indices.size() / 3);
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				memcpy(&triangles[i / 3][(i % 3) * 3], vertices.data() + indices[i] * sizeof(Vertex), sizeof(Vertex));
+			}
+
+			std::sort(triangles.begin(), triangles.end());
+			return triangles;
+		};
+
+		return expand(verticesA, indicesA) == expand(verticesB, indicesB);
+	}
+}
+
+TEST_CASE("MeshOptimization")
+{
+	SECTION("Welding")
+	{
+		auto vertices = MakeShuffledGrid(4);
+		const auto original = vertices;
+
+		std::vector<unsigned> indices;
+		WeldVertices(vertices, sizeof(Vertex), indices);
+
+		CHECK(indices.size() == 4 * 4 * 6);
+		CHECK(vertices.size() == 5 * 5 * sizeof(Vertex));
+
+		// Every index reproduces the original vertex.
+		bool matches = true;
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			matches &= memcmp(vertices.data() + indices[i] * sizeof(Vertex), original.data() + i * sizeof(Vertex), sizeof(Vertex)) == 0;
+		}
+		CHECK(matches);
+	}
+
+	SECTION("Vertex Cache")
+	{
+		auto vertices = MakeShuffledGrid(64);
+
+		std::vector<unsigned> indices;
+		WeldVertices(vertices, sizeof(Vertex), indices);
+
+		const auto weldedVertices = vertices;
+		const auto weldedIndices = indices;
+		const unsigned numVertices = static_cast<unsigned>(vertices.size() / sizeof(Vertex));
+
+		const float before = ComputeACMR(indices, numVertices);
+		OptimizeVertexCache(indices, numVertices);
+		const float after = ComputeACMR(indices, numVertices);
+
+		WARN("ACMR before: " << before << ", after: " << after);
+		CHECK(after < before);
+		CHECK(after < 0.8f);
+
+		// Reordering vertices for fetching doesn't affect the cache.
+		OptimizeVertexFetch(vertices, sizeof(Vertex), indices);
+		CHECK(ComputeACMR(indices, numVertices) == Approx(after));
+
+		// Indices are first referenced in increasing order.
+		bool ordered = true;
+		unsigned highest = 0;
+		for (unsigned index : indices)
+		{
+			ordered &= index <= highest;
+			highest = std::max(highest, index + 1);
+		}
+		CHECK(ordered);
+
+		CHECK(SameTriangles(weldedVertices, weldedIndices, vertices, indices));
+	}
+
+	SECTION("Simplify")
+	{
+		auto vertices = MakeShuffledGrid(32);
+
+		std::vector<unsigned> indices;
+		WeldVertices(vertices, sizeof(Vertex), indices);
+
+		std::vector<vec3> positions(vertices.size() / sizeof(Vertex));
+		memcpy(positions.data(), vertices.data(), vertices.size());
+
+		// A flat grid can lose most of its interior without changing shape.
+		std::vector<unsigned> simplified;
+		const float flatError = SimplifyMesh(indices, positions, static_cast<unsigned>(indices.size() / 4), simplified);
+
+		CHECK(simplified.size() % 3 == 0);
+		CHECK(simplified.size() <= indices.size() / 4);
+		CHECK(flatError == Approx(0.0f).margin(0.0001f));
+
+		// Triangles keep facing the same way, and the border is preserved.
+		bool facingUp = true;
+		float area = 0.0f;
+		for (size_t i = 0; i < simplified.size(); i += 3)
+		{
+			const vec3 normal = Cross(positions[simplified[i + 1]] - positions[simplified[i]], positions[simplified[i + 2]] - positions[simplified[i]]);
+			facingUp &= normal.z > 0.0f;
+			area += normal.z * 0.5f;
+		}
+		CHECK(facingUp);
+		CHECK(area == Approx(32.0f * 32.0f));
+
+		// Bending the grid into a curve means that simplifying further costs more accuracy.
+		for (auto& position : positions)
+		{
+			position.z = std::sin(position.x * 0.2f) * 4.0f;
+		}
+
+		std::vector<unsigned> half;
+		std::vector<unsigned> quarter;
+		const float halfError = SimplifyMesh(indices, positions, static_cast<unsigned>(indices.size() / 2), half);
+		const float quarterError = SimplifyMesh(indices, positions, static_cast<unsigned>(indices.size() / 4), quarter);
+
+		CHECK(half.size() <= indices.size() / 2);
+		CHECK(quarter.size() <= indices.size() / 4);
+		CHECK(halfError > 0.0f);
+		CHECK(quarterError >= halfError);
+		CHECK(quarterError < 1.0f);
+	}
+
+	SECTION("ACMR")
+	{
+		// No reuse.
+		CHECK(ComputeACMR({ 0, 1, 2, 3, 4, 5 }, 6) == Approx(3.0f));
+
+		// Two triangles sharing an edge.
+		CHECK(ComputeACMR({ 0, 1, 2, 2, 1, 3 }, 4) == Approx(2.0f));
+
+		CHECK(ComputeACMR({}, 0) == 0.0f);
+	}
+}
@@ -0,0 +1,144 @@
+#include <catch.hpp>
+#include <Jewel3D/Network/MessageBuffer.h>
+
+#include <algorithm>
+
+using namespace Jwl;
+
+namespace
+{
+	// Moves the bytes from one buffer to another in pieces, like recv() might.
+	void Transfer(MessageBuffer& src, MessageBuffer& dest, unsigned pieceSize)
+	{
+		while (!src.IsEmpty())
+		{
+			unsigned space = 0;
+			char* data = dest.Reserve(pieceSize, space);
+
+			std::string_view bytes = src.Peek();
+			const unsigned count = std::min({ space, pieceSize, static_cast<unsigned>(bytes.size()) });
+
+			memcpy(data, bytes.data(), count);
+			dest.Commit(count);
+			src.Consume(count);
+		}
+	}
+}
+
+TEST_CASE("MessageBuffer")
+{
+	MessageBuffer buffer(64);
+	std::string_view message;
+
+	SECTION("Framing")
+	{
+		buffer.WriteMessage("Hello");
+		buffer.WriteMessage("");
+		buffer.WriteMessage("World");
+		CHECK(buffer.GetSize() == 3 * MessageBuffer::HEADER_SIZE + 10);
+
+		REQUIRE(buffer.ReadMessage(message));
+		CHECK(message == "Hello");
+		REQUIRE(buffer.ReadMessage(message));
+		CHECK(message.empty());
+		REQUIRE(buffer.ReadMessage(message));
+		CHECK(message == "World");
+
+		CHECK(!buffer.ReadMessage(message));
+		CHECK(buffer.IsEmpty());
+	}
+
+	SECTION("Binary Data")
+	{
+		const std::string binary("\0\xFF\0\n\0", 5);
+		buffer.WriteMessage(binary);
+
+		REQUIRE(buffer.ReadMessage(message));
+		CHECK(message.size() == 5);
+		CHECK(message == binary);
+	}
+
+	SECTION("Partial Messages")
+	{
+		MessageBuffer stream;
+		stream.WriteMessage("Message One");
+		stream.WriteMessage("Message Two");
+
+		// Nothing can be read until a whole message has arrived.
+		unsigned space = 0;
+		char* data = buffer.Reserve(1, space);
+		REQUIRE(space >= 6);
+
+		memcpy(data, stream.Peek().data(), 6);
+		buffer.Commit(6);
+		stream.Consume(6);
+		CHECK(!buffer.ReadMessage(message));
+
+		Transfer(stream, buffer, 3);
+		REQUIRE(buffer.ReadMessage(message));
+		CHECK(message == "Message One");
+		REQUIRE(buffer.ReadMessage(message));
+		CHECK(message == "Message Two");
+		CHECK(buffer.IsEmpty());
+	}
+
+	SECTION("Wrapping")
+	{
+		// Messages of varying sizes are repeatedly written and read, so they end up crossing the end of the buffer.
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			const std::string first(i % 23, static_cast<char>('a' + i % 26));
+			const std::string second(i % 17, static_cast<char>('A' + i % 26));
+
+			buffer.WriteMessage(first);
+			buffer.WriteMessage(second);
+
+			REQUIRE(buffer.ReadMessage(message));
+			CHECK(message == first);
+			REQUIRE(buffer.ReadMessage(message));
+			CHECK(message == second);
+		}
+
+		// The buffer never needed to grow.
+		CHECK(buffer.GetCapacity() == 64);
+	}
+
+	SECTION("Growing")
+	{
+		std::string large(1000, '\0');
+		for (unsigned i = 0; i < large.size(); ++i)
+		{
+			large[i] = static_cast<char>(i);
+		}
+
+		buffer.WriteMessage("Small");
+		buffer.WriteMessage(large);
+		CHECK(buffer.GetCapacity() >= 1000);
+
+		MessageBuffer stream(64);
+		Transfer(buffer, stream, 100);
+
+		REQUIRE(stream.ReadMessage(message));
+		CHECK(message == "Small");
+		REQUIRE(stream.ReadMessage(message));
+		CHECK(message == large);
+	}
+
+	SECTION("Oversized Messages")
+	{
+		buffer.WriteMessage("Valid");
+
+		// A length prefix beyond the limit can never be read, no matter how much data follows.
+		unsigned space = 0;
+		char* data = buffer.Reserve(MessageBuffer::HEADER_SIZE, space);
+		memset(data, 0xFF, MessageBuffer::HEADER_SIZE);
+		buffer.Commit(MessageBuffer::HEADER_SIZE);
+
+		CHECK(!buffer.HasInvalidMessage());
+		REQUIRE(buffer.ReadMessage(message));
+		CHECK(message == "Valid");
+
+		CHECK(buffer.HasInvalidMessage());
+		CHECK(!buffer.ReadMessage(message));
+	}
+}
@@ -0,0 +1,389 @@
+#include <catch.hpp>
+#include <Jewel3D/Network/Network.h>
+
+#include <set>
+#include <unordered_map>
+
+using namespace Jwl;
+
+namespace
+{
+	constexpr int SERVER_PORT_TCP = 50000;
+	constexpr int SERVER_PORT_UDP = 50001;
+	constexpr unsigned NUM_CLIENTS = 1000;
+
+	// Connects the client to the server and returns its ID, or -1 on failure.
+	int Connect(NetworkServer& server, NetworkClient& client, unsigned index = 0)
+	{
+		if (!client.Init(52000 + index, 54000 + index, "127.0.0.1", SERVER_PORT_TCP, SERVER_PORT_UDP) ||
+			!client.SendConnectionRequest())
+		{
+			return -1;
+		}
+
+		int ID = -1;
+		for (unsigned attempts = 0; ID == -1 && attempts < 100; ++attempts)
+		{
+			server.Poll(10);
+			ID = server.CheckForConnectionRequests();
+		}
+
+		return ID;
+	}
+}
+
+TEST_CASE("NetworkServer")
+{
+	REQUIRE(InitWinSock());
+
+	NetworkServer server;
+	REQUIRE(server.Init(SERVER_PORT_TCP, SERVER_PORT_UDP));
+	REQUIRE(server.OpenToConnectionRequests());
+
+	SECTION("No Activity")
+	{
+		CHECK(server.Poll());
+		CHECK(server.CheckForConnectionRequests() == -1);
+		CHECK(server.CheckForDisconnections() == -1);
+
+		std::string packet;
+		CHECK(server.ReceiveTCP(packet) == -1);
+		CHECK(server.GetNumClients() == 0);
+	}
+
+	SECTION("Message Framing")
+	{
+		NetworkClient client;
+		const int ID = Connect(server, client);
+		REQUIRE(ID != -1);
+
+		const std::string binary("\0\1\2\0\3", 5);
+		std::string large(100000, '\0');
+		for (unsigned i = 0; i < large.size(); ++i)
+		{
+			large[i] = static_cast<char>(i * 31);
+		}
+
+		// Messages keep their boundaries, even when they arrive together or in pieces.
+		REQUIRE(client.SendTCP("First"));
+		REQUIRE(client.SendTCP(binary));
+		REQUIRE(client.SendTCP(""));
+		REQUIRE(client.SendTCP(large));
+
+		std::vector<std::string> received;
+		for (unsigned attempts = 0; received.size() < 4 && attempts < 500; ++attempts)
+		{
+			client.FlushTCP();
+
+			std::string packet;
+			while (server.ReceiveTCP(packet) == ID)
+			{
+				received.push_back(packet);
+			}
+
+			server.Poll(10);
+		}
+
+		REQUIRE(received.size() == 4);
+		CHECK(received[0] == "First");
+		CHECK(received[1] == binary);
+		CHECK(received[2].empty());
+		CHECK(received[3] == large);
+
+		// And in the other direction.
+		REQUIRE(server.SendTCP(large, ID));
+
+		std::string_view packet;
+		bool isReceived = false;
+		for (unsigned attempts = 0; !isReceived && attempts < 500; ++attempts)
+		{
+			server.Poll(10);
+			isReceived = client.ReceiveTCP(packet);
+		}
+
+		REQUIRE(isReceived);
+		CHECK(packet == large);
+
+		client.Destroy();
+	}
+
+	SECTION("Datagrams")
+	{
+		// Both clients share an address, so they are told apart by their ports and tokens.
+		NetworkClient client1;
+		NetworkClient client2;
+		const int ID1 = Connect(server, client1, 0);
+		const int ID2 = Connect(server, client2, 1);
+		REQUIRE(ID1 != -1);
+		REQUIRE(ID2 != -1);
+
+		// Datagrams without a client's token are ignored.
+		NetworkUDP stranger;
+		REQUIRE(stranger.Init("127.0.0.1", SERVER_PORT_UDP));
+		REQUIRE(stranger.Send("Not a client"));
+
+		const std::string binary("\0\1\0\2", 4);
+		REQUIRE(client1.SendUDP("From 1"));
+		REQUIRE(client2.SendUDP("From 2"));
+		REQUIRE(client2.SendUDP(binary));
+
+		std::vector<std::pair<int, std::string>> received;
+		for (unsigned attempts = 0; received.size() < 3 && attempts < 100; ++attempts)
+		{
+			std::vector<NetworkMessage> messages;
+			server.ReceiveUDP(messages);
+			for (auto& message : messages)
+			{
+				received.emplace_back(message.clientID, message.data);
+			}
+
+			server.Poll(10);
+		}
+
+		REQUIRE(received.size() == 3);
+		CHECK(received[0] == std::make_pair(ID1, std::string("From 1")));
+		CHECK(received[1] == std::make_pair(ID2, std::string("From 2")));
+		CHECK(received[2] == std::make_pair(ID2, binary));
+
+		// Replies reach only the intended client.
+		REQUIRE(server.SendUDP("To 2", ID2));
+
+		std::string packet;
+		for (unsigned attempts = 0; packet.empty() && attempts < 100; ++attempts)
+		{
+			server.Poll(10);
+			client2.ReceiveUDP(packet);
+		}
+
+		CHECK(packet == "To 2");
+		CHECK(!client1.ReceiveUDP(packet));
+
+		// Clients are still identified after the ones before them are removed.
+		server.RemoveClient(ID1);
+		REQUIRE(client2.SendUDP("Still 2"));
+
+		received.clear();
+		for (unsigned attempts = 0; received.empty() && attempts < 100; ++attempts)
+		{
+			std::vector<NetworkMessage> messages;
+			server.ReceiveUDP(messages);
+			for (auto& message : messages)
+			{
+				received.emplace_back(message.clientID, message.data);
+			}
+
+			server.Poll(10);
+		}
+
+		REQUIRE(received.size() == 1);
+		CHECK(received[0] == std::make_pair(ID2, std::string("Still 2")));
+
+		stranger.Destroy();
+		client1.Destroy();
+		client2.Destroy();
+	}
+
+	SECTION("Many Clients")
+	{
+		std::vector<NetworkClient> clients(NUM_CLIENTS);
+		std::vector<int> IDs;
+
+		for (unsigned i = 0; i < NUM_CLIENTS; ++i)
+		{
+			REQUIRE(clients[i].Init(52000 + i, 54000 + i, "127.0.0.1", SERVER_PORT_TCP, SERVER_PORT_UDP));
+			REQUIRE(clients[i].SendConnectionRequest());
+
+			// Keep the backlog short.
+			int ID = server.CheckForConnectionRequests();
+			if (ID != -1)
+			{
+				IDs.push_back(ID);
+			}
+		}
+
+		for (unsigned attempts = 0; IDs.size() < NUM_CLIENTS && attempts < 500; ++attempts)
+		{
+			server.Poll(10);
+
+			int ID;
+			while ((ID = server.CheckForConnectionRequests()) != -1)
+			{
+				IDs.push_back(ID);
+			}
+		}
+
+		REQUIRE(IDs.size() == NUM_CLIENTS);
+		CHECK(server.GetNumClients() == NUM_CLIENTS);
+		CHECK(std::set<int>(IDs.begin(), IDs.end()).size() == NUM_CLIENTS);
+		for (int ID : IDs)
+		{
+			CHECK(server.IsConnected(ID));
+		}
+
+		// Every client's message is received, each from a different client.
+		for (unsigned i = 0; i < NUM_CLIENTS; ++i)
+		{
+			REQUIRE(clients[i].SendTCP("Message " + std::to_string(i)));
+		}
+
+		std::unordered_map<int, std::string> received;
+		std::set<std::string> contents;
+		unsigned numMessages = 0;
+		for (unsigned attempts = 0; numMessages < NUM_CLIENTS && attempts < 500; ++attempts)
+		{
+			server.Poll(10);
+
+			// The views are only valid until the next poll.
+			std::vector<NetworkMessage> messages;
+			numMessages += server.ReceiveTCP(messages);
+			for (auto& message : messages)
+			{
+				received[message.clientID] = message.data;
+				contents.emplace(message.data);
+			}
+		}
+
+		REQUIRE(numMessages == NUM_CLIENTS);
+		CHECK(received.size() == NUM_CLIENTS);
+		CHECK(contents.size() == NUM_CLIENTS);
+		CHECK(contents.count("Message 0") == 1);
+		CHECK(contents.count("Message 999") == 1);
+
+		// Closed connections are reported once and removed.
+		for (auto& client : clients)
+		{
+			client.Destroy();
+		}
+
+		std::vector<int> closed;
+		for (unsigned attempts = 0; closed.size() < NUM_CLIENTS && attempts < 500; ++attempts)
+		{
+			server.Poll(10);
+
+			int ID;
+			while ((ID = server.CheckForDisconnections()) != -1)
+			{
+				closed.push_back(ID);
+			}
+		}
+
+		CHECK(closed.size() == NUM_CLIENTS);
+		CHECK(server.GetNumClients() == 0);
+		for (int ID : IDs)
+		{
+			CHECK(!server.IsConnected(ID));
+		}
+	}
+
+	server.Destroy();
+	DestroyWinSock();
+}
+
+TEST_CASE("Network Benchmark", "[!benchmark]")
+{
+	REQUIRE(InitWinSock());
+
+	NetworkServer server;
+	REQUIRE(server.Init(SERVER_PORT_TCP, SERVER_PORT_UDP));
+	REQUIRE(server.OpenToConnectionRequests());
+
+	NetworkClient client;
+	REQUIRE(Connect(server, client) != -1);
+
+	// Sends 64MB over loopback, keeping a limited number of messages in flight.
+	auto transfer = [&](unsigned messageSize) {
+		const std::string message(messageSize, 'x');
+		const unsigned count = (64 * 1024 * 1024) / messageSize;
+
+		unsigned sent = 0;
+		unsigned received = 0;
+		std::vector<NetworkMessage> messages;
+		while (received < count)
+		{
+			while (sent < count && sent - received < 64)
+			{
+				client.SendTCP(message);
+				++sent;
+			}
+
+			client.FlushTCP();
+
+			messages.clear();
+			received += server.ReceiveTCP(messages);
+		}
+	};
+
+	BENCHMARK("Send 64MB as 1KB Messages")
+	{
+		transfer(1024);
+	}
+
+	BENCHMARK("Send 64MB as 64KB Messages")
+	{
+		transfer(64 * 1024);
+	}
+
+	client.Destroy();
+	server.Destroy();
+	DestroyWinSock();
+}
+
+TEST_CASE("Network Datagram Benchmark", "[!benchmark]")
+{
+	REQUIRE(InitWinSock());
+
+	NetworkServer server;
+	REQUIRE(server.Init(SERVER_PORT_TCP, SERVER_PORT_UDP));
+	REQUIRE(server.OpenToConnectionRequests());
+
+	constexpr unsigned NUM_PLAYERS = 64;
+	std::vector<NetworkClient> clients(NUM_PLAYERS);
+	for (unsigned i = 0; i < NUM_PLAYERS; ++i)
+	{
+		REQUIRE(Connect(server, clients[i], i) != -1);
+	}
+
+	// A typical snapshot or input packet. Divide the number of packets by the time taken to get the packets per second.
+	const std::string packet(200, 'x');
+
+	BENCHMARK("Receive 64K Datagrams from 64 Clients")
+	{
+		unsigned received = 0;
+		std::vector<NetworkMessage> messages;
+		for (unsigned round = 0; round < 1024; ++round)
+		{
+			for (auto& client : clients)
+			{
+				client.SendUDP(packet);
+			}
+
+			messages.clear();
+			received += server.ReceiveUDP(messages);
+		}
+
+		// Some datagrams might be dropped by the operating system under load.
+		CHECK(received > 0);
+	}
+
+	BENCHMARK("Broadcast 64K Datagrams to 64 Clients")
+	{
+		for (unsigned round = 0; round < 1024; ++round)
+		{
+			server.SendUDP(packet);
+
+			std::string ignored;
+			for (auto& client : clients)
+			{
+				client.ReceiveUDP(ignored);
+			}
+		}
+	}
+
+	for (auto& client : clients)
+	{
+		client.Destroy();
+	}
+
+	server.Destroy();
+	DestroyWinSock();
+}
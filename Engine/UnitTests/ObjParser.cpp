@@ -0,0 +1,246 @@
+#include <catch.hpp>
+#include <Jewel3D/Utilities/ObjParser.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace Jwl;
+
+namespace
+{
+	// A grid of quads with uvs and normals, optionally referencing attributes with negative indices.
+	std::string MakeGrid(unsigned size, bool relative)
+	{
+		std::string text;
+		text.reserve(size * size * 96);
+
+		char line[128];
+		for (unsigned y = 0; y <= size; ++y)
+		{
+			for (unsigned x = 0; x <= size; ++x)
+			{
+				snprintf(line, sizeof(line), "v %.6f %.6f 0.0\nvt %.6f %.6f\nvn 0 0 1\n",
+					x * 0.25f, y * 0.25f, float(x) / size, float(y) / size);
+				text += line;
+			}
+		}
+
+		const unsigned stride = size + 1;
+		const int count = static_cast<int>(stride * stride);
+		for (unsigned y = 0; y < size; ++y)
+		{
+			for (unsigned x = 0; x < size; ++x)
+			{
+				const int a = static_cast<int>(y * stride + x + 1);
+				const int b = a + 1;
+				const int c = a + static_cast<int>(stride) + 1;
+				const int d = a + static_cast<int>(stride);
+
+				if (relative)
+				{
+					snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+						a - count - 1, a - count - 1, a - count - 1,
+						b - count - 1, b - count - 1, b - count - 1,
+						c - count - 1, c - count - 1, c - count - 1,
+						d - count - 1, d - count - 1, d - count - 1);
+				}
+				else
+				{
+					snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+				}
+
+				text += line;
+			}
+		}
+
+		return text;
+	}
+}
+
+TEST_CASE("ObjParser")
+{
+	SECTION("Triangle")
+	{
+		ObjMesh mesh;
+		REQUIRE(ParseObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", mesh));
+
+		REQUIRE(mesh.positions.size() == 3);
+		CHECK(mesh.positions[1] == vec3(1.0f, 0.0f, 0.0f));
+		CHECK(mesh.uvs.empty());
+		CHECK(mesh.normals.empty());
+
+		REQUIRE(mesh.corners.size() == 3);
+		CHECK(mesh.corners[0] == ObjCorner{ 0, -1, -1 });
+		CHECK(mesh.corners[2] == ObjCorner{ 2, -1, -1 });
+	}
+
+	SECTION("Corner Formats")
+	{
+		ObjMesh mesh;
+		REQUIRE(ParseObj(
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+			"vt 0 0\nvt 1 0\nvt 0 1\n"
+			"vn 0 0 1\n"
+			"f 1/1 2/2 3/3\n"
+			"f 1//1 2//1 3//1\n"
+			"f 1/1/1 2/2/1 3/3/1\n", mesh));
+
+		REQUIRE(mesh.corners.size() == 9);
+		CHECK(mesh.corners[1] == ObjCorner{ 1, 1, -1 });
+		CHECK(mesh.corners[4] == ObjCorner{ 1, -1, 0 });
+		CHECK(mesh.corners[8] == ObjCorner{ 2, 2, 0 });
+	}
+
+	SECTION("Polygons")
+	{
+		ObjMesh mesh;
+		REQUIRE(ParseObj("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv -1 1 0\nf 1 2 3 4 5\n", mesh));
+
+		// Triangulated as a fan around the first corner.
+		REQUIRE(mesh.corners.size() == 9);
+		const int expected[] = { 0, 1, 2, 0, 2, 3, 0, 3, 4 };
+		for (unsigned i = 0; i < 9; ++i)
+		{
+			CHECK(mesh.corners[i].position == expected[i]);
+		}
+	}
+
+	SECTION("Relative Indices")
+	{
+		ObjMesh mesh;
+		REQUIRE(ParseObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nf -3//-1 -2//-1 -1//-1\n", mesh));
+
+		REQUIRE(mesh.corners.size() == 3);
+		CHECK(mesh.corners[0] == ObjCorner{ 0, -1, 0 });
+		CHECK(mesh.corners[2] == ObjCorner{ 2, -1, 0 });
+	}
+
+	SECTION("Formatting")
+	{
+		ObjMesh mesh;
+		REQUIRE(ParseObj(
+			"# A comment\r\n"
+			"mtllib scene.mtl\r\n"
+			"o Object\r\n"
+			"v  0.5\t-2.0e1  +3.25E-1 1.0\r\n"
+			"v 1 0 0\r\n"
+			"   v 0 1 0\r\n"
+			"vt 0.5\r\n"
+			"usemtl Material\r\n"
+			"s off\r\n"
+			"f 1 2 3 # Trailing comment\r\n"
+			"f 1 2 3", mesh));
+
+		REQUIRE(mesh.positions.size() == 3);
+		CHECK(mesh.positions[0] == vec3(0.5f, -20.0f, 0.325f));
+		REQUIRE(mesh.uvs.size() == 1);
+		CHECK(mesh.uvs[0] == vec2(0.5f, 0.0f));
+		CHECK(mesh.corners.size() == 6);
+	}
+
+	SECTION("Long Lines")
+	{
+		std::string text = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf";
+		for (unsigned i = 0; i < 100; ++i)
+		{
+			text += " 1 2 3";
+		}
+
+		ObjMesh mesh;
+		REQUIRE(ParseObj(text, mesh));
+		// 300 corners make 298 triangles.
+		CHECK(mesh.corners.size() == 298 * 3);
+	}
+
+	SECTION("Float Accuracy")
+	{
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> mantissa(-1.0f, 1.0f);
+		std::uniform_int_distribution<int> exponent(-20, 20);
+
+		std::string text;
+		std::vector<float> expected;
+		for (unsigned i = 0; i < 3000; ++i)
+		{
+			const float value = std::ldexp(mantissa(rng), exponent(rng));
+			char buffer[32];
+			snprintf(buffer, sizeof(buffer), "%.9g", value);
+
+			expected.push_back(strtof(buffer, nullptr));
+			text += (i % 3 == 0) ? "v " : " ";
+			text += buffer;
+			if (i % 3 == 2)
+			{
+				text += '\n';
+			}
+		}
+
+		ObjMesh mesh;
+		REQUIRE(ParseObj(text, mesh));
+		REQUIRE(mesh.positions.size() == 1000);
+
+		unsigned mismatches = 0;
+		for (unsigned i = 0; i < 1000; ++i)
+		{
+			for (unsigned j = 0; j < 3; ++j)
+			{
+				mismatches += mesh.positions[i][j] != expected[i * 3 + j];
+			}
+		}
+
+		CHECK(mismatches == 0);
+	}
+
+	SECTION("Parallel")
+	{
+		// Large enough to be split into many chunks, with faces that refer to attributes in earlier chunks.
+		for (bool relative : { false, true })
+		{
+			const std::string text = MakeGrid(200, relative);
+
+			ObjMesh single;
+			ObjMesh parallel;
+			REQUIRE(ParseObj(text, single, 1));
+			REQUIRE(ParseObj(text, parallel, 8));
+
+			CHECK(single.positions.size() == 201 * 201);
+			CHECK(single.corners.size() == 200 * 200 * 6);
+
+			CHECK(single.positions == parallel.positions);
+			CHECK(single.uvs == parallel.uvs);
+			CHECK(single.normals == parallel.normals);
+			CHECK(single.corners == parallel.corners);
+		}
+	}
+
+	SECTION("Errors")
+	{
+		ObjMesh mesh;
+		CHECK(!ParseObj("v 0 0 0\nv 1 0 0\nf 1 2\n", mesh));
+		CHECK(!ParseObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n", mesh));
+		CHECK(!ParseObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 0 1 2\n", mesh));
+		CHECK(!ParseObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1/1 2/1 3/1\n", mesh));
+		CHECK(!ParseObj("v 0 0\n", mesh));
+		CHECK(!ParseObj("v 0 0 x\n", mesh));
+	}
+}
+
+TEST_CASE("ObjParser Benchmark", "[!benchmark]")
+{
+	// 2237 * 2237 quads is just over 10 million triangles.
+	const std::string text = MakeGrid(2237, false);
+
+	BENCHMARK("Parse 10M Triangles (1 Thread)")
+	{
+		ObjMesh mesh;
+		CHECK(ParseObj(text, mesh, 1));
+	}
+
+	BENCHMARK("Parse 10M Triangles (All Threads)")
+	{
+		ObjMesh mesh;
+		CHECK(ParseObj(text, mesh));
+	}
+}
@@ -0,0 +1,198 @@
+#include <catch.hpp>
+#include <Jewel3D/Application/Profiler.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace Jwl;
+
+namespace
+{
+	const ZoneSummary* FindZone(std::string_view name)
+	{
+		for (const ZoneSummary& zone : Profiler.GetFrameSummary())
+		{
+			if (zone.name == name)
+			{
+				return &zone;
+			}
+		}
+
+		return nullptr;
+	}
+}
+
+TEST_CASE("Profiler")
+{
+	// Start from an empty frame.
+	Profiler.EndFrame();
+
+	SECTION("Frame Summary")
+	{
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			PROFILE_SCOPE("Outer");
+			for (unsigned j = 0; j < 2; ++j)
+			{
+				PROFILE_SCOPE("Inner");
+			}
+		}
+
+		Profiler.EndFrame();
+
+		const ZoneSummary* outer = FindZone("Outer");
+		const ZoneSummary* inner = FindZone("Inner");
+		REQUIRE(outer);
+		REQUIRE(inner);
+		CHECK(outer->count == 3);
+		CHECK(inner->count == 6);
+		CHECK(outer->totalMS >= inner->totalMS);
+		CHECK(outer->maxMS <= outer->totalMS);
+
+		// Each zone is only summarized once.
+		Profiler.EndFrame();
+		CHECK(FindZone("Outer") == nullptr);
+	}
+
+	SECTION("Threads")
+	{
+		constexpr unsigned NUM_THREADS = 4;
+		constexpr unsigned NUM_ZONES = 1000;
+
+		std::vector<std::thread> threads;
+		for (unsigned t = 0; t < NUM_THREADS; ++t)
+		{
+			threads.emplace_back([] {
+				for (unsigned i = 0; i < NUM_ZONES; ++i)
+				{
+					PROFILE_SCOPE("Worker");
+				}
+			});
+		}
+
+		// Frames can end while the other threads are still recording.
+		unsigned count = 0;
+		for (std::thread& thread : threads)
+		{
+			Profiler.EndFrame();
+			if (const ZoneSummary* zone = FindZone("Worker"))
+			{
+				count += zone->count;
+			}
+
+			thread.join();
+		}
+
+		Profiler.EndFrame();
+		if (const ZoneSummary* zone = FindZone("Worker"))
+		{
+			count += zone->count;
+		}
+
+		CHECK(count == NUM_THREADS * NUM_ZONES);
+	}
+
+	SECTION("Exited Threads")
+	{
+		const auto countThreads = [] {
+			REQUIRE(Profiler.ExportChromeTrace("ProfilerTest.json"));
+
+			std::ifstream file("ProfilerTest.json");
+			std::stringstream stream;
+			stream << file.rdbuf();
+			const std::string json = stream.str();
+			file.close();
+			std::remove("ProfilerTest.json");
+
+			// Unnamed threads are not mistaken for the main thread.
+			CHECK(json.find("\"Main\"") == std::string::npos);
+
+			unsigned count = 0;
+			for (size_t pos = json.find("\"thread_name\""); pos != std::string::npos; pos = json.find("\"thread_name\"", pos + 1))
+			{
+				++count;
+			}
+
+			return count;
+		};
+
+		std::thread([] { PROFILE_SCOPE("Short Lived"); }).join();
+		const unsigned numThreads = countThreads();
+
+		// Each new thread reuses the buffer of the one before it.
+		for (unsigned i = 0; i < 10; ++i)
+		{
+			std::thread([] { PROFILE_SCOPE("Short Lived"); }).join();
+		}
+
+		CHECK(countThreads() == numThreads);
+
+		Profiler.EndFrame();
+		const ZoneSummary* zone = FindZone("Short Lived");
+		REQUIRE(zone);
+		CHECK(zone->count == 11);
+	}
+
+	SECTION("Overflow")
+	{
+		// Only the newest zones are kept once the buffer is full.
+		for (unsigned i = 0; i < ProfilerSingleton::BUFFER_SIZE; ++i)
+		{
+			PROFILE_SCOPE("Old");
+		}
+
+		for (unsigned i = 0; i < 10; ++i)
+		{
+			PROFILE_SCOPE("New");
+		}
+
+		Profiler.EndFrame();
+
+		const ZoneSummary* oldZone = FindZone("Old");
+		const ZoneSummary* newZone = FindZone("New");
+		REQUIRE(oldZone);
+		REQUIRE(newZone);
+		// The oldest remaining zone is also dropped, since it could have been in the middle of being overwritten.
+		CHECK(oldZone->count == ProfilerSingleton::BUFFER_SIZE - 11);
+		CHECK(newZone->count == 10);
+	}
+
+	SECTION("Chrome Trace")
+	{
+		{
+			PROFILE_SCOPE("Traced \"Zone\"");
+		}
+
+		Profiler.SetThreadName("Test Thread");
+		REQUIRE(Profiler.ExportChromeTrace("ProfilerTest.json"));
+
+		std::ifstream file("ProfilerTest.json");
+		REQUIRE(file);
+		std::stringstream stream;
+		stream << file.rdbuf();
+		const std::string json = stream.str();
+		file.close();
+		std::remove("ProfilerTest.json");
+
+		CHECK(json.find("\"traceEvents\":[") != std::string::npos);
+		CHECK(json.find("\"name\":\"Traced \\\"Zone\\\"\",\"ph\":\"X\"") != std::string::npos);
+		CHECK(json.find("\"args\":{\"name\":\"Test Thread\"}") != std::string::npos);
+		CHECK(json.substr(json.size() - 3) == "]}\n");
+	}
+}
+
+TEST_CASE("Profiler Benchmark", "[!benchmark]")
+{
+	BENCHMARK("Record 10000 Zones")
+	{
+		for (unsigned i = 0; i < 10000; ++i)
+		{
+			PROFILE_SCOPE("Benchmark");
+		}
+	}
+
+	Profiler.EndFrame();
+}
@@ -0,0 +1,289 @@
+#include <catch.hpp>
+#include <Jewel3D/Network/Network.h>
+#include <Jewel3D/Network/NetworkConditioner.h>
+#include <Jewel3D/Network/ReliableEndpoint.h>
+
+#include <algorithm>
+#include <memory>
+
+using namespace Jwl;
+
+namespace
+{
+	enum Channels
+	{
+		UNRELIABLE,
+		RELIABLE,
+		ORDERED
+	};
+
+	const std::vector<ChannelType> CHANNELS = { ChannelType::Unreliable, ChannelType::Reliable, ChannelType::ReliableOrdered };
+
+	// Two endpoints exchanging packets through simulated connections.
+	struct Link
+	{
+		Link()
+		{
+			a = std::make_unique<ReliableEndpoint>(CHANNELS, [this](std::string_view packet) { toB.Send(packet); });
+			b = std::make_unique<ReliableEndpoint>(CHANNELS, [this](std::string_view packet) { toA.Send(packet); });
+		}
+
+		void SetConditions(double loss, double duplication, double latency, double jitter)
+		{
+			for (auto* conditioner : { &toA, &toB })
+			{
+				conditioner->SetLoss(loss);
+				conditioner->SetDuplication(duplication);
+				conditioner->SetLatency(latency, jitter);
+			}
+		}
+
+		// Runs at 60 frames per second for the given time.
+		void Run(double durationMS)
+		{
+			for (double end = time + durationMS; time < end; time += 16.0)
+			{
+				toA.Update(time);
+				toB.Update(time);
+				a->Update(time);
+				b->Update(time);
+			}
+		}
+
+		double time = 0.0;
+		NetworkConditioner toA{ [this](std::string_view packet) { a->ProcessPacket(packet, time); }, 1 };
+		NetworkConditioner toB{ [this](std::string_view packet) { b->ProcessPacket(packet, time); }, 2 };
+		std::unique_ptr<ReliableEndpoint> a;
+		std::unique_ptr<ReliableEndpoint> b;
+	};
+
+	std::vector<std::string> ReceiveAll(ReliableEndpoint& endpoint, unsigned channel)
+	{
+		std::vector<std::string> result;
+		std::string message;
+		while (endpoint.Receive(channel, message))
+		{
+			result.push_back(message);
+		}
+
+		return result;
+	}
+
+	std::string MakeLargeMessage(unsigned size)
+	{
+		std::string message(size, '\0');
+		for (unsigned i = 0; i < size; ++i)
+		{
+			message[i] = static_cast<char>(i * 7);
+		}
+
+		return message;
+	}
+}
+
+TEST_CASE("ReliableEndpoint")
+{
+	Link link;
+
+	SECTION("Perfect Connection")
+	{
+		link.a->Send(ORDERED, "First");
+		link.a->Send(ORDERED, "Second");
+		link.a->Send(UNRELIABLE, "Unreliable");
+		link.b->Send(RELIABLE, std::string("\0Binary\0", 8));
+		link.Run(100.0);
+
+		auto ordered = ReceiveAll(*link.b, ORDERED);
+		REQUIRE(ordered.size() == 2);
+		CHECK(ordered[0] == "First");
+		CHECK(ordered[1] == "Second");
+
+		auto unreliable = ReceiveAll(*link.b, UNRELIABLE);
+		REQUIRE(unreliable.size() == 1);
+		CHECK(unreliable[0] == "Unreliable");
+
+		auto reliable = ReceiveAll(*link.a, RELIABLE);
+		REQUIRE(reliable.size() == 1);
+		CHECK(reliable[0] == std::string("\0Binary\0", 8));
+
+		CHECK(link.a->GetPacketLoss() == 0.0);
+		CHECK(link.a->GetNumPacketsAcked() > 0);
+	}
+
+	SECTION("Lossy Connection")
+	{
+		link.SetConditions(0.25, 0.05, 50.0, 20.0);
+
+		std::vector<std::string> sent;
+		for (unsigned i = 0; i < 500; ++i)
+		{
+			sent.push_back("Message " + std::to_string(i));
+			link.a->Send(ORDERED, sent.back());
+			link.a->Send(RELIABLE, sent.back());
+			link.a->Send(UNRELIABLE, sent.back());
+
+			// Spread over a few seconds, like gameplay traffic.
+			if (i % 10 == 0)
+			{
+				link.Run(16.0);
+			}
+		}
+
+		link.Run(5000.0);
+
+		// Every reliable message arrives exactly once.
+		auto ordered = ReceiveAll(*link.b, ORDERED);
+		CHECK(ordered == sent);
+
+		auto reliable = ReceiveAll(*link.b, RELIABLE);
+		std::sort(reliable.begin(), reliable.end());
+		auto sorted = sent;
+		std::sort(sorted.begin(), sorted.end());
+		CHECK(reliable == sorted);
+
+		// Some unreliable messages are lost, but none are duplicated.
+		auto unreliable = ReceiveAll(*link.b, UNRELIABLE);
+		CHECK(unreliable.size() < sent.size());
+		CHECK(unreliable.size() > sent.size() / 2);
+		std::sort(unreliable.begin(), unreliable.end());
+		CHECK(std::adjacent_find(unreliable.begin(), unreliable.end()) == unreliable.end());
+
+		// The estimates reflect the simulated conditions.
+		CHECK(link.a->GetRoundTripTime() > 90.0);
+		CHECK(link.a->GetRoundTripTime() < 300.0);
+		CHECK(link.a->GetPacketLoss() > 0.05);
+		CHECK(link.a->GetPacketLoss() < 0.6);
+	}
+
+	SECTION("First Packet Lost")
+	{
+		// B's first packet is dropped. A's first packet is sent before A has received anything, so it must not acknowledge it.
+		bool isFirst = true;
+		link.b = std::make_unique<ReliableEndpoint>(CHANNELS, [&link, &isFirst](std::string_view packet) {
+			if (!isFirst)
+			{
+				link.toA.Send(packet);
+			}
+
+			isFirst = false;
+		});
+
+		link.a->Send(RELIABLE, "From A");
+		link.b->Send(RELIABLE, "From B");
+		link.Run(2000.0);
+
+		auto fromA = ReceiveAll(*link.b, RELIABLE);
+		REQUIRE(fromA.size() == 1);
+		CHECK(fromA[0] == "From A");
+
+		auto fromB = ReceiveAll(*link.a, RELIABLE);
+		REQUIRE(fromB.size() == 1);
+		CHECK(fromB[0] == "From B");
+	}
+
+	SECTION("Fragmentation")
+	{
+		link.SetConditions(0.2, 0.0, 30.0, 30.0);
+
+		const std::string large = MakeLargeMessage(20000);
+		link.a->Send(ORDERED, "Before");
+		link.a->Send(ORDERED, large);
+		link.a->Send(ORDERED, "After");
+		link.a->Send(RELIABLE, large);
+		link.Run(5000.0);
+
+		auto ordered = ReceiveAll(*link.b, ORDERED);
+		REQUIRE(ordered.size() == 3);
+		CHECK(ordered[0] == "Before");
+		CHECK(ordered[1] == large);
+		CHECK(ordered[2] == "After");
+
+		auto reliable = ReceiveAll(*link.b, RELIABLE);
+		REQUIRE(reliable.size() == 1);
+		CHECK(reliable[0] == large);
+	}
+
+	SECTION("Sequence Numbers Wrap Around")
+	{
+		link.SetConditions(0.1, 0.0, 20.0, 0.0);
+
+		// Enough messages and packets for the 16 bit IDs to wrap.
+		std::vector<std::string> sent;
+		for (unsigned i = 0; i < 70000; ++i)
+		{
+			sent.push_back(std::to_string(i));
+			link.a->Send(ORDERED, sent.back());
+
+			if (i % 25 == 0)
+			{
+				link.Run(16.0);
+			}
+		}
+
+		link.Run(5000.0);
+
+		auto ordered = ReceiveAll(*link.b, ORDERED);
+		REQUIRE(ordered.size() == sent.size());
+		CHECK(std::equal(ordered.begin(), ordered.end(), sent.begin()));
+	}
+}
+
+TEST_CASE("ReliableEndpoint Over Loopback")
+{
+	REQUIRE(InitWinSock());
+
+	NetworkUDP socketA;
+	NetworkUDP socketB;
+	REQUIRE(socketA.Init(50010));
+	REQUIRE(socketA.Init("127.0.0.1", 50011));
+	REQUIRE(socketB.Init(50011));
+	REQUIRE(socketB.Init("127.0.0.1", 50010));
+
+	// A's packets pass through a lossy connection on their way to the socket.
+	NetworkConditioner conditioner([&socketA](std::string_view packet) { socketA.Send(packet); });
+	conditioner.SetLoss(0.3);
+
+	ReliableEndpoint a(CHANNELS, [&conditioner](std::string_view packet) { conditioner.Send(packet); });
+	ReliableEndpoint b(CHANNELS, [&socketB](std::string_view packet) { socketB.Send(packet); });
+
+	const std::string large = MakeLargeMessage(5000);
+	for (unsigned i = 0; i < 100; ++i)
+	{
+		a.Send(ORDERED, std::to_string(i));
+	}
+	a.Send(ORDERED, large);
+
+	std::vector<std::string> received;
+	std::string packet;
+	for (double time = 0.0; received.size() < 101 && time < 10000.0; time += 16.0)
+	{
+		conditioner.Update(time);
+		a.Update(time);
+		b.Update(time);
+
+		while (socketA.Receive(packet))
+		{
+			a.ProcessPacket(packet, time);
+		}
+
+		while (socketB.Receive(packet))
+		{
+			b.ProcessPacket(packet, time);
+		}
+
+		std::string message;
+		while (b.Receive(ORDERED, message))
+		{
+			received.push_back(message);
+		}
+	}
+
+	REQUIRE(received.size() == 101);
+	CHECK(received[0] == "0");
+	CHECK(received[99] == "99");
+	CHECK(received[100] == large);
+
+	socketA.Destroy();
+	socketB.Destroy();
+	DestroyWinSock();
+}
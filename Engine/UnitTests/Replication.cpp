@@ -0,0 +1,423 @@
+#include <catch.hpp>
+#include <Jewel3D/Application/ThreadPool.h>
+#include <Jewel3D/Entity/Entity.h>
+#include <Jewel3D/Math/Math.h>
+#include <Jewel3D/Network/Replication.h>
+
+using namespace Jwl;
+
+namespace
+{
+	class Health : public Component<Health>
+	{
+	public:
+		Health(Entity& owner) : Component(owner) {}
+
+		void Write(BitWriter& writer) const { writer.WriteInt(value, 0, 1000); }
+		bool Read(BitReader& reader) { return reader.ReadInt(0, 1000, value); }
+
+		int value = 100;
+	};
+
+	class Team : public Component<Team>
+	{
+	public:
+		Team(Entity& owner) : Component(owner) {}
+
+		void Write(BitWriter& writer) const { writer.WriteBytes(name); writer.WriteBytes(std::string_view("", 1)); }
+		bool Read(BitReader& reader)
+		{
+			name.clear();
+			std::string byte;
+			while (reader.ReadBytes(1, byte))
+			{
+				if (byte[0] == '\0')
+				{
+					return true;
+				}
+
+				name += byte;
+			}
+
+			return false;
+		}
+
+		std::string name;
+	};
+
+	// Sends a packet from the server to the client, and optionally the acknowledgement back. Returns the size in bytes.
+	unsigned Send(ReplicationServer& server, ReplicationClient& client, bool deliverAck = true)
+	{
+		BitWriter packet;
+		server.WritePacket(1, packet);
+		REQUIRE(client.ProcessPacket(packet.GetData()));
+
+		if (deliverAck)
+		{
+			BitWriter ack;
+			client.WriteAck(ack);
+			REQUIRE(server.ProcessAck(1, ack.GetData()));
+		}
+
+		return packet.GetByteCount();
+	}
+
+	bool IsClose(const vec3& a, const vec3& b)
+	{
+		return Abs(a.x - b.x) <= 0.001f && Abs(a.y - b.y) <= 0.001f && Abs(a.z - b.z) <= 0.001f;
+	}
+}
+
+TEST_CASE("Replication")
+{
+	// Packets are not limited here, so that every change arrives at once. Limits are tested separately below.
+	ReplicationSettings settings;
+	settings.maxPacketSize = 0;
+
+	ReplicationServer server(settings);
+	ReplicationClient client(settings);
+	server.Register<Health>();
+	server.Register<Team>();
+	client.Register<Health>();
+	client.Register<Team>();
+	server.AddClient(1);
+
+	std::vector<Entity::Ptr> entities;
+	for (unsigned i = 0; i < 3; ++i)
+	{
+		auto& entity = entities.emplace_back(Entity::MakeNew());
+		entity->Add<Replicated>();
+		entity->position = vec3(i * 10.0f, 1.5f, -3.25f);
+	}
+
+	entities[0]->RotateY(45.0f);
+	entities[1]->Add<Health>().value = 42;
+	entities[2]->Add<Team>().name = "Red";
+	entities[2]->scale = vec3(2.0f);
+
+	server.Capture();
+	const unsigned fullSize = Send(server, client);
+
+	REQUIRE(client.GetNumEntities() == 3);
+	for (auto& entity : entities)
+	{
+		const unsigned id = entity->Get<Replicated>().GetNetworkID();
+		REQUIRE(id != 0);
+
+		auto replica = client.GetEntity(id);
+		REQUIRE(replica);
+		CHECK(IsClose(replica->position, entity->position));
+		CHECK(IsClose(replica->scale, entity->scale));
+		CHECK(Abs(Dot(replica->rotation, entity->rotation)) > 0.9999f);
+		CHECK_FALSE(replica->Has<Replicated>());
+	}
+
+	auto GetReplica = [&](unsigned index) {
+		return client.GetEntity(entities[index]->Get<Replicated>().GetNetworkID());
+	};
+
+	CHECK(GetReplica(1)->Get<Health>().value == 42);
+	CHECK(GetReplica(2)->Get<Team>().name == "Red");
+	CHECK_FALSE(GetReplica(0)->Has<Health>());
+
+	SECTION("Deltas")
+	{
+		// Nothing has changed, so only the header is sent.
+		server.Capture();
+		CHECK(Send(server, client) <= 5);
+
+		entities[0]->position.x += 0.05f;
+		entities[1]->Get<Health>().value = 41;
+		server.Capture();
+		const unsigned deltaSize = Send(server, client);
+
+		CHECK(deltaSize < fullSize / 2);
+		CHECK(IsClose(GetReplica(0)->position, entities[0]->position));
+		CHECK(GetReplica(1)->Get<Health>().value == 41);
+
+		// Components can be added and removed.
+		entities[0]->Add<Health>().value = 7;
+		entities[2]->Remove<Team>();
+		server.Capture();
+		Send(server, client);
+
+		CHECK(GetReplica(0)->Get<Health>().value == 7);
+		CHECK_FALSE(GetReplica(2)->Has<Team>());
+	}
+
+	SECTION("Creation and Removal")
+	{
+		auto& added = entities.emplace_back(Entity::MakeNew());
+		added->Add<Replicated>();
+		added->position = vec3(-50.0f);
+
+		const unsigned removedID = entities[0]->Get<Replicated>().GetNetworkID();
+		entities[0].reset();
+
+		server.Capture();
+		Send(server, client);
+
+		CHECK(client.GetNumEntities() == 3);
+		CHECK(client.GetEntity(removedID) == nullptr);
+
+		auto replica = client.GetEntity(added->Get<Replicated>().GetNetworkID());
+		REQUIRE(replica);
+		CHECK(IsClose(replica->position, vec3(-50.0f)));
+	}
+
+	SECTION("Lost Packets")
+	{
+		// Without acknowledgements, each packet is encoded against the last acknowledged snapshot.
+		for (unsigned i = 0; i < 10; ++i)
+		{
+			entities[0]->position.y += 1.0f;
+			entities[1]->Get<Health>().value = i;
+			server.Capture();
+
+			// Only some of the packets arrive.
+			if (i % 3 == 0)
+			{
+				Send(server, client, false);
+			}
+		}
+
+		CHECK(client.GetSequence() == server.GetSequence());
+		CHECK(IsClose(GetReplica(0)->position, entities[0]->position));
+		CHECK(GetReplica(1)->Get<Health>().value == 9);
+
+		// Old packets are ignored.
+		BitWriter stale;
+		stale.Write(server.GetSequence() - 1, 16);
+		stale.WriteBool(false);
+		CHECK(client.ProcessPacket(stale.GetData()));
+		CHECK(client.GetSequence() == server.GetSequence());
+	}
+
+	SECTION("Malformed Packets")
+	{
+		entities[0]->position.z = 100.0f;
+		server.Capture();
+
+		BitWriter packet;
+		server.WritePacket(1, packet);
+
+		// A truncated packet is rejected without changing anything.
+		const std::string_view data = packet.GetData();
+		CHECK_FALSE(client.ProcessPacket(data.substr(0, data.size() / 2)));
+		CHECK(client.GetSequence() == server.GetSequence() - 1);
+		CHECK(GetReplica(0)->position.z == Approx(-3.25f));
+
+		CHECK(client.ProcessPacket(data));
+		CHECK(GetReplica(0)->position.z == Approx(100.0f));
+	}
+
+	SECTION("Bandwidth")
+	{
+		// A crowd where a tenth of the entities move slowly each tick.
+		for (unsigned i = 0; i < 1000; ++i)
+		{
+			auto& entity = entities.emplace_back(Entity::MakeNew());
+			entity->Add<Replicated>();
+			entity->Add<Health>();
+			entity->position = vec3(static_cast<float>(i), 0.0f, static_cast<float>(i % 37));
+		}
+
+		server.Capture();
+		const unsigned crowdSize = Send(server, client);
+
+		for (unsigned i = 3; i < entities.size(); i += 10)
+		{
+			entities[i]->position += vec3(0.016f, 0.0f, -0.02f);
+		}
+
+		server.Capture();
+		const unsigned tickSize = Send(server, client);
+
+		CHECK(tickSize * 10 < crowdSize);
+		CHECK(client.GetNumEntities() == entities.size());
+		CHECK(IsClose(client.GetEntity(entities[13]->Get<Replicated>().GetNetworkID())->position, entities[13]->position));
+	}
+
+	SECTION("Interest Management")
+	{
+		// Only the first two entities are within the view.
+		server.SetClientView(1, vec3(5.0f, 0.0f, 0.0f), 8.0f);
+		server.Capture();
+		Send(server, client);
+
+		CHECK(client.GetNumEntities() == 2);
+		CHECK(GetReplica(2) == nullptr);
+
+		// Entities entering the view are sent in full, and those leaving it are released.
+		server.SetClientView(1, vec3(20.0f, 0.0f, 0.0f), 12.0f);
+		entities[2]->Get<Team>().name = "Blue";
+		server.Capture();
+		Send(server, client);
+
+		CHECK(client.GetNumEntities() == 2);
+		CHECK(GetReplica(0) == nullptr);
+		REQUIRE(GetReplica(2));
+		CHECK(GetReplica(2)->Get<Team>().name == "Blue");
+
+		// Entities spread over many cells are found the same way as with a linear search.
+		for (unsigned i = 0; i < 500; ++i)
+		{
+			auto& entity = entities.emplace_back(Entity::MakeNew());
+			entity->Add<Replicated>();
+			entity->position = vec3(static_cast<float>(i % 10) * 100.0f, static_cast<float>(i / 10 % 10) * 100.0f, static_cast<float>(i / 100) * 100.0f);
+		}
+
+		server.SetClientView(1, vec3(450.0f, 450.0f, 200.0f), 150.0f);
+		server.Capture();
+		Send(server, client);
+
+		unsigned expected = 0;
+		for (auto& entity : entities)
+		{
+			const bool isVisible = Distance(entity->position, vec3(450.0f, 450.0f, 200.0f)) <= 150.0f;
+			CHECK((GetReplica(static_cast<unsigned>(&entity - entities.data())) != nullptr) == isVisible);
+			expected += isVisible;
+		}
+
+		CHECK(expected > 0);
+		CHECK(client.GetNumEntities() == expected);
+	}
+
+	SECTION("Parallel Packets")
+	{
+		ReplicationClient others[4];
+		for (int i = 0; i < 4; ++i)
+		{
+			others[i].Register<Health>();
+			others[i].Register<Team>();
+			server.AddClient(i + 2);
+			server.SetClientView(i + 2, entities[i % 3]->position, 5.0f);
+		}
+
+		ThreadPool pool(2);
+		server.Capture();
+		server.WritePackets(&pool);
+
+		for (int i = 0; i < 4; ++i)
+		{
+			REQUIRE(others[i].ProcessPacket(server.GetPacket(i + 2)));
+			CHECK(others[i].GetNumEntities() == 1);
+			CHECK(others[i].GetEntity(entities[i % 3]->Get<Replicated>().GetNetworkID()));
+		}
+
+		// The packets match those written one at a time.
+		BitWriter packet;
+		server.WritePacket(3, packet);
+		CHECK(packet.GetData() == server.GetPacket(3));
+	}
+}
+
+TEST_CASE("Replication Priority")
+{
+	ReplicationSettings settings;
+	settings.maxPacketSize = 200;
+
+	ReplicationServer server(settings);
+	ReplicationClient client(settings);
+	server.Register<Health>();
+	server.Register<Team>();
+	client.Register<Health>();
+	client.Register<Team>();
+	server.AddClient(1);
+	server.SetClientView(1, vec3(0.0f), 1000.0f);
+
+	std::vector<Entity::Ptr> entities;
+	for (unsigned i = 0; i < 200; ++i)
+	{
+		auto& entity = entities.emplace_back(Entity::MakeNew());
+		entity->Add<Replicated>();
+		entity->Add<Team>().name = "Green";
+		entity->position = vec3(static_cast<float>(i), 0.0f, 0.0f);
+	}
+
+	entities.back()->Get<Replicated>().priority = 100.0f;
+
+	// Everything arrives over several packets, none of which are over the limit.
+	unsigned numPackets = 0;
+	while (client.GetNumEntities() < entities.size())
+	{
+		REQUIRE(numPackets++ < 50);
+		server.Capture();
+		CHECK(Send(server, client) <= 200);
+
+		// The most important entity is sent first, despite being the furthest.
+		CHECK(client.GetEntity(entities.back()->Get<Replicated>().GetNetworkID()));
+	}
+
+	CHECK(numPackets > 1);
+
+	// Distant entities still get updated while the packets are full.
+	for (auto& entity : entities)
+	{
+		entity->position.y += 1.0f;
+	}
+
+	for (unsigned i = 0; i < 50; ++i)
+	{
+		server.Capture();
+		CHECK(Send(server, client) <= 200);
+	}
+
+	for (auto& entity : entities)
+	{
+		CHECK(IsClose(client.GetEntity(entity->Get<Replicated>().GetNetworkID())->position, entity->position));
+	}
+}
+
+TEST_CASE("Replication Benchmark", "[!benchmark]")
+{
+	ReplicationServer server;
+	server.Register<Health>();
+
+	std::vector<Entity::Ptr> entities;
+	for (unsigned i = 0; i < 5000; ++i)
+	{
+		auto& entity = entities.emplace_back(Entity::MakeNew());
+		entity->Add<Replicated>();
+		entity->Add<Health>();
+		entity->position = vec3(static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100));
+	}
+
+	// Every client sees a quarter of the world, and has acknowledged the previous tick.
+	for (int i = 0; i < 64; ++i)
+	{
+		server.AddClient(i);
+		server.SetClientView(i, vec3(static_cast<float>(i % 8) * 12.5f, 0.0f, static_cast<float>(i / 8) * 6.25f), 25.0f);
+	}
+
+	server.Capture();
+	server.WritePackets();
+	for (int i = 0; i < 64; ++i)
+	{
+		BitWriter ack;
+		ack.Write(server.GetSequence(), 16);
+		server.ProcessAck(i, ack.GetData());
+	}
+
+	for (unsigned i = 0; i < entities.size(); i += 4)
+	{
+		entities[i]->position.y += 0.1f;
+	}
+
+	ThreadPool pool(4);
+
+	BENCHMARK("Capture 5000 Entities")
+	{
+		server.Capture();
+	}
+
+	BENCHMARK("Write Packets for 64 Clients")
+	{
+		server.WritePackets();
+	}
+
+	BENCHMARK("Write Packets for 64 Clients in Parallel")
+	{
+		server.WritePackets(&pool);
+	}
+}
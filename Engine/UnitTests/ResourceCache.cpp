@@ -0,0 +1,150 @@
+#include <catch.hpp>
+#include <Jewel3D/Resource/Resource.h>
+
+using namespace Jwl;
+
+namespace
+{
+	// Loads without touching the disk. Each asset reports 100 bytes of system memory and 300 bytes of video memory.
+	class SizedAsset : public Resource<SizedAsset>
+	{
+	public:
+		bool Load(std::string)
+		{
+			return true;
+		}
+
+		MemoryUsage GetMemoryUsage() const
+		{
+			MemoryUsage usage;
+			usage.cpuBytes = 100;
+			usage.gpuBytes = 300;
+
+			return usage;
+		}
+	};
+
+	// Does not report its memory usage.
+	class PlainAsset : public Resource<PlainAsset>
+	{
+	public:
+		bool Load(std::string)
+		{
+			return true;
+		}
+	};
+
+	bool IsCached(const char* name)
+	{
+		return SizedAsset::Find(RootAssetDirectory + name) != nullptr;
+	}
+}
+
+TEST_CASE("Resource Cache")
+{
+	UnloadAll<SizedAsset>();
+	SizedAsset::SetBudget(SIZE_MAX);
+	SizedAsset::SetCachePolicy(CachePolicy::Strong);
+	const ResourceStats initial = SizedAsset::GetStats();
+
+	SECTION("Accounting")
+	{
+		auto a = Load<SizedAsset>("a");
+		auto b = Load<SizedAsset>("b");
+		CHECK(Load<SizedAsset>("a") == a);
+
+		const ResourceStats stats = SizedAsset::GetStats();
+		CHECK(stats.count == 2);
+		CHECK(stats.cpuBytes == 200);
+		CHECK(stats.gpuBytes == 600);
+		CHECK(stats.hits - initial.hits == 1);
+		CHECK(stats.misses - initial.misses == 2);
+
+		// Assets that do not report their usage are still counted.
+		auto plain = Load<PlainAsset>("plain");
+		CHECK(PlainAsset::GetStats().count == 1);
+		CHECK(PlainAsset::GetStats().gpuBytes == 0);
+	}
+
+	SECTION("Referenced Assets Are Kept")
+	{
+		auto a = Load<SizedAsset>("a");
+		auto b = Load<SizedAsset>("b");
+
+		// Nothing can be evicted while the assets are in use, even when over budget.
+		SizedAsset::SetBudget(0);
+		CHECK(SizedAsset::GetStats().count == 2);
+		CHECK(SizedAsset::GetStats().unreferencedCount == 0);
+
+		// Once released, they are evicted the next time the budget is checked.
+		a.reset();
+		b.reset();
+		CHECK(SizedAsset::GetStats().unreferencedCount == 2);
+		SizedAsset::SetBudget(0);
+		CHECK(SizedAsset::GetStats().count == 0);
+		CHECK(SizedAsset::GetStats().evictions - initial.evictions == 2);
+	}
+
+	SECTION("Least Recently Used Eviction")
+	{
+		// Room for two assets.
+		SizedAsset::SetBudget(800);
+
+		Load<SizedAsset>("a");
+		Load<SizedAsset>("b");
+
+		// Using 'a' again makes 'b' the least recently used.
+		CHECK(IsCached("a"));
+		Load<SizedAsset>("c");
+
+		CHECK(IsCached("a"));
+		CHECK(!IsCached("b"));
+		CHECK(IsCached("c"));
+		CHECK(SizedAsset::GetStats().evictions - initial.evictions == 1);
+		CHECK(SizedAsset::GetStats().cpuBytes + SizedAsset::GetStats().gpuBytes <= 800);
+
+		// Evicted assets are loaded again on request.
+		const unsigned misses = SizedAsset::GetStats().misses;
+		CHECK(Load<SizedAsset>("b") != nullptr);
+		CHECK(SizedAsset::GetStats().misses == misses + 1);
+	}
+
+	SECTION("Evict Unused")
+	{
+		auto a = Load<SizedAsset>("a");
+		Load<SizedAsset>("b");
+		Load<SizedAsset>("c");
+
+		CHECK(SizedAsset::EvictUnused() == 2);
+		CHECK(IsCached("a"));
+		CHECK(SizedAsset::GetStats().count == 1);
+	}
+
+	SECTION("Weak Caching")
+	{
+		SizedAsset::SetCachePolicy(CachePolicy::Weak);
+
+		auto a = Load<SizedAsset>("a");
+		Load<SizedAsset>("b");
+
+		// Only assets in use remain.
+		CHECK(IsCached("a"));
+		CHECK(!IsCached("b"));
+		CHECK(Load<SizedAsset>("a") == a);
+
+		a.reset();
+		CHECK(!IsCached("a"));
+		CHECK(SizedAsset::GetStats().count == 0);
+
+		// Switching back keeps the assets that are still alive.
+		auto c = Load<SizedAsset>("c");
+		SizedAsset::SetCachePolicy(CachePolicy::Strong);
+		c.reset();
+		CHECK(IsCached("c"));
+	}
+
+	UnloadAll<SizedAsset>();
+	UnloadAll<PlainAsset>();
+	SizedAsset::SetBudget(SIZE_MAX);
+	SizedAsset::SetCachePolicy(CachePolicy::Strong);
+}
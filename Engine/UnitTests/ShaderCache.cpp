@@ -0,0 +1,69 @@
+#include <catch.hpp>
+#include <Jewel3D/Application/FileSystem.h>
+#include <Jewel3D/Resource/ShaderCache.h>
+
+using namespace Jwl;
+
+TEST_CASE("ShaderCache")
+{
+	const char* source = "void main() { gl_Position = vec4(0.0); }";
+
+	SECTION("Key Derivation")
+	{
+		auto key = ShaderCacheKey::Create(source, "#define A \n");
+
+		CHECK(key == ShaderCacheKey::Create(source, "#define A \n"));
+		CHECK(key.GetFileName() == ShaderCacheKey::Create(source, "#define A \n").GetFileName());
+
+		CHECK(key != ShaderCacheKey::Create(source, "#define B \n"));
+		CHECK(key != ShaderCacheKey::Create(source, ""));
+		CHECK(key != ShaderCacheKey::Create("void main() {}", "#define A \n"));
+
+		// Moving text between the source and the defines must not produce the same key.
+		CHECK(ShaderCacheKey::Create("ab", "c") != ShaderCacheKey::Create("a", "bc"));
+
+		CHECK(key.GetFileName() != ShaderCacheKey::Create(source, "").GetFileName());
+		CHECK(key.GetFileName().size() == 32 + sizeof(".shaderbin") - 1);
+	}
+
+	SECTION("File Format")
+	{
+		const char* file = "ShaderCacheTest.shaderbin";
+		auto key = ShaderCacheKey::Create(source, "#define A \n");
+
+		ShaderBinary binary;
+		binary.format = 0x1234;
+		binary.data = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+		REQUIRE(SaveShaderBinary(file, key, binary));
+
+		ShaderBinary loaded;
+		CHECK(LoadShaderBinary(file, key, loaded));
+		CHECK(loaded.format == binary.format);
+		CHECK(loaded.data == binary.data);
+
+		// A binary is only valid for the key it was created with.
+		CHECK_FALSE(LoadShaderBinary(file, ShaderCacheKey::Create(source, ""), loaded));
+
+		// A corrupted payload must be rejected.
+		FILE* corrupt = fopen(file, "r+b");
+		REQUIRE(corrupt != nullptr);
+		fseek(corrupt, -1, SEEK_END);
+		fputc(0xFF, corrupt);
+		fclose(corrupt);
+		CHECK_FALSE(LoadShaderBinary(file, key, loaded));
+
+		// A truncated file must be rejected.
+		corrupt = fopen(file, "wb");
+		REQUIRE(corrupt != nullptr);
+		fputs("JWSB", corrupt);
+		fclose(corrupt);
+		CHECK_FALSE(LoadShaderBinary(file, key, loaded));
+
+		CHECK(RemoveFile(file));
+		CHECK_FALSE(LoadShaderBinary(file, key, loaded));
+
+		// Empty binaries are never saved.
+		CHECK_FALSE(SaveShaderBinary(file, key, ShaderBinary()));
+	}
+}
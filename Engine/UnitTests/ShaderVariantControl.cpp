@@ -0,0 +1,85 @@
+#include <catch.hpp>
+#include <Jewel3D/Resource/Shader.h>
+
+using namespace Jwl;
+
+TEST_CASE("ShaderVariantControl")
+{
+	SECTION("Interning")
+	{
+		ShaderDefine a = "JWL_TEST_A";
+		ShaderDefine b = "JWL_TEST_B";
+
+		CHECK(a.GetId() == ShaderDefine("JWL_TEST_A").GetId());
+		CHECK(a.GetId() != b.GetId());
+		CHECK(a.GetName() == "JWL_TEST_A");
+		CHECK(ShaderDefine::GetString(ShaderDefine::Intern("")).empty());
+	}
+
+	SECTION("Defines")
+	{
+		ShaderVariantControl svc;
+		CHECK(svc.IsEmpty());
+		CHECK(svc.GetHash() == ShaderVariantControl().GetHash());
+
+		svc.Define("JWL_TEST_A", "1");
+		CHECK(svc.IsDefined("JWL_TEST_A"));
+		CHECK_FALSE(svc.IsDefined("JWL_TEST_B"));
+
+		svc.Switch("JWL_TEST_B", true);
+		svc.Toggle("JWL_TEST_C");
+		CHECK(svc.GetString() == "#define JWL_TEST_A 1\n#define JWL_TEST_B \n#define JWL_TEST_C \n");
+
+		svc.Toggle("JWL_TEST_C");
+		svc.Switch("JWL_TEST_B", false);
+		svc.Undefine("JWL_TEST_D");
+		CHECK(svc.GetString() == "#define JWL_TEST_A 1\n");
+
+		svc.Reset();
+		CHECK(svc.IsEmpty());
+		CHECK(svc == ShaderVariantControl());
+	}
+
+	SECTION("Equality")
+	{
+		ShaderVariantControl first;
+		first.Define("JWL_TEST_A");
+		first.Define("JWL_TEST_B", "2");
+
+		// The order of definition does not matter.
+		ShaderVariantControl second;
+		second.Define("JWL_TEST_B", "2");
+		second.Define("JWL_TEST_A");
+		CHECK(first == second);
+		CHECK(first.GetHash() == second.GetHash());
+
+		second.Define("JWL_TEST_B", "3");
+		CHECK(first != second);
+
+		second.Define("JWL_TEST_B", "2");
+		CHECK(first == second);
+	}
+
+	SECTION("Collisions")
+	{
+		// Swapping names with values must produce a different variant.
+		ShaderVariantControl first;
+		first.Define("JWL_TEST_A", "JWL_TEST_B");
+
+		ShaderVariantControl second;
+		second.Define("JWL_TEST_B", "JWL_TEST_A");
+		CHECK(first != second);
+		CHECK(first.GetHash() != second.GetHash());
+
+		// Moving a value to a different define must produce a different variant.
+		first.Reset();
+		first.Define("JWL_TEST_A", "1");
+		first.Define("JWL_TEST_B");
+
+		second.Reset();
+		second.Define("JWL_TEST_A");
+		second.Define("JWL_TEST_B", "1");
+		CHECK(first != second);
+		CHECK(first.GetHash() != second.GetHash());
+	}
+}
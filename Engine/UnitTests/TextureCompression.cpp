@@ -0,0 +1,254 @@
+#include <catch.hpp>
+#include <Jewel3D/Application/ThreadPool.h>
+#include <Jewel3D/Utilities/TextureCompression.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Jwl;
+
+namespace
+{
+	// Smooth gradients with some noise and a few hard edges, which is representative of typical texture content.
+	std::vector<unsigned char> MakeImage(unsigned width, unsigned height)
+	{
+		std::mt19937 rng(7);
+		std::uniform_int_distribution<int> noise(-2, 2);
+
+		std::vector<unsigned char> pixels(width * height * 4);
+		for (unsigned y = 0; y < height; ++y)
+		{
+			for (unsigned x = 0; x < width; ++x)
+			{
+				const float u = float(x) / width;
+				const float v = float(y) / height;
+				const bool stripe = ((x / 16) + (y / 24)) % 5 == 0;
+
+				const float values[4] = {
+					stripe ? 230.0f : 200.0f * u + 20.0f,
+					stripe ? 40.0f : 128.0f + 100.0f * std::sin(v * 6.0f),
+					stripe ? 60.0f : 255.0f * (1.0f - u) * v,
+					255.0f * (0.5f + 0.5f * std::cos(u * 4.0f + v * 3.0f))
+				};
+
+				for (unsigned c = 0; c < 4; ++c)
+				{
+					const int value = static_cast<int>(values[c]) + noise(rng);
+					pixels[(y * width + x) * 4 + c] = static_cast<unsigned char>(std::clamp(value, 0, 255));
+				}
+			}
+		}
+
+		return pixels;
+	}
+
+	// Returns the PSNR of the first 'numChannels' channels of each pixel.
+	float ComputeChannelPSNR(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, unsigned numChannels)
+	{
+		std::vector<unsigned char> packedA;
+		std::vector<unsigned char> packedB;
+		for (size_t i = 0; i < a.size(); i += 4)
+		{
+			packedA.insert(packedA.end(), &a[i], &a[i] + numChannels);
+			packedB.insert(packedB.end(), &b[i], &b[i] + numChannels);
+		}
+
+		return ComputePSNR(packedA.data(), packedB.data(), packedA.size());
+	}
+
+	float RoundTrip(const std::vector<unsigned char>& image, unsigned width, unsigned height, TextureFormat format, unsigned numChannels)
+	{
+		std::vector<unsigned char> blocks;
+		CompressImage(image.data(), width, height, 4, format, blocks);
+		REQUIRE(blocks.size() == CountBytes(format, width, height));
+
+		std::vector<unsigned char> decoded;
+		REQUIRE(DecompressImage(blocks.data(), width, height, format, decoded));
+		REQUIRE(decoded.size() == image.size());
+
+		return ComputeChannelPSNR(image, decoded, numChannels);
+	}
+}
+
+TEST_CASE("Texture Compression")
+{
+	const unsigned width = 128;
+	const unsigned height = 96;
+	const auto image = MakeImage(width, height);
+
+	SECTION("Block Sizes")
+	{
+		CHECK(CountBytes(TextureFormat::RGB_BC1, 128, 96) == 32 * 24 * 8);
+		CHECK(CountBytes(TextureFormat::RGBA_BC7, 128, 96) == 32 * 24 * 16);
+		CHECK(CountBytes(TextureFormat::RG_BC5, 1, 1) == 16);
+		CHECK(CountBytes(TextureFormat::sRGBA_8, 5, 3) == 60);
+		CHECK(IsCompressed(TextureFormat::sRGBA_BC3));
+		CHECK(!IsCompressed(TextureFormat::sRGBA_8));
+	}
+
+	SECTION("BC1")
+	{
+		CHECK(RoundTrip(image, width, height, TextureFormat::RGB_BC1, 3) > 38.0f);
+	}
+
+	SECTION("BC3")
+	{
+		CHECK(RoundTrip(image, width, height, TextureFormat::RGBA_BC3, 3) > 38.0f);
+		CHECK(RoundTrip(image, width, height, TextureFormat::RGBA_BC3, 4) > 39.0f);
+	}
+
+	SECTION("BC5")
+	{
+		CHECK(RoundTrip(image, width, height, TextureFormat::RG_BC5, 2) > 44.0f);
+	}
+
+	SECTION("BC7")
+	{
+		const float psnr = RoundTrip(image, width, height, TextureFormat::RGBA_BC7, 4);
+		CHECK(psnr > 40.0f);
+		// Higher quality than BC3 at the same size.
+		CHECK(psnr > RoundTrip(image, width, height, TextureFormat::RGBA_BC3, 4));
+	}
+
+	SECTION("Solid Colors")
+	{
+		// Constant blocks are reproduced to within the precision of the endpoints.
+		const std::vector<unsigned char> solid = { 201, 13, 77, 140 };
+		std::vector<unsigned char> pixels;
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			pixels.insert(pixels.end(), solid.begin(), solid.end());
+		}
+
+		std::vector<unsigned char> blocks;
+		std::vector<unsigned char> decoded;
+		CompressImage(pixels.data(), 4, 4, 4, TextureFormat::RGBA_BC7, blocks);
+		REQUIRE(DecompressImage(blocks.data(), 4, 4, TextureFormat::RGBA_BC7, decoded));
+		for (unsigned i = 0; i < decoded.size(); ++i)
+		{
+			CHECK(std::abs(decoded[i] - pixels[i]) <= 1);
+		}
+
+		CompressImage(pixels.data(), 4, 4, 4, TextureFormat::RG_BC5, blocks);
+		REQUIRE(DecompressImage(blocks.data(), 4, 4, TextureFormat::RG_BC5, decoded));
+		CHECK(decoded[0] == 201);
+		CHECK(decoded[1] == 13);
+	}
+
+	SECTION("Partial Blocks")
+	{
+		// Sizes that are not a multiple of 4, as seen in the smallest mip levels.
+		const auto small = MakeImage(13, 7);
+		CHECK(RoundTrip(small, 13, 7, TextureFormat::RGBA_BC7, 4) > 36.0f);
+		CHECK(RoundTrip(small, 13, 7, TextureFormat::RGB_BC1, 3) > 34.0f);
+	}
+
+	SECTION("Three Channel Input")
+	{
+		std::vector<unsigned char> rgb;
+		for (size_t i = 0; i < image.size(); i += 4)
+		{
+			rgb.insert(rgb.end(), &image[i], &image[i] + 3);
+		}
+
+		std::vector<unsigned char> blocks;
+		std::vector<unsigned char> decoded;
+		CompressImage(rgb.data(), width, height, 3, TextureFormat::RGBA_BC7, blocks);
+		REQUIRE(DecompressImage(blocks.data(), width, height, TextureFormat::RGBA_BC7, decoded));
+
+		// Missing alpha is opaque.
+		CHECK(decoded[3] == 255);
+		CHECK(ComputeChannelPSNR(image, decoded, 3) > 40.0f);
+	}
+}
+
+TEST_CASE("Parallel Texture Processing")
+{
+	// Large enough to be split into many strips.
+	const unsigned size = 512;
+	const auto image = MakeImage(size, size);
+	ThreadPool pool(4);
+
+	SECTION("Compression")
+	{
+		for (TextureFormat format : { TextureFormat::RGB_BC1, TextureFormat::RGBA_BC3, TextureFormat::RG_BC5, TextureFormat::RGBA_BC7 })
+		{
+			std::vector<unsigned char> serial;
+			std::vector<unsigned char> parallel;
+			CompressImage(image.data(), size, size, 4, format, serial);
+			CompressImage(image.data(), size, size, 4, format, parallel, &pool);
+
+			CHECK(serial == parallel);
+		}
+	}
+
+	SECTION("Mip Generation")
+	{
+		std::vector<unsigned char> serial;
+		std::vector<unsigned char> parallel;
+		DownsampleImage(image.data(), size, size, 4, true, serial);
+		DownsampleImage(image.data(), size, size, 4, true, parallel, &pool);
+
+		CHECK(serial == parallel);
+	}
+}
+
+TEST_CASE("Mip Generation")
+{
+	// A checkerboard of black and white pixels.
+	std::vector<unsigned char> pixels(4 * 4 * 2);
+	for (unsigned i = 0; i < 16; ++i)
+	{
+		const unsigned char value = ((i % 4) + (i / 4)) % 2 ? 255 : 0;
+		pixels[i * 2] = value;
+		pixels[i * 2 + 1] = value;
+	}
+
+	SECTION("Linear")
+	{
+		std::vector<unsigned char> mip;
+		DownsampleImage(pixels.data(), 4, 4, 2, false, mip);
+
+		REQUIRE(mip.size() == 2 * 2 * 2);
+		CHECK(mip[0] == 128);
+	}
+
+	SECTION("sRGB")
+	{
+		// Half of the light of white is brighter than half of the sRGB value.
+		std::vector<unsigned char> mip;
+		DownsampleImage(pixels.data(), 4, 4, 2, true, mip);
+
+		REQUIRE(mip.size() == 2 * 2 * 2);
+		CHECK(mip[0] == 188);
+	}
+
+	SECTION("Alpha")
+	{
+		// The fourth channel is always filtered linearly.
+		std::vector<unsigned char> rgba(4 * 4 * 4);
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			const unsigned char value = ((i % 4) + (i / 4)) % 2 ? 255 : 0;
+			std::fill_n(&rgba[i * 4], 4, value);
+		}
+
+		std::vector<unsigned char> mip;
+		DownsampleImage(rgba.data(), 4, 4, 4, true, mip);
+		CHECK(mip[0] == 188);
+		CHECK(mip[3] == 128);
+	}
+
+	SECTION("Odd Sizes")
+	{
+		std::vector<unsigned char> mip;
+		DownsampleImage(pixels.data(), 4, 1, 2, false, mip);
+		CHECK(mip.size() == 2 * 1 * 2);
+
+		DownsampleImage(pixels.data(), 1, 1, 2, false, mip);
+		CHECK(mip.size() == 2);
+		CHECK(mip[0] == pixels[0]);
+	}
+}
@@ -0,0 +1,233 @@
+#include <catch.hpp>
+#include <Jewel3D/Resource/TextureResidency.h>
+
+#include <vector>
+
+using namespace Jwl;
+
+namespace
+{
+	// The level sizes of an uncompressed 256x256 RGBA texture. Levels from 64x64 down make up the 21844 byte tail.
+	const std::vector<size_t> levels = { 262144, 65536, 16384, 4096, 1024, 256, 64, 16, 4 };
+	const unsigned tail = 2;
+	const size_t tailSize = 21844;
+	const size_t fullSize = 349524;
+
+	unsigned CountLoads(const std::vector<TextureResidency::Change>& changes)
+	{
+		unsigned count = 0;
+		for (auto& change : changes)
+		{
+			count += change.isLoad;
+		}
+
+		return count;
+	}
+}
+
+TEST_CASE("Texture Residency")
+{
+	TextureResidency residency;
+
+	SECTION("Tails")
+	{
+		const unsigned a = residency.Add(levels, tail);
+		const unsigned b = residency.Add(levels, tail);
+
+		// Only the small levels are resident at first.
+		CHECK(a != b);
+		CHECK(residency.GetLevel(a) == tail);
+		CHECK(residency.GetCommittedBytes() == tailSize * 2);
+
+		// Nothing changes if nothing is requested.
+		CHECK(residency.Update(1).empty());
+
+		residency.Remove(a);
+		CHECK(residency.GetCommittedBytes() == tailSize);
+		CHECK(residency.GetCount() == 1);
+	}
+
+	SECTION("Loading")
+	{
+		const unsigned a = residency.Add(levels, tail);
+
+		// The most detailed request of the frame is the one that counts.
+		residency.Request(a, 1, 1);
+		residency.Request(a, 0, 1);
+		residency.Request(a, 5, 1);
+
+		auto changes = residency.Update(1);
+		REQUIRE(changes.size() == 1);
+		CHECK(changes[0].handle == a);
+		CHECK(changes[0].level == 0);
+		CHECK(changes[0].isLoad);
+
+		// The memory is reserved right away.
+		CHECK(residency.IsPending(a));
+		CHECK(residency.GetCommittedBytes() == fullSize);
+
+		// Requests are ignored until the load finishes.
+		residency.Request(a, 0, 2);
+		CHECK(residency.Update(2).empty());
+
+		residency.Complete(a, true);
+		CHECK(!residency.IsPending(a));
+		CHECK(residency.GetLevel(a) == 0);
+		CHECK(residency.GetCommittedBytes() == fullSize);
+
+		// Already resident.
+		residency.Request(a, 0, 3);
+		CHECK(residency.Update(3).empty());
+	}
+
+	SECTION("Failed Loads")
+	{
+		const unsigned a = residency.Add(levels, tail);
+		residency.Request(a, 0, 1);
+		REQUIRE(residency.Update(1).size() == 1);
+
+		residency.Complete(a, false);
+		CHECK(residency.GetLevel(a) == tail);
+		CHECK(residency.GetCommittedBytes() == tailSize);
+
+		// Completing a texture that was removed while loading is harmless.
+		residency.Request(a, 0, 2);
+		REQUIRE(residency.Update(2).size() == 1);
+		residency.Remove(a);
+		residency.Complete(a, true);
+		CHECK(residency.GetCommittedBytes() == 0);
+	}
+
+	SECTION("Requests Beyond The Tail")
+	{
+		const unsigned a = residency.Add(levels, tail);
+
+		// The tail is always resident, so smaller levels need no work.
+		residency.Request(a, 8, 1);
+		CHECK(residency.Update(1).empty());
+		CHECK(residency.GetLevel(a) == tail);
+	}
+
+	SECTION("Least Recently Used Eviction")
+	{
+		// Room for the tails and one full texture.
+		residency.SetBudget(tailSize * 3 + (fullSize - tailSize));
+
+		const unsigned a = residency.Add(levels, tail);
+		const unsigned b = residency.Add(levels, tail);
+		const unsigned c = residency.Add(levels, tail);
+
+		residency.Request(a, 0, 1);
+		REQUIRE(residency.Update(1).size() == 1);
+		residency.Complete(a, true);
+
+		// 'a' is no longer in view, so it makes room for 'b'.
+		residency.Request(b, 0, 2);
+		auto changes = residency.Update(2);
+		REQUIRE(changes.size() == 2);
+		CHECK(changes[0].handle == a);
+		CHECK(changes[0].level == tail);
+		CHECK(!changes[0].isLoad);
+		CHECK(changes[1].handle == b);
+		CHECK(changes[1].isLoad);
+		residency.Complete(b, true);
+
+		CHECK(residency.GetLevel(a) == tail);
+		CHECK(residency.GetCommittedBytes() <= residency.GetBudget());
+
+		// 'b' and 'c' are both in view, so 'c' only gets what is left over.
+		residency.Request(b, 0, 3);
+		residency.Request(c, 0, 3);
+		changes = residency.Update(3);
+		CHECK(CountLoads(changes) == 0);
+		CHECK(residency.GetLevel(b) == 0);
+		CHECK(residency.GetLevel(c) == tail);
+
+		// Once 'b' is only seen from afar, its extra levels are given to 'c'.
+		residency.Request(b, tail, 4);
+		residency.Request(c, 0, 4);
+		changes = residency.Update(4);
+		REQUIRE(changes.size() == 2);
+		CHECK(changes[0].handle == b);
+		CHECK(changes[0].level == tail);
+		CHECK(changes[1].handle == c);
+		CHECK(changes[1].level == 0);
+	}
+
+	SECTION("Eviction Order")
+	{
+		residency.SetBudget(tailSize * 3 + (fullSize - tailSize) * 2);
+
+		const unsigned a = residency.Add(levels, tail);
+		const unsigned b = residency.Add(levels, tail);
+		const unsigned c = residency.Add(levels, tail);
+
+		residency.Request(a, 0, 1);
+		residency.Update(1);
+		residency.Complete(a, true);
+
+		residency.Request(b, 0, 2);
+		residency.Update(2);
+		residency.Complete(b, true);
+
+		// 'a' was used longer ago than 'b'.
+		residency.Request(c, 0, 3);
+		auto changes = residency.Update(3);
+		REQUIRE(changes.size() == 2);
+		CHECK(changes[0].handle == a);
+		CHECK(!changes[0].isLoad);
+		CHECK(residency.GetLevel(b) == 0);
+	}
+
+	SECTION("Partial Loads")
+	{
+		// Room for the tail and the 128x128 level, but not the full texture.
+		residency.SetBudget(tailSize + 65536);
+
+		const unsigned a = residency.Add(levels, tail);
+		residency.Request(a, 0, 1);
+
+		auto changes = residency.Update(1);
+		REQUIRE(changes.size() == 1);
+		CHECK(changes[0].level == 1);
+		CHECK(residency.GetCommittedBytes() == tailSize + 65536);
+	}
+
+	SECTION("Priority")
+	{
+		// Room for one more 128x128 level.
+		residency.SetBudget(tailSize * 2 + 65536);
+
+		const unsigned a = residency.Add(levels, tail);
+		const unsigned b = residency.Add(levels, tail);
+
+		// 'b' is missing more detail, so it is served first. 'a' no longer fits.
+		residency.Request(a, 1, 1);
+		residency.Request(b, 0, 1);
+
+		auto changes = residency.Update(1);
+		REQUIRE(changes.size() == 1);
+		CHECK(changes[0].handle == b);
+		CHECK(changes[0].level == 1);
+	}
+
+	SECTION("Lowering The Budget")
+	{
+		const unsigned a = residency.Add(levels, tail);
+		const unsigned b = residency.Add(levels, tail);
+
+		residency.Request(a, 0, 1);
+		residency.Request(b, 0, 1);
+		REQUIRE(CountLoads(residency.Update(1)) == 2);
+		residency.Complete(a, true);
+		residency.Complete(b, true);
+
+		// The tails are kept even when they exceed the budget.
+		residency.SetBudget(0);
+		auto changes = residency.Update(2);
+		CHECK(changes.size() == 2);
+		CHECK(residency.GetLevel(a) == tail);
+		CHECK(residency.GetLevel(b) == tail);
+		CHECK(residency.GetCommittedBytes() == tailSize * 2);
+	}
+}
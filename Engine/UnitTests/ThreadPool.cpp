@@ -0,0 +1,49 @@
+#include <catch.hpp>
+#include <Jewel3D/Application/ThreadPool.h>
+
+#include <atomic>
+
+using namespace Jwl;
+
+TEST_CASE("ThreadPool")
+{
+	SECTION("Thread Count")
+	{
+		CHECK(ThreadPool(3).GetThreadCount() == 3);
+		CHECK(ThreadPool().GetThreadCount() >= 1);
+	}
+
+	SECTION("Wait")
+	{
+		ThreadPool pool(4);
+		std::atomic<unsigned> count = 0;
+
+		for (unsigned i = 0; i < 1000; ++i)
+		{
+			pool.Submit([&count] { ++count; });
+		}
+
+		pool.Wait();
+		CHECK(count == 1000);
+
+		// The pool can be reused after waiting.
+		pool.Submit([&count] { ++count; });
+		pool.Wait();
+		CHECK(count == 1001);
+	}
+
+	SECTION("Destruction")
+	{
+		std::atomic<unsigned> count = 0;
+		{
+			ThreadPool pool(2);
+			for (unsigned i = 0; i < 100; ++i)
+			{
+				pool.Submit([&count] { ++count; });
+			}
+		}
+
+		// Queued jobs are finished before the threads exit.
+		CHECK(count == 100);
+	}
+}
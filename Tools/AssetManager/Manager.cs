@@ -1,10 +1,13 @@
 ﻿// Copyright (c) 2017 Emilian Cioca
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Diagnostics;
 using System.Drawing;
 using System.IO;
 using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
 using System.Windows.Forms;
 
 namespace AssetManager
@@ -128,37 +131,134 @@ namespace AssetManager
 			if (!cache.ShouldPack(file))
 				return;
 
+			if (IsEncoded(file))
+			{
+				EncodeFiles(new List<string> { file });
+			}
+			else
+			{
+				CopyFile(file);
+			}
+		}
+
+		private bool IsEncoded(string file)
+		{
+			return encoders.ContainsKey(Path.GetExtension(file).Substring(1));
+		}
+
+		private void CopyFile(string file)
+		{
+			if (config.IsExtensionExcluded(Path.GetExtension(file).Substring(1)))
+				return;
+
 			string logName = file.Substring(inputPath.Length + 1);
-			string extension = Path.GetExtension(file).Substring(1);
+			var outFile = file.Replace(inputPath, outputPath);
 
-			if (encoders.ContainsKey(extension))
+			Log($"Copying:  {logName}");
+			File.Copy(file, outFile, true);
+		}
+
+		class EncodeResult
+		{
+			public string logName;
+			public int exitCode;
+			public List<string> output = new List<string>();
+		}
+
+		// Runs the encoders of several files at the same time, each in its own process.
+		// The output of each encoder is buffered and logged from the calling thread once it finishes, so that files are not interleaved.
+		private void EncodeFiles(List<string> files)
+		{
+			if (files.Count == 0)
+				return;
+
+			int parallelEncoders = Math.Min(config.GetParallelEncoders(), files.Count);
+			// Share the cores between the encoders that are running at the same time.
+			int threadsPerEncoder = Math.Max(1, Environment.ProcessorCount / parallelEncoders);
+
+			var results = new BlockingCollection<EncodeResult>();
+			var cancellation = new CancellationTokenSource();
+			var options = new ParallelOptions
 			{
-				Log($"Encoding: {logName}");
+				MaxDegreeOfParallelism = parallelEncoders,
+				CancellationToken = cancellation.Token
+			};
 
-				var outDir = Path.GetDirectoryName(file.Replace(inputPath, outputPath)) + Path.DirectorySeparatorChar;
+			var worker = Task.Run(() => {
+				try
+				{
+					Parallel.ForEach(files, options, file => results.Add(EncodeFile(file, threadsPerEncoder)));
+				}
+				catch (OperationCanceledException) {}
+				finally
+				{
+					results.CompleteAdding();
+				}
+			});
 
-				var process = encoders[extension];
-				process.StartInfo.Arguments = $"-pack -src \"{file}\" -dest \"{outDir}\\\"";
-				process.Start();
-				process.BeginOutputReadLine();
-				process.WaitForExit();
-				process.CancelOutputRead();
+			string failedFile = null;
+			foreach (var result in results.GetConsumingEnumerable())
+			{
+				Log($"Encoding: {result.logName}");
+				foreach (var line in result.output)
+					LogEncoder(line);
 
-				if (process.ExitCode != 0)
+				if (result.exitCode != 0 && failedFile == null)
 				{
-					throw new Exception($"Failed to encode: {logName}");
+					// Stop starting new files, but let the running encoders finish.
+					failedFile = result.logName;
+					cancellation.Cancel();
 				}
 			}
-			else
+
+			worker.Wait();
+
+			if (failedFile != null)
 			{
-				if (config.IsExtensionExcluded(extension))
-					return;
+				throw new Exception($"Failed to encode: {failedFile}");
+			}
+		}
+
+		// Safe to call from any thread.
+		private EncodeResult EncodeFile(string file, int numThreads)
+		{
+			var result = new EncodeResult { logName = file.Substring(inputPath.Length + 1) };
+			var outDir = Path.GetDirectoryName(file.Replace(inputPath, outputPath)) + Path.DirectorySeparatorChar;
+			var encoder = encoders[Path.GetExtension(file).Substring(1)];
+
+			try
+			{
+				using (var process = new Process())
+				{
+					process.StartInfo.FileName = encoder.StartInfo.FileName;
+					process.StartInfo.Arguments = $"-pack -src \"{file}\" -dest \"{outDir}\\\" -threads {numThreads}";
+					process.StartInfo.UseShellExecute = false;
+					process.StartInfo.RedirectStandardOutput = true;
+					process.StartInfo.CreateNoWindow = true;
+					process.OutputDataReceived += (sender, args) => {
+						if (args.Data == null)
+							return;
+
+						lock (result.output)
+							result.output.Add(args.Data);
+					};
 
-				var outFile = file.Replace(inputPath, outputPath);
+					process.Start();
+					process.BeginOutputReadLine();
+					process.WaitForExit();
 
-				Log($"Copying:  {logName}");
-				File.Copy(file, outFile, true);
+					result.exitCode = process.ExitCode;
+				}
 			}
+			catch (Exception e)
+			{
+				lock (result.output)
+					result.output.Add($"ERROR: {e.Message}");
+
+				result.exitCode = -1;
+			}
+
+			return result;
 		}
 
 		private void UpdateFile(string file)
@@ -241,8 +341,13 @@ namespace AssetManager
 			workspaceFiles.RemoveAll(x => x.EndsWith(".meta", StringComparison.InvariantCultureIgnoreCase));
 			try
 			{
-				foreach (string file in workspaceFiles)
-					PackFile(file);
+				// The cache is checked up front because the encoders run on several threads.
+				var changedFiles = workspaceFiles.Where(x => cache.ShouldPack(x)).ToList();
+
+				foreach (string file in changedFiles.Where(x => !IsEncoded(x)))
+					CopyFile(file);
+
+				EncodeFiles(changedFiles.Where(IsEncoded).ToList());
 
 				Log(">>>>>> Finished Packing <<<<<<", ConsoleColor.Green);
 				result = true;
@@ -17,6 +17,8 @@ namespace AssetManager
 	{
 		public string outputDirectory;
 		public string excludedExtensions;
+		// The number of assets that can be encoded at the same time. 0 uses one per core.
+		public int parallelEncoders;
 
 		[System.NonSerialized()]
 		private string[] _excludedExtensions;
@@ -36,9 +38,15 @@ namespace AssetManager
 
 			outputDirectory = "../Assets";
 			excludedExtensions = "";
+			parallelEncoders = 0;
 			_excludedExtensions = new string[0];
 		}
 
+		public int GetParallelEncoders()
+		{
+			return parallelEncoders > 0 ? parallelEncoders : System.Environment.ProcessorCount;
+		}
+
 		public bool IsExtensionExcluded(string extension)
 		{
 			return _excludedExtensions.Contains(extension);
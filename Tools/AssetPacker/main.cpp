@@ -0,0 +1,93 @@
+#include "Jewel3D/Application/Archive.h"
+#include "Jewel3D/Application/CmdArgs.h"
+#include "Jewel3D/Application/FileSystem.h"
+#include "Jewel3D/Application/Logging.h"
+#include "Jewel3D/Utilities/String.h"
+
+#include <cstdlib>
+
+namespace
+{
+	// Adds every file under the directory to the archive, named relative to the root of the search.
+	bool AddDirectory(Jwl::ArchiveWriter& writer, const std::string& directory, const std::string& prefix, bool compress)
+	{
+		Jwl::DirectoryData data;
+		if (!Jwl::ParseDirectory(data, directory))
+		{
+			Jwl::Error("Could not read directory ( %s ).", directory.c_str());
+			return false;
+		}
+
+		for (auto& file : data.files)
+		{
+			// Metadata and build records are only needed by the encoders.
+			const std::string extension = Jwl::ExtractFileExtension(file);
+			if (Jwl::CompareLowercase(extension, ".meta") || Jwl::CompareLowercase(extension, ".build"))
+			{
+				continue;
+			}
+
+			if (!writer.AddFile(prefix + file, directory + file, compress))
+			{
+				return false;
+			}
+		}
+
+		for (auto& folder : data.folders)
+		{
+			if (!AddDirectory(writer, directory + folder + "/", prefix + folder + "/", compress))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+int main()
+{
+	const char* usage =
+		"Jewel3D asset packer.\nUsage:\n"
+		"  AssetPacker.exe -src <folder> -dest <file> [-compress]\n"
+		"Options:\n"
+		"  -src        The folder of encoded assets to pack, such as an encoder's output folder.\n"
+		"  -dest       The archive to create.\n"
+		"  -compress   Compress entries with LZ4 when it makes them smaller.";
+
+	std::string src;
+	if (!Jwl::GetCommandLineArg("-src", src))
+	{
+		Jwl::Error("Invalid command line parameters: Missing '-src <folder>'");
+		Jwl::Log(usage);
+		return EXIT_FAILURE;
+	}
+
+	const char* dest = nullptr;
+	if (!Jwl::GetCommandLineArg("-dest", dest))
+	{
+		Jwl::Error("Invalid command line parameters: Missing '-dest <file>'");
+		Jwl::Log(usage);
+		return EXIT_FAILURE;
+	}
+
+	if (src.back() != '/' && src.back() != '\\')
+	{
+		src.push_back('/');
+	}
+
+	Jwl::ArchiveWriter writer;
+	if (!AddDirectory(writer, src, "", Jwl::HasCommandLineArg("-compress")))
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (!writer.Save(dest))
+	{
+		return EXIT_FAILURE;
+	}
+
+	Jwl::Log("Packed %u files into ( %s ).", writer.GetEntryCount(), dest);
+
+	return EXIT_SUCCESS;
+}
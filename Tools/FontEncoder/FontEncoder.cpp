@@ -16,7 +16,7 @@ struct CharData
 };
 
 FontEncoder::FontEncoder()
-	: Encoder(CURRENT_VERSION)
+	: Encoder(CURRENT_VERSION, ".font")
 {
 }
 
@@ -118,7 +118,7 @@ bool FontEncoder::Validate(const Jwl::ConfigTable& metadata, unsigned loadedVers
 
 bool FontEncoder::Convert(std::string_view source, std::string_view destination, const Jwl::ConfigTable& metadata) const
 {
-	const std::string outputFile = std::string(destination) + Jwl::ExtractFilename(source) + ".font";
+	const std::string outputFile = GetOutputFile(source, destination);
 	const unsigned width = static_cast<unsigned>(metadata.GetInt("width"));
 	const unsigned height = static_cast<unsigned>(metadata.GetInt("height"));
 
@@ -4,7 +4,7 @@
 #define CURRENT_VERSION 1
 
 MaterialEncoder::MaterialEncoder()
-	: Jwl::Encoder(CURRENT_VERSION)
+	: Jwl::Encoder(CURRENT_VERSION, ".material")
 {
 }
 
@@ -179,7 +179,7 @@ bool MaterialEncoder::Validate(const Jwl::ConfigTable& metadata, unsigned loaded
 
 bool MaterialEncoder::Convert(std::string_view source, std::string_view destination, const Jwl::ConfigTable& metadata) const
 {
-	const std::string outputFile = std::string(destination) + Jwl::ExtractFilename(source) + ".material";
+	const std::string outputFile = GetOutputFile(source, destination);
 	const std::string shader = metadata.GetString("shader");
 	const std::vector<int> units = metadata.GetIntArray("texture_bind_points");
 	const std::vector<std::string> textures = metadata.GetStringArray("textures");
@@ -1,17 +1,23 @@
 // Copyright (c) 2017 Emilian Cioca
 #include "MeshEncoder.h"
 
+#include "Jewel3D/Math/Math.h"
 #include "Jewel3D/Math/Matrix.h"
 #include "Jewel3D/Math/Vector.h"
 #include "Jewel3D/Resource/Encoder.h"
+#include "Jewel3D/Resource/Model.h"
+#include "Jewel3D/Utilities/MeshOptimization.h"
+#include "Jewel3D/Utilities/ObjParser.h"
+#include "Jewel3D/Utilities/String.h"
 
-#include <fstream>
+#include <array>
+#include <map>
 #include <vector>
 
-#define CURRENT_VERSION 2
-#define CHAR_BUFFER_SIZE 128
+#define CURRENT_VERSION 4
+#define MAX_LODS 8
 
-// Indices for three points; one triangle. v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3
+// Zero-based indices for three points; one triangle. v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3
 struct MeshFace
 {
 	unsigned vertices[3];
@@ -23,8 +29,100 @@ struct MeshFace
 	Jwl::vec4 tangent[3];
 };
 
+namespace
+{
+	// Converts to a 16-bit float, rounding to the nearest value.
+	unsigned short FloatToHalf(float value)
+	{
+		unsigned bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		const unsigned sign = (bits >> 16) & 0x8000;
+		const int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+		unsigned mantissa = bits & 0x7FFFFF;
+
+		if (exponent >= 31)
+		{
+			// Overflow to infinity, preserving NaN.
+			const bool isNaN = ((bits >> 23) & 0xFF) == 0xFF && mantissa != 0;
+			return static_cast<unsigned short>(sign | 0x7C00 | (isNaN ? 0x200 : 0));
+		}
+
+		if (exponent <= 0)
+		{
+			// Too small for a normal half. Produce a subnormal, or zero.
+			if (exponent < -10)
+			{
+				return static_cast<unsigned short>(sign);
+			}
+
+			mantissa |= 0x800000;
+			const unsigned shift = static_cast<unsigned>(14 - exponent);
+			const unsigned half = (mantissa >> shift) + ((mantissa >> (shift - 1)) & 1);
+			return static_cast<unsigned short>(sign | half);
+		}
+
+		// Rounding may carry into the exponent, which correctly rounds up to the next power of two or infinity.
+		const unsigned half = (static_cast<unsigned>(exponent) << 10) + (mantissa >> 13) + ((mantissa >> 12) & 1);
+		return static_cast<unsigned short>(sign | half);
+	}
+
+	unsigned short FloatToUnorm16(float value)
+	{
+		return static_cast<unsigned short>(Jwl::Clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+	}
+
+	// Packs a signed normalized vector into 10:10:10:2 bits. 'w' must be -1, 0, or 1.
+	unsigned PackSnorm10(const Jwl::vec3& v, float w)
+	{
+		auto pack10 = [](float value) {
+			const int scaled = static_cast<int>(std::round(Jwl::Clamp(value, -1.0f, 1.0f) * 511.0f));
+			return static_cast<unsigned>(scaled) & 0x3FF;
+		};
+
+		// -2 decodes as -1 under both the older and newer OpenGL conversion rules, while -1 does not.
+		const int packedW = w < 0.0f ? -2 : (w > 0.0f ? 1 : 0);
+
+		return pack10(v.x) | (pack10(v.y) << 10) | (pack10(v.z) << 20) | ((static_cast<unsigned>(packedW) & 0x3) << 30);
+	}
+
+	bool ParseEncoding(const Jwl::ConfigTable& metadata, const char* setting, Jwl::VertexEncoding& out)
+	{
+		auto str = metadata.GetString(setting);
+		if (Jwl::CompareLowercase(str, "float"))
+		{
+			out = Jwl::VertexEncoding::Float;
+		}
+		else if (Jwl::CompareLowercase(str, "half"))
+		{
+			out = Jwl::VertexEncoding::Half;
+		}
+		else if (Jwl::CompareLowercase(str, "unorm16"))
+		{
+			out = Jwl::VertexEncoding::Unorm16;
+		}
+		else if (Jwl::CompareLowercase(str, "snorm10"))
+		{
+			out = Jwl::VertexEncoding::Snorm10;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	void Append(std::vector<unsigned char>& buffer, const T& value)
+	{
+		auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+		buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+	}
+}
+
 MeshEncoder::MeshEncoder()
-	: Encoder(CURRENT_VERSION)
+	: Encoder(CURRENT_VERSION, ".model", Jwl::MODEL_VERSION)
 {
 }
 
@@ -37,6 +135,11 @@ Jwl::ConfigTable MeshEncoder::GetDefault() const
 	defaultConfig.SetValue("uvs", true);
 	defaultConfig.SetValue("normals", true);
 	defaultConfig.SetValue("tangents", true);
+	defaultConfig.SetValue("position_format", "float");
+	defaultConfig.SetValue("uv_format", "float");
+	defaultConfig.SetValue("normal_format", "float");
+	defaultConfig.SetValue("lod_count", 1);
+	defaultConfig.SetValue("lod_reduction", 0.5f);
 
 	return defaultConfig;
 }
@@ -61,6 +164,25 @@ bool MeshEncoder::Validate(const Jwl::ConfigTable& metadata, unsigned loadedVers
 		return false;
 	}
 
+	auto validateFormat = [](const Jwl::ConfigTable& data, const char* setting, std::initializer_list<Jwl::VertexEncoding> supported, const char* options)
+	{
+		if (!data.HasSetting(setting))
+		{
+			Jwl::Error("Missing \"%s\" value.", setting);
+			return false;
+		}
+
+		Jwl::VertexEncoding encoding;
+		if (!ParseEncoding(data, setting, encoding) ||
+			std::find(supported.begin(), supported.end(), encoding) == supported.end())
+		{
+			Jwl::Error("\"%s\" is invalid. Valid options are %s.", setting, options);
+			return false;
+		}
+
+		return true;
+	};
+
 	switch (loadedVersion)
 	{
 	case 1:
@@ -84,6 +206,60 @@ bool MeshEncoder::Validate(const Jwl::ConfigTable& metadata, unsigned loadedVers
 			return false;
 		}
 		break;
+
+	case 3:
+	case 4:
+		if (!metadata.HasSetting("tangents"))
+		{
+			Jwl::Error("Missing \"tangents\" value.");
+			return false;
+		}
+
+		using Jwl::VertexEncoding;
+		if (!validateFormat(metadata, "position_format", { VertexEncoding::Float, VertexEncoding::Unorm16 }, "\"float\" or \"unorm16\"")) return false;
+		if (!validateFormat(metadata, "uv_format", { VertexEncoding::Float, VertexEncoding::Half, VertexEncoding::Unorm16 }, "\"float\", \"half\", or \"unorm16\"")) return false;
+		if (!validateFormat(metadata, "normal_format", { VertexEncoding::Float, VertexEncoding::Snorm10 }, "\"float\" or \"snorm10\"")) return false;
+
+		if (loadedVersion == 3)
+		{
+			if (metadata.GetSize() != 8)
+			{
+				Jwl::Error("Incorrect number of value entries.");
+				return false;
+			}
+			break;
+		}
+
+		if (!metadata.HasSetting("lod_count"))
+		{
+			Jwl::Error("Missing \"lod_count\" value.");
+			return false;
+		}
+
+		if (!metadata.HasSetting("lod_reduction"))
+		{
+			Jwl::Error("Missing \"lod_reduction\" value.");
+			return false;
+		}
+
+		if (metadata.GetInt("lod_count") < 1 || metadata.GetInt("lod_count") > MAX_LODS)
+		{
+			Jwl::Error("\"lod_count\" must be in the range of [1, %d].", MAX_LODS);
+			return false;
+		}
+
+		if (metadata.GetFloat("lod_reduction") <= 0.0f || metadata.GetFloat("lod_reduction") >= 1.0f)
+		{
+			Jwl::Error("\"lod_reduction\" must be greater than 0 and less than 1.");
+			return false;
+		}
+
+		if (metadata.GetSize() != 10)
+		{
+			Jwl::Error("Incorrect number of value entries.");
+			return false;
+		}
+		break;
 	}
 
 	return true;
@@ -91,151 +267,57 @@ bool MeshEncoder::Validate(const Jwl::ConfigTable& metadata, unsigned loadedVers
 
 bool MeshEncoder::Convert(std::string_view source, std::string_view destination, const Jwl::ConfigTable& metadata) const
 {
-	const std::string outputFile = std::string(destination) + Jwl::ExtractFilename(source) + ".model";
+	const std::string outputFile = GetOutputFile(source, destination);
 	const float scale = metadata.GetFloat("scale");
 	const bool packUvs = metadata.GetBool("uvs");
 	const bool packNormals = metadata.GetBool("normals");
 	const bool packTangents = metadata.GetBool("tangents");
+	const unsigned lodCount = static_cast<unsigned>(metadata.GetInt("lod_count"));
+	const float lodReduction = metadata.GetFloat("lod_reduction");
+
+	Jwl::VertexEncoding positionEncoding;
+	Jwl::VertexEncoding uvEncoding;
+	Jwl::VertexEncoding normalEncoding;
+	ParseEncoding(metadata, "position_format", positionEncoding);
+	ParseEncoding(metadata, "uv_format", uvEncoding);
+	ParseEncoding(metadata, "normal_format", normalEncoding);
 
 	// Load ASCII file.
-	std::ifstream input;
-	input.open(source.data());
-	if (!input)
+	Jwl::ObjMesh obj;
+	if (!Jwl::LoadObj(source, obj))
 	{
 		Jwl::Error("Input file could not be opened or processed.");
 		return false;
 	}
 
-	char inputString[CHAR_BUFFER_SIZE] = { '\0' };
-	bool hasUvs = false;
-	bool hasNormals = false;
-
-	// Unique data.
-	std::vector<Jwl::vec3> vertexData;
-	std::vector<Jwl::vec2> textureData;
-	std::vector<Jwl::vec3> normalData;
-	// Indexing data.
-	std::vector<MeshFace> faceData;
-
-	Jwl::vec3 minBounds{ FLT_MAX };
-	Jwl::vec3 maxBounds{ FLT_MIN };
+	std::vector<Jwl::vec3>& vertexData = obj.positions;
+	const std::vector<Jwl::vec2>& textureData = obj.uvs;
+	const std::vector<Jwl::vec3>& normalData = obj.normals;
 
-	while (!input.eof())
+	// Attributes are only used if every face provides them.
+	bool hasUvs = !textureData.empty();
+	bool hasNormals = !normalData.empty();
+	for (auto& corner : obj.corners)
 	{
-		input.getline(inputString, CHAR_BUFFER_SIZE);
-
-		if (inputString[0] == 'v')
-		{
-			if (inputString[1] == 't')
-			{
-				hasUvs = true;
-
-				if (!(packUvs || packTangents))
-					continue;
-
-				// Load texture coordinates.
-				char* endPtr;
-				Jwl::vec2 temp;
-				temp.x = std::strtof(inputString + 3, &endPtr);
-				temp.y = std::strtof(endPtr + 1, nullptr);
-
-				textureData.push_back(temp);
-			}
-			else if (inputString[1] == 'n')
-			{
-				hasNormals = true;
-
-				if (!(packNormals || packTangents))
-					continue;
-
-				// Load normals.
-				char* endPtr;
-				Jwl::vec3 temp;
-				temp.x = std::strtof(inputString + 3, &endPtr);
-				temp.y = std::strtof(endPtr + 1, &endPtr);
-				temp.z = std::strtof(endPtr + 1, nullptr);
+		hasUvs &= corner.uv != -1;
+		hasNormals &= corner.normal != -1;
+	}
 
-				normalData.push_back(temp);
-			}
-			else
-			{
-				// Load vertices.
-				char* endPtr;
-				Jwl::vec3 temp;
-				temp.x = std::strtof(inputString + 2, &endPtr);
-				temp.y = std::strtof(endPtr + 1, &endPtr);
-				temp.z = std::strtof(endPtr + 1, nullptr);
-
-				if (temp.x < minBounds.x) minBounds.x = temp.x;
-				if (temp.y < minBounds.y) minBounds.y = temp.y;
-				if (temp.z < minBounds.z) minBounds.z = temp.z;
-
-				if (temp.x > maxBounds.x) maxBounds.x = temp.x;
-				if (temp.y > maxBounds.y) maxBounds.y = temp.y;
-				if (temp.z > maxBounds.z) maxBounds.z = temp.z;
-
-				vertexData.push_back(temp);
-			}
-		}
-		else if (inputString[0] == 'f')
+	// Indexing data.
+	std::vector<MeshFace> faceData(obj.corners.size() / 3);
+	for (unsigned i = 0; i < faceData.size(); ++i)
+	{
+		for (unsigned j = 0; j < 3; ++j)
 		{
-			// Load face indices.
-			MeshFace face;
-			char* endPtr;
-
-			// Each permutation of data formats.
-			if (hasUvs && hasNormals)
-			{
-				// Format of "f #/#/# #/#/# #/#/#"
-				face.vertices[0] = std::strtol(inputString + 2, &endPtr, 10);
-				face.textures[0] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.normals[0] = std::strtol(endPtr + 1, &endPtr, 10);
-
-				face.vertices[1] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.textures[1] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.normals[1] = std::strtol(endPtr + 1, &endPtr, 10);
-
-				face.vertices[2] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.textures[2] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.normals[2] = std::strtol(endPtr + 1, nullptr, 10);
-			}
-			else if (hasUvs && !hasNormals)
-			{
-				// Format: "f #/# #/# #/#"
-				face.vertices[0] = std::strtol(inputString + 2, &endPtr, 10);
-				face.textures[0] = std::strtol(endPtr + 1, &endPtr, 10);
-
-				face.vertices[1] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.textures[1] = std::strtol(endPtr + 1, &endPtr, 10);
-
-				face.vertices[2] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.textures[2] = std::strtol(endPtr + 1, nullptr, 10);
-			}
-			else if (!hasUvs && hasNormals)
-			{
-				// Format: "f #//# #//# #//#"
-				face.vertices[0] = std::strtol(inputString + 2, &endPtr, 10);
-				face.normals[0] = std::strtol(endPtr + 2, &endPtr, 10);
-
-				face.vertices[1] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.normals[1] = std::strtol(endPtr + 2, &endPtr, 10);
-
-				face.vertices[2] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.normals[2] = std::strtol(endPtr + 2, nullptr, 10);
-			}
-			else
-			{
-				// Format: "f # # #"
-				face.vertices[0] = std::strtol(inputString + 2, &endPtr, 10);
-				face.vertices[1] = std::strtol(endPtr + 1, &endPtr, 10);
-				face.vertices[2] = std::strtol(endPtr + 1, nullptr, 10);
-			}
-
-			faceData.push_back(face);
+			const Jwl::ObjCorner& corner = obj.corners[i * 3 + j];
+			faceData[i].vertices[j] = corner.position;
+			faceData[i].textures[j] = corner.uv;
+			faceData[i].normals[j] = corner.normal;
 		}
 	}
 
-	input.close();
+	obj.corners.clear();
+	obj.corners.shrink_to_fit();
 
 	// Apply scale.
 	if (scale != 1.0f)
@@ -246,6 +328,23 @@ bool MeshEncoder::Convert(std::string_view source, std::string_view destination,
 		}
 	}
 
+	// Bounds are computed after scaling so that they match the output.
+	Jwl::vec3 minBounds{ vertexData.empty() ? 0.0f : FLT_MAX };
+	Jwl::vec3 maxBounds{ vertexData.empty() ? 0.0f : -FLT_MAX };
+	for (auto& vertex : vertexData)
+	{
+		if (vertex.x < minBounds.x) minBounds.x = vertex.x;
+		if (vertex.y < minBounds.y) minBounds.y = vertex.y;
+		if (vertex.z < minBounds.z) minBounds.z = vertex.z;
+
+		if (vertex.x > maxBounds.x) maxBounds.x = vertex.x;
+		if (vertex.y > maxBounds.y) maxBounds.y = vertex.y;
+		if (vertex.z > maxBounds.z) maxBounds.z = vertex.z;
+	}
+
+	// Quantized positions are stored relative to the bounds.
+	const Jwl::vec3 quantizationScale = Jwl::Model::GetQuantizationScale(minBounds, maxBounds);
+
 	const bool useUvs = packUvs && hasUvs;
 	const bool useNormals = packNormals && hasNormals;
 	const bool useTangents = packTangents && hasUvs && hasNormals;
@@ -256,20 +355,20 @@ bool MeshEncoder::Convert(std::string_view source, std::string_view destination,
 		for (unsigned i = 0; i < faceData.size(); ++i)
 		{
 			const Jwl::vec3 edge1 =
-				vertexData[faceData[i].vertices[0] - 1] -
-				vertexData[faceData[i].vertices[1] - 1];
+				vertexData[faceData[i].vertices[0]] -
+				vertexData[faceData[i].vertices[1]];
 
 			const Jwl::vec3 edge2 =
-				vertexData[faceData[i].vertices[0] - 1] -
-				vertexData[faceData[i].vertices[2] - 1];
+				vertexData[faceData[i].vertices[0]] -
+				vertexData[faceData[i].vertices[2]];
 
 			const Jwl::vec2 edgeUV1 =
-				textureData[faceData[i].textures[0] - 1] -
-				textureData[faceData[i].textures[1] - 1];
+				textureData[faceData[i].textures[0]] -
+				textureData[faceData[i].textures[1]];
 
 			const Jwl::vec2 edgeUV2 =
-				textureData[faceData[i].textures[0] - 1] -
-				textureData[faceData[i].textures[2] - 1];
+				textureData[faceData[i].textures[0]] -
+				textureData[faceData[i].textures[2]];
 
 			const Jwl::mat2 UVs = Jwl::mat2(
 				edgeUV1.x, edgeUV1.y,
@@ -288,7 +387,7 @@ bool MeshEncoder::Convert(std::string_view source, std::string_view destination,
 			// Each face's tangent is further refined per-vertex by using their respective normals.
 			for (unsigned v = 0; v < 3; ++v)
 			{
-				const Jwl::vec3 normal = normalData[faceData[i].normals[v] - 1];
+				const Jwl::vec3 normal = normalData[faceData[i].normals[v]];
 
 				// Calculate handedness.
 				const float handedness = Jwl::Dot(Jwl::Cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
@@ -299,52 +398,199 @@ bool MeshEncoder::Convert(std::string_view source, std::string_view destination,
 				faceData[i].tangent[v] = Jwl::vec4(t, handedness);
 			}
 		}
+
+		// Faces sharing a vertex average their tangents so that the vertex can be welded into one.
+		std::map<std::array<unsigned, 4>, Jwl::vec3> sharedTangents;
+		auto key = [](const MeshFace& face, unsigned v) {
+			return std::array<unsigned, 4>{ face.vertices[v], face.textures[v], face.normals[v], face.tangent[v].w < 0.0f ? 1u : 0u };
+		};
+
+		for (auto& face : faceData)
+		{
+			for (unsigned v = 0; v < 3; ++v)
+			{
+				sharedTangents[key(face, v)] += Jwl::vec3(face.tangent[v]);
+			}
+		}
+
+		for (auto& face : faceData)
+		{
+			for (unsigned v = 0; v < 3; ++v)
+			{
+				const Jwl::vec3& sum = sharedTangents[key(face, v)];
+				if (Jwl::Length(sum) > 0.0f)
+				{
+					face.tangent[v] = Jwl::vec4(Jwl::Normalize(sum), face.tangent[v].w);
+				}
+			}
+		}
 	}
 
-	const unsigned numVertices = faceData.size() * 3;
-	unsigned bufferSize = numVertices * 3;
-	if (useUvs) bufferSize += numVertices * 2;
-	if (useNormals) bufferSize += numVertices * 3;
-	if (useTangents) bufferSize += numVertices * 4;
+	Jwl::Model::StreamData layout;
+	layout.hasUvs = useUvs;
+	layout.hasNormals = useNormals;
+	layout.hasTangents = useTangents;
+	layout.positionEncoding = positionEncoding;
+	layout.uvEncoding = uvEncoding;
+	layout.normalEncoding = normalEncoding;
+
+	const unsigned vertexSize = Jwl::Model::GetVertexSize(layout);
+	std::vector<unsigned char> vertices;
+	vertices.reserve(faceData.size() * 3 * vertexSize);
 
-	float* data = static_cast<float*>(malloc(sizeof(float) * bufferSize));
-	defer{ free(data); };
+	bool uvsClamped = false;
 
-	// Unpack the data.
-	unsigned pen = 0;
+	// Unpack and encode the data.
 	for (unsigned i = 0; i < faceData.size(); ++i)
 	{
 		for (unsigned j = 0; j < 3; ++j)
 		{
-			data[pen++] = vertexData[faceData[i].vertices[j] - 1].x;
-			data[pen++] = vertexData[faceData[i].vertices[j] - 1].y;
-			data[pen++] = vertexData[faceData[i].vertices[j] - 1].z;
+			const Jwl::vec3& position = vertexData[faceData[i].vertices[j]];
+			if (positionEncoding == Jwl::VertexEncoding::Unorm16)
+			{
+				const Jwl::vec3 normalized = (position - minBounds) / quantizationScale;
+				Append(vertices, FloatToUnorm16(normalized.x));
+				Append(vertices, FloatToUnorm16(normalized.y));
+				Append(vertices, FloatToUnorm16(normalized.z));
+				Append(vertices, FloatToUnorm16(1.0f));
+			}
+			else
+			{
+				Append(vertices, position);
+			}
 
 			if (useUvs)
 			{
-				data[pen++] = textureData[faceData[i].textures[j] - 1].x;
-				data[pen++] = textureData[faceData[i].textures[j] - 1].y;
+				const Jwl::vec2& uv = textureData[faceData[i].textures[j]];
+				if (uvEncoding == Jwl::VertexEncoding::Half)
+				{
+					Append(vertices, FloatToHalf(uv.x));
+					Append(vertices, FloatToHalf(uv.y));
+				}
+				else if (uvEncoding == Jwl::VertexEncoding::Unorm16)
+				{
+					uvsClamped |= uv.x < 0.0f || uv.x > 1.0f || uv.y < 0.0f || uv.y > 1.0f;
+					Append(vertices, FloatToUnorm16(uv.x));
+					Append(vertices, FloatToUnorm16(uv.y));
+				}
+				else
+				{
+					Append(vertices, uv);
+				}
 			}
 
 			if (useNormals)
 			{
-				data[pen++] = normalData[faceData[i].normals[j] - 1].x;
-				data[pen++] = normalData[faceData[i].normals[j] - 1].y;
-				data[pen++] = normalData[faceData[i].normals[j] - 1].z;
+				const Jwl::vec3& normal = normalData[faceData[i].normals[j]];
+				if (normalEncoding == Jwl::VertexEncoding::Snorm10)
+				{
+					Append(vertices, PackSnorm10(Jwl::Normalize(normal), 0.0f));
+				}
+				else
+				{
+					Append(vertices, normal);
+				}
 			}
 
 			if (useTangents)
 			{
-				data[pen++] = faceData[i].tangent[j].x;
-				data[pen++] = faceData[i].tangent[j].y;
-				data[pen++] = faceData[i].tangent[j].z;
-				data[pen++] = faceData[i].tangent[j].w;
+				const Jwl::vec4& tangent = faceData[i].tangent[j];
+				if (normalEncoding == Jwl::VertexEncoding::Snorm10)
+				{
+					Append(vertices, PackSnorm10(Jwl::vec3(tangent), tangent.w));
+				}
+				else
+				{
+					Append(vertices, tangent);
+				}
 			}
 		}
 	}
 
-	// Save file.
-	FILE* modelFile = fopen(outputFile.c_str(), "wb");
+	// Weld identical vertices.
+	std::vector<unsigned> indices;
+	Jwl::WeldVertices(vertices, vertexSize, indices);
+
+	const unsigned numVertices = static_cast<unsigned>(vertices.size() / vertexSize);
+	const float acmrBefore = Jwl::ComputeACMR(indices, numVertices);
+
+	// Each level of detail is simplified from the previous one. They all share the same vertices.
+	std::vector<std::vector<unsigned>> lodIndices = { std::move(indices) };
+	std::vector<float> lodErrors = { 0.0f };
+	if (lodCount > 1)
+	{
+		std::vector<Jwl::vec3> positions(numVertices);
+		for (unsigned i = 0; i < lodIndices[0].size(); ++i)
+		{
+			positions[lodIndices[0][i]] = vertexData[faceData[i / 3].vertices[i % 3]];
+		}
+
+		while (lodIndices.size() < lodCount)
+		{
+			const auto& previous = lodIndices.back();
+			const unsigned target = static_cast<unsigned>(previous.size() / 3 * lodReduction) * 3;
+			if (target == 0)
+			{
+				break;
+			}
+
+			std::vector<unsigned> simplified;
+			const float error = Jwl::SimplifyMesh(previous, positions, target, simplified);
+
+			// Stop once the mesh cannot be meaningfully reduced any further, such as when only borders and seams remain.
+			if (simplified.size() > previous.size() - (previous.size() - target) / 4)
+			{
+				Jwl::Warning("Only %u of the %u requested levels of detail could be generated.", static_cast<unsigned>(lodIndices.size()), lodCount);
+				break;
+			}
+
+			lodErrors.push_back(lodErrors.back() + error);
+			lodIndices.push_back(std::move(simplified));
+		}
+	}
+
+	// Order each level for the GPU's vertex cache, then order the shared vertices for fetching.
+	std::vector<Jwl::Model::Lod> lods;
+	indices.clear();
+	for (unsigned i = 0; i < lodIndices.size(); ++i)
+	{
+		Jwl::OptimizeVertexCache(lodIndices[i], numVertices);
+
+		Jwl::Model::Lod lod;
+		lod.firstIndex = static_cast<unsigned>(indices.size());
+		lod.indexCount = static_cast<unsigned>(lodIndices[i].size());
+		lod.error = lodErrors[i];
+		lods.push_back(lod);
+
+		indices.insert(indices.end(), lodIndices[i].begin(), lodIndices[i].end());
+	}
+
+	Jwl::OptimizeVertexFetch(vertices, vertexSize, indices);
+
+	const unsigned numIndices = static_cast<unsigned>(indices.size());
+	const unsigned numLods = static_cast<unsigned>(lods.size());
+
+	Jwl::Log("Welded %u vertices into %u. ACMR: %.3f -> %.3f", lods[0].indexCount, numVertices, acmrBefore, Jwl::ComputeACMR(lodIndices[0], numVertices));
+	for (unsigned i = 1; i < numLods; ++i)
+	{
+		Jwl::Log("LOD %u: %u triangles, error %g", i, lods[i].indexCount / 3, lods[i].error);
+	}
+
+	// Indices are stored with 16 bits whenever every vertex can be addressed that way.
+	const bool useShortIndices = numVertices <= 0x10000;
+	std::vector<unsigned short> shortIndices;
+	if (useShortIndices)
+	{
+		shortIndices.reserve(indices.size());
+		for (unsigned index : indices)
+		{
+			shortIndices.push_back(static_cast<unsigned short>(index));
+		}
+	}
+
+	// Save file. It is written beside the output first, since the engine might have the old one mapped.
+	const std::string tempFile = outputFile + ".tmp";
+	FILE* modelFile = fopen(tempFile.c_str(), "wb");
 	if (modelFile == nullptr)
 	{
 		Jwl::Error("Output file could not be created.");
@@ -352,20 +598,42 @@ bool MeshEncoder::Convert(std::string_view source, std::string_view destination,
 	}
 
 	// Write header.
+	fwrite(Jwl::MODEL_MAGIC, sizeof(Jwl::MODEL_MAGIC), 1, modelFile);
+	fwrite(&Jwl::MODEL_VERSION, sizeof(unsigned), 1, modelFile);
 	fwrite(&minBounds, sizeof(Jwl::vec3), 1, modelFile);
 	fwrite(&maxBounds, sizeof(Jwl::vec3), 1, modelFile);
 	fwrite(&useUvs, sizeof(bool), 1, modelFile);
 	fwrite(&useNormals, sizeof(bool), 1, modelFile);
 	fwrite(&useTangents, sizeof(bool), 1, modelFile);
+	fwrite(&positionEncoding, sizeof(Jwl::VertexEncoding), 1, modelFile);
+	fwrite(&uvEncoding, sizeof(Jwl::VertexEncoding), 1, modelFile);
+	fwrite(&normalEncoding, sizeof(Jwl::VertexEncoding), 1, modelFile);
 	fwrite(&numVertices, sizeof(int), 1, modelFile);
+	fwrite(&numIndices, sizeof(int), 1, modelFile);
+	fwrite(&numLods, sizeof(int), 1, modelFile);
+	for (auto& lod : lods)
+	{
+		fwrite(&lod.firstIndex, sizeof(unsigned), 1, modelFile);
+		fwrite(&lod.indexCount, sizeof(unsigned), 1, modelFile);
+		fwrite(&lod.error, sizeof(float), 1, modelFile);
+	}
 
 	// Write Data.
-	fwrite(data, sizeof(float), bufferSize, modelFile);
+	fwrite(vertices.data(), sizeof(unsigned char), vertices.size(), modelFile);
+	if (useShortIndices)
+	{
+		fwrite(shortIndices.data(), sizeof(unsigned short), shortIndices.size(), modelFile);
+	}
+	else
+	{
+		fwrite(indices.data(), sizeof(unsigned), indices.size(), modelFile);
+	}
 	auto result = fclose(modelFile);
 
 	// Report results.
-	if (result != 0)
+	if (result != 0 || !Jwl::OverwriteFile(outputFile, tempFile))
 	{
+		Jwl::RemoveFile(tempFile);
 		Jwl::Error("Failed to generate mesh Binary\nOutput file could not be saved.");
 		return false;
 	}
@@ -391,6 +659,11 @@ bool MeshEncoder::Convert(std::string_view source, std::string_view destination,
 			Jwl::Warning("Output of tangents was enabled but the mesh has no normals. Normals are required to compute tangents.");
 		}
 
+		if (uvsClamped)
+		{
+			Jwl::Warning("Some uvs were outside of the [0, 1] range supported by \"unorm16\" and were clamped. Consider \"half\" instead.");
+		}
+
 		return true;
 	}
 }
@@ -403,6 +676,19 @@ bool MeshEncoder::Upgrade(Jwl::ConfigTable& metadata, unsigned loadedVersion) co
 		// Added tangents field.
 		metadata.SetValue("tangents", true);
 		break;
+
+	case 2:
+		// Added attribute formats.
+		metadata.SetValue("position_format", "float");
+		metadata.SetValue("uv_format", "float");
+		metadata.SetValue("normal_format", "float");
+		break;
+
+	case 3:
+		// Added levels of detail.
+		metadata.SetValue("lod_count", 1);
+		metadata.SetValue("lod_reduction", 0.5f);
+		break;
 	}
 
 	return true;
@@ -2,6 +2,8 @@
 
 #define CURRENT_VERSION 1
 
+// Passing the extension of the output file, such as Jwl::Encoder(CURRENT_VERSION, ".asset"),
+// lets packing skip files whose output is already up to date.
 Encoder::Encoder()
 	: Jwl::Encoder(CURRENT_VERSION)
 {
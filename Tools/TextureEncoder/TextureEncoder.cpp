@@ -1,12 +1,37 @@
 #include "TextureEncoder.h"
+#include "Jewel3D/Application/ThreadPool.h"
 #include "Jewel3D/Rendering/Rendering.h"
 #include "Jewel3D/Resource/Texture.h"
 #include "Jewel3D/Utilities/String.h"
+#include "Jewel3D/Utilities/TextureCompression.h"
 
-#define CURRENT_VERSION 2
+#include <memory>
+#include <vector>
+
+#define CURRENT_VERSION 3
+
+namespace
+{
+	// Returns false if the setting is not a valid "compression" option.
+	bool ParseCompression(std::string_view str, bool isSRGB, Jwl::TextureFormat& out)
+	{
+		if (Jwl::CompareLowercase(str, "bc1"))
+			out = isSRGB ? Jwl::TextureFormat::sRGB_BC1 : Jwl::TextureFormat::RGB_BC1;
+		else if (Jwl::CompareLowercase(str, "bc3"))
+			out = isSRGB ? Jwl::TextureFormat::sRGBA_BC3 : Jwl::TextureFormat::RGBA_BC3;
+		else if (Jwl::CompareLowercase(str, "bc5"))
+			out = Jwl::TextureFormat::RG_BC5;
+		else if (Jwl::CompareLowercase(str, "bc7"))
+			out = isSRGB ? Jwl::TextureFormat::sRGBA_BC7 : Jwl::TextureFormat::RGBA_BC7;
+		else
+			return Jwl::CompareLowercase(str, "none");
+
+		return true;
+	}
+}
 
 TextureEncoder::TextureEncoder()
-	: Jwl::Encoder(CURRENT_VERSION)
+	: Jwl::Encoder(CURRENT_VERSION, ".texture")
 {
 }
 
@@ -21,6 +46,7 @@ Jwl::ConfigTable TextureEncoder::GetDefault() const
 	defaultConfig.SetValue("wrap_x", "clamp");
 	defaultConfig.SetValue("wrap_y", "clamp");
 	defaultConfig.SetValue("s_rgb", "true");
+	defaultConfig.SetValue("compression", "none");
 
 	return defaultConfig;
 }
@@ -110,13 +136,37 @@ bool TextureEncoder::Validate(const Jwl::ConfigTable& metadata, unsigned loadedV
 		break;
 
 	case 2:
+	case 3:
 		if (!metadata.HasSetting("s_rgb"))
 		{
 			Jwl::Error("Missing \"s_rgb\" value.");
 			return false;
 		}
 
-		if (metadata.GetSize() != 7)
+		if (loadedVersion == 2)
+		{
+			if (metadata.GetSize() != 7)
+			{
+				Jwl::Error("Incorrect number of value entries.");
+				return false;
+			}
+			break;
+		}
+
+		if (!metadata.HasSetting("compression"))
+		{
+			Jwl::Error("Missing \"compression\" value.");
+			return false;
+		}
+
+		Jwl::TextureFormat format;
+		if (!ParseCompression(metadata.GetString("compression"), false, format))
+		{
+			Jwl::Error("\"compression\" is invalid. Valid options are \"none\", \"bc1\", \"bc3\", \"bc5\", or \"bc7\".");
+			return false;
+		}
+
+		if (metadata.GetSize() != 8)
 		{
 			Jwl::Error("Incorrect number of value entries.");
 			return false;
@@ -129,13 +179,20 @@ bool TextureEncoder::Validate(const Jwl::ConfigTable& metadata, unsigned loadedV
 
 bool TextureEncoder::Convert(std::string_view source, std::string_view destination, const Jwl::ConfigTable& metadata) const
 {
-	const std::string outputFile = std::string(destination) + Jwl::ExtractFilename(source) + ".texture";
+	const std::string outputFile = GetOutputFile(source, destination);
 	const float anisotropicLevel = metadata.GetFloat("anisotropic_level");
 	const bool isCubemap = metadata.GetBool("cubemap");
-	const bool isSRGB = metadata.GetBool("s_rgb");
 	const Jwl::TextureFilter filter = Jwl::StringToTextureFilter(metadata.GetString("filter"));
-	const Jwl::TextureWrap wrapX = Jwl::StringToTextureWrap(metadata.GetString("wrap_x"));
-	const Jwl::TextureWrap wrapY = Jwl::StringToTextureWrap(metadata.GetString("wrap_y"));
+	Jwl::TextureWrap wrapX = Jwl::StringToTextureWrap(metadata.GetString("wrap_x"));
+	Jwl::TextureWrap wrapY = Jwl::StringToTextureWrap(metadata.GetString("wrap_y"));
+	const std::string compression = metadata.GetString("compression");
+	bool isSRGB = metadata.GetBool("s_rgb");
+
+	if (isSRGB && Jwl::CompareLowercase(compression, "bc5"))
+	{
+		Jwl::Warning("\"bc5\" compression does not support sRGB. The texture will be treated as linear.");
+		isSRGB = false;
+	}
 
 	auto image = Jwl::Image::Load(source, !isCubemap, isSRGB);
 	if (image.data == nullptr)
@@ -143,20 +200,24 @@ bool TextureEncoder::Convert(std::string_view source, std::string_view destinati
 
 	const unsigned elementCount = Jwl::CountChannels(image.format);
 
-	// Save file.
-	FILE* fontFile = fopen(outputFile.c_str(), "wb");
-	if (fontFile == nullptr)
+	Jwl::TextureFormat format = image.format;
+	ParseCompression(compression, isSRGB, format);
+
+	if (elementCount == 4 && (format == Jwl::TextureFormat::RGB_BC1 || format == Jwl::TextureFormat::sRGB_BC1))
 	{
-		Jwl::Error("Output file could not be created.");
-		return false;
+		Jwl::Warning("\"bc1\" compression does not store an alpha channel. Consider \"bc3\" or \"bc7\" instead.");
 	}
 
+	unsigned width = image.width;
+	unsigned height = image.height;
+
+	// The full resolution image of each face.
+	std::vector<std::vector<unsigned char>> faces;
 	if (isCubemap)
 	{
 		// Validate size. Width to height ratio must be 4/3.
 		if (image.width * 3 != image.height * 4)
 		{
-			fclose(fontFile);
 			Jwl::Error("Cubemap texture layout is incorrect.");
 			return false;
 		}
@@ -168,67 +229,106 @@ bool TextureEncoder::Convert(std::string_view source, std::string_view destinati
 		}
 
 		const unsigned faceSize = image.width / 4;
-		const Jwl::TextureWrap cubeMapWrapMode = Jwl::TextureWrap::Clamp;
-
-		// Write header.
-		fwrite(&isCubemap, sizeof(bool), 1, fontFile);
-		fwrite(&faceSize, sizeof(unsigned), 1, fontFile);
-		fwrite(&faceSize, sizeof(unsigned), 1, fontFile);
-		fwrite(&image.format, sizeof(Jwl::TextureFormat), 1, fontFile);
-		fwrite(&filter, sizeof(Jwl::TextureFilter), 1, fontFile);
-		fwrite(&cubeMapWrapMode, sizeof(Jwl::TextureWrap), 1, fontFile);
-		fwrite(&cubeMapWrapMode, sizeof(Jwl::TextureWrap), 1, fontFile);
-		fwrite(&anisotropicLevel, sizeof(float), 1, fontFile);
-
-		// Write faces.
-		const unsigned textureSize = faceSize * faceSize * elementCount;
-		unsigned char* data = static_cast<unsigned char*>(malloc(sizeof(unsigned char) * textureSize * 6));
-		defer { free(data); };
+		wrapX = Jwl::TextureWrap::Clamp;
+		wrapY = Jwl::TextureWrap::Clamp;
+		width = faceSize;
+		height = faceSize;
 
 		// Strip out the dead space of the source texture, the final data is 6 textures in sequence.
-		auto copyFace = [&image, faceSize, elementCount](unsigned char* dest, unsigned startX, unsigned startY)
+		auto copyFace = [&image, faceSize, elementCount](std::vector<unsigned char>& dest, unsigned startX, unsigned startY)
 		{
+			dest.reserve(faceSize * faceSize * elementCount);
 			for (unsigned y = startY; y < startY + faceSize; ++y)
 			{
-				for (unsigned x = startX; x < startX + faceSize; ++x)
-				{
-					unsigned index = (x + y * image.width) * elementCount;
-
-					memcpy(dest, image.data + index, elementCount);
-					dest += elementCount;
-				}
+				const unsigned char* row = image.data + (startX + y * image.width) * elementCount;
+				dest.insert(dest.end(), row, row + faceSize * elementCount);
 			}
 		};
-		
-		copyFace(data, faceSize * 2, faceSize);						// +X
-		copyFace(data + 1 * textureSize, 0, faceSize);				// -X
-		copyFace(data + 2 * textureSize, faceSize, 0);				// +Y
-		copyFace(data + 3 * textureSize, faceSize, faceSize * 2);	// -Y
-		copyFace(data + 4 * textureSize, faceSize, faceSize);		// +Z
-		copyFace(data + 5 * textureSize, faceSize * 3, faceSize);	// -Z
-
-		fwrite(data, sizeof(unsigned char), textureSize * 6, fontFile);
+
+		faces.resize(6);
+		copyFace(faces[0], faceSize * 2, faceSize);	// +X
+		copyFace(faces[1], 0, faceSize);			// -X
+		copyFace(faces[2], faceSize, 0);			// +Y
+		copyFace(faces[3], faceSize, faceSize * 2);	// -Y
+		copyFace(faces[4], faceSize, faceSize);		// +Z
+		copyFace(faces[5], faceSize * 3, faceSize);	// -Z
 	}
 	else
 	{
-		// Write header.
-		fwrite(&isCubemap, sizeof(bool), 1, fontFile);
-		fwrite(&image.width, sizeof(unsigned), 1, fontFile);
-		fwrite(&image.height, sizeof(unsigned), 1, fontFile);
-		fwrite(&image.format, sizeof(Jwl::TextureFormat), 1, fontFile);
-		fwrite(&filter, sizeof(Jwl::TextureFilter), 1, fontFile);
-		fwrite(&wrapX, sizeof(Jwl::TextureWrap), 1, fontFile);
-		fwrite(&wrapY, sizeof(Jwl::TextureWrap), 1, fontFile);
-		fwrite(&anisotropicLevel, sizeof(float), 1, fontFile);
-
-		// Write Data.
-		const unsigned textureSize = image.width * image.height * elementCount;
-		fwrite(image.data, sizeof(unsigned char), textureSize, fontFile);
+		faces.emplace_back(image.data, image.data + image.width * image.height * elementCount);
 	}
 
-	auto result = fclose(fontFile);
-	if (result != 0)
+	// Each image is split into strips which are processed across all cores.
+	std::unique_ptr<Jwl::ThreadPool> pool;
+	if (numThreads != 1)
 	{
+		pool = std::make_unique<Jwl::ThreadPool>(numThreads);
+	}
+
+	// Precompute the mip chain of each face, so that none need to be generated when loading.
+	// levels[level][face]
+	const unsigned numLevels = Jwl::CountMipLevels(width, height, filter);
+	std::vector<std::vector<std::vector<unsigned char>>> levels(numLevels, std::vector<std::vector<unsigned char>>(faces.size()));
+	for (unsigned face = 0; face < faces.size(); ++face)
+	{
+		levels[0][face] = std::move(faces[face]);
+
+		for (unsigned level = 1; level < numLevels; ++level)
+		{
+			Jwl::DownsampleImage(
+				levels[level - 1][face].data(),
+				std::max(width >> (level - 1), 1u),
+				std::max(height >> (level - 1), 1u),
+				elementCount, isSRGB, levels[level][face], pool.get());
+		}
+	}
+
+	if (Jwl::IsCompressed(format))
+	{
+		std::vector<unsigned char> blocks;
+		for (unsigned level = 0; level < numLevels; ++level)
+		{
+			for (auto& levelFace : levels[level])
+			{
+				Jwl::CompressImage(levelFace.data(), std::max(width >> level, 1u), std::max(height >> level, 1u), elementCount, format, blocks, pool.get());
+				levelFace.swap(blocks);
+			}
+		}
+	}
+
+	// Save file. It is written beside the output first, since the engine might have the old one mapped.
+	const std::string tempFile = outputFile + ".tmp";
+	FILE* textureFile = fopen(tempFile.c_str(), "wb");
+	if (textureFile == nullptr)
+	{
+		Jwl::Error("Output file could not be created.");
+		return false;
+	}
+
+	// Write header.
+	fwrite(&isCubemap, sizeof(bool), 1, textureFile);
+	fwrite(&width, sizeof(unsigned), 1, textureFile);
+	fwrite(&height, sizeof(unsigned), 1, textureFile);
+	fwrite(&format, sizeof(Jwl::TextureFormat), 1, textureFile);
+	fwrite(&filter, sizeof(Jwl::TextureFilter), 1, textureFile);
+	fwrite(&wrapX, sizeof(Jwl::TextureWrap), 1, textureFile);
+	fwrite(&wrapY, sizeof(Jwl::TextureWrap), 1, textureFile);
+	fwrite(&anisotropicLevel, sizeof(float), 1, textureFile);
+	fwrite(&numLevels, sizeof(unsigned), 1, textureFile);
+
+	// Write data, from the largest level to the smallest. Each level stores all of its faces in sequence.
+	for (auto& level : levels)
+	{
+		for (auto& levelFace : level)
+		{
+			fwrite(levelFace.data(), sizeof(unsigned char), levelFace.size(), textureFile);
+		}
+	}
+
+	auto result = fclose(textureFile);
+	if (result != 0 || !Jwl::OverwriteFile(outputFile, tempFile))
+	{
+		Jwl::RemoveFile(tempFile);
 		Jwl::Error("Failed to generate Texture Binary\nOutput file could not be saved.");
 		return false;
 	}
@@ -244,6 +344,11 @@ bool TextureEncoder::Upgrade(Jwl::ConfigTable& metadata, unsigned loadedVersion)
 		// Added s_rgb field.
 		metadata.SetValue("s_rgb", "true");
 		break;
+
+	case 2:
+		// Added compression field.
+		metadata.SetValue("compression", "none");
+		break;
 	}
 
 	return true;